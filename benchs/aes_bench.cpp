@@ -2,6 +2,7 @@
 #include <hj/crypto/aes.hpp>
 #include <vector>
 #include <random>
+#include <sstream>
 #include <string>
 
 static std::vector<unsigned char> make_random_vec(size_t len)
@@ -131,3 +132,195 @@ static void bm_aes_decrypt_large_cbc_pkcs7(benchmark::State &state)
     }
 }
 BENCHMARK(bm_aes_decrypt_large_cbc_pkcs7);
+
+// 1-2KB messages under one key: static api (key setup per call) against a
+// reused session and a batch of 16 messages
+static std::string nonce = std::string(12, 'N');
+
+static void bm_aes_gcm_msg_static(benchmark::State &state)
+{
+    auto                       msg = make_random_vec(state.range(0));
+    std::vector<unsigned char> out(msg.size() + 32);
+    for(auto _ : state)
+    {
+        std::size_t out_len = out.size();
+        auto        ec      = hj::aes::encrypt(
+            out.data(),
+            out_len,
+            msg.data(),
+            msg.size(),
+            reinterpret_cast<const unsigned char *>(key256.c_str()),
+            key256.size(),
+            hj::aes::mode::gcm,
+            hj::aes::padding::pkcs7,
+            reinterpret_cast<const unsigned char *>(nonce.c_str()),
+            nonce.size());
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+BENCHMARK(bm_aes_gcm_msg_static)->Arg(1024)->Arg(2048);
+
+static void bm_aes_gcm_msg_session(benchmark::State &state)
+{
+    auto                       msg = make_random_vec(state.range(0));
+    std::vector<unsigned char> out(msg.size() + 32);
+    hj::aes::session           sess{
+        reinterpret_cast<const unsigned char *>(key256.c_str()),
+        key256.size(),
+        hj::aes::mode::gcm};
+    for(auto _ : state)
+    {
+        std::size_t out_len = out.size();
+        auto        ec      = sess.encrypt(
+            out.data(),
+            out_len,
+            msg.data(),
+            msg.size(),
+            reinterpret_cast<const unsigned char *>(nonce.c_str()),
+            nonce.size());
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+BENCHMARK(bm_aes_gcm_msg_session)->Arg(1024)->Arg(2048);
+
+static void bm_aes_gcm_msg_batch(benchmark::State &state)
+{
+    const std::size_t n   = 16;
+    auto              msg = make_random_vec(state.range(0));
+    std::vector<std::vector<unsigned char>> outs(
+        n,
+        std::vector<unsigned char>(msg.size() + 32));
+    std::vector<hj::aes::batch_item> items(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        items[i].dst     = outs[i].data();
+        items[i].src     = msg.data();
+        items[i].src_len = msg.size();
+        items[i].iv      = reinterpret_cast<const unsigned char *>(
+            nonce.c_str());
+        items[i].iv_len  = nonce.size();
+    }
+
+    hj::aes::session sess{
+        reinterpret_cast<const unsigned char *>(key256.c_str()),
+        key256.size(),
+        hj::aes::mode::gcm};
+    for(auto _ : state)
+    {
+        auto ec = sess.encrypt_batch(items.data(), n);
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * n * msg.size());
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(bm_aes_gcm_msg_batch)->Arg(1024)->Arg(2048);
+
+static void bm_aes_cbc_msg_static(benchmark::State &state)
+{
+    auto                       msg = make_random_vec(state.range(0));
+    std::vector<unsigned char> out(msg.size() + 32);
+    for(auto _ : state)
+    {
+        std::size_t out_len = out.size();
+        auto        ec      = hj::aes::encrypt(
+            out.data(),
+            out_len,
+            msg.data(),
+            msg.size(),
+            reinterpret_cast<const unsigned char *>(key256.c_str()),
+            key256.size(),
+            hj::aes::mode::cbc,
+            hj::aes::padding::pkcs7,
+            reinterpret_cast<const unsigned char *>(iv.c_str()),
+            iv.size());
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+BENCHMARK(bm_aes_cbc_msg_static)->Arg(1024)->Arg(2048);
+
+static void bm_aes_cbc_msg_session(benchmark::State &state)
+{
+    auto                       msg = make_random_vec(state.range(0));
+    std::vector<unsigned char> out(msg.size() + 32);
+    hj::aes::session           sess{
+        reinterpret_cast<const unsigned char *>(key256.c_str()),
+        key256.size(),
+        hj::aes::mode::cbc};
+    for(auto _ : state)
+    {
+        std::size_t out_len = out.size();
+        auto        ec      = sess.encrypt(
+            out.data(),
+            out_len,
+            msg.data(),
+            msg.size(),
+            reinterpret_cast<const unsigned char *>(iv.c_str()),
+            iv.size());
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+BENCHMARK(bm_aes_cbc_msg_session)->Arg(1024)->Arg(2048);
+
+// 32MB through the stream api: one AES_BUF_SIZE loop against parallel
+// chunks on range(0) threads
+static std::string stream_data(32 * 1024 * 1024, 'S');
+
+static void bm_aes_ctr_stream_sequential(benchmark::State &state)
+{
+    for(auto _ : state)
+    {
+        std::istringstream in(stream_data);
+        std::ostringstream out;
+        auto               ec = hj::aes::encrypt(
+            out,
+            in,
+            reinterpret_cast<const unsigned char *>(key256.c_str()),
+            key256.size(),
+            hj::aes::mode::ctr,
+            hj::aes::padding::no_padding,
+            reinterpret_cast<const unsigned char *>(iv.c_str()),
+            iv.size());
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * stream_data.size());
+}
+BENCHMARK(bm_aes_ctr_stream_sequential)->Unit(benchmark::kMillisecond);
+
+static void bm_aes_stream_parallel(benchmark::State &state, hj::aes::mode mod)
+{
+    hj::thread_pool           pool{static_cast<unsigned long>(state.range(0))};
+    hj::aes::parallel_options opts;
+    opts.pool = &pool;
+
+    const std::string &v = mod == hj::aes::mode::gcm ? nonce : iv;
+    for(auto _ : state)
+    {
+        std::istringstream in(stream_data);
+        std::ostringstream out;
+        auto               ec = hj::aes::encrypt_parallel(
+            out,
+            in,
+            reinterpret_cast<const unsigned char *>(key256.c_str()),
+            key256.size(),
+            mod,
+            reinterpret_cast<const unsigned char *>(v.c_str()),
+            v.size(),
+            opts);
+        benchmark::DoNotOptimize(ec);
+    }
+    state.SetBytesProcessed(state.iterations() * stream_data.size());
+}
+BENCHMARK_CAPTURE(bm_aes_stream_parallel, ctr, hj::aes::mode::ctr)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(bm_aes_stream_parallel, gcm, hj::aes::mode::gcm)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
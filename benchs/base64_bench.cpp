@@ -4,6 +4,10 @@
 #include <vector>
 #include <random>
 
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/buffer.h>
+
 static std::string make_random_data(size_t len)
 {
     std::string                                 data(len, '\0');
@@ -86,3 +90,106 @@ static void bm_base64_is_valid_large(benchmark::State &state)
     }
 }
 BENCHMARK(bm_base64_is_valid_large);
+
+// the BIO chain base64 used to be built on, as the baseline
+static bool bio_encode(std::string &dst, const std::string &src)
+{
+    BUF_MEM *mem;
+    BIO     *b64 = BIO_new(BIO_f_base64());
+    BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+    BIO_push(b64, BIO_new(BIO_s_mem()));
+    BIO_write(b64, src.data(), static_cast<int>(src.size()));
+    BIO_flush(b64);
+    BIO_get_mem_ptr(b64, &mem);
+    dst.assign(mem->data, mem->length);
+    BIO_free_all(b64);
+    return true;
+}
+
+static bool bio_decode(std::string &dst, const std::string &src)
+{
+    dst.resize(src.size() / 4 * 3);
+    BIO *b64 = BIO_new(BIO_f_base64());
+    BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+    BIO_push(b64, BIO_new_mem_buf(src.data(), static_cast<int>(src.size())));
+    int n = BIO_read(b64, &dst[0], static_cast<int>(dst.size()));
+    BIO_free_all(b64);
+    if(n < 0)
+        return false;
+
+    dst.resize(static_cast<std::size_t>(n));
+    return true;
+}
+
+static void bm_base64_encode_bio(benchmark::State &state)
+{
+    const std::string &src = state.range(0) ? large_data : small_data;
+    std::string        out;
+    for(auto _ : state)
+        benchmark::DoNotOptimize(bio_encode(out, src));
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+}
+BENCHMARK(bm_base64_encode_bio)->Arg(0)->Arg(1);
+
+static void bm_base64_decode_bio(benchmark::State &state)
+{
+    const std::string &src = state.range(0) ? large_data : small_data;
+    std::string        encoded;
+    std::string        out;
+    bio_encode(encoded, src);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(bio_decode(out, encoded));
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+}
+BENCHMARK(bm_base64_decode_bio)->Arg(0)->Arg(1);
+
+// range(0): engine, range(1): 0 small / 1 large
+static void bm_base64_encode_engine(benchmark::State &state)
+{
+    auto e   = static_cast<hj::base64::engine>(state.range(0));
+    auto def = hj::base64::get_engine();
+    if(!hj::base64::set_engine(e))
+    {
+        state.SkipWithError("engine not supported");
+        return;
+    }
+
+    const std::string &src = state.range(1) ? large_data : small_data;
+    std::string        out;
+    for(auto _ : state)
+        benchmark::DoNotOptimize(hj::base64::encode(out, src));
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+    hj::base64::set_engine(def);
+}
+BENCHMARK(bm_base64_encode_engine)
+    ->ArgsProduct({{int(hj::base64::engine::scalar),
+                    int(hj::base64::engine::sse41),
+                    int(hj::base64::engine::avx2),
+                    int(hj::base64::engine::neon)},
+                   {0, 1}});
+
+static void bm_base64_decode_engine(benchmark::State &state)
+{
+    auto e   = static_cast<hj::base64::engine>(state.range(0));
+    auto def = hj::base64::get_engine();
+    if(!hj::base64::set_engine(e))
+    {
+        state.SkipWithError("engine not supported");
+        return;
+    }
+
+    const std::string &src = state.range(1) ? large_data : small_data;
+    std::string        encoded;
+    std::string        out;
+    hj::base64::encode(encoded, src);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(hj::base64::decode(out, encoded));
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+    hj::base64::set_engine(def);
+}
+BENCHMARK(bm_base64_decode_engine)
+    ->ArgsProduct({{int(hj::base64::engine::scalar),
+                    int(hj::base64::engine::sse41),
+                    int(hj::base64::engine::avx2),
+                    int(hj::base64::engine::neon)},
+                   {0, 1}});
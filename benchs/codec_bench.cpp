@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/compress/codec.hpp>
+#include <vector>
+#include <string>
+#include <random>
+
+// Same payloads through gzip, lz4 and zstd at their default levels.
+// "ratio" is compressed / original, lower is better.
+
+enum payload : int
+{
+    small_json = 0, // one ~300 byte RPC message
+    log_text   = 1, // 256KB of access log lines
+    binary     = 2  // 256KB of mostly random bytes
+};
+
+static const std::vector<unsigned char> &codec_payload(int kind)
+{
+    static std::vector<unsigned char> data[3];
+    auto                             &buf = data[kind];
+    if(!buf.empty())
+        return buf;
+
+    std::mt19937 gen(12345);
+    if(kind == small_json)
+    {
+        std::string s =
+            "{\"id\":1234567,\"symbol\":\"AAPL\",\"side\":\"buy\",\"qty\":100,"
+            "\"px\":189.25,\"tif\":\"day\",\"account\":\"ACC-000123\","
+            "\"ts\":\"2025-01-01T09:30:00.123456Z\",\"venue\":\"XNAS\","
+            "\"tags\":[\"algo\",\"vwap\"],\"parent\":1234500,\"status\":"
+            "\"new\",\"filled\":0,\"leaves\":100,\"text\":\"\"}";
+        buf.assign(s.begin(), s.end());
+    } else if(kind == log_text)
+    {
+        const char *paths[] = {"/api/orders", "/api/quotes", "/health"};
+        while(buf.size() < 256 * 1024)
+        {
+            std::string line = "10.0.0." + std::to_string(gen() % 256)
+                               + " - - [01/Jan/2025:09:30:"
+                               + std::to_string(gen() % 60) + "] \"GET "
+                               + paths[gen() % 3] + " HTTP/1.1\" 200 "
+                               + std::to_string(gen() % 5000) + "\n";
+            buf.insert(buf.end(), line.begin(), line.end());
+        }
+    } else
+    {
+        buf.resize(256 * 1024);
+        for(size_t i = 0; i < buf.size(); ++i)
+            buf[i] = static_cast<unsigned char>(i % 16 == 0 ? 0 : gen());
+    }
+    return buf;
+}
+
+static void bm_codec_compress(benchmark::State &state)
+{
+    const auto &c =
+        hj::codec::get(static_cast<hj::codec::algo>(state.range(0)));
+    const auto &src = codec_payload(static_cast<int>(state.range(1)));
+    state.SetLabel(c.name());
+
+    std::vector<unsigned char> out;
+    for(auto _ : state)
+    {
+        if(c.compress(out, src.data(), src.size()) != hj::codec::err::ok)
+            state.SkipWithError("compress failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+    state.counters["ratio"] = double(out.size()) / double(src.size());
+}
+
+static void bm_codec_decompress(benchmark::State &state)
+{
+    const auto &c =
+        hj::codec::get(static_cast<hj::codec::algo>(state.range(0)));
+    const auto &src = codec_payload(static_cast<int>(state.range(1)));
+    state.SetLabel(c.name());
+
+    std::vector<unsigned char> compressed, out;
+    c.compress(compressed, src.data(), src.size());
+    for(auto _ : state)
+    {
+        if(c.decompress(out, compressed.data(), compressed.size())
+           != hj::codec::err::ok)
+            state.SkipWithError("decompress failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+}
+
+// without context reuse: what every small message paid before
+static void bm_zstd_small_fresh_context(benchmark::State &state)
+{
+    const auto                &src = codec_payload(small_json);
+    std::vector<unsigned char> out(ZSTD_compressBound(src.size()));
+    for(auto _ : state)
+    {
+        size_t n = ZSTD_compress(out.data(),
+                                 out.size(),
+                                 src.data(),
+                                 src.size(),
+                                 ZSTD_CLEVEL_DEFAULT);
+        benchmark::DoNotOptimize(n);
+    }
+}
+
+static void codec_args(benchmark::internal::Benchmark *b)
+{
+    for(int a = 0; a < 3; ++a)
+        for(int p = 0; p < 3; ++p)
+            b->Args({a, p});
+}
+
+BENCHMARK(bm_codec_compress)->Apply(codec_args);
+BENCHMARK(bm_codec_decompress)->Apply(codec_args);
+BENCHMARK(bm_zstd_small_fresh_context);
@@ -77,4 +77,49 @@ static void bm_crc32_high_concurrency(benchmark::State &state)
         }
     }
 }
-BENCHMARK(bm_crc32_high_concurrency);
\ No newline at end of file
+BENCHMARK(bm_crc32_high_concurrency);
+// the one byte per step loop crc32() used to be, as the baseline
+static uint32_t crc32_bytewise(const void *buf, size_t len)
+{
+    uint32_t       crc = 0xFFFFFFFF;
+    const uint8_t *u   = static_cast<const uint8_t *>(buf);
+    for(size_t i = 0; i < len; ++i)
+        crc = crc32_table[(crc ^ u[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+// range(0): bytes, a small packet, an MTU sized one and a WAL block
+static void bm_crc32_bytewise(benchmark::State &state)
+{
+    std::string data(static_cast<size_t>(state.range(0)), 'x');
+    for(auto _ : state)
+        benchmark::DoNotOptimize(crc32_bytewise(data.data(), data.size()));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_crc32_bytewise)->Arg(64)->Arg(1500)->Arg(65536);
+
+static void bm_crc32_throughput(benchmark::State &state)
+{
+    std::string data(static_cast<size_t>(state.range(0)), 'x');
+    for(auto _ : state)
+        benchmark::DoNotOptimize(crc32(data.data(), data.size(), 0));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_crc32_throughput)->Arg(64)->Arg(1500)->Arg(65536);
+
+static void bm_crc32c_throughput(benchmark::State &state)
+{
+    std::string data(static_cast<size_t>(state.range(0)), 'x');
+    for(auto _ : state)
+        benchmark::DoNotOptimize(crc32c(data.data(), data.size(), 0));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_crc32c_throughput)->Arg(64)->Arg(1500)->Arg(65536);
+
+static void bm_crc32_combine(benchmark::State &state)
+{
+    for(auto _ : state)
+        benchmark::DoNotOptimize(
+            hj_crc32_combine(0x12345678, 0x9ABCDEF0, 65536));
+}
+BENCHMARK(bm_crc32_combine);
@@ -1,7 +1,12 @@
 #include <benchmark/benchmark.h>
 #include <hj/hardware/dpdk.h>
+#include <cstdlib>
 #include <cstring>
 
+#if defined(PKT_PLATFORM_LINUX)
+#include <sys/types.h>
+#endif
+
 // Benchmark that simply checks whether DPDK support was compiled in
 static void bm_dpdk_compiled_flag(benchmark::State &st)
 {
@@ -36,3 +41,145 @@ static void bm_simulated_packet_processing(benchmark::State &st)
     }
 }
 BENCHMARK(bm_simulated_packet_processing)->Iterations(2000);
+
+
+#if defined(PKT_PLATFORM_LINUX)
+
+static bool bench_allow_net()
+{
+    return std::getenv("HJ_BENCH_ALLOW_NET") != nullptr;
+}
+
+static const uint16_t bench_pkt_ether = 0x88B5;
+
+static bool bench_pkt_open(pkt_queue_t *q, uint32_t blocks, uint32_t tx)
+{
+    pkt_queue_conf_t conf;
+    pkt_queue_conf_default(&conf);
+    conf.ifname         = "lo";
+    conf.block_count    = blocks;
+    conf.tx_frame_count = tx;
+    return pkt_queue_open(q, &conf) == PKT_OK;
+}
+
+static bool bench_pkt_is_test(const uint8_t *data, size_t len)
+{
+    return len >= 14 && data[12] == (bench_pkt_ether >> 8)
+           && data[13] == (bench_pkt_ether & 0xff);
+}
+
+// queues a burst of 64B test frames on lo through the tx ring
+static void bench_pkt_send(pkt_queue_t *tx, uint32_t burst)
+{
+    for(uint32_t i = 0; i < burst; ++i)
+    {
+        uint32_t cap   = 0;
+        uint8_t *frame = pkt_tx_frame(tx, &cap);
+        if(frame == NULL)
+            break;
+
+        memset(frame, 0, 64);
+        frame[12] = bench_pkt_ether >> 8;
+        frame[13] = bench_pkt_ether & 0xff;
+        pkt_tx_commit(tx, 64);
+    }
+    pkt_tx_flush(tx);
+}
+
+// rx through the mmapped TPACKET_V3 ring, no syscall and no copy per packet;
+// both benches send a burst per iteration and drain what is ready, so a
+// partially filled block waits for block_timeout_ms without stalling them
+static void bm_pkt_ring_rx_burst(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    pkt_queue_t rx, tx;
+    if(!bench_pkt_open(&rx, 16, 0))
+    {
+        state.SkipWithError("AF_PACKET ring not available");
+        return;
+    }
+    if(!bench_pkt_open(&tx, 0, 1024))
+    {
+        pkt_queue_close(&rx);
+        state.SkipWithError("AF_PACKET ring not available");
+        return;
+    }
+
+    const auto burst = static_cast<uint32_t>(state.range(0));
+    pkt_view_t views[PKT_MAX_BURST];
+    int64_t    total = 0;
+    for(auto _ : state)
+    {
+        bench_pkt_send(&tx, burst);
+        uint32_t n;
+        while((n = pkt_rx_burst(&rx, views, PKT_MAX_BURST)) > 0)
+        {
+            for(uint32_t i = 0; i < n; ++i)
+                total += bench_pkt_is_test(views[i].data, views[i].len);
+            pkt_rx_release(&rx);
+        }
+    }
+    state.SetItemsProcessed(total);
+
+    pkt_queue_close(&tx);
+    pkt_queue_close(&rx);
+}
+BENCHMARK(bm_pkt_ring_rx_burst)->Arg(1)->Arg(32)->Arg(256);
+
+// same traffic through recv() on a plain AF_PACKET socket, one syscall and
+// one copy per packet
+static void bm_pkt_socket_recv(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    pkt_queue_t tx;
+    if(!bench_pkt_open(&tx, 0, 1024))
+    {
+        state.SkipWithError("AF_PACKET ring not available");
+        return;
+    }
+
+    int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family   = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex  = (int) if_nametoindex("lo");
+    int one           = 1;
+    setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one));
+    if(fd < 0 || bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0)
+    {
+        if(fd >= 0)
+            close(fd);
+        pkt_queue_close(&tx);
+        state.SkipWithError("AF_PACKET socket not available");
+        return;
+    }
+
+    const auto burst = static_cast<uint32_t>(state.range(0));
+    uint8_t    buf[2048];
+    int64_t    total = 0;
+    for(auto _ : state)
+    {
+        bench_pkt_send(&tx, burst);
+        ssize_t len;
+        while((len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) >= 0)
+            total += bench_pkt_is_test(buf, (size_t) len);
+    }
+    state.SetItemsProcessed(total);
+
+    close(fd);
+    pkt_queue_close(&tx);
+}
+BENCHMARK(bm_pkt_socket_recv)->Arg(1)->Arg(32)->Arg(256);
+
+#endif // PKT_PLATFORM_LINUX
@@ -3,9 +3,15 @@
 #ifdef GRPC_ENABLE
 #include <hj/net/grpc.hpp>
 #include <grpcpp/grpcpp.h>
+#include "grpc/grpc_test.grpc.pb.h"
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 
 #ifdef GRPC_ENABLE
 static void bm_grpc_channel_connect(benchmark::State &state)
@@ -32,8 +38,143 @@ static void bm_grpc_server_start_stop(benchmark::State &state)
     }
 }
 
+using namespace GrpcLibrary;
+
+static bool bench_allow_net()
+{
+    return std::getenv("HJ_BENCH_ALLOW_NET") != nullptr;
+}
+
+class SyncHelloImpl : public GrpcService::Service
+{
+  public:
+    grpc::Status SayHello(grpc::ServerContext *,
+                          const HelloRequest *req,
+                          HelloReply         *rep) override
+    {
+        rep->set_message("Hello, " + req->name());
+        return grpc::Status::OK;
+    }
+};
+
+// closed loop: every client thread keeps one SayHello in flight
+static void run_clients(benchmark::State  &state,
+                        const std::string &addr,
+                        int                clients)
+{
+    const int           per_client = 500;
+    std::vector<double> lat;
+    std::size_t         failed = 0;
+    auto                ch =
+        grpc::CreateChannel(addr, grpc::InsecureChannelCredentials());
+    auto stub = GrpcService::NewStub(ch);
+    for(auto _ : state)
+    {
+        std::vector<std::vector<double>> per(clients);
+        std::vector<std::size_t>         errs(clients, 0);
+        std::vector<std::thread>         pool;
+        for(int c = 0; c < clients; ++c)
+            pool.emplace_back([&, c]() {
+                HelloRequest req;
+                req.set_name("bench");
+                for(int i = 0; i < per_client; ++i)
+                {
+                    HelloReply          rep;
+                    grpc::ClientContext ctx;
+                    auto                t0 = std::chrono::steady_clock::now();
+                    if(!stub->SayHello(&ctx, req, &rep).ok())
+                        errs[c]++;
+                    per[c].push_back(
+                        std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - t0)
+                            .count());
+                }
+            });
+        for(auto &th : pool)
+            th.join();
+        for(int c = 0; c < clients; ++c)
+        {
+            lat.insert(lat.end(), per[c].begin(), per[c].end());
+            failed += errs[c];
+        }
+    }
+
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&lat](double p) {
+        return lat.empty()
+                   ? 0.0
+                   : lat[static_cast<std::size_t>(p * (lat.size() - 1))];
+    };
+    state.SetItemsProcessed(state.iterations() * clients * per_client);
+    state.counters["p50_us"] = pct(0.50);
+    state.counters["p99_us"] = pct(0.99);
+    state.counters["errors"] = static_cast<double>(failed);
+}
+
+// Args: completion queues, client threads
+static void bm_grpc_async_server_unary(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    hj::grpc_async_server_options opts;
+    opts.cq_num = static_cast<std::size_t>(state.range(0));
+    GrpcService::AsyncService svc; // outlives the server
+    hj::grpc_async_server     server{opts};
+    server.unary<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestSayHello,
+        [](grpc::ServerContext &, const HelloRequest &req, HelloReply &rep) {
+            rep.set_message("Hello, " + req.name());
+            return grpc::Status::OK;
+        });
+    if(!server.start("127.0.0.1:0", &svc))
+    {
+        state.SkipWithError("start failed");
+        return;
+    }
+    run_clients(state,
+                "127.0.0.1:" + std::to_string(server.port()),
+                static_cast<int>(state.range(1)));
+}
+
+// Args: client threads; grpc's synchronous thread pool path
+static void bm_grpc_sync_server_unary(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    SyncHelloImpl   svc;
+    hj::grpc_server server;
+    if(!server.start("127.0.0.1:50061", &svc))
+    {
+        state.SkipWithError("start failed");
+        return;
+    }
+    run_clients(state, "127.0.0.1:50061", static_cast<int>(state.range(0)));
+}
+
 BENCHMARK(bm_grpc_channel_connect);
 BENCHMARK(bm_grpc_server_start_stop);
+BENCHMARK(bm_grpc_async_server_unary)
+    ->Args({1, 1})
+    ->Args({1, 16})
+    ->Args({4, 16})
+    ->Args({4, 64})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_grpc_sync_server_unary)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
 #else
 // GRPC not enabled: provide tiny no-op benchmarks so file compiles.
 static void bm_grpc_noop(benchmark::State &state)
@@ -153,6 +153,101 @@ static void bm_gzip_compression_ratio(benchmark::State &state)
     }
 }
 
+// ~8MB of log lines, the shape compress_parallel is meant for
+static const std::vector<unsigned char> &gzip_log_data()
+{
+    static std::vector<unsigned char> data = [] {
+        std::mt19937               gen(12345);
+        std::vector<unsigned char> v;
+        while(v.size() < 8 * 1024 * 1024)
+        {
+            std::string line = "2025-01-01 12:00:00 INFO id="
+                               + std::to_string(gen() % 100000)
+                               + " status=200 latency_us="
+                               + std::to_string(gen() % 5000) + "\n";
+            v.insert(v.end(), line.begin(), line.end());
+        }
+        return v;
+    }();
+    return data;
+}
+
+static void bm_gzip_compress_log_sequential(benchmark::State &state)
+{
+    const auto                &src = gzip_log_data();
+    std::vector<unsigned char> out;
+    for(auto _ : state)
+    {
+        if(gzip::compress(out, src.data(), src.size()) != gzip::err::ok)
+            state.SkipWithError("compress failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+    state.counters["ratio"] = gzip::compression_ratio(src.size(), out.size());
+}
+
+// arg0: threads, arg1: indexed
+static void bm_gzip_compress_log_parallel(benchmark::State &state)
+{
+    const auto                &src = gzip_log_data();
+    std::vector<unsigned char> out;
+    thread_pool                pool(static_cast<size_t>(state.range(0)));
+    gzip::parallel_options     opts;
+    opts.pool    = &pool;
+    opts.indexed = state.range(1) != 0;
+    for(auto _ : state)
+    {
+        if(gzip::compress_parallel(out,
+                                   src.data(),
+                                   src.size(),
+                                   gzip::compression_lvl::default_compression,
+                                   gzip::mem_lvl::default_level,
+                                   opts)
+           != gzip::err::ok)
+            state.SkipWithError("compress_parallel failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+    state.counters["ratio"] = gzip::compression_ratio(src.size(), out.size());
+}
+
+static void bm_gzip_decompress_log(benchmark::State &state)
+{
+    const auto                &src = gzip_log_data();
+    std::vector<unsigned char> packed, out;
+    thread_pool                pool(static_cast<size_t>(state.range(0)));
+    gzip::parallel_options     opts;
+    opts.pool    = &pool;
+    opts.indexed = true;
+    if(gzip::compress_parallel(packed,
+                               src.data(),
+                               src.size(),
+                               gzip::compression_lvl::default_compression,
+                               gzip::mem_lvl::default_level,
+                               opts)
+       != gzip::err::ok)
+    {
+        state.SkipWithError("prepare compress failed");
+        return;
+    }
+
+    // arg0 == 0: sequential decompress of the same bytes
+    for(auto _ : state)
+    {
+        auto res = state.range(0) == 0
+                       ? gzip::decompress(out, packed.data(), packed.size())
+                       : gzip::decompress_parallel(out,
+                                                   packed.data(),
+                                                   packed.size(),
+                                                   0,
+                                                   opts);
+        if(res != gzip::err::ok)
+            state.SkipWithError("decompress failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * src.size());
+}
+
 BENCHMARK(bm_gzip_compress_small);
 BENCHMARK(bm_gzip_decompress_small);
 BENCHMARK(bm_gzip_compress_random);
@@ -160,3 +255,17 @@ BENCHMARK(bm_gzip_compress_large);
 BENCHMARK(bm_gzip_stream_compress);
 BENCHMARK(bm_gzip_crc32);
 BENCHMARK(bm_gzip_compression_ratio);
+BENCHMARK(bm_gzip_compress_log_sequential)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_gzip_compress_log_parallel)
+    ->Args({1, 0})
+    ->Args({2, 0})
+    ->Args({4, 0})
+    ->Args({4, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_gzip_decompress_log)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
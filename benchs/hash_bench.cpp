@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <hj/algo/hash.hpp>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+
+static void bm_hash64(benchmark::State &state)
+{
+    std::string buf(static_cast<size_t>(state.range(0)), 'x');
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(hj::hash64(buf.data(), buf.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_hash64)->Arg(8)->Arg(16)->Arg(64)->Arg(1024)->Arg(65536);
+
+static void bm_std_hash_string_view(benchmark::State &state)
+{
+    std::string      buf(static_cast<size_t>(state.range(0)), 'x');
+    std::string_view sv{buf};
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::hash<std::string_view>{}(sv));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_std_hash_string_view)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(65536);
+
+static void bm_hash128(benchmark::State &state)
+{
+    std::string buf(static_cast<size_t>(state.range(0)), 'x');
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(hj::hash128(buf.data(), buf.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(bm_hash128)->Arg(16)->Arg(1024);
+
+static void bm_hasher64_update(benchmark::State &state)
+{
+    std::string buf(65536, 'x');
+    size_t      chunk = static_cast<size_t>(state.range(0));
+    for(auto _ : state)
+    {
+        hj::hasher64 h;
+        for(size_t off = 0; off < buf.size(); off += chunk)
+            h.update(buf.data() + off, std::min(chunk, buf.size() - off));
+        benchmark::DoNotOptimize(h.finish());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 65536);
+}
+BENCHMARK(bm_hasher64_update)->Arg(7)->Arg(64)->Arg(4096);
+
+static void bm_hash_mix_int(benchmark::State &state)
+{
+    uint64_t v = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(hj::hash<uint64_t>{}(++v));
+    }
+}
+BENCHMARK(bm_hash_mix_int);
+
+static void bm_std_hash_int(benchmark::State &state)
+{
+    uint64_t v = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::hash<uint64_t>{}(++v));
+    }
+}
+BENCHMARK(bm_std_hash_int);
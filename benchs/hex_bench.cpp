@@ -95,9 +95,61 @@ static void bm_hex_is_valid_file(benchmark::State &state)
     }
 }
 
+// range(0): input bytes, e.g. an order id (16) or a sha256 digest (32)
+static void bm_hex_encode_string(benchmark::State &state)
+{
+    std::string data(static_cast<std::size_t>(state.range(0)), '\xA5');
+    for(auto _ : state)
+        benchmark::DoNotOptimize(hex::encode(data, false));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void bm_hex_encode_to(benchmark::State &state)
+{
+    std::vector<unsigned char> data(static_cast<std::size_t>(state.range(0)),
+                                    0xA5);
+    std::vector<char>          buf(data.size() * 2);
+    for(auto _ : state)
+    {
+        std::size_t n = buf.size();
+        benchmark::DoNotOptimize(
+            hex::encode_to(buf.data(), n, data.data(), data.size(), false));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void bm_hex_decode_string(benchmark::State &state)
+{
+    std::string encoded = hex::encode(
+        std::string(static_cast<std::size_t>(state.range(0)), '\xA5'));
+    for(auto _ : state)
+        benchmark::DoNotOptimize(hex::decode(encoded));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void bm_hex_decode_to(benchmark::State &state)
+{
+    std::string encoded = hex::encode(
+        std::string(static_cast<std::size_t>(state.range(0)), '\xA5'));
+    std::vector<unsigned char> buf(encoded.size() / 2);
+    for(auto _ : state)
+    {
+        std::size_t n = buf.size();
+        benchmark::DoNotOptimize(
+            hex::decode_to(buf.data(), n, encoded.data(), encoded.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
 BENCHMARK(bm_hex_decode_int);
 BENCHMARK(bm_hex_encode_int);
 BENCHMARK(bm_hex_stream_encode);
 BENCHMARK(bm_hex_stream_decode);
 BENCHMARK(bm_hex_is_valid_string);
 BENCHMARK(bm_hex_is_valid_file);
+BENCHMARK(bm_hex_encode_string)->Arg(16)->Arg(32)->Arg(4096);
+BENCHMARK(bm_hex_encode_to)->Arg(16)->Arg(32)->Arg(4096);
+BENCHMARK(bm_hex_decode_string)->Arg(16)->Arg(32)->Arg(4096);
+BENCHMARK(bm_hex_decode_to)->Arg(16)->Arg(32)->Arg(4096);
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/net/http/http_async_client.hpp>
+#include <hj/net/http/http_async_server.hpp>
+#include <hj/net/http/http_client.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool bench_allow_net()
+{
+    return std::getenv("HJ_BENCH_ALLOW_NET") != nullptr;
+}
+
+// local server the clients below talk to
+struct bench_server
+{
+    bench_server()
+        : srv{2}
+    {
+        srv.set_keep_alive_max_count(0);
+        srv.Get("/plaintext", [](const auto &, auto &res) {
+            res.set_content("Hello, World!", "text/plain");
+        });
+        port = srv.bind_to_any_port("127.0.0.1");
+        th   = std::thread([this]() { srv.listen_after_bind(); });
+        srv.wait_until_ready();
+    }
+    ~bench_server()
+    {
+        srv.stop();
+        th.join();
+    }
+
+    hj::http_async_server srv;
+    int                   port;
+    std::thread           th;
+};
+
+// Args: max connections per host, pipeline depth; 1000 requests in flight
+static void bm_http_async_client_get(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    bench_server                  server;
+    boost::asio::io_context       io;
+    auto                          guard = boost::asio::make_work_guard(io);
+    std::thread                   io_th([&io]() { io.run(); });
+    hj::http_async_client_options opts;
+    opts.max_conns_per_host = static_cast<std::size_t>(state.range(0));
+    opts.pipeline_depth     = static_cast<std::size_t>(state.range(1));
+    std::string url =
+        "http://127.0.0.1:" + std::to_string(server.port) + "/plaintext";
+
+    const int n = 1000;
+    {
+        hj::http_async_client cli{io, opts};
+        for(auto _ : state)
+        {
+            std::atomic<int>   done{0};
+            std::promise<void> all;
+            for(int i = 0; i < n; ++i)
+                cli.async_get(url, [&](const auto &, auto) {
+                    if(++done == n)
+                        all.set_value();
+                });
+            all.get_future().wait();
+        }
+        state.counters["conns"] =
+            static_cast<double>(cli.connections_opened());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    guard.reset();
+    io_th.join();
+}
+
+// Args: client threads, reuse client; blocking httplib calls as before
+static void bm_httplib_client_get(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    bench_server server;
+    const int    threads = static_cast<int>(state.range(0));
+    const bool   reuse   = state.range(1) != 0;
+    const int    n       = 1000;
+    for(auto _ : state)
+    {
+        std::vector<std::thread> pool;
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back([&]() {
+                hj::http_client shared{"127.0.0.1", server.port};
+                for(int i = 0; i < n / threads; ++i)
+                {
+                    if(reuse)
+                    {
+                        benchmark::DoNotOptimize(shared.Get("/plaintext"));
+                        continue;
+                    }
+                    hj::http_client cli{"127.0.0.1", server.port};
+                    benchmark::DoNotOptimize(cli.Get("/plaintext"));
+                }
+            });
+        for(auto &th : pool)
+            th.join();
+    }
+    state.SetItemsProcessed(state.iterations() * (n / threads) * threads);
+}
+
+BENCHMARK(bm_http_async_client_get)
+    ->Args({1, 1})
+    ->Args({1, 16})
+    ->Args({8, 1})
+    ->Args({8, 16})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_httplib_client_get)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({8, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
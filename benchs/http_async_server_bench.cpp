@@ -0,0 +1,262 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/net/http/http_async_server.hpp>
+#include <hj/net/http/http_server.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool bench_allow_net()
+{
+    return std::getenv("HJ_BENCH_ALLOW_NET") != nullptr;
+}
+
+// wrk-style closed loop load generator: every connection keeps `depth`
+// pipelined keep-alive requests in flight until it sent `per_conn` requests
+class load_gen
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    load_gen(int         port,
+             std::size_t conns,
+             std::size_t depth,
+             std::size_t per_conn)
+        : _port{port}
+        , _conns{conns}
+        , _depth{depth}
+        , _per_conn{per_conn}
+    {
+        for(std::size_t i = 0; i < depth; ++i)
+            _batch += "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    // returns per batch latencies in microseconds
+    std::vector<double> run(std::size_t threads)
+    {
+        boost::asio::io_context io;
+        _latencies.clear();
+        _failed = 0;
+        for(std::size_t i = 0; i < _conns; ++i)
+        {
+            auto c = std::make_shared<conn>(io);
+            c->sock.async_connect(
+                {boost::asio::ip::make_address("127.0.0.1"),
+                 static_cast<unsigned short>(_port)},
+                [this, c](const boost::system::error_code &ec) {
+                    if(ec)
+                    {
+                        _failed++;
+                        return;
+                    }
+                    c->sock.set_option(boost::asio::ip::tcp::no_delay(true));
+                    _send(c);
+                });
+        }
+
+        std::vector<std::thread> pool;
+        for(std::size_t i = 1; i < threads; ++i)
+            pool.emplace_back([&io]() { io.run(); });
+        io.run();
+        for(auto &t : pool)
+            t.join();
+        return std::move(_latencies);
+    }
+
+    inline std::size_t failed() const { return _failed.load(); }
+
+  private:
+    struct conn
+    {
+        explicit conn(boost::asio::io_context &io)
+            : sock{io}
+        {
+        }
+
+        boost::asio::ip::tcp::socket sock;
+        boost::beast::flat_buffer    buf;
+        std::optional<boost::beast::http::response_parser<
+            boost::beast::http::string_body>>
+                          parser;
+        std::size_t       sent    = 0;
+        std::size_t       pending = 0;
+        clock::time_point start;
+    };
+
+    void _send(std::shared_ptr<conn> c)
+    {
+        if(c->sent >= _per_conn)
+            return;
+
+        c->sent += _depth;
+        c->pending = _depth;
+        c->start   = clock::now();
+        boost::asio::async_write(
+            c->sock,
+            boost::asio::buffer(_batch),
+            [this, c](const boost::system::error_code &ec, std::size_t) {
+                if(ec)
+                {
+                    _failed++;
+                    return;
+                }
+                _recv(c);
+            });
+    }
+
+    void _recv(std::shared_ptr<conn> c)
+    {
+        c->parser.emplace();
+        boost::beast::http::async_read(
+            c->sock,
+            c->buf,
+            *c->parser,
+            [this, c](const boost::system::error_code &ec, std::size_t) {
+                if(ec)
+                {
+                    _failed++;
+                    return;
+                }
+                if(--c->pending > 0)
+                {
+                    _recv(c);
+                    return;
+                }
+
+                double us = std::chrono::duration<double, std::micro>(
+                                clock::now() - c->start)
+                                .count();
+                {
+                    std::lock_guard<std::mutex> lock(_mu);
+                    _latencies.push_back(us);
+                }
+                _send(c);
+            });
+    }
+
+  private:
+    int                      _port;
+    std::size_t              _conns;
+    std::size_t              _depth;
+    std::size_t              _per_conn;
+    std::string              _batch;
+    std::mutex               _mu;
+    std::vector<double>      _latencies;
+    std::atomic<std::size_t> _failed{0};
+};
+
+static void report(benchmark::State    &state,
+                   std::vector<double> &lat,
+                   std::size_t          requests,
+                   std::size_t          failed)
+{
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&lat](double p) {
+        return lat.empty()
+                   ? 0.0
+                   : lat[static_cast<std::size_t>(p * (lat.size() - 1))];
+    };
+    state.SetItemsProcessed(static_cast<int64_t>(requests));
+    state.counters["p50_us"] = pct(0.50);
+    state.counters["p99_us"] = pct(0.99);
+    state.counters["max_us"] = lat.empty() ? 0.0 : lat.back();
+    state.counters["errors"] = static_cast<double>(failed);
+}
+
+// Args: io threads, handler threads, connections, pipeline depth
+static void bm_http_async_server_load(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto io_threads      = static_cast<std::size_t>(state.range(0));
+    const auto handler_threads = static_cast<std::size_t>(state.range(1));
+    const auto conns           = static_cast<std::size_t>(state.range(2));
+    const auto depth           = static_cast<std::size_t>(state.range(3));
+    const auto per_conn        = 64 * depth;
+
+    hj::http_async_server srv{io_threads, handler_threads};
+    srv.set_keep_alive_max_count(0);
+    srv.Get("/plaintext", [](const auto &, auto &res) {
+        res.set_content("Hello, World!", "text/plain");
+    });
+    int         port = srv.bind_to_any_port("127.0.0.1");
+    std::thread th([&srv]() { srv.listen_after_bind(); });
+    srv.wait_until_ready();
+
+    std::vector<double> lat;
+    std::size_t         requests = 0, failed = 0;
+    load_gen            gen{port, conns, depth, per_conn};
+    for(auto _ : state)
+    {
+        auto batch = gen.run(2);
+        lat.insert(lat.end(), batch.begin(), batch.end());
+        requests += conns * per_conn;
+        failed += gen.failed();
+    }
+    srv.stop();
+    th.join();
+    report(state, lat, requests, failed);
+}
+
+// same load against the thread-per-connection httplib server
+static void bm_httplib_server_load(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const std::size_t conns    = static_cast<std::size_t>(state.range(0));
+    const std::size_t depth    = static_cast<std::size_t>(state.range(1));
+    const std::size_t per_conn = 64 * depth;
+
+    hj::http_server srv;
+    srv.set_keep_alive_max_count(per_conn + 1);
+    srv.Get("/plaintext", [](const httplib::Request &, httplib::Response &res) {
+        res.set_content("Hello, World!", "text/plain");
+    });
+    int         port = srv.bind_to_any_port("127.0.0.1");
+    std::thread th([&srv]() { srv.listen_after_bind(); });
+    srv.wait_until_ready();
+
+    std::vector<double> lat;
+    std::size_t         requests = 0, failed = 0;
+    load_gen            gen{port, conns, depth, per_conn};
+    for(auto _ : state)
+    {
+        auto batch = gen.run(2);
+        lat.insert(lat.end(), batch.begin(), batch.end());
+        requests += conns * per_conn;
+        failed += gen.failed();
+    }
+    srv.stop();
+    th.join();
+    report(state, lat, requests, failed);
+}
+
+BENCHMARK(bm_http_async_server_load)
+    ->Args({1, 0, 64, 1})
+    ->Args({4, 0, 64, 1})
+    ->Args({4, 0, 64, 16})
+    ->Args({4, 4, 64, 1})
+    ->Args({4, 0, 1024, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_httplib_server_load)
+    ->Args({64, 1})
+    ->Args({64, 16})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,671 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/net/tcp/tcp_conn.hpp>
+#include <hj/net/tcp/tcp_listener.hpp>
+#include <hj/net/udp/udp_socket.hpp>
+#include <hj/net/http/ws_server.hpp>
+#include <hj/net/http/ws_client.hpp>
+#include <hj/net/zmq.hpp>
+#include <hj/testing/hdr_histogram.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Loopback suite for the tcp / udp / ws / zmq stacks: every connection runs
+// closed loop echo round trips, latencies go to an hdr_histogram and are
+// reported as p50/p99/p99.9/max next to the throughput.
+//
+//   HJ_BENCH_ALLOW_NET=1   enable
+//   HJ_BENCH_NET_FORK=1    run the servers in a forked process instead of a
+//                          thread, so client and server do not share a heap
+//                          or an allocator lock
+
+using namespace std::chrono_literals;
+using bench_clock = std::chrono::steady_clock;
+
+static const std::size_t s_rounds = 256; // round trips per connection
+
+static bool bench_allow_net()
+{
+    return std::getenv("HJ_BENCH_ALLOW_NET") != nullptr;
+}
+
+static bool bench_fork()
+{
+#if defined(_WIN32)
+    return false;
+#else
+    return std::getenv("HJ_BENCH_NET_FORK") != nullptr;
+#endif
+}
+
+// runs a server body on a thread or in a forked child; start() returns once
+// the body called ready() or returned. The body must return by itself once
+// the clients sent their stop message.
+class server_runner
+{
+  public:
+    using ready_t = std::function<void()>;
+    using body_t  = std::function<void(const ready_t &)>;
+
+    ~server_runner() { stop(); }
+
+    // false when the body returned without calling ready()
+    bool start(body_t body)
+    {
+#if !defined(_WIN32)
+        if(bench_fork())
+        {
+            int fds[2];
+            if(::pipe(fds) != 0)
+                return false;
+
+            _pid = ::fork();
+            if(_pid == 0)
+            {
+                ::close(fds[0]);
+                bool sent = false;
+                body([&]() {
+                    char c = 1;
+                    if(!sent && ::write(fds[1], &c, 1) == 1)
+                        sent = true;
+                });
+                ::_exit(0);
+            }
+
+            // EOF when the child died before ready()
+            ::close(fds[1]);
+            char    c = 0;
+            ssize_t n = -1;
+            while(_pid > 0 && (n = ::read(fds[0], &c, 1)) < 0 && errno == EINTR)
+                ;
+            ::close(fds[0]);
+            return n == 1;
+        }
+#endif
+        auto ready = std::make_shared<std::promise<bool>>();
+        auto once  = std::make_shared<std::once_flag>();
+        auto done  = [ready, once](bool ok) {
+            std::call_once(*once, [&]() { ready->set_value(ok); });
+        };
+        _th = std::thread([body, done]() {
+            body([&done]() { done(true); });
+            done(false);
+        });
+        return ready->get_future().get();
+    }
+
+    void stop()
+    {
+        if(_th.joinable())
+            _th.join();
+#if !defined(_WIN32)
+        if(_pid <= 0)
+            return;
+
+        // the stop message should end it, do not hang the run if it did not
+        for(int i = 0; i < 200 && ::waitpid(_pid, nullptr, WNOHANG) == 0; ++i)
+            std::this_thread::sleep_for(10ms);
+        if(::kill(_pid, SIGKILL) == 0)
+            ::waitpid(_pid, nullptr, 0);
+        _pid = -1;
+#endif
+    }
+
+  private:
+    std::thread _th;
+#if !defined(_WIN32)
+    pid_t _pid = -1;
+#endif
+};
+
+// one thread per connection, each does s_rounds round trips per iteration;
+// trip(i) does one on connection i and returns false on error
+template <typename Trip>
+static void run_clients(benchmark::State  &state,
+                        std::size_t        conns,
+                        std::size_t        size,
+                        hj::hdr_histogram &hist,
+                        Trip             &&trip)
+{
+    std::atomic<std::size_t> failed{0};
+    for(auto _ : state)
+    {
+        std::vector<hj::hdr_histogram> part(conns);
+        std::vector<std::thread>       pool;
+        for(std::size_t i = 0; i < conns; ++i)
+            pool.emplace_back([&, i]() {
+                for(std::size_t n = 0; n < s_rounds; ++n)
+                {
+                    auto start = bench_clock::now();
+                    if(!trip(i))
+                    {
+                        failed++;
+                        return;
+                    }
+                    part[i].record(std::chrono::duration_cast<
+                                       std::chrono::nanoseconds>(
+                                       bench_clock::now() - start)
+                                       .count());
+                }
+            });
+        for(auto &th : pool)
+            th.join();
+        for(auto &h : part)
+            hist.merge(h);
+    }
+
+    state.SetItemsProcessed(hist.count());
+    state.SetBytesProcessed(hist.count() * static_cast<int64_t>(size));
+    state.counters["p50_us"]  = hist.percentile(50.0) / 1e3;
+    state.counters["p99_us"]  = hist.percentile(99.0) / 1e3;
+    state.counters["p999_us"] = hist.percentile(99.9) / 1e3;
+    state.counters["max_us"]  = hist.max() / 1e3;
+    state.counters["errors"]  = static_cast<double>(failed.load());
+}
+
+// -----------------------------------------------------------------------------
+// tcp_conn
+// -----------------------------------------------------------------------------
+struct net_msg
+{
+    std::string data;
+};
+
+// 4 byte length + payload, an empty payload asks the server to stop
+static std::size_t net_encode(unsigned char          *buf,
+                              const std::size_t       len,
+                              hj::tcp_conn::msg_ptr_t msg)
+{
+    auto    *m = static_cast<net_msg *>(msg);
+    uint32_t n = static_cast<uint32_t>(m->data.size());
+    if(len < sizeof(n) + n)
+        return 0;
+
+    std::memcpy(buf, &n, sizeof(n));
+    std::memcpy(buf + sizeof(n), m->data.data(), n);
+    return sizeof(n) + n;
+}
+
+static std::size_t net_decode(hj::tcp_conn::msg_ptr_t msg,
+                              const unsigned char    *buf,
+                              const std::size_t       len)
+{
+    uint32_t n = 0;
+    if(len < sizeof(n))
+        return 0;
+
+    std::memcpy(&n, buf, sizeof(n));
+    if(len < sizeof(n) + n)
+        return 0;
+
+    auto *m = static_cast<net_msg *>(msg);
+    m->data.assign(reinterpret_cast<const char *>(buf) + sizeof(n), n);
+    return sizeof(n) + n;
+}
+
+static void set_codec(hj::tcp_conn &conn)
+{
+    conn.set_encode_handler(net_encode);
+    conn.set_decode_handler(net_decode);
+}
+
+// Args: message bytes (a frame must fit in one MTU), connections
+static void bm_net_tcp_conn_echo(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size  = static_cast<std::size_t>(state.range(0));
+    const auto     conns = static_cast<std::size_t>(state.range(1));
+    const uint16_t port  = 22100;
+
+    server_runner srv;
+    bool up = srv.start([conns](const server_runner::ready_t &ready) {
+        hj::tcp_conn::io_t       io;
+        hj::tcp_listener         li{io};
+        std::vector<std::thread> echo;
+        ready();
+        for(std::size_t i = 0; i < conns; ++i)
+        {
+            auto sock = li.accept(port);
+            if(!sock)
+                break;
+
+            echo.emplace_back([&io, sock]() {
+                hj::tcp_conn conn{io, sock};
+                set_codec(conn);
+                net_msg msg;
+                while(conn.recv(&msg) && !msg.data.empty())
+                    if(!conn.send(&msg))
+                        break;
+            });
+        }
+        for(auto &th : echo)
+            th.join();
+        li.close();
+    });
+    if(!up)
+    {
+        state.SkipWithError("server failed to start");
+        return;
+    }
+
+    // connect() runs the io_context, so every connection gets its own
+    std::vector<std::unique_ptr<hj::tcp_conn::io_t>> ios;
+    std::vector<std::unique_ptr<hj::tcp_conn>>       clients;
+    for(std::size_t i = 0; i < conns; ++i)
+    {
+        ios.push_back(std::make_unique<hj::tcp_conn::io_t>());
+        for(int retry = 0; retry < 100; ++retry)
+        {
+            auto conn = std::make_unique<hj::tcp_conn>(*ios.back());
+            if(conn->connect("127.0.0.1", port))
+            {
+                set_codec(*conn);
+                clients.push_back(std::move(conn));
+                break;
+            }
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+
+    if(clients.size() == conns)
+    {
+        std::vector<net_msg> out(conns, net_msg{std::string(size, 'x')});
+        std::vector<net_msg> in(conns);
+        hj::hdr_histogram    hist;
+        run_clients(state, conns, size, hist, [&](std::size_t i) {
+            return clients[i]->send(&out[i]) && clients[i]->recv(&in[i])
+                   && in[i].data.size() == size;
+        });
+    } else
+    {
+        state.SkipWithError("connect failed");
+    }
+
+    net_msg bye;
+    for(auto &conn : clients)
+        conn->send(&bye);
+    srv.stop();
+}
+
+// -----------------------------------------------------------------------------
+// udp::socket
+// -----------------------------------------------------------------------------
+// Args: datagram bytes, sockets; all sockets talk to one server socket, one
+// datagram in flight each so loopback does not drop
+static void bm_net_udp_echo(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size  = static_cast<std::size_t>(state.range(0));
+    const auto     conns = static_cast<std::size_t>(state.range(1));
+    const uint16_t port  = 22200;
+
+    server_runner srv;
+    bool up = srv.start([](const server_runner::ready_t &ready) {
+        boost::asio::io_context io;
+        hj::udp::socket         sock{io.get_executor(), "127.0.0.1", port};
+        std::error_code         ec;
+        sock.set_option(hj::udp::opt::recv_buf_sz(1 << 22), ec);
+        ready();
+
+        // a 1 byte datagram asks the server to stop
+        std::vector<char>         buf(65536);
+        hj::udp::socket::endpoint_t from;
+        while(true)
+        {
+            size_t n = sock.recv(buf.data(), buf.size(), from, ec);
+            if(ec || n <= 1)
+                break;
+            sock.send(buf.data(), n, from, ec);
+        }
+    });
+    if(!up)
+    {
+        state.SkipWithError("server failed to start");
+        return;
+    }
+
+    boost::asio::io_context                       io;
+    auto                                          to =
+        hj::udp::socket::endpoint("127.0.0.1", port);
+    std::vector<std::unique_ptr<hj::udp::socket>> clients;
+    for(std::size_t i = 0; i < conns; ++i)
+        clients.push_back(std::make_unique<hj::udp::socket>(io.get_executor()));
+
+    std::vector<std::string> out(conns, std::string(size, 'x'));
+    std::vector<std::string> in(conns, std::string(65536, '\0'));
+    hj::hdr_histogram        hist;
+    run_clients(state, conns, size, hist, [&](std::size_t i) {
+        std::error_code             ec;
+        hj::udp::socket::endpoint_t from;
+        clients[i]->send(out[i].data(), size, to, ec);
+        if(ec)
+            return false;
+
+        size_t n = clients[i]->recv(&in[i][0], in[i].size(), from, ec);
+        return !ec && n == size;
+    });
+
+    std::error_code ec;
+    clients[0]->send("q", 1, to, ec);
+    srv.stop();
+}
+
+// -----------------------------------------------------------------------------
+// ws_server / ws_client
+// -----------------------------------------------------------------------------
+// Args: message bytes, connections
+static void bm_net_ws_echo(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size  = static_cast<std::size_t>(state.range(0));
+    const auto     conns = static_cast<std::size_t>(state.range(1));
+    const uint16_t port  = 22300;
+
+    server_runner srv;
+    bool up = srv.start([conns](const server_runner::ready_t &ready) {
+        hj::ws_server::io_t      io;
+        auto                     serv = std::make_shared<hj::ws_server>(io);
+        auto                     ep = hj::ws_server::make_endpoint("127.0.0.1",
+                                                                   port);
+        std::vector<std::thread> echo;
+        ready();
+        for(std::size_t i = 0; i < conns; ++i)
+        {
+            hj::ws_server::err_t err;
+            auto                 ws = serv->accept(ep, err);
+            if(err || !ws)
+                break;
+
+            // ends when the client closes
+            echo.emplace_back([serv, ws]() {
+                hj::ws_server::err_t err;
+                while(true)
+                {
+                    auto msg = serv->recv(ws, err);
+                    if(err)
+                        break;
+                    serv->send(ws, err, msg);
+                    if(err)
+                        break;
+                }
+            });
+        }
+        for(auto &th : echo)
+            th.join();
+        serv->close();
+    });
+    if(!up)
+    {
+        state.SkipWithError("server failed to start");
+        return;
+    }
+
+    hj::ws_client::io_t                         io;
+    std::vector<std::shared_ptr<hj::ws_client>> clients;
+    for(std::size_t i = 0; i < conns; ++i)
+    {
+        auto client = std::make_shared<hj::ws_client>(io);
+        for(int retry = 0; retry < 100; ++retry)
+        {
+            if(client->connect("127.0.0.1", std::to_string(port), "/"))
+            {
+                clients.push_back(client);
+                break;
+            }
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+
+    if(clients.size() == conns)
+    {
+        const std::string        out(size, 'x');
+        std::vector<std::string> in(conns);
+        hj::hdr_histogram        hist;
+        run_clients(state, conns, size, hist, [&](std::size_t i) {
+            return clients[i]->send(out) && clients[i]->recv(in[i])
+                   && in[i].size() == size;
+        });
+    } else
+    {
+        state.SkipWithError("connect failed");
+    }
+
+    for(auto &client : clients)
+        client->close();
+    srv.stop();
+}
+
+// -----------------------------------------------------------------------------
+// zmq
+// -----------------------------------------------------------------------------
+static std::string zmq_addr(uint16_t port)
+{
+    return "tcp://127.0.0.1:" + std::to_string(port);
+}
+
+// Args: message bytes, connections; a PUSH/PULL pipe each way per
+// connection, the server forwards frames without copying them
+static void bm_net_zmq_push_pull(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size  = static_cast<std::size_t>(state.range(0));
+    const auto     conns = static_cast<std::size_t>(state.range(1));
+    const uint16_t port  = 22400;
+
+    server_runner srv;
+    bool up = srv.start([conns](const server_runner::ready_t &ready) {
+        auto ctx = hj::zmq::context::create();
+        std::vector<std::unique_ptr<hj::zmq::socket>>   pulls;
+        std::vector<std::unique_ptr<hj::zmq::producer>> pushes;
+        for(std::size_t i = 0; i < conns; ++i)
+        {
+            pulls.push_back(std::make_unique<hj::zmq::socket>(ctx, ZMQ_PULL));
+            pushes.push_back(std::make_unique<hj::zmq::producer>(ctx));
+            auto in  = zmq_addr(static_cast<uint16_t>(port + 2 * i));
+            auto out = zmq_addr(static_cast<uint16_t>(port + 2 * i + 1));
+            if(zmq_bind(pulls.back()->get(), in.c_str()) != 0
+               || pushes.back()->bind(out) != 0)
+                return;
+        }
+        ready();
+
+        // an empty frame asks the forwarder to stop
+        std::vector<std::thread> fwd;
+        for(std::size_t i = 0; i < conns; ++i)
+            fwd.emplace_back([&pulls, &pushes, i]() {
+                hj::zmq::message msg;
+                while(pulls[i]->recv(msg) && msg.size() > 0)
+                    if(!pushes[i]->send(msg))
+                        break;
+            });
+        for(auto &th : fwd)
+            th.join();
+    });
+    if(!up)
+    {
+        state.SkipWithError("server failed to start");
+        return;
+    }
+
+    auto ctx = hj::zmq::context::create();
+    std::vector<std::unique_ptr<hj::zmq::socket>>   pushes;
+    std::vector<std::unique_ptr<hj::zmq::consumer>> pulls;
+    for(std::size_t i = 0; i < conns; ++i)
+    {
+        pushes.push_back(std::make_unique<hj::zmq::socket>(ctx, ZMQ_PUSH));
+        pulls.push_back(std::make_unique<hj::zmq::consumer>(ctx));
+        auto in  = zmq_addr(static_cast<uint16_t>(port + 2 * i));
+        auto out = zmq_addr(static_cast<uint16_t>(port + 2 * i + 1));
+        zmq_connect(pushes.back()->get(), in.c_str());
+        pulls.back()->connect(out);
+        pulls.back()->set_opt(ZMQ_RCVTIMEO, 1000);
+    }
+
+    const std::string        out(size, 'x');
+    std::vector<std::string> in(conns);
+    hj::hdr_histogram        hist;
+    run_clients(state, conns, size, hist, [&](std::size_t i) {
+        hj::zmq::message msg{out};
+        return pushes[i]->send(msg) && pulls[i]->pull(in[i]) == int(size);
+    });
+
+    for(auto &push : pushes)
+    {
+        hj::zmq::message bye;
+        push->send(bye);
+    }
+    srv.stop();
+    for(auto &push : pushes)
+        push->set_linger(0);
+    for(auto &pull : pulls)
+        pull->set_linger(0);
+}
+
+// Args: message bytes, connections; one PUB/SUB pair per connection
+// against a single forwarding server, every connection subscribes to its
+// own topic so the server's PUB filters for all of them
+static void bm_net_zmq_pub_sub(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size  = static_cast<std::size_t>(state.range(0));
+    const auto     conns = static_cast<std::size_t>(state.range(1));
+    const uint16_t port  = 22500;
+
+    server_runner srv;
+    bool up = srv.start([](const server_runner::ready_t &ready) {
+        auto                ctx = hj::zmq::context::create();
+        hj::zmq::subscriber sub{ctx};
+        hj::zmq::publisher  pub{ctx};
+        sub.sub("");
+        if(zmq_bind(sub.get(), zmq_addr(port).c_str()) != 0
+           || pub.bind(zmq_addr(port + 1)) != 0)
+            return;
+        ready();
+
+        hj::zmq::message msg;
+        while(sub.recv(*msg.get()) >= 0 && msg.size() > 0)
+            if(!pub.send(msg))
+                break;
+    });
+    if(!up)
+    {
+        state.SkipWithError("server failed to start");
+        return;
+    }
+
+    auto ctx = hj::zmq::context::create();
+    std::vector<std::unique_ptr<hj::zmq::publisher>>  pubs;
+    std::vector<std::unique_ptr<hj::zmq::subscriber>> subs;
+    std::vector<std::string>                          outs;
+    for(std::size_t i = 0; i < conns; ++i)
+    {
+        std::string topic = std::to_string(i) + ":";
+        pubs.push_back(std::make_unique<hj::zmq::publisher>(ctx));
+        subs.push_back(std::make_unique<hj::zmq::subscriber>(ctx));
+        pubs.back()->bind_broker(zmq_addr(port));
+        subs.back()->connect(zmq_addr(port + 1));
+        subs.back()->sub(topic);
+        subs.back()->set_opt(ZMQ_RCVTIMEO, 10);
+        outs.push_back(topic + std::string(size - topic.size(), 'x'));
+    }
+
+    // slow joiner: both subscriptions take a while to reach the publishers,
+    // probe until one comes back; late probes are told apart by their size
+    bool joined = true;
+    for(std::size_t i = 0; i < conns && joined; ++i)
+    {
+        std::string probe = std::to_string(i) + ":", got;
+        joined            = false;
+        for(int retry = 0; retry < 500 && !joined; ++retry)
+            joined = pubs[i]->pub(probe) >= 0 && subs[i]->recv(got) >= 0;
+        subs[i]->set_opt(ZMQ_RCVTIMEO, 1000);
+    }
+
+    if(joined)
+    {
+        std::vector<std::string> in(conns);
+        hj::hdr_histogram        hist;
+        run_clients(state, conns, size, hist, [&](std::size_t i) {
+            if(pubs[i]->pub(outs[i]) < 0)
+                return false;
+
+            int n;
+            do
+            {
+                n = subs[i]->recv(in[i]);
+            } while(n >= 0 && static_cast<std::size_t>(n) != size);
+            return n >= 0;
+        });
+    } else
+    {
+        state.SkipWithError("subscription did not propagate");
+    }
+
+    pubs[0]->pub(std::string_view());
+    srv.stop();
+    for(auto &pub : pubs)
+        pub->set_linger(0);
+    for(auto &sub : subs)
+        sub->set_linger(0);
+}
+
+BENCHMARK(bm_net_tcp_conn_echo)
+    ->ArgsProduct({{16, 256, 1024}, {1, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_net_udp_echo)
+    ->ArgsProduct({{16, 1024, 8192}, {1, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_net_ws_echo)
+    ->ArgsProduct({{16, 1024, 16384}, {1, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_net_zmq_push_pull)
+    ->ArgsProduct({{16, 1024, 16384}, {1, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_net_zmq_pub_sub)
+    ->ArgsProduct({{16, 1024, 16384}, {1, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -134,6 +134,67 @@ bm_rsa_verify(benchmark::State &state, size_t key_bits, size_t plain_len)
     state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(plain_len));
 }
 
+static void
+bm_rsa_verify_key(benchmark::State &state, size_t key_bits, size_t plain_len)
+{
+    std::mt19937 rng(46);
+    auto         kp    = generate_rsa_keypair(key_bits);
+    std::string  plain = random_string(plain_len, rng);
+    auto         pri   = hj::rsa::key::load_private(kp.prikey);
+    auto         pub   = hj::rsa::key::load_public(kp.pubkey);
+    auto src = reinterpret_cast<const unsigned char *>(plain.data());
+
+    std::vector<unsigned char> sig(pri.size());
+    std::size_t                sig_len = sig.size();
+    hj::rsa::signature(sig.data(), sig_len, src, plain.size(), pri);
+    for(auto _ : state)
+    {
+        auto ec =
+            hj::rsa::verify(src, plain.size(), sig.data(), sig_len, pub);
+        if(ec != hj::rsa::error_code::ok)
+            state.SkipWithError("verify failed");
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+// verifies of a batch per second, pool of state.range(0) threads
+static void bm_rsa_verify_batch(benchmark::State &state, size_t key_bits)
+{
+    const size_t n = 1024;
+    std::mt19937 rng(47);
+    auto         kp  = generate_rsa_keypair(key_bits);
+    auto         pri = hj::rsa::key::load_private(kp.prikey);
+    auto         pub = hj::rsa::key::load_public(kp.pubkey);
+
+    std::vector<std::string>          msgs(n);
+    std::vector<unsigned char>        sigs(n * pri.size());
+    std::vector<hj::rsa::verify_item> items(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        msgs[i]         = random_string(64, rng);
+        std::size_t len = pri.size();
+        auto src = reinterpret_cast<const unsigned char *>(msgs[i].data());
+        hj::rsa::signature(sigs.data() + i * len, len, src, 64, pri);
+        items[i].msg     = src;
+        items[i].msg_len = 64;
+        items[i].sig     = sigs.data() + i * pri.size();
+        items[i].sig_len = len;
+    }
+
+    hj::thread_pool pool(static_cast<size_t>(state.range(0)));
+    for(auto _ : state)
+    {
+        auto ec = hj::rsa::verify_batch(items.data(),
+                                        n,
+                                        pub,
+                                        hj::rsa::padding::pkcs1,
+                                        &pool);
+        if(ec != hj::rsa::error_code::ok)
+            state.SkipWithError("verify_batch failed");
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(n));
+}
+
 #define REGISTER_RSA_BENCHMARKS(KEYBITS, PAD, PLAINTEXTLEN)                    \
     benchmark::RegisterBenchmark(                                              \
         ("rsa_encrypt/" #KEYBITS "/" #PAD "/" #PLAINTEXTLEN),                  \
@@ -175,6 +236,16 @@ void RegisterAllRSABenchmarks()
                                  &bm_rsa_verify,
                                  2048,
                                  64);
+    benchmark::RegisterBenchmark("rsa_verify_key/2048/64",
+                                 &bm_rsa_verify_key,
+                                 2048,
+                                 64);
+    benchmark::RegisterBenchmark("rsa_verify_batch/2048",
+                                 &bm_rsa_verify_batch,
+                                 2048)
+        ->Arg(1)
+        ->Arg(4)
+        ->UseRealTime();
 }
 
 auto rsa_bench_init = (RegisterAllRSABenchmarks(), 0);
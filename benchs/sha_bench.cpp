@@ -4,6 +4,7 @@
 #include <vector>
 #include <random>
 #include <sstream>
+#include <memory>
 
 template <typename RNG>
 std::string random_string(size_t len, RNG &rng)
@@ -169,6 +170,52 @@ static void bm_sha512_convenience(benchmark::State &state, size_t input_len)
     state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input_len));
 }
 
+// one reused context vs a one-shot call per message
+static void bm_sha_hasher(benchmark::State &state, size_t input_len)
+{
+    std::mt19937    rng(44);
+    std::string     input = random_string(input_len, rng);
+    std::string     output;
+    hj::sha::hasher h(hj::sha::algorithm::sha256);
+    for(auto _ : state)
+    {
+        h.update(input);
+        auto ec = h.finish(output);
+        benchmark::DoNotOptimize(output);
+        if(ec != hj::sha::error_code::ok)
+            state.SkipWithError("SHA hasher failed");
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input_len));
+}
+
+// 4096 messages of input_len per iteration, pool of state.range(0) threads
+// (0 = caller thread only)
+static void bm_sha_hash_many(benchmark::State &state, size_t input_len)
+{
+    const size_t             n = 4096;
+    std::mt19937             rng(45);
+    std::vector<std::string> input(n);
+    for(auto &s : input)
+        s = random_string(input_len, rng);
+
+    std::unique_ptr<hj::thread_pool> pool;
+    if(state.range(0) > 0)
+        pool.reset(new hj::thread_pool(static_cast<size_t>(state.range(0))));
+
+    std::vector<std::string> output;
+    for(auto _ : state)
+    {
+        auto ec = hj::sha::hash_many(output,
+                                     input,
+                                     hj::sha::algorithm::sha256,
+                                     pool.get());
+        benchmark::DoNotOptimize(output);
+        if(ec != hj::sha::error_code::ok)
+            state.SkipWithError("SHA hash_many failed");
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(n));
+}
+
 #define REGISTER_SHA_BENCHMARKS(ALGO, ALGO_NAME, INPUT_SIZE)                   \
     benchmark::RegisterBenchmark(("sha_" #ALGO_NAME "_string/" #INPUT_SIZE),   \
                                  &bm_sha_encode_string,                        \
@@ -231,7 +278,20 @@ void RegisterAllSHABenchmarks()
             ("SHA512_convenience/" + std::to_string(size)).c_str(),
             &bm_sha512_convenience,
             size);
+        benchmark::RegisterBenchmark(
+            ("SHA256_hasher/" + std::to_string(size)).c_str(),
+            &bm_sha_hasher,
+            size);
     }
+
+    for(auto size : {64, 1024})
+        benchmark::RegisterBenchmark(
+            ("SHA256_hash_many/" + std::to_string(size)).c_str(),
+            &bm_sha_hash_many,
+            size)
+            ->Arg(0)
+            ->Arg(4)
+            ->UseRealTime();
 }
 
 auto sha_bench_init = (RegisterAllSHABenchmarks(), 0);
\ No newline at end of file
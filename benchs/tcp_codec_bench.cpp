@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/net/tcp/tcp_codec.hpp>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Build a buffered stream of n frames of msg_sz bytes with codec
+template <typename Codec>
+static std::vector<unsigned char>
+make_stream(const Codec &codec, std::size_t n, std::size_t msg_sz)
+{
+    std::string   payload(msg_sz, 'x');
+    unsigned char head[8] = {};
+    hj::tcp_frame in      = std::is_same<Codec, hj::header_body_codec>::value
+                                ? hj::tcp_frame(head,
+                                                sizeof(head),
+                                                payload.data(),
+                                                payload.size())
+                                : hj::tcp_frame(payload);
+
+    std::vector<unsigned char> stream;
+    std::vector<unsigned char> buf(msg_sz + 64);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::size_t sz = codec.encode(buf.data(), buf.size(), &in);
+        stream.insert(stream.end(), buf.begin(), buf.begin() + sz);
+    }
+    return stream;
+}
+
+template <typename Codec>
+static void decode_all(benchmark::State &state, const Codec &codec)
+{
+    const std::size_t n      = 1024;
+    const std::size_t msg_sz = static_cast<std::size_t>(state.range(0));
+    auto              stream = make_stream(codec, n, msg_sz);
+
+    hj::tcp_frame frame;
+    for(auto _ : state)
+    {
+        const unsigned char *p   = stream.data();
+        std::size_t          len = stream.size();
+        std::size_t          sz  = 0;
+        while((sz = codec.decode(&frame, p, len)) > 0)
+        {
+            benchmark::DoNotOptimize(frame.data());
+            p += sz;
+            len -= sz;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+// Typical hand-written decoder: copy every frame into a std::string
+static void bm_tcp_codec_decode_string_copy(benchmark::State &state)
+{
+    const std::size_t       n      = 1024;
+    const std::size_t       msg_sz = static_cast<std::size_t>(state.range(0));
+    hj::length_prefix_codec codec;
+    auto                    stream = make_stream(codec, n, msg_sz);
+
+    std::string msg;
+    for(auto _ : state)
+    {
+        const unsigned char *p   = stream.data();
+        std::size_t          len = stream.size();
+        while(len >= 4)
+        {
+            std::size_t body = (std::size_t(p[0]) << 24)
+                               | (std::size_t(p[1]) << 16)
+                               | (std::size_t(p[2]) << 8) | p[3];
+            if(len - 4 < body)
+                break;
+
+            msg = std::string(reinterpret_cast<const char *>(p + 4), body);
+            benchmark::DoNotOptimize(msg.data());
+            p += 4 + body;
+            len -= 4 + body;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+static void bm_tcp_codec_decode_length_u32(benchmark::State &state)
+{
+    decode_all(state, hj::length_prefix_codec{hj::length_field::u32});
+}
+
+static void bm_tcp_codec_decode_length_varint(benchmark::State &state)
+{
+    decode_all(state, hj::length_prefix_codec{hj::length_field::varint});
+}
+
+static void bm_tcp_codec_decode_delimiter(benchmark::State &state)
+{
+    decode_all(state, hj::delimiter_codec{"\r\n"});
+}
+
+static void bm_tcp_codec_decode_header_body(benchmark::State &state)
+{
+    decode_all(state, hj::header_body_codec{8, 4});
+}
+
+BENCHMARK(bm_tcp_codec_decode_string_copy)->Arg(64)->Arg(1024);
+BENCHMARK(bm_tcp_codec_decode_length_u32)->Arg(64)->Arg(1024);
+BENCHMARK(bm_tcp_codec_decode_length_varint)->Arg(64)->Arg(1024);
+BENCHMARK(bm_tcp_codec_decode_delimiter)->Arg(64)->Arg(1024);
+BENCHMARK(bm_tcp_codec_decode_header_body)->Arg(64)->Arg(1024);
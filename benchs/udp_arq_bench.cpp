@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/net/udp/udp_arq.hpp>
+#include <deque>
+#include <string>
+
+// Two arq cores wired back to back in memory, every n-th datagram dropped
+static void bm_udp_arq_transfer(benchmark::State &state)
+{
+    const std::size_t   msg_sz   = static_cast<std::size_t>(state.range(0));
+    const std::uint32_t drop_nth = static_cast<std::uint32_t>(state.range(1));
+    const std::size_t   n        = 256;
+    std::string         msg(msg_sz, 'x');
+    std::string         out;
+
+    for(auto _ : state)
+    {
+        std::uint32_t           now = 0, count = 0;
+        std::deque<std::string> ab, ba;
+        hj::udp::arq            a{1};
+        hj::udp::arq            b{1};
+        a.set_output([&](const char *data, std::size_t len) {
+            if(drop_nth == 0 || ++count % drop_nth != 0)
+                ab.emplace_back(data, len);
+        });
+        b.set_output([&](const char *data, std::size_t len) {
+            ba.emplace_back(data, len);
+        });
+
+        for(std::size_t i = 0; i < n; ++i)
+            a.send(msg.data(), msg.size());
+
+        std::size_t recvd = 0;
+        for(; recvd < n && now < 600000; now += 10)
+        {
+            a.update(now);
+            b.set_current(now);
+            for(; !ab.empty(); ab.pop_front())
+                b.input(ab.front().data(), ab.front().size());
+            b.update(now);
+            a.set_current(now);
+            for(; !ba.empty(); ba.pop_front())
+                a.input(ba.front().data(), ba.front().size());
+            while(b.recv(out))
+                recvd++;
+        }
+        benchmark::DoNotOptimize(recvd);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * msg_sz);
+}
+
+BENCHMARK(bm_udp_arq_transfer)
+    ->Args({64, 0})
+    ->Args({4096, 0})
+    ->Args({64, 20})
+    ->Args({4096, 20})
+    ->Unit(benchmark::kMicrosecond);
@@ -205,9 +205,80 @@ static void bm_udp_executor_and_socket_reuse(benchmark::State &state)
     }
 }
 
+#if defined(__linux__)
+// Loopback packets/sec: one send()/recv() syscall per datagram
+static void bm_udp_pps_single(benchmark::State &state)
+{
+    if(!bench_allow_net())
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+
+    const size_t            burst = static_cast<size_t>(state.range(0));
+    boost::asio::io_context io;
+    hj::udp::socket         rx(io.get_executor());
+    hj::udp::socket         tx(io.get_executor());
+    uint16_t        port = static_cast<uint16_t>(s_port_base.fetch_add(1));
+    std::error_code ec;
+    rx.bind(port, ec);
+    rx.set_option(hj::udp::opt::recv_buf_sz(4 * 1024 * 1024), ec);
+    auto ep = hj::udp::socket::endpoint("127.0.0.1", port);
+
+    char                        buf[64] = {0};
+    hj::udp::socket::endpoint_t sender;
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < burst; ++i)
+            tx.send(buf, sizeof(buf), ep, ec);
+        for(size_t i = 0; i < burst; ++i)
+            benchmark::DoNotOptimize(rx.recv(buf, sizeof(buf), sender, ec));
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+// Loopback packets/sec: sendmmsg()/recvmmsg() with preallocated batches
+static void bm_udp_pps_batch(benchmark::State &state)
+{
+    if(!bench_allow_net())
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+
+    const size_t            burst = static_cast<size_t>(state.range(0));
+    boost::asio::io_context io;
+    hj::udp::socket         rx(io.get_executor());
+    hj::udp::socket         tx(io.get_executor());
+    uint16_t        port = static_cast<uint16_t>(s_port_base.fetch_add(1));
+    std::error_code ec;
+    rx.bind(port, ec);
+    rx.set_option(hj::udp::opt::recv_buf_sz(4 * 1024 * 1024), ec);
+    auto ep = hj::udp::socket::endpoint("127.0.0.1", port);
+
+    char                buf[64] = {0};
+    hj::udp::mmsg_batch out(burst);
+    hj::udp::mmsg_batch in(burst, 64);
+    for(size_t i = 0; i < burst; ++i)
+        out.push(buf, sizeof(buf), ep);
+
+    for(auto _ : state)
+    {
+        tx.send_batch(out, ec);
+        for(size_t recvd = 0; recvd < burst;)
+        {
+            size_t n = rx.recv_batch(in, ec);
+            if(ec)
+                break;
+            recvd += n;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+#endif
+
 BENCHMARK(bm_udp_construct_close)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_udp_bind_and_set_option)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_udp_send_recv)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_udp_async_send_recv)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_udp_invalid_argument)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_udp_executor_and_socket_reuse)->Unit(benchmark::kMicrosecond);
+
+#if defined(__linux__)
+BENCHMARK(bm_udp_pps_single)->Arg(1)->Arg(32)->Arg(256);
+BENCHMARK(bm_udp_pps_batch)->Arg(1)->Arg(32)->Arg(256);
+#endif
@@ -80,8 +80,80 @@ static void bm_uuid_gen_parallel(benchmark::State &state)
     }
 }
 
+// UUIDv7 (per-thread sequence block)
+static void bm_uuid_gen_v7(benchmark::State &state)
+{
+    for(auto _ : state)
+    {
+        auto v = hj::uuid::gen_v7();
+        benchmark::DoNotOptimize(v);
+    }
+}
+
+// bulk generation into a caller buffer, one reservation per batch
+static void bm_uuid_genu64_n(benchmark::State &state)
+{
+    std::vector<uint64_t> buf(static_cast<size_t>(state.range(0)));
+    for(auto _ : state)
+    {
+        hj::uuid::gen_u64_n(buf.data(), buf.size());
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void bm_uuid_gen_v7_n(benchmark::State &state)
+{
+    std::vector<hj::uuid128> buf(static_cast<size_t>(state.range(0)));
+    for(auto _ : state)
+    {
+        hj::uuid::gen_v7_n(buf.data(), buf.size());
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+// non-allocating text form
+static void bm_uuid_format_to(benchmark::State &state)
+{
+    hj::uuid128 id = hj::uuid::gen_v7();
+    char        buf[36];
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(hj::uuid::format_to(buf, id));
+        benchmark::ClobberMemory();
+    }
+}
+
+// per-order / per-event ids from several threads at once
+static void bm_uuid_gen_v7_threads(benchmark::State &state)
+{
+    for(auto _ : state)
+    {
+        auto v = hj::uuid::gen_v7();
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void bm_uuid_genu64_threads(benchmark::State &state)
+{
+    for(auto _ : state)
+    {
+        auto v = hj::uuid::gen_u64();
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
 BENCHMARK(bm_uuid_gen_string)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_uuid_genu64_default)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_uuid_genu64_big_endian)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_uuid_genu64_little_endian)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_uuid_gen_parallel)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_uuid_gen_v7);
+BENCHMARK(bm_uuid_genu64_n)->Arg(64)->Arg(4096);
+BENCHMARK(bm_uuid_gen_v7_n)->Arg(64)->Arg(4096);
+BENCHMARK(bm_uuid_format_to);
+BENCHMARK(bm_uuid_gen_v7_threads)->Threads(1)->Threads(4);
+BENCHMARK(bm_uuid_genu64_threads)->Threads(1)->Threads(4);
@@ -7,6 +7,11 @@
 #include <filesystem>
 #include <atomic>
 #include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <zlib.h>
 
 using namespace std::chrono_literals;
 
@@ -209,8 +214,364 @@ static void bm_wsserver_ssl_accept_recv_send_close(benchmark::State &state)
     }
 }
 
+// Args: subscribers, payload bytes, shared frame (1) or a copy per client (0)
+static void bm_wsserver_broadcast_fanout(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     subs   = static_cast<std::size_t>(state.range(0));
+    const auto     size   = static_cast<std::size_t>(state.range(1));
+    const bool     shared = state.range(2) != 0;
+    const uint16_t port   = 21100;
+    const int      msgs   = 100;
+
+    hj::ws_server::io_t sio;
+    auto                sguard = boost::asio::make_work_guard(sio);
+    auto                serv   = std::make_shared<hj::ws_server>(sio);
+    using policy_t = hj::ws_server::fanout_t::overflow_policy;
+    serv->fanout().set_high_water(std::numeric_limits<std::size_t>::max(),
+                                  policy_t::drop);
+    std::vector<hj::ws_server::ws_stream_ptr_t> conns;
+    std::thread acceptor([&]() {
+        hj::ws_server::err_t err;
+        auto ep = hj::ws_server::make_endpoint("127.0.0.1", port);
+        for(std::size_t i = 0; i < subs; ++i)
+        {
+            auto ws = serv->accept(ep, err);
+            if(err)
+                return;
+            serv->subscribe(ws);
+            conns.push_back(ws);
+        }
+    });
+
+    hj::ws_client::io_t                         cio;
+    std::vector<std::shared_ptr<hj::ws_client>> clients;
+    for(std::size_t i = 0; i < subs; ++i)
+    {
+        auto client = std::make_shared<hj::ws_client>(cio);
+        for(int retry = 0; retry < 100; ++retry)
+        {
+            if(client->connect("127.0.0.1", std::to_string(port), "/"))
+                break;
+            std::this_thread::sleep_for(10ms);
+        }
+        clients.push_back(client);
+    }
+    acceptor.join();
+    if(conns.size() != subs)
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    std::atomic<std::size_t>                              got{0};
+    std::function<void(std::shared_ptr<hj::ws_client>)> drain;
+    drain = [&](std::shared_ptr<hj::ws_client> client) {
+        client->async_recv(
+            [&, client](const hj::ws_client::err_t &err, std::string) {
+                if(err)
+                    return;
+                got++;
+                drain(client);
+            });
+    };
+    for(auto &client : clients)
+        drain(client);
+    std::thread cth([&cio]() { cio.run(); });
+    std::thread sth([&sio]() { sio.run(); });
+
+    const std::string payload(size, 'x');
+    std::size_t       expect = 0;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < msgs; ++i)
+        {
+            if(shared)
+            {
+                serv->broadcast(payload);
+                continue;
+            }
+            for(auto &ws : conns)
+                serv->fanout().send(
+                    ws,
+                    hj::ws_server::fanout_t::make_message(payload));
+        }
+        expect += subs * msgs;
+        while(got.load() < expect)
+            std::this_thread::yield();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(expect));
+    state.SetBytesProcessed(static_cast<int64_t>(expect * size));
+
+    for(auto &ws : conns)
+        boost::asio::post(sio, [ws]() {
+            hj::ws_server::err_t ec;
+            boost::beast::get_lowest_layer(*ws).close(ec);
+        });
+    cth.join();
+    serv->close();
+    sguard.reset();
+    sth.join();
+}
+
+// market snapshot shaped JSON, 4-7x on its own, more with context takeover
+static std::string make_snapshot(std::size_t size, int seed)
+{
+    std::string out = "[";
+    for(int i = seed; out.size() < size; ++i)
+        out += "{\"sym\":\"SYM" + std::to_string(i % 200)
+               + "\",\"bid\":" + std::to_string(100 + i % 37)
+               + ".25,\"ask\":" + std::to_string(101 + i % 37)
+               + ".5,\"qty\":" + std::to_string((i * 7919) % 10000) + "},";
+    out.resize(size);
+    return out;
+}
+
+// Args: message bytes, level, window bits, context takeover
+// Raw deflate + sync flush per message, the work permessage-deflate does
+// for each frame; reports ratio and CPU per message to pick min_size.
+static void bm_ws_deflate_ratio(benchmark::State &state)
+{
+    const auto size     = static_cast<std::size_t>(state.range(0));
+    const int  level    = static_cast<int>(state.range(1));
+    const int  bits     = static_cast<int>(state.range(2));
+    const bool takeover = state.range(3) != 0;
+
+    std::vector<std::string> msgs;
+    for(int i = 0; i < 64; ++i)
+        msgs.push_back(make_snapshot(size, i * 13));
+
+    z_stream zs{};
+    deflateInit2(&zs, level, Z_DEFLATED, -bits, 8, Z_DEFAULT_STRATEGY);
+    std::vector<unsigned char> out(deflateBound(&zs, size) + 16);
+    std::size_t                in_bytes = 0, out_bytes = 0, i = 0;
+    for(auto _ : state)
+    {
+        const auto &msg = msgs[i++ % msgs.size()];
+        if(!takeover)
+            deflateReset(&zs);
+        auto *src    = const_cast<char *>(msg.data());
+        zs.next_in   = reinterpret_cast<Bytef *>(src);
+        zs.avail_in  = static_cast<uInt>(msg.size());
+        zs.next_out  = out.data();
+        zs.avail_out = static_cast<uInt>(out.size());
+        deflate(&zs, Z_SYNC_FLUSH);
+        in_bytes += msg.size();
+        // the trailing 00 00 ff ff of the flush is not sent on the wire
+        out_bytes += out.size() - zs.avail_out - 4;
+    }
+    deflateEnd(&zs);
+    state.SetBytesProcessed(static_cast<int64_t>(in_bytes));
+    state.counters["ratio"] =
+        out_bytes ? static_cast<double>(in_bytes) / out_bytes : 0.0;
+}
+
+// Args: message bytes, permessage-deflate on/off; client -> server over
+// loopback, 1000 messages per iteration
+static void bm_wsserver_deflate_stream(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     size    = static_cast<std::size_t>(state.range(0));
+    const bool     deflate = state.range(1) != 0;
+    const uint16_t port    = 21101;
+    const int      msgs    = 1000;
+
+    hj::ws_deflate_options opts;
+    opts.enable = deflate;
+
+    hj::ws_server::io_t sio;
+    auto                serv = std::make_shared<hj::ws_server>(sio);
+    serv->set_deflate(opts);
+    hj::ws_server::ws_stream_ptr_t conn;
+    std::thread                    acceptor([&]() {
+        hj::ws_server::err_t err;
+        conn = serv->accept(hj::ws_server::make_endpoint("127.0.0.1", port),
+                            err);
+    });
+
+    hj::ws_client::io_t cio;
+    auto                client = std::make_shared<hj::ws_client>(cio);
+    client->set_deflate(opts);
+    for(int retry = 0; retry < 100; ++retry)
+    {
+        if(client->connect("127.0.0.1", std::to_string(port), "/"))
+            break;
+        std::this_thread::sleep_for(10ms);
+    }
+    acceptor.join();
+    if(!conn)
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    std::atomic<std::size_t> got{0};
+    std::function<void()>    drain = [&]() {
+        serv->async_recv(conn,
+                         [&](const hj::ws_server::err_t &err,
+                             hj::ws_server::ws_stream_ptr_t,
+                             std::string) {
+                             if(err)
+                                 return;
+                             got++;
+                             drain();
+                         });
+    };
+    drain();
+    std::thread sth([&sio]() { sio.run(); });
+
+    std::vector<std::string> payloads;
+    for(int i = 0; i < 64; ++i)
+        payloads.push_back(make_snapshot(size, i * 13));
+    std::size_t expect = 0;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < msgs; ++i)
+            client->send(payloads[i % payloads.size()]);
+        expect += msgs;
+        while(got.load() < expect)
+            std::this_thread::yield();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(expect));
+    state.SetBytesProcessed(static_cast<int64_t>(expect * size));
+
+    client->close();
+    sth.join();
+    serv->close();
+}
+
+// Args: 0 async_recv (string per message), else async_read_loop max_batch.
+// The client writes 10000 pre-built 64 byte frames per iteration straight
+// to the socket, so the server's receive path is what gets measured.
+static void bm_wsserver_recv_path(benchmark::State &state)
+{
+    if(!bench_allow_net())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_NET not set");
+        return;
+    }
+
+    const auto     batch = static_cast<std::size_t>(state.range(0));
+    const uint16_t port  = 21102;
+    const int      msgs  = 10000;
+
+    hj::ws_server::io_t            sio;
+    auto                           serv = std::make_shared<hj::ws_server>(sio);
+    hj::ws_server::ws_stream_ptr_t conn;
+    std::thread                    acceptor([&]() {
+        hj::ws_server::err_t err;
+        conn = serv->accept(hj::ws_server::make_endpoint("127.0.0.1", port),
+                            err);
+    });
+
+    boost::asio::io_context cio;
+    hj::ws_server::ws_stream_t client{cio};
+    for(int retry = 0; retry < 100; ++retry)
+    {
+        boost::system::error_code ec;
+        client.next_layer().connect(
+            {boost::asio::ip::make_address("127.0.0.1"), port},
+            ec);
+        if(!ec)
+            break;
+        client.next_layer().close();
+        std::this_thread::sleep_for(10ms);
+    }
+    boost::system::error_code ec;
+    client.handshake("127.0.0.1", "/", ec);
+    acceptor.join();
+    if(ec || !conn)
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    std::atomic<std::size_t> got{0};
+    std::atomic<std::size_t> bytes{0};
+    std::function<void()>    drain = [&]() {
+        serv->async_recv(conn,
+                         [&](const hj::ws_server::err_t &err,
+                             hj::ws_server::ws_stream_ptr_t,
+                             std::string msg) {
+                             if(err)
+                                 return;
+                             bytes += msg.size();
+                             got++;
+                             drain();
+                         });
+    };
+    if(batch == 0)
+        drain();
+    else
+        serv->async_read_loop(
+            conn,
+            [&](const hj::ws_server::err_t &err,
+                hj::ws_server::ws_stream_ptr_t,
+                const hj::ws_server::messages_t &batch) {
+                for(auto &m : batch)
+                    bytes += m.size();
+                got += batch.size();
+                return !err;
+            },
+            batch);
+    std::thread sth([&sio]() { sio.run(); });
+
+    // FIN + text, masked with an all zero key, 64 byte payload
+    std::string frames;
+    for(int i = 0; i < msgs; ++i)
+        frames += std::string("\x81\xc0\0\0\0\0", 6) + std::string(64, 'x');
+    std::size_t expect = 0;
+    for(auto _ : state)
+    {
+        boost::asio::write(client.next_layer(), boost::asio::buffer(frames));
+        expect += msgs;
+        while(got.load() < expect)
+            std::this_thread::yield();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(expect));
+    benchmark::DoNotOptimize(bytes.load());
+
+    client.next_layer().close();
+    sth.join();
+    serv->close();
+}
+
 BENCHMARK(bm_wsserver_accept_recv_send_close)->Unit(benchmark::kMillisecond);
 BENCHMARK(bm_wsserver_async_accept_recv_send_close)
     ->Unit(benchmark::kMillisecond);
 BENCHMARK(bm_wsserver_ssl_accept_recv_send_close)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_wsserver_broadcast_fanout)
+    ->Args({16, 64, 1})
+    ->Args({16, 64, 0})
+    ->Args({256, 64, 1})
+    ->Args({256, 64, 0})
+    ->Args({256, 16384, 1})
+    ->Args({256, 16384, 0})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_ws_deflate_ratio)
+    ->ArgsProduct({{64, 256, 1024, 16384}, {1, 6}, {15}, {0, 1}})
+    ->Args({1024, 6, 10, 1})
+    ->Args({16384, 6, 10, 1});
+BENCHMARK(bm_wsserver_deflate_stream)
+    ->ArgsProduct({{256, 4096, 65536}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_wsserver_recv_path)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -1,9 +1,15 @@
 #include <benchmark/benchmark.h>
 
 #include <hj/net/zmq.hpp>
+#include <hj/net/zmq_reactor.hpp>
+#include <hj/sync/object_pool.hpp>
 #include <string>
 #include <atomic>
 #include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 static std::atomic_uint_fast64_t s_zmq_id{0};
 
@@ -24,17 +30,21 @@ static std::string make_inproc_addr()
 static void bm_zmq_chan_basic(benchmark::State &state)
 {
     if(!bench_allow_zmq())
+    {
         state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
 
     for(auto _ : state)
     {
-        hj::zmq::context ctx;
-        hj::zmq::chan    ch(ctx.get());
-        std::string      msg = "hello zmq";
-        bool             ok  = ch << msg;
+        auto            ctx = hj::zmq::context::create();
+        hj::zmq::w_chan w_ch(ctx);
+        hj::zmq::r_chan r_ch = w_ch.make_r_chan();
+        std::string     msg  = "hello zmq";
+        bool            ok   = w_ch << msg;
         benchmark::DoNotOptimize(ok);
         std::string recv;
-        ok = ch >> recv;
+        ok = r_ch >> recv;
         benchmark::DoNotOptimize(recv);
         benchmark::ClobberMemory();
     }
@@ -44,14 +54,17 @@ static void bm_zmq_chan_basic(benchmark::State &state)
 static void bm_zmq_producer_consumer(benchmark::State &state)
 {
     if(!bench_allow_zmq())
+    {
         state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
 
     for(auto _ : state)
     {
-        hj::zmq::context  ctx;
+        auto              ctx  = hj::zmq::context::create();
         std::string       addr = make_inproc_addr();
-        hj::zmq::producer prod(ctx.get());
-        hj::zmq::consumer cons(ctx.get());
+        hj::zmq::producer prod(ctx);
+        hj::zmq::consumer cons(ctx);
 
         int b = prod.bind(addr);
         benchmark::DoNotOptimize(b);
@@ -74,14 +87,17 @@ static void bm_zmq_producer_consumer(benchmark::State &state)
 static void bm_zmq_pubsub(benchmark::State &state)
 {
     if(!bench_allow_zmq())
+    {
         state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
 
     for(auto _ : state)
     {
-        hj::zmq::context    ctx;
+        auto                ctx  = hj::zmq::context::create();
         std::string         addr = make_inproc_addr();
-        hj::zmq::publisher  pub(ctx.get());
-        hj::zmq::subscriber sub(ctx.get());
+        hj::zmq::publisher  pub(ctx);
+        hj::zmq::subscriber sub(ctx);
 
         int pb = pub.bind(addr);
         benchmark::DoNotOptimize(pb);
@@ -105,16 +121,19 @@ static void bm_zmq_pubsub(benchmark::State &state)
 static void bm_zmq_broker_bind(benchmark::State &state)
 {
     if(!bench_allow_zmq())
+    {
         state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
 
     for(auto _ : state)
     {
-        hj::zmq::context ctx;
-        std::string      xpub = make_inproc_addr();
-        std::string      xsub = make_inproc_addr();
+        auto        ctx  = hj::zmq::context::create();
+        std::string xpub = make_inproc_addr();
+        std::string xsub = make_inproc_addr();
 
-        hj::zmq::socket xpub_sock(ctx.get(), ZMQ_XPUB);
-        hj::zmq::socket xsub_sock(ctx.get(), ZMQ_XSUB);
+        hj::zmq::socket xpub_sock(ctx, ZMQ_XPUB);
+        hj::zmq::socket xsub_sock(ctx, ZMQ_XSUB);
         hj::zmq::broker bk(xpub_sock.get(), xsub_sock.get());
 
         int b = bk.bind(xpub, xsub);
@@ -123,7 +142,273 @@ static void bm_zmq_broker_bind(benchmark::State &state)
     }
 }
 
+static std::string make_addr(int64_t transport)
+{
+    if(transport == 0)
+        return make_inproc_addr();
+
+    static std::atomic_uint_fast64_t s_ipc_id{0};
+    std::ostringstream               ss;
+    ss << "ipc:///tmp/hj_zmq_bench_" << ::getpid() << "_"
+       << s_ipc_id.fetch_add(1, std::memory_order_relaxed);
+    return ss.str();
+}
+
+// push/pull pair kept alive across iterations
+struct zmq_pipe
+{
+    explicit zmq_pipe(int64_t transport)
+        : ctx{hj::zmq::context::create()}
+        , prod{ctx}
+        , cons{ctx}
+    {
+        std::string addr = make_addr(transport);
+        prod.bind(addr);
+        cons.connect(addr);
+    }
+
+    hj::zmq::context::ptr ctx;
+    hj::zmq::producer     prod;
+    hj::zmq::consumer     cons;
+};
+
+static const int s_batch = 256;
+
+// Args: transport (0 inproc, 1 ipc), payload bytes; payload copied into zmq
+static void bm_zmq_send_copy(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    zmq_pipe         pipe(state.range(0));
+    std::string      payload(static_cast<size_t>(state.range(1)), 'x');
+    hj::zmq::message in;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < s_batch; ++i)
+            pipe.prod.push(payload);
+        for(int i = 0; i < s_batch; ++i)
+            pipe.cons.recv(in);
+        benchmark::DoNotOptimize(in.data());
+    }
+    state.SetItemsProcessed(state.iterations() * s_batch);
+    state.SetBytesProcessed(state.iterations() * s_batch * state.range(1));
+}
+
+// Args: transport (0 inproc, 1 ipc), payload bytes; pooled buffers are
+// handed to zmq and come back through the free callback
+static void bm_zmq_send_adopt(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    using buffer_t = std::vector<char>;
+    zmq_pipe                  pipe(state.range(0));
+    const size_t              size = static_cast<size_t>(state.range(1));
+    hj::object_pool<buffer_t> pool;
+    hj::zmq::message          in;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < s_batch; ++i)
+        {
+            buffer_t *buf = pool.acquire();
+            while(!buf)
+            {
+                pool.create(size, 'x');
+                buf = pool.acquire();
+            }
+            auto msg = hj::zmq::message::adopt(pool, buf, buf->data(), size);
+            pipe.prod.send(msg);
+        }
+        for(int i = 0; i < s_batch; ++i)
+            pipe.cons.recv(in);
+        benchmark::DoNotOptimize(in.data());
+    }
+    in = hj::zmq::message();
+    state.SetItemsProcessed(state.iterations() * s_batch);
+    state.SetBytesProcessed(state.iterations() * s_batch * state.range(1));
+}
+
+// Args: transport (0 inproc, 1 ipc); 3-frame messages through the
+// allocating vector<string> API
+static void bm_zmq_multipart_strings(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    zmq_pipe                      pipe(state.range(0));
+    std::string                   body(512, 'b');
+    std::vector<std::string_view> out{"topic", "header", body};
+    std::vector<std::string>      in;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < s_batch; ++i)
+            pipe.prod.send_multipart(out);
+        for(int i = 0; i < s_batch; ++i)
+            pipe.cons.recv_multipart(in);
+        benchmark::DoNotOptimize(in.data());
+    }
+    state.SetItemsProcessed(state.iterations() * s_batch);
+}
+
+// Args: transport (0 inproc, 1 ipc); same messages with reused frame
+// arrays and batched receive
+static void bm_zmq_multipart_reuse(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    zmq_pipe                        pipe(state.range(0));
+    std::string                     body(512, 'b');
+    hj::zmq::multipart              out;
+    std::vector<hj::zmq::multipart> in;
+    for(auto _ : state)
+    {
+        for(int i = 0; i < s_batch; ++i)
+        {
+            out.add("topic");
+            out.add("header");
+            out.add(body);
+            pipe.prod.send_multipart(out);
+        }
+        for(int got = 0; got < s_batch;)
+            got += static_cast<int>(pipe.cons.recv_batch(in, 64));
+        benchmark::DoNotOptimize(in.data());
+    }
+    state.SetItemsProcessed(state.iterations() * s_batch);
+}
+
+// N push/pull pairs fed by one producer thread
+struct zmq_fan_in
+{
+    explicit zmq_fan_in(size_t n)
+        : ctx{hj::zmq::context::create()}
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            std::string addr = make_inproc_addr();
+            prods.push_back(std::make_unique<hj::zmq::producer>(ctx));
+            conss.push_back(std::make_unique<hj::zmq::consumer>(ctx));
+            prods.back()->bind(addr);
+            conss.back()->connect(addr);
+        }
+    }
+
+    std::thread produce(int per_sock)
+    {
+        return std::thread([this, per_sock]() {
+            for(int i = 0; i < per_sock; ++i)
+                for(auto &p : prods)
+                    p->push("payload");
+        });
+    }
+
+    hj::zmq::context::ptr                           ctx;
+    std::vector<std::unique_ptr<hj::zmq::producer>> prods;
+    std::vector<std::unique_ptr<hj::zmq::consumer>> conss;
+};
+
+static const int s_per_sock = 2000;
+
+// Args: sockets; one blocking consumer thread per socket
+static void bm_zmq_consume_threads(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    zmq_fan_in fan(static_cast<size_t>(state.range(0)));
+    for(auto _ : state)
+    {
+        std::thread              prod = fan.produce(s_per_sock);
+        std::vector<std::thread> pool;
+        for(auto &c : fan.conss)
+            pool.emplace_back([&c]() {
+                hj::zmq::message in;
+                for(int i = 0; i < s_per_sock; ++i)
+                    c->recv(in);
+            });
+        for(auto &th : pool)
+            th.join();
+        prod.join();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * s_per_sock);
+}
+
+// Args: sockets; every consumer on one io thread through hj::zmq::reactor
+static void bm_zmq_consume_reactor(benchmark::State &state)
+{
+    if(!bench_allow_zmq())
+    {
+        state.SkipWithError("HJ_BENCH_ALLOW_ZMQ not set");
+        return;
+    }
+
+    zmq_fan_in fan(static_cast<size_t>(state.range(0)));
+    const auto total = static_cast<int>(fan.conss.size()) * s_per_sock;
+    for(auto _ : state)
+    {
+        boost::asio::io_context io;
+        hj::zmq::reactor        r(io);
+        hj::zmq::message        in;
+        int                     got = 0;
+        for(auto &c : fan.conss)
+            r.add(*c, [&](hj::zmq::socket_base &sock) {
+                while(sock.recv(in, ZMQ_DONTWAIT))
+                    if(++got == total)
+                        io.stop();
+            });
+
+        std::thread prod = fan.produce(s_per_sock);
+        io.run();
+        prod.join();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * s_per_sock);
+}
+
 BENCHMARK(bm_zmq_chan_basic)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_zmq_producer_consumer)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_zmq_pubsub)->Unit(benchmark::kMicrosecond);
 BENCHMARK(bm_zmq_broker_bind)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bm_zmq_send_copy)
+    ->ArgsProduct({{0, 1}, {64, 64 << 10, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(bm_zmq_send_adopt)
+    ->ArgsProduct({{0, 1}, {64, 64 << 10, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(bm_zmq_multipart_strings)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(bm_zmq_multipart_reuse)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(bm_zmq_consume_threads)
+    ->Arg(8)
+    ->Arg(32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(bm_zmq_consume_reactor)
+    ->Arg(8)
+    ->Arg(32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
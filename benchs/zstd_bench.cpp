@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include <hj/compress/gzip.hpp>
+#include <hj/compress/zstd.hpp>
+#include <vector>
+#include <string>
+#include <random>
+
+// 200-800 byte JSON-like RPC records, one message per iteration so "Time"
+// is ns/message. "ratio" is compressed / original over the whole corpus,
+// lower is better. The dictionary is trained on a disjoint set of records.
+
+static std::vector<std::string> make_records(int n, unsigned seed)
+{
+    const char  *syms[]   = {"AAPL", "MSFT", "NVDA", "TSLA", "AMZN", "META"};
+    const char  *status[] = {"new", "partially_filled", "filled", "canceled"};
+    std::mt19937 gen(seed);
+    std::vector<std::string> out;
+    for(int i = 0; i < n; ++i)
+    {
+        std::string s = "{\"id\":" + std::to_string(gen() % 100000000)
+                        + ",\"symbol\":\"" + syms[gen() % 6]
+                        + "\",\"side\":\"" + (gen() % 2 ? "buy" : "sell")
+                        + "\",\"qty\":" + std::to_string(gen() % 10000)
+                        + ",\"px\":" + std::to_string(100 + gen() % 900) + "."
+                        + std::to_string(gen() % 100)
+                        + ",\"tif\":\"day\",\"account\":\"ACC-"
+                        + std::to_string(gen() % 100000)
+                        + "\",\"venue\":\"XNAS\",\"status\":\""
+                        + status[gen() % 4] + "\",\"tags\":[";
+
+        // 0-8 fills grow the record from ~200 to ~800 bytes
+        unsigned fills = gen() % 9;
+        for(unsigned f = 0; f < fills; ++f)
+            s += std::string(f ? "," : "") + "{\"fill_id\":"
+                 + std::to_string(gen() % 1000000) + ",\"qty\":"
+                 + std::to_string(gen() % 500) + ",\"px\":"
+                 + std::to_string(100 + gen() % 900) + ",\"liq\":\""
+                 + (gen() % 2 ? "maker" : "taker") + "\"}";
+        s += "],\"ts\":\"2025-01-01T09:30:" + std::to_string(10 + gen() % 50)
+             + "." + std::to_string(gen() % 1000000) + "Z\"}";
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+static const std::vector<std::string> &corpus()
+{
+    static std::vector<std::string> data = make_records(1000, 2);
+    return data;
+}
+
+static const hj::zstd::dictionary &trained(size_t capacity)
+{
+    static hj::zstd::dictionary dicts[2];
+    auto                       &dict = dicts[capacity > 16 * 1024 ? 1 : 0];
+    if(dict.empty())
+        hj::zstd::dictionary::train(dict, make_records(5000, 1), capacity);
+    return dict;
+}
+
+template <typename F>
+static void run_compress(benchmark::State &state, F &&compress)
+{
+    const auto                &msgs = corpus();
+    std::vector<unsigned char> out;
+    size_t                     raw = 0, packed = 0;
+    for(const auto &msg : msgs)
+    {
+        if(!compress(out, msg))
+        {
+            state.SkipWithError("compress failed");
+            return;
+        }
+        raw += msg.size();
+        packed += out.size();
+    }
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        const auto &msg = msgs[i++ % msgs.size()];
+        compress(out, msg);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["ratio"] = double(packed) / double(raw);
+}
+
+static void bm_small_msg_gzip(benchmark::State &state)
+{
+    run_compress(state,
+                 [](std::vector<unsigned char> &out, const std::string &msg) {
+                     return hj::gzip::compress(out, msg.data(), msg.size())
+                            == hj::gzip::err::ok;
+                 });
+}
+
+static void bm_small_msg_zstd(benchmark::State &state)
+{
+    run_compress(state,
+                 [](std::vector<unsigned char> &out, const std::string &msg) {
+                     return hj::zstd::compress(out, msg.data(), msg.size())
+                            == hj::zstd::err::ok;
+                 });
+}
+
+// arg: dictionary capacity
+static void bm_small_msg_zstd_dict(benchmark::State &state)
+{
+    const auto &dict = trained(static_cast<size_t>(state.range(0)));
+    run_compress(
+        state,
+        [&dict](std::vector<unsigned char> &out, const std::string &msg) {
+            return hj::zstd::compress(out, msg.data(), msg.size(), dict)
+                   == hj::zstd::err::ok;
+        });
+}
+
+static void bm_small_msg_zstd_dict_decompress(benchmark::State &state)
+{
+    const auto                             &dict = trained(16 * 1024);
+    std::vector<std::vector<unsigned char>> frames;
+    for(const auto &msg : corpus())
+    {
+        frames.emplace_back();
+        hj::zstd::compress(frames.back(), msg.data(), msg.size(), dict);
+    }
+
+    std::vector<unsigned char> out;
+    size_t                     i = 0;
+    for(auto _ : state)
+    {
+        const auto &f = frames[i++ % frames.size()];
+        if(hj::zstd::decompress(out, f.data(), f.size(), dict)
+           != hj::zstd::err::ok)
+            state.SkipWithError("decompress failed");
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void bm_zstd_dict_train(benchmark::State &state)
+{
+    auto samples = make_records(5000, 1);
+    for(auto _ : state)
+    {
+        hj::zstd::dictionary dict;
+        if(hj::zstd::dictionary::train(dict, samples) != hj::zstd::err::ok)
+            state.SkipWithError("train failed");
+        benchmark::DoNotOptimize(dict.id());
+    }
+}
+
+BENCHMARK(bm_small_msg_gzip);
+BENCHMARK(bm_small_msg_zstd);
+BENCHMARK(bm_small_msg_zstd_dict)->Arg(16 * 1024)->Arg(64 * 1024);
+BENCHMARK(bm_small_msg_zstd_dict_decompress);
+BENCHMARK(bm_zstd_dict_train)->Unit(benchmark::kMillisecond);
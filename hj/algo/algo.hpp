@@ -9,6 +9,8 @@
 
 #include <hj/algo/bloom_filter.hpp>
 
+#include <hj/algo/hash.hpp>
+
 #include <hj/algo/crc16.h>
 
 #include <hj/algo/crc32.h>
@@ -36,6 +36,8 @@
 #include <utility>
 #include <vector>
 
+#include <hj/algo/hash.hpp>
+
 namespace hj::astar
 {
 
@@ -179,12 +181,9 @@ struct location
     {
         std::size_t operator()(const location &loc) const
         {
-            std::size_t seed = 0;
-            seed ^= std::hash<T>()(loc.x) + 0x9e3779b97f4a7c15ULL + (seed << 6)
-                    + (seed >> 2);
-            seed ^= std::hash<T>()(loc.y) + 0x9e3779b97f4a7c15ULL + (seed << 6)
-                    + (seed >> 2);
-            return seed;
+            const hj::hash<T> h{};
+            uint64_t          seed = hj::hash_combine(h(loc.x), h(loc.y));
+            return static_cast<std::size_t>(seed);
         }
     };
 };
@@ -202,7 +201,7 @@ struct edge_hash
         const typename Location::hash hasher{};
         const std::size_t             h1 = hasher(edge.first);
         const std::size_t             h2 = hasher(edge.second);
-        return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+        return static_cast<std::size_t>(hj::hash_combine(h1, h2));
     }
 };
 
@@ -26,6 +26,8 @@
 #include <cstring>
 #include <algorithm>
 
+#include <hj/algo/hash.hpp>
+
 #ifndef BLOOM_FILTER_MIN_BITS
 #define BLOOM_FILTER_MIN_BITS 64
 #endif
@@ -117,12 +119,18 @@ class dynamic_bitset
 
 } // namespace detail
 
-template <typename T = std::string>
+// Hash: any std::hash-like functor; the k bit positions are derived from
+// its one result (Kirsch-Mitzenmacher double hashing), so it must spread
+// all 64 bits well, std::hash for integers does not.
+template <typename T = std::string, typename Hash = hj::hash<T>>
 class bloom_filter
 {
   public:
-    bloom_filter(size_t expected_insertions, double false_positive_rate)
-        : _expected_insertions{expected_insertions}
+    bloom_filter(size_t      expected_insertions,
+                 double      false_positive_rate,
+                 const Hash &hash = Hash())
+        : _hash{hash}
+        , _expected_insertions{expected_insertions}
         , _false_positive_rate{false_positive_rate}
         , _num_bits(0)
         , _num_hash_functions(0)
@@ -162,20 +170,20 @@ class bloom_filter
     void add(const T &value)
     {
         _assert_not_empty(value);
-        for(size_t i = 0; i < _num_hash_functions; ++i)
-        {
-            size_t hash = _hash_i(value, i);
-            _bits.set(hash % _num_bits);
-        }
+        uint64_t h1 = _hash(value);
+        uint64_t h2 = _second(h1);
+        for(size_t i = 0; i < _num_hash_functions; ++i, h1 += h2)
+            _bits.set(h1 % _num_bits);
     }
 
     bool contains(const T &value) const
     {
         _assert_not_empty(value);
-        for(size_t i = 0; i < _num_hash_functions; ++i)
+        uint64_t h1 = _hash(value);
+        uint64_t h2 = _second(h1);
+        for(size_t i = 0; i < _num_hash_functions; ++i, h1 += h2)
         {
-            size_t hash = _hash_i(value, i);
-            if(!_bits.test(hash % _num_bits))
+            if(!_bits.test(h1 % _num_bits))
                 return false;
         }
         return true;
@@ -201,8 +209,9 @@ class bloom_filter
   private:
     static size_t _optimal_num_of_bits(size_t n, double p)
     {
-        return static_cast<size_t>(-1 * n * std::log(p)
-                                   / (std::pow(std::log(2), 2)));
+        // n is unsigned, negate after converting or the product wraps
+        return static_cast<size_t>(-static_cast<double>(n) * std::log(p)
+                                   / (std::log(2.0) * std::log(2.0)));
     }
 
     static size_t _optimal_num_of_hash_functions(size_t n, size_t m)
@@ -214,13 +223,10 @@ class bloom_filter
             static_cast<size_t>(std::round((double) m / n * std::log(2))));
     }
 
-    static size_t _hash_i(const T &value, size_t i)
+    // i-th position is h1 + i * h2; h2 odd so the k positions differ
+    static inline uint64_t _second(uint64_t h1)
     {
-        std::hash<T>      h1;
-        std::hash<size_t> h2;
-        size_t            hval = h1(value);
-        size_t            hmix = hval + i * h2(hval);
-        return hmix & 0x7FFFFFFFFFFFFFFF;
+        return hj::hash_mix(h1) | 1;
     }
 
     template <typename U = T>
@@ -231,6 +237,7 @@ class bloom_filter
     }
 
   private:
+    Hash                   _hash;
     size_t                 _expected_insertions;
     double                 _false_positive_rate;
     size_t                 _num_bits;
@@ -0,0 +1,377 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace hj
+{
+
+// Fast non-cryptographic hashing (wyhash final4 by Wang Yi, public
+// domain): about 15 GB/s on long keys and a few ns on short ones, passes
+// SMHasher. Not for anything an attacker picks the keys of (use a random
+// seed there) and never for signatures or passwords, see hj/crypto.
+//
+// Results are the same on every platform, so they may be stored.
+namespace hash_detail
+{
+
+static constexpr uint64_t secret[4] = {0xa0761d6478bd642fULL,
+                                       0xe7037ed1a0b428dbULL,
+                                       0x8ebc6af09c88c6e3ULL,
+                                       0x589965cc75374cc3ULL};
+
+// 64x64 -> 128 multiply, a gets the low and b the high half
+inline void mum(uint64_t &a, uint64_t &b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a             = static_cast<uint64_t>(r);
+    b             = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) noexcept
+{
+    mum(a, b);
+    return a ^ b;
+}
+
+// little endian loads whatever the host is
+inline uint64_t r8(const uint8_t *p) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline uint64_t r4(const uint8_t *p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+// 1..3 bytes
+inline uint64_t r3(const uint8_t *p, std::size_t k) noexcept
+{
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+}
+
+inline uint64_t init(uint64_t seed) noexcept
+{
+    return seed ^ mix(seed ^ secret[0], secret[1]);
+}
+
+inline void stripe(const uint8_t *p,
+                   uint64_t      &seed,
+                   uint64_t      &see1,
+                   uint64_t      &see2) noexcept
+{
+    seed = mix(r8(p) ^ secret[1], r8(p + 8) ^ seed);
+    see1 = mix(r8(p + 16) ^ secret[2], r8(p + 24) ^ see1);
+    see2 = mix(r8(p + 32) ^ secret[3], r8(p + 40) ^ see2);
+}
+
+// the part after the 48 byte stripes: i (1..48) bytes at p, the 16 bytes
+// before p must be readable when i < 16 (they are the previous stripe)
+inline uint64_t
+tail(const uint8_t *p, std::size_t i, uint64_t seed, uint64_t len) noexcept
+{
+    for(; i > 16; i -= 16, p += 16)
+        seed = mix(r8(p) ^ secret[1], r8(p + 8) ^ seed);
+
+    uint64_t a = r8(p + i - 16) ^ secret[1];
+    uint64_t b = r8(p + i - 8) ^ seed;
+    mum(a, b);
+    return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+inline uint64_t
+wyhash(const uint8_t *p, std::size_t len, uint64_t seed) noexcept
+{
+    seed = init(seed);
+    if(len <= 16)
+    {
+        uint64_t a = 0, b = 0;
+        if(len >= 4)
+        {
+            a = (r4(p) << 32) | r4(p + ((len >> 3) << 2));
+            b = (r4(p + len - 4) << 32) | r4(p + len - 4 - ((len >> 3) << 2));
+        } else if(len > 0)
+        {
+            a = r3(p, len);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+    }
+
+    std::size_t i = len;
+    if(i > 48)
+    {
+        uint64_t see1 = seed, see2 = seed;
+        do
+        {
+            stripe(p, seed, see1, see2);
+            p += 48;
+            i -= 48;
+        } while(i > 48);
+        seed ^= see1 ^ see2;
+    }
+    return tail(p, i, seed, len);
+}
+
+} // namespace hash_detail
+
+struct hash128_t
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    inline bool operator==(const hash128_t &o) const noexcept
+    {
+        return lo == o.lo && hi == o.hi;
+    }
+    inline bool operator!=(const hash128_t &o) const noexcept
+    {
+        return !(*this == o);
+    }
+};
+
+inline uint64_t
+hash64(const void *data, const std::size_t len, const uint64_t seed = 0)
+{
+    return hash_detail::wyhash(static_cast<const uint8_t *>(data), len, seed);
+}
+
+inline uint64_t hash64(std::string_view str, const uint64_t seed = 0)
+{
+    return hash64(str.data(), str.size(), seed);
+}
+
+// two 64-bit passes with unrelated seeds; for content ids / dedup keys
+// where 64 bits give too many collisions, at twice the cost
+inline hash128_t
+hash128(const void *data, const std::size_t len, const uint64_t seed = 0)
+{
+    return hash128_t{hash64(data, len, seed),
+                     hash64(data, len, seed ^ hash_detail::secret[2])};
+}
+
+inline hash128_t hash128(std::string_view str, const uint64_t seed = 0)
+{
+    return hash128(str.data(), str.size(), seed);
+}
+
+// Integer mixer (splitmix64 finalizer, Stafford's Mix13): a bijection
+// where every input bit flips each output bit with p ~ 0.5. Turns
+// sequential ids or pointers into well spread bucket / shard indexes.
+inline constexpr uint64_t hash_mix(uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// folds v into seed, e.g. for the members of a struct; order matters
+inline constexpr uint64_t hash_combine(uint64_t seed, uint64_t v) noexcept
+{
+    return hash_mix(seed * 0x9e3779b97f4a7c15ULL + v);
+}
+
+// Streaming hash64(): update() in pieces of any size, finish() returns
+// what hash64() gives for all of them at once. 48 byte stripes are hashed
+// as they fill, the state is ~120 bytes and update() never allocates.
+class hasher64
+{
+  public:
+    explicit hasher64(const uint64_t seed = 0) noexcept
+        : _seed0{seed}
+    {
+        reset();
+    }
+
+    void update(const void *data, std::size_t len) noexcept
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        _total += len;
+
+        // a stripe is only taken once more bytes are known to follow it
+        if(_len > 0)
+        {
+            std::size_t n = std::min(len, sizeof(_buf) - _len);
+            std::memcpy(_buf + _len, p, n);
+            _len += n;
+            p += n;
+            len -= n;
+            if(len == 0)
+                return;
+
+            _consume(_buf);
+            _len = 0;
+        }
+        for(; len > 48; p += 48, len -= 48)
+            _consume(p);
+
+        std::memcpy(_buf, p, len);
+        _len = len;
+    }
+
+    inline void update(std::string_view str) noexcept
+    {
+        update(str.data(), str.size());
+    }
+
+    uint64_t finish() const noexcept
+    {
+        if(!_striped)
+            return hash64(_buf, _len, _seed0);
+
+        // the last 16 bytes may reach back into the previous stripe
+        uint8_t tmp[16 + sizeof(_buf)];
+        std::memcpy(tmp, _last, 16);
+        std::memcpy(tmp + 16, _buf, _len);
+        return hash_detail::tail(tmp + 16,
+                                 _len,
+                                 _seed ^ _see1 ^ _see2,
+                                 _total);
+    }
+
+    void reset() noexcept
+    {
+        _seed    = hash_detail::init(_seed0);
+        _see1    = _seed;
+        _see2    = _seed;
+        _total   = 0;
+        _len     = 0;
+        _striped = false;
+    }
+
+  private:
+    inline void _consume(const uint8_t *p) noexcept
+    {
+        hash_detail::stripe(p, _seed, _see1, _see2);
+        std::memcpy(_last, p + 32, 16);
+        _striped = true;
+    }
+
+  private:
+    uint64_t    _seed0;
+    uint64_t    _seed;
+    uint64_t    _see1;
+    uint64_t    _see2;
+    uint64_t    _total;
+    uint8_t     _buf[48];
+    uint8_t     _last[16];
+    std::size_t _len;
+    bool        _striped;
+};
+
+// Drop-in for std::hash<T> in hashed containers. libstdc++'s std::hash is
+// the identity for integers, which piles keys with a common stride into
+// the same buckets / stripes; this mixes them.
+template <typename T, typename = void>
+struct hash
+{
+    // anything else: std::hash, mixed
+    inline std::size_t operator()(const T &v) const
+    {
+        return static_cast<std::size_t>(hash_mix(std::hash<T>{}(v)));
+    }
+};
+
+template <typename T>
+struct hash<T,
+            typename std::enable_if<std::is_integral<T>::value
+                                    || std::is_enum<T>::value
+                                    || std::is_pointer<T>::value>::type>
+{
+    inline std::size_t operator()(const T v) const noexcept
+    {
+        uint64_t x;
+        if constexpr(std::is_pointer<T>::value)
+            x = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(v));
+        else
+            x = static_cast<uint64_t>(v);
+        return static_cast<std::size_t>(hash_mix(x));
+    }
+};
+
+template <typename T>
+struct hash<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    inline std::size_t operator()(const T v) const noexcept
+    {
+        // 0.0 == -0.0, so they must hash alike
+        return v == T(0) ? hash<int>{}(0) : hash64(&v, sizeof(v));
+    }
+};
+
+template <>
+struct hash<std::string>
+{
+    using is_transparent = void;
+
+    inline std::size_t operator()(std::string_view s) const noexcept
+    {
+        return static_cast<std::size_t>(hash64(s.data(), s.size()));
+    }
+};
+
+template <>
+struct hash<std::string_view> : hash<std::string>
+{
+};
+
+} // namespace hj
+
+#endif // HASH_HPP
@@ -21,10 +21,13 @@
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/member.hpp>
 #include <type_traits>
 
+#include <hj/algo/hash.hpp>
+
 namespace hj
 {
 
@@ -52,6 +55,22 @@ struct nonunique_index_impl
                   "MemberPtr must be a member pointer");
 };
 
+template <typename MemberType,
+          auto MemberPtr,
+          typename Tag,
+          typename Hash,
+          bool Unique>
+struct hashed_index_impl
+{
+    using member_type                = MemberType;
+    static constexpr auto member_ptr = MemberPtr;
+    using tag_type                   = Tag;
+    using hash_type                  = Hash;
+    static constexpr bool is_unique  = Unique;
+    static_assert(std::is_member_pointer_v<decltype(MemberPtr)>,
+                  "MemberPtr must be a member pointer");
+};
+
 template <typename IndexConfig, typename Class>
 struct make_index;
 
@@ -71,6 +90,34 @@ struct make_index<nonunique_index_impl<MemberType, MemberPtr, Tag>, Class>
         boost::multi_index::member<Class, MemberType, MemberPtr>>;
 };
 
+template <typename MemberType,
+          auto MemberPtr,
+          typename Tag,
+          typename Hash,
+          typename Class>
+struct make_index<hashed_index_impl<MemberType, MemberPtr, Tag, Hash, true>,
+                  Class>
+{
+    using type = boost::multi_index::hashed_unique<
+        boost::multi_index::tag<Tag>,
+        boost::multi_index::member<Class, MemberType, MemberPtr>,
+        Hash>;
+};
+
+template <typename MemberType,
+          auto MemberPtr,
+          typename Tag,
+          typename Hash,
+          typename Class>
+struct make_index<hashed_index_impl<MemberType, MemberPtr, Tag, Hash, false>,
+                  Class>
+{
+    using type = boost::multi_index::hashed_non_unique<
+        boost::multi_index::tag<Tag>,
+        boost::multi_index::member<Class, MemberType, MemberPtr>,
+        Hash>;
+};
+
 template <typename Class, auto MemberPtr>
 using member_type_t = std::remove_cv_t<
     std::remove_reference_t<decltype(std::declval<Class>().*MemberPtr)>>;
@@ -84,6 +131,22 @@ template <typename MemberType, auto MemberPtr, typename Tag>
 using nonunique_index =
     detail::nonunique_index_impl<MemberType, MemberPtr, Tag>;
 
+// O(1) lookups without ordering; hashed with hj::hash unless told
+// otherwise (boost::hash is the identity for integers too)
+template <typename MemberType,
+          auto MemberPtr,
+          typename Tag,
+          typename Hash = hj::hash<MemberType>>
+using hashed_unique_index =
+    detail::hashed_index_impl<MemberType, MemberPtr, Tag, Hash, true>;
+
+template <typename MemberType,
+          auto MemberPtr,
+          typename Tag,
+          typename Hash = hj::hash<MemberType>>
+using hashed_nonunique_index =
+    detail::hashed_index_impl<MemberType, MemberPtr, Tag, Hash, false>;
+
 template <typename Class, typename... IndexConfigs>
 using multi_index = boost::multi_index::multi_index_container<
     Class,
@@ -95,6 +158,10 @@ using multi_index = boost::multi_index::multi_index_container<
     hj::unique_index<member_type, member_ptr, tag>,
 #define HJ_NON_UNIQUE_INDEX(member_type, member_ptr, tag)                      \
     hj::nonunique_index<member_type, member_ptr, tag>
+#define HJ_HASHED_UNIQUE_INDEX(member_type, member_ptr, tag)                   \
+    hj::hashed_unique_index<member_type, member_ptr, tag>,
+#define HJ_HASHED_NON_UNIQUE_INDEX(member_type, member_ptr, tag)               \
+    hj::hashed_nonunique_index<member_type, member_ptr, tag>
 
 #define HJ_INDEX_TAG(tag)                                                      \
     struct tag                                                                 \
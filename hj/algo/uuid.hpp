@@ -19,18 +19,44 @@
 #ifndef UUID_HPP
 #define UUID_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
-#include <cstdio>
+#include <cstring>
+#include <random>
 #include <string>
-#include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <type_traits>
 
+#if defined(__linux__)
+#include <time.h>
+#endif
+
 namespace hj
 {
 
+// 128-bit id, hi holds the first 8 bytes of the text form
+struct uuid128
+{
+    uint64_t hi;
+    uint64_t lo;
+
+    inline bool operator==(const uuid128 &other) const noexcept
+    {
+        return hi == other.hi && lo == other.lo;
+    }
+    inline bool operator!=(const uuid128 &other) const noexcept
+    {
+        return !(*this == other);
+    }
+    inline bool operator<(const uuid128 &other) const noexcept
+    {
+        return hi < other.hi || (hi == other.hi && lo < other.lo);
+    }
+};
+
 namespace detail
 {
 // tool function to swap endianness of a 64-bit integer
@@ -62,20 +88,48 @@ inline uint64_t to_endian(uint64_t val, bool big_endian)
     return val;
 }
 
+// 8 lowercase hex digits of v, in text order once stored to memory
+inline uint64_t hex8(uint32_t v) noexcept
+{
+    uint64_t x = v;
+    x          = ((x & 0xFFFF0000ULL) << 16) | (x & 0x0000FFFFULL);
+    x = ((x & 0x0000FF000000FF00ULL) << 8) | (x & 0x000000FF000000FFULL);
+    x = ((x & 0x00F000F000F000F0ULL) << 4) | (x & 0x000F000F000F000FULL);
+
+    // one nibble per byte now; bytes above 9 get 'a' - '0' - 10 more
+    uint64_t alpha = ((x + 0x0606060606060606ULL) >> 4) & 0x0101010101010101ULL;
+    x += 0x3030303030303030ULL + alpha * ('a' - '0' - 10);
+    return to_endian(x, true);
+}
+
+// writes the 36 chars of "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx", no '\0'
+inline char *format_uuid(char *dst, uint64_t hi, uint64_t lo) noexcept
+{
+    uint64_t digits[4] = {hex8(static_cast<uint32_t>(hi >> 32)),
+                          hex8(static_cast<uint32_t>(hi)),
+                          hex8(static_cast<uint32_t>(lo >> 32)),
+                          hex8(static_cast<uint32_t>(lo))};
+    const char *src       = reinterpret_cast<const char *>(digits);
+
+    std::memcpy(dst, src, 8);
+    dst[8] = '-';
+    std::memcpy(dst + 9, src + 8, 4);
+    dst[13] = '-';
+    std::memcpy(dst + 14, src + 12, 4);
+    dst[18] = '-';
+    std::memcpy(dst + 19, src + 16, 4);
+    dst[23] = '-';
+    std::memcpy(dst + 24, src + 20, 12);
+    return dst + 36;
+}
+
 inline std::string rfc_uuid_format(uint64_t high, uint64_t low)
 {
     uint64_t rfc_high = (high & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000008000ULL;
     uint64_t rfc_low  = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
 
-    char buf[37];
-    std::snprintf(buf,
-                  sizeof(buf),
-                  "%08x-%04x-%04x-%04x-%012llx",
-                  static_cast<uint32_t>(rfc_high >> 32),
-                  static_cast<uint16_t>((rfc_high >> 16) & 0xFFFF),
-                  static_cast<uint16_t>(rfc_high & 0xFFFF),
-                  static_cast<uint16_t>((rfc_low >> 48) & 0xFFFF),
-                  static_cast<unsigned long long>(rfc_low & 0xFFFFFFFFFFFFULL));
+    char buf[36];
+    format_uuid(buf, rfc_high, rfc_low);
     return std::string(buf, 36);
 }
 
@@ -98,6 +152,19 @@ struct has_gen<T, std::void_t<decltype(T::gen())>> : std::true_type
 {
 };
 
+template <typename T, typename Id, typename = void>
+struct has_generate_n : std::false_type
+{
+};
+template <typename T, typename Id>
+struct has_generate_n<T,
+                      Id,
+                      std::void_t<decltype(T::generate_n(
+                          std::declval<Id *>(), std::size_t{0}, true))>>
+    : std::true_type
+{
+};
+
 // Generator_impl struct to call the appropriate gen_u64 method
 template <typename Generator, typename Enable = void>
 struct generator_impl
@@ -131,6 +198,144 @@ struct generator_impl
     }
 };
 
+// Lock-free source of (milliseconds << SeqBits | sequence) values shared by
+// the time ordered generators below; every value is handed out once.
+//
+// The value is a logical clock: it follows the wall clock but never goes
+// back, a sequence overflow carries into the next millisecond and a clock
+// that stepped back by up to max_backward_ms just keeps counting on the
+// last millisecond. It may run ahead of the wall clock by max_ahead_ms
+// under bursts, beyond that callers wait for the clock to catch up; the
+// bound covers the last value of a reservation, so a single reserve() is
+// limited to max_reserve values and bulk callers split larger runs.
+//
+// next() serves each thread from a private block taken with one CAS, the
+// block doubles while the thread drains it within one millisecond and is
+// dropped once the clock moved on, so ids keep tracking the time. Ids are
+// unique and increasing per thread; across threads they are ordered by
+// millisecond only.
+template <unsigned SeqBits, uint64_t Epoch>
+class seq_clock
+{
+  public:
+    static constexpr uint64_t seq_bits        = SeqBits;
+    static constexpr uint64_t max_block       = 1ULL << (SeqBits - 6);
+    static constexpr uint64_t max_backward_ms = 5000ULL;
+    static constexpr uint64_t max_ahead_ms    = 1000ULL;
+    static constexpr uint64_t max_reserve     = (max_ahead_ms / 4) << SeqBits;
+
+    seq_clock()
+        : _id{_next_instance()}
+    {
+    }
+
+    seq_clock(const seq_clock &)            = delete;
+    seq_clock &operator=(const seq_clock &) = delete;
+
+    // read on every next(); the coarse clock is a few ns instead of a few
+    // dozen and its tick (1-4 ms) is plenty for a millisecond field
+    static uint64_t now_ms() noexcept
+    {
+#if defined(__linux__)
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000ULL
+               + static_cast<uint64_t>(ts.tv_nsec) / 1000000ULL - Epoch;
+#else
+        using namespace std::chrono;
+        return static_cast<uint64_t>(
+                   duration_cast<milliseconds>(
+                       system_clock::now().time_since_epoch())
+                       .count())
+               - Epoch;
+#endif
+    }
+
+    uint64_t next()
+    {
+        thread_local _block blk;
+        if(blk.owner != _id)
+            blk = _block{_id, 0, 0, 1};
+
+        uint64_t now = now_ms();
+        if(blk.next != blk.end && (blk.next >> SeqBits) >= now)
+            return blk.next++;
+
+        bool drained = blk.end != 0 && ((blk.end - 1) >> SeqBits) >= now;
+        blk.size     = drained ? std::min(blk.size * 2, max_block) : 1;
+        blk.next     = reserve(blk.size, now);
+        blk.end      = blk.next + blk.size;
+        return blk.next++;
+    }
+
+    // n consecutive values for bulk generation, returns the first one;
+    // 1 <= n <= max_reserve
+    inline uint64_t reserve(uint64_t n) { return reserve(n, now_ms()); }
+
+    uint64_t reserve(uint64_t n, uint64_t now)
+    {
+        if(n == 0 || n > max_reserve)
+            throw std::invalid_argument("Reservation size out of range!");
+
+        uint64_t seen = _observe(now);
+        if(now + max_backward_ms < seen)
+            throw std::runtime_error("Clock moved backwards too much!");
+
+        uint64_t old = _state.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            uint64_t base = std::max(old, now << SeqBits);
+            if(((base + n - 1) >> SeqBits) > std::max(seen, now) + max_ahead_ms)
+            {
+                std::this_thread::yield();
+                now  = now_ms();
+                seen = _observe(now);
+                old  = _state.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(_state.compare_exchange_weak(old,
+                                            base + n,
+                                            std::memory_order_relaxed,
+                                            std::memory_order_relaxed))
+                return base;
+        }
+    }
+
+  private:
+    struct _block
+    {
+        uint64_t owner = 0;
+        uint64_t next  = 0;
+        uint64_t end   = 0;
+        uint64_t size  = 1;
+    };
+
+    static uint64_t _next_instance() noexcept
+    {
+        static std::atomic<uint64_t> count{0};
+        return count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // latest wall clock reading, a stepped back clock shows up below it
+    uint64_t _observe(uint64_t now) noexcept
+    {
+        uint64_t seen = _seen.load(std::memory_order_relaxed);
+        while(now > seen
+              && !_seen.compare_exchange_weak(seen,
+                                              now,
+                                              std::memory_order_relaxed))
+        {
+        }
+        return std::max(seen, now);
+    }
+
+  private:
+    const uint64_t        _id;
+    std::atomic<uint64_t> _state{0};
+    std::atomic<uint64_t> _seen{0};
+};
+
 // snowflake engine implementation
 class snowflake_engine
 {
@@ -145,83 +350,53 @@ class snowflake_engine
         1735689600000ULL; // 2025-01-01 00:00:00 UTC
     static constexpr uint64_t max_backward_ms = 5000ULL;
 
+    using clock_t = seq_clock<_seqbits, epoch>;
+
     explicit snowflake_engine(uint64_t worker_id = 1)
         : _worker_id(worker_id)
     {
-        if(_worker_id > max_worker_id)
+        if(worker_id > max_worker_id)
             throw std::invalid_argument("Worker ID exceeds limit (1023)");
     }
 
     inline void reset_worker_id(uint64_t worker_id)
     {
-        std::lock_guard<std::mutex> lock(_mu);
         if(worker_id > max_worker_id)
             throw std::invalid_argument("Worker ID exceeds limit (1023)");
 
-        _worker_id = worker_id;
+        _worker_id.store(worker_id, std::memory_order_relaxed);
     }
 
-    uint64_t next_id()
+    inline uint64_t next_id() { return _compose(_clock.next()); }
+
+    // n ids in increasing order, one reservation per max_reserve ids
+    void generate_n(uint64_t *dst, std::size_t n)
     {
-        std::unique_lock<std::mutex> lock(_mu);
-        uint64_t                     timestamp = _current_time_ms();
-        if(timestamp < _last_timestamp)
-        {
-            uint64_t offset = _last_timestamp - timestamp;
-            if(offset > max_backward_ms)
-                throw std::runtime_error("Clock moved backwards too much!");
-
-            // avoid busy waiting by releasing the lock and sleeping for a short duration
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(offset));
-            lock.lock();
-
-            timestamp = _current_time_ms();
-            if(timestamp < _last_timestamp)
-                timestamp = _wait_next_millis(_last_timestamp);
-        }
+        if(n == 0)
+            return;
 
-        if(timestamp == _last_timestamp)
-        {
-            _seq = (_seq + 1) & _seqmask;
-            if(_seq == 0)
-                timestamp = _wait_next_millis(_last_timestamp);
-        } else
+        while(n > 0)
         {
-            _seq = 0;
+            std::size_t k    = std::min<uint64_t>(n, clock_t::max_reserve);
+            uint64_t    base = _clock.reserve(k);
+            for(std::size_t i = 0; i < k; ++i)
+                dst[i] = _compose(base + i);
+            dst += k;
+            n -= k;
         }
-        _last_timestamp = timestamp;
-        return ((timestamp - epoch) << timestamp_shift)
-               | (_worker_id << _worker_idshift) | _seq;
     }
 
   private:
-    static uint64_t _current_time_ms()
+    inline uint64_t _compose(uint64_t v) const noexcept
     {
-        using namespace std::chrono;
-        return duration_cast<milliseconds>(
-                   system_clock::now().time_since_epoch())
-            .count();
-    }
-
-    static uint64_t _wait_next_millis(uint64_t last_time)
-    {
-        uint64_t timestamp = _current_time_ms();
-        while(timestamp <= last_time)
-        {
-            // avoid busy waiting by yielding the thread and updating the timestamp
-            std::this_thread::yield();
-            timestamp = _current_time_ms();
-        }
-
-        return timestamp;
+        uint64_t worker = _worker_id.load(std::memory_order_relaxed);
+        return ((v >> _seqbits) << timestamp_shift)
+               | (worker << _worker_idshift) | (v & _seqmask);
     }
 
   private:
-    std::mutex _mu;
-    uint64_t   _worker_id{1};
-    uint64_t   _seq{0};
-    uint64_t   _last_timestamp{0};
+    std::atomic<uint64_t> _worker_id{1};
+    clock_t               _clock;
 };
 
 struct snowflake
@@ -234,6 +409,15 @@ struct snowflake
         return detail::to_endian(id, big_endian);
     }
 
+    static void
+    generate_n(uint64_t *dst, std::size_t n, bool big_endian = true)
+    {
+        _instance().generate_n(dst, n);
+        if(big_endian)
+            for(std::size_t i = 0; i < n; ++i)
+                dst[i] = detail::to_endian(dst[i], true);
+    }
+
     static std::string gen()
     {
         uint64_t                     id   = gen_u64(false);
@@ -257,6 +441,85 @@ struct snowflake
     }
 };
 
+// RFC 9562 UUIDv7: 48-bit unix milliseconds, version 7, then a 16-bit
+// sequence spread over rand_a and the top of rand_b so ids sort by
+// creation time, and 58 random bits so other processes do not collide
+struct uuid_v7
+{
+    static constexpr uint64_t seq_bits = 16ULL;
+
+    using clock_t = seq_clock<seq_bits, 0>;
+
+    static uuid128 next()
+    {
+        return _compose(_clock().next(), _random());
+    }
+
+    // n ids in increasing order, one reservation per max_reserve ids
+    static void generate_n(uuid128 *dst, std::size_t n)
+    {
+        if(n == 0)
+            return;
+
+        while(n > 0)
+        {
+            std::size_t k    = std::min<uint64_t>(n, clock_t::max_reserve);
+            uint64_t    base = _clock().reserve(k);
+            for(std::size_t i = 0; i < k; ++i)
+                dst[i] = _compose(base + i, _random());
+            dst += k;
+            n -= k;
+        }
+    }
+
+    static std::string gen()
+    {
+        uuid128 id = next();
+        char    buf[36];
+        format_uuid(buf, id.hi, id.lo);
+        return std::string(buf, 36);
+    }
+
+  private:
+    static inline uuid128 _compose(uint64_t v, uint64_t rnd) noexcept
+    {
+        uint64_t ms  = v >> seq_bits;
+        uint64_t seq = v & ((1ULL << seq_bits) - 1);
+
+        uuid128 id;
+        id.hi = (ms << 16) | 0x7000ULL | (seq >> 4);
+        id.lo = 0x8000000000000000ULL | ((seq & 0xFULL) << 58)
+                | (rnd & 0x03FFFFFFFFFFFFFFULL);
+        return id;
+    }
+
+    // splitmix64, seeded once per thread
+    static inline uint64_t _random() noexcept
+    {
+        thread_local uint64_t state = _seed();
+        uint64_t              z     = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t _seed()
+    {
+        std::random_device rd;
+        uint64_t           seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        seed ^= static_cast<uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        seed ^= std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return seed;
+    }
+
+    static clock_t &_clock()
+    {
+        static clock_t inst;
+        return inst;
+    }
+};
+
 } // namespace detail
 
 class uuid
@@ -281,6 +544,42 @@ class uuid
     {
         return detail::generator_impl<Generator>::gen();
     }
+
+    // n ids into dst, one reservation instead of n when the generator
+    // has generate_n
+    template <typename Generator = hj::detail::snowflake>
+    static void gen_u64_n(uint64_t *dst, std::size_t n, bool big_endian = true)
+    {
+        if constexpr(detail::has_generate_n<Generator, uint64_t>::value)
+        {
+            Generator::generate_n(dst, n, big_endian);
+        } else
+        {
+            for(std::size_t i = 0; i < n; ++i)
+                dst[i] = gen_u64<Generator>(big_endian);
+        }
+    }
+
+    // time ordered RFC 9562 UUIDv7
+    static uuid128 gen_v7() { return detail::uuid_v7::next(); }
+
+    static void gen_v7_n(uuid128 *dst, std::size_t n)
+    {
+        detail::uuid_v7::generate_n(dst, n);
+    }
+
+    // writes the 36 char text form (no '\0'), returns dst + 36
+    static inline char *format_to(char *dst, const uuid128 &id) noexcept
+    {
+        return detail::format_uuid(dst, id.hi, id.lo);
+    }
+
+    static std::string to_string(const uuid128 &id)
+    {
+        char buf[36];
+        format_to(buf, id);
+        return std::string(buf, 36);
+    }
 };
 
 } // namespace hj
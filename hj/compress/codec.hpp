@@ -0,0 +1,290 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+
+#include <hj/compress/gzip.hpp>
+#include <hj/compress/lz4.hpp>
+#include <hj/compress/zstd.hpp>
+
+namespace hj
+{
+
+// Runtime choice between hj::gzip, hj::lz4 and hj::zstd, e.g. from a config
+// file or a negotiated header:
+//
+//   auto c = hj::codec::make(hj::codec::algo::zstd);
+//   c->compress(buf, data, len);
+//
+// Instances are immutable and safe to share between threads.
+class codec
+{
+  public:
+    enum class algo : int
+    {
+        gzip,
+        lz4,
+        zstd
+    };
+
+    enum class err : int
+    {
+        ok = 0,
+        stream_error,
+        data_error,
+        mem_error,
+
+        input_invalid,
+        buffer_too_small,
+        max_output_sz_exceeded,
+        read_buffer_error,
+        write_buffer_error
+    };
+
+    virtual ~codec() = default;
+
+    virtual algo        type() const noexcept = 0;
+    virtual const char *name() const noexcept = 0;
+    virtual size_t      compress_reserve_sz(const size_t src_sz) const = 0;
+
+    virtual err compress(std::vector<unsigned char> &dst,
+                         const void                 *src,
+                         const size_t                src_sz) const = 0;
+
+    virtual err decompress(std::vector<unsigned char> &dst,
+                           const void                 *src,
+                           const size_t                src_sz,
+                           const size_t max_output_sz = 0) const = 0;
+
+    virtual err compress(std::ostream &out, std::istream &in) const = 0;
+
+    virtual err decompress(std::ostream &out,
+                           std::istream &in,
+                           const size_t  max_output_sz = 0) const = 0;
+
+    err compress_file(const std::string &dst_file_path,
+                      const std::string &src_file_path) const
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return compress(out, in);
+    }
+
+    err decompress_file(const std::string &dst_file_path,
+                        const std::string &src_file_path,
+                        const size_t       max_output_sz = 0) const
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return decompress(out, in, max_output_sz);
+    }
+
+    // level 0 is the codec's default, anything else is on the codec's own
+    // scale (gzip 1..9, lz4 -N..12, zstd -N..22)
+    static std::unique_ptr<codec> make(const algo a, const int level = 0);
+
+    // nullptr for an unknown name; accepts "gzip", "lz4" and "zstd"
+    static std::unique_ptr<codec> make(const std::string &name,
+                                       const int          level = 0)
+    {
+        algo a;
+        if(!from_name(a, name))
+            return nullptr;
+
+        return make(a, level);
+    }
+
+    // shared instances at the default level
+    static const codec &get(const algo a);
+
+    static bool from_name(algo &a, const std::string &name)
+    {
+        if(name == "gzip")
+            a = algo::gzip;
+        else if(name == "lz4")
+            a = algo::lz4;
+        else if(name == "zstd")
+            a = algo::zstd;
+        else
+            return false;
+
+        return true;
+    }
+
+    // tells the algorithm from the frame magic
+    static bool detect(algo &a, const void *data, const size_t size)
+    {
+        if(hj::zstd::is_zstd_format(data, size))
+            a = algo::zstd;
+        else if(hj::lz4::is_lz4_format(data, size))
+            a = algo::lz4;
+        else if(hj::gzip::is_gzip_format(data, size))
+            a = algo::gzip;
+        else
+            return false;
+
+        return true;
+    }
+};
+
+namespace detail
+{
+
+// the three codecs share their error names
+template <typename E>
+inline codec::err to_codec_err(const E e)
+{
+    switch(e)
+    {
+        case E::ok:
+            return codec::err::ok;
+        case E::data_error:
+            return codec::err::data_error;
+        case E::mem_error:
+            return codec::err::mem_error;
+        case E::input_invalid:
+            return codec::err::input_invalid;
+        case E::buffer_too_small:
+            return codec::err::buffer_too_small;
+        case E::max_output_sz_exceeded:
+            return codec::err::max_output_sz_exceeded;
+        case E::read_buffer_error:
+            return codec::err::read_buffer_error;
+        case E::write_buffer_error:
+            return codec::err::write_buffer_error;
+        default:
+            return codec::err::stream_error;
+    }
+}
+
+template <typename Codec, codec::algo Algo>
+class codec_impl final : public codec
+{
+  public:
+    using lvl_t = typename Codec::compression_lvl;
+
+    explicit codec_impl(const lvl_t lvl, const char *name)
+        : _lvl{lvl}
+        , _name{name}
+    {
+    }
+
+    algo        type() const noexcept override { return Algo; }
+    const char *name() const noexcept override { return _name; }
+
+    size_t compress_reserve_sz(const size_t src_sz) const override
+    {
+        return Codec::compress_reserve_sz(src_sz);
+    }
+
+    err compress(std::vector<unsigned char> &dst,
+                 const void                 *src,
+                 const size_t                src_sz) const override
+    {
+        return to_codec_err(Codec::compress(dst, src, src_sz, _lvl));
+    }
+
+    err decompress(std::vector<unsigned char> &dst,
+                   const void                 *src,
+                   const size_t                src_sz,
+                   const size_t max_output_sz = 0) const override
+    {
+        return to_codec_err(
+            Codec::decompress(dst, src, src_sz, max_output_sz));
+    }
+
+    err compress(std::ostream &out, std::istream &in) const override
+    {
+        return to_codec_err(Codec::compress(out, in, _lvl));
+    }
+
+    err decompress(std::ostream &out,
+                   std::istream &in,
+                   const size_t  max_output_sz = 0) const override
+    {
+        return to_codec_err(Codec::decompress(out, in, max_output_sz));
+    }
+
+  private:
+    lvl_t       _lvl;
+    const char *_name;
+};
+
+} // namespace detail
+
+inline std::unique_ptr<codec> codec::make(const algo a, const int level)
+{
+    switch(a)
+    {
+        case algo::gzip: {
+            // 0 would be gzip's "store only"
+            auto lvl = level == 0 ? gzip::compression_lvl::default_compression
+                                  : static_cast<gzip::compression_lvl>(level);
+            return std::make_unique<
+                detail::codec_impl<hj::gzip, algo::gzip>>(lvl, "gzip");
+        }
+        case algo::lz4:
+            return std::make_unique<detail::codec_impl<hj::lz4, algo::lz4>>(
+                static_cast<lz4::compression_lvl>(level), "lz4");
+        case algo::zstd: {
+            auto lvl = level == 0 ? zstd::compression_lvl::default_compression
+                                  : static_cast<zstd::compression_lvl>(level);
+            return std::make_unique<
+                detail::codec_impl<hj::zstd, algo::zstd>>(lvl, "zstd");
+        }
+    }
+    return nullptr;
+}
+
+inline const codec &codec::get(const algo a)
+{
+    static const std::unique_ptr<codec> gzip_inst = make(algo::gzip);
+    static const std::unique_ptr<codec> lz4_inst  = make(algo::lz4);
+    static const std::unique_ptr<codec> zstd_inst = make(algo::zstd);
+    switch(a)
+    {
+        case algo::gzip:
+            return *gzip_inst;
+        case algo::lz4:
+            return *lz4_inst;
+        default:
+            return *zstd_inst;
+    }
+}
+
+} // namespace hj
+
+#endif // CODEC_HPP
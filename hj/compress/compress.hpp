@@ -5,4 +5,17 @@
 #include <hj/compress/gzip.hpp>
 #endif
 
+#ifdef HJ_ENABLE_LZ4
+#include <hj/compress/lz4.hpp>
+#endif
+
+#ifdef HJ_ENABLE_ZSTD
+#include <hj/compress/zstd.hpp>
+#endif
+
+#if defined(HJ_ENABLE_GZIP) && defined(HJ_ENABLE_LZ4) \
+    && defined(HJ_ENABLE_ZSTD)
+#include <hj/compress/codec.hpp>
+#endif
+
 #endif // COMPRESS_HPP
\ No newline at end of file
@@ -28,6 +28,11 @@
 #include <cstring>
 #include <limits>
 #include <algorithm>
+#include <deque>
+#include <future>
+#include <thread>
+
+#include <hj/sync/thread_pool.hpp>
 
 namespace hj
 {
@@ -37,6 +42,15 @@ static constexpr int GZIP_WINDOW_BITS =
 static constexpr size_t GZIP_MAX_SAFE_SZ =
     (std::numeric_limits<size_t>::max()) - 1000;
 
+struct gzip_parallel_options
+{
+    size_t       block_size = 128 * 1024; // input bytes per block
+    size_t       threads    = 0;          // 0 = hardware_concurrency
+    size_t       depth      = 0;          // blocks in flight, 0 = 2 x pool
+    thread_pool *pool       = nullptr;    // shared pool instead of own
+    bool         indexed    = false;      // independent members, see below
+};
+
 class gzip
 {
   public:
@@ -260,7 +274,7 @@ class gzip
         dst.clear();
         const size_t               chunk_size = 16384; // 16KB chunks
         std::vector<unsigned char> chunk(chunk_size);
-        do
+        for(;;)
         {
             stream.avail_out = static_cast<uInt>(chunk_size);
             stream.next_out  = chunk.data();
@@ -286,7 +300,17 @@ class gzip
             }
 
             dst.insert(dst.end(), chunk.begin(), chunk.begin() + have);
-        } while(stream.avail_out == 0);
+            if(ret == Z_STREAM_END)
+            {
+                // concatenated members are one stream, as for gunzip
+                if(stream.avail_in == 0 || stream.next_in[0] != 0x1f)
+                    break;
+                inflateReset(&stream);
+            } else if(stream.avail_out != 0)
+            {
+                break;
+            }
+        }
 
         inflateEnd(&stream);
         if(ret != Z_STREAM_END)
@@ -298,6 +322,8 @@ class gzip
         return err::ok;
     }
 
+    // concatenated members are one stream, trailing bytes that do not
+    // start another member are ignored
     static err decompress(std::ostream &out,
                           std::istream &in,
                           const size_t  max_output_sz = 0,
@@ -306,65 +332,174 @@ class gzip
         if(!in || !out)
             return err::input_invalid;
 
-        z_stream stream;
-        std::memset(&stream, 0, sizeof(stream));
-        int ret = inflateInit2(&stream, GZIP_WINDOW_BITS);
-        if(ret != Z_OK)
-            return static_cast<err>(ret);
+        _istream_src src{in};
+        _ostream_dst dst{out};
+        size_t       total_out = 0;
+        return _inflate_seq(src,
+                            dst,
+                            nullptr,
+                            0,
+                            max_output_sz,
+                            chunk_size,
+                            total_out,
+                            false);
+    }
 
-        std::vector<unsigned char> inbuf(chunk_size), outbuf(chunk_size);
-        err                        result    = err::ok;
-        size_t                     total_out = 0;
-        while(in)
-        {
-            in.read(reinterpret_cast<char *>(inbuf.data()), chunk_size);
-            std::streamsize read_sz = in.gcount();
-            if(read_sz <= 0)
-                break;
+    static err compress_file(
+        const std::string    &dst_file_path,
+        const std::string    &src_file_path,
+        const compression_lvl compr_lvl = compression_lvl::default_compression,
+        const mem_lvl         mem_level = mem_lvl::default_level)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
 
-            stream.avail_in = static_cast<uInt>(read_sz);
-            stream.next_in  = inbuf.data();
-            do
-            {
-                stream.avail_out = static_cast<uInt>(chunk_size);
-                stream.next_out  = outbuf.data();
-                ret              = inflate(&stream, Z_NO_FLUSH);
-                switch(ret)
-                {
-                    case Z_NEED_DICT:
-                    case Z_DATA_ERROR:
-                    case Z_MEM_ERROR: {
-                        result = static_cast<err>(ret);
-                        inflateEnd(&stream);
-                        return result;
-                    }
-                    default:
-                        break;
-                }
-                size_t have = chunk_size - stream.avail_out;
-                total_out += have;
-                if(max_output_sz > 0 && total_out > max_output_sz)
-                {
-                    result = err::max_output_sz_exceeded;
-                    inflateEnd(&stream);
-                    return result;
-                }
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
 
-                out.write(reinterpret_cast<const char *>(outbuf.data()), have);
-                if(!out)
-                {
-                    result = err::write_buffer_error;
-                    inflateEnd(&stream);
-                    return result;
-                }
+        return compress(out, in, compr_lvl, mem_level);
+    }
 
-            } while(stream.avail_out == 0);
-        }
-        if(ret != Z_STREAM_END)
-            result = static_cast<err>(ret);
+    static err decompress_file(const std::string &dst_file_path,
+                               const std::string &src_file_path,
+                               const size_t       max_output_sz = 0)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
 
-        inflateEnd(&stream);
-        return result;
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return decompress(out, in, max_output_sz);
+    }
+
+    // Parallel (pigz style) compression for large files and streams: the
+    // input is cut into block_size pieces that are deflated on a thread
+    // pool while the calling thread reads ahead and writes finished blocks
+    // in order, at most depth blocks are in memory.
+    //
+    // default: one gzip member, every block is a raw deflate run primed
+    //          with the last 32KB of the input before it and ended by a
+    //          sync flush, the trailer crc is crc32_combine of the block
+    //          crcs. Ratio is close to compress(), any gunzip reads it.
+    // indexed: every block is an independent gzip member whose header
+    //          carries an extra field "HJ" (len 4) with the member size
+    //          in bytes (u32 le). Slightly larger, still plain gzip for
+    //          gunzip, and decompress_parallel() inflates the members on
+    //          the pool.
+    //
+    // On error the output written so far must be discarded.
+    using parallel_options = gzip_parallel_options;
+
+    static err compress_parallel(
+        std::ostream         &out,
+        std::istream         &in,
+        const compression_lvl compr_lvl = compression_lvl::default_compression,
+        const mem_lvl         mem_level = mem_lvl::default_level,
+        const parallel_options &opts    = parallel_options())
+    {
+        if(!in || !out)
+            return err::input_invalid;
+
+        _istream_src src{in};
+        _ostream_dst dst{out};
+        return _deflate_parallel(src, dst, compr_lvl, mem_level, opts);
+    }
+
+    static err compress_parallel(
+        std::vector<unsigned char> &dst,
+        const void                 *src,
+        const size_t                src_sz,
+        const compression_lvl compr_lvl = compression_lvl::default_compression,
+        const mem_lvl         mem_level = mem_lvl::default_level,
+        const parallel_options &opts    = parallel_options())
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        dst.clear();
+        dst.reserve(compress_reserve_sz(src_sz));
+        _memory_src in{static_cast<const unsigned char *>(src), src_sz};
+        _vector_dst out{dst};
+        err ret = _deflate_parallel(in, out, compr_lvl, mem_level, opts);
+        if(ret != err::ok)
+            dst.clear();
+        return ret;
+    }
+
+    // indexed members are inflated on the pool and checked against their
+    // crc; from the first member without the index on (any gzip input),
+    // the rest is inflated on the calling thread like decompress()
+    static err
+    decompress_parallel(std::ostream           &out,
+                        std::istream           &in,
+                        const size_t            max_output_sz = 0,
+                        const parallel_options &opts = parallel_options())
+    {
+        if(!in || !out)
+            return err::input_invalid;
+
+        _istream_src src{in};
+        _ostream_dst dst{out};
+        return _inflate_parallel(src, dst, max_output_sz, opts);
+    }
+
+    static err
+    decompress_parallel(std::vector<unsigned char> &dst,
+                        const void                 *src,
+                        const size_t                src_sz,
+                        const size_t                max_output_sz = 0,
+                        const parallel_options     &opts = parallel_options())
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        dst.clear();
+        _memory_src in{static_cast<const unsigned char *>(src), src_sz};
+        _vector_dst out{dst};
+        err ret = _inflate_parallel(in, out, max_output_sz, opts);
+        if(ret != err::ok)
+            dst.clear();
+        return ret;
+    }
+
+    static err compress_file_parallel(
+        const std::string    &dst_file_path,
+        const std::string    &src_file_path,
+        const compression_lvl compr_lvl = compression_lvl::default_compression,
+        const mem_lvl         mem_level = mem_lvl::default_level,
+        const parallel_options &opts    = parallel_options())
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return compress_parallel(out, in, compr_lvl, mem_level, opts);
+    }
+
+    static err
+    decompress_file_parallel(const std::string      &dst_file_path,
+                             const std::string      &src_file_path,
+                             const size_t            max_output_sz = 0,
+                             const parallel_options &opts = parallel_options())
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return decompress_parallel(out, in, max_output_sz, opts);
     }
 
     static unsigned long crc32_checksum(const void *data, const size_t size)
@@ -396,6 +531,538 @@ class gzip
         const unsigned char *bytes = static_cast<const unsigned char *>(data);
         return (bytes[0] == 0x1f && bytes[1] == 0x8b);
     }
+
+  private:
+    static constexpr size_t DICT_SZ       = 32768; // deflate window
+    static constexpr size_t HEAD_SZ       = 10;
+    static constexpr size_t INDEX_HEAD_SZ = HEAD_SZ + 2 + 8; // xlen + "HJ"
+    static constexpr size_t TRAILER_SZ    = 8;
+    static constexpr size_t MAX_BLOCK_SZ  = size_t(1) << 30;
+    static constexpr size_t READ_CHUNK_SZ = size_t(1) << 20;
+
+    struct _istream_src
+    {
+        std::istream &in;
+
+        bool read(unsigned char *buf, const size_t n, size_t &got)
+        {
+            in.read(reinterpret_cast<char *>(buf),
+                    static_cast<std::streamsize>(n));
+            got = static_cast<size_t>(in.gcount());
+            return !in.bad();
+        }
+
+        bool at_end() { return in.peek() == std::char_traits<char>::eof(); }
+    };
+
+    struct _memory_src
+    {
+        const unsigned char *data;
+        size_t               left;
+
+        bool read(unsigned char *buf, const size_t n, size_t &got)
+        {
+            got = (std::min) (n, left);
+            if(got > 0)
+                std::memcpy(buf, data, got);
+            data += got;
+            left -= got;
+            return true;
+        }
+
+        bool at_end() const { return left == 0; }
+    };
+
+    struct _ostream_dst
+    {
+        std::ostream &out;
+
+        bool write(const unsigned char *buf, const size_t n)
+        {
+            out.write(reinterpret_cast<const char *>(buf),
+                      static_cast<std::streamsize>(n));
+            return !out.fail();
+        }
+    };
+
+    struct _vector_dst
+    {
+        std::vector<unsigned char> &v;
+
+        bool write(const unsigned char *buf, const size_t n)
+        {
+            v.insert(v.end(), buf, buf + n);
+            return true;
+        }
+    };
+
+    // one block of compress_parallel/decompress_parallel
+    struct _block
+    {
+        std::vector<unsigned char> in;
+        std::vector<unsigned char> dict;
+        std::vector<unsigned char> out;
+        uLong                      crc   = 0;
+        bool                       final = false;
+    };
+
+    static inline void _put_le32(unsigned char *p, const uint32_t v)
+    {
+        for(int i = 0; i < 4; ++i)
+            p[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+
+    static inline uint32_t _get_le32(const unsigned char *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16)
+               | (uint32_t(p[3]) << 24);
+    }
+
+    // mtime 0, os unknown; indexed headers add FEXTRA with "HJ" and the
+    // member size
+    static inline void _put_header(unsigned char *p, const bool indexed)
+    {
+        static const unsigned char head[INDEX_HEAD_SZ] =
+            {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff, 8, 0, 'H', 'J', 4, 0};
+        std::memcpy(p, head, indexed ? INDEX_HEAD_SZ : HEAD_SZ);
+        if(indexed)
+            p[3] = 0x04;
+    }
+
+    static inline bool _is_indexed_header(const unsigned char *p)
+    {
+        return p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && p[3] == 0x04
+               && p[10] == 8 && p[11] == 0 && p[12] == 'H' && p[13] == 'J'
+               && p[14] == 4 && p[15] == 0;
+    }
+
+    static thread_pool *_pool_of(const parallel_options       &opts,
+                                 std::unique_ptr<thread_pool> &own_pool)
+    {
+        if(opts.pool != nullptr)
+            return opts.pool;
+
+        size_t n = opts.threads > 0 ? opts.threads
+                                    : std::thread::hardware_concurrency();
+        own_pool.reset(new thread_pool(n > 0 ? n : 1));
+        return own_pool.get();
+    }
+
+    static err _deflate_block(_block    &b,
+                              const int  lvl,
+                              const int  mem_level,
+                              const bool indexed)
+    {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        int ret = deflateInit2(&stream,
+                               lvl,
+                               Z_DEFLATED,
+                               -MAX_WBITS, // raw deflate
+                               mem_level,
+                               static_cast<int>(strategy::default_strategy));
+        if(ret != Z_OK)
+            return static_cast<err>(ret);
+
+        if(!b.dict.empty())
+            deflateSetDictionary(&stream,
+                                 b.dict.data(),
+                                 static_cast<uInt>(b.dict.size()));
+
+        // a sync flush appends an empty stored block
+        const size_t head = indexed ? INDEX_HEAD_SZ : 0;
+        const size_t bound =
+            deflateBound(&stream, static_cast<uLong>(b.in.size())) + 16;
+        b.out.resize(head + bound + (indexed ? TRAILER_SZ : 0));
+
+        unsigned char dummy = 0;
+        stream.next_in      = b.in.empty() ? &dummy : b.in.data();
+        stream.avail_in     = static_cast<uInt>(b.in.size());
+        stream.next_out     = b.out.data() + head;
+        stream.avail_out    = static_cast<uInt>(bound);
+        const bool finish   = indexed || b.final;
+        ret = deflate(&stream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        const bool done = finish ? ret == Z_STREAM_END
+                                 : ret == Z_OK && stream.avail_out > 0;
+        const size_t body = static_cast<size_t>(stream.total_out);
+        deflateEnd(&stream);
+        if(!done || stream.avail_in != 0)
+            return err::buffer_too_small;
+
+        b.crc = crc32(0L, b.in.data(), static_cast<uInt>(b.in.size()));
+        if(!indexed)
+        {
+            b.out.resize(body);
+            return err::ok;
+        }
+
+        const size_t member = head + body + TRAILER_SZ;
+        _put_header(b.out.data(), true);
+        _put_le32(b.out.data() + 16, static_cast<uint32_t>(member));
+        _put_le32(b.out.data() + head + body, static_cast<uint32_t>(b.crc));
+        _put_le32(b.out.data() + head + body + 4,
+                  static_cast<uint32_t>(b.in.size()));
+        b.out.resize(member);
+        return err::ok;
+    }
+
+    // b.in is one indexed member, its trailer gives the output size;
+    // budget is what is left of max_output_sz for this block
+    static err _inflate_block(_block &b, const size_t budget)
+    {
+        const unsigned char *p    = b.in.data();
+        const size_t         n    = b.in.size();
+        const size_t         body = n - INDEX_HEAD_SZ - TRAILER_SZ;
+        const uint32_t       crc  = _get_le32(p + n - 8);
+        const uint32_t       size = _get_le32(p + n - 4);
+
+        // deflate never expands more than ~1032:1
+        if(size > body * 1032 + 1032)
+            return err::data_error;
+        if(size > budget)
+            return err::max_output_sz_exceeded;
+
+        b.out.resize(size);
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        int ret = inflateInit2(&stream, -MAX_WBITS);
+        if(ret != Z_OK)
+            return static_cast<err>(ret);
+
+        unsigned char dummy = 0;
+        stream.next_in      = const_cast<Bytef *>(p + INDEX_HEAD_SZ);
+        stream.avail_in     = static_cast<uInt>(body);
+        stream.next_out     = size > 0 ? b.out.data() : &dummy;
+        stream.avail_out    = static_cast<uInt>(size);
+        ret                 = inflate(&stream, Z_FINISH);
+        const bool done     = ret == Z_STREAM_END && stream.avail_in == 0
+                          && stream.total_out == size;
+        inflateEnd(&stream);
+        if(ret == Z_MEM_ERROR)
+            return err::mem_error;
+        if(!done || crc32(0L, b.out.data(), size) != crc)
+            return err::data_error;
+
+        return err::ok;
+    }
+
+    // waits for the oldest block and writes it, blocks finish in any order
+    // but leave in input order
+    template <typename Dst, typename OnBlock>
+    static void _write_front(std::deque<std::shared_ptr<_block>> &blocks,
+                             std::deque<std::future<err>>        &pending,
+                             Dst                                 &dst,
+                             err                                 &ec,
+                             OnBlock                            &&on_block)
+    {
+        err r = pending.front().get();
+        if(ec == err::ok && r != err::ok)
+            ec = r;
+        if(ec == err::ok)
+            ec = on_block(*blocks.front());
+        if(ec == err::ok)
+        {
+            const _block &b = *blocks.front();
+            if(!b.out.empty() && !dst.write(b.out.data(), b.out.size()))
+                ec = err::write_buffer_error;
+        }
+        pending.pop_front();
+        blocks.pop_front();
+    }
+
+    template <typename Src, typename Dst>
+    static err _deflate_parallel(Src                    &src,
+                                 Dst                    &dst,
+                                 const compression_lvl   compr_lvl,
+                                 const mem_lvl           mem_level,
+                                 const parallel_options &opts)
+    {
+        if(opts.block_size == 0 || opts.block_size > MAX_BLOCK_SZ)
+            return err::input_invalid;
+
+        std::unique_ptr<thread_pool> own_pool;
+        thread_pool                 *pool  = _pool_of(opts, own_pool);
+        const size_t                 depth =
+            opts.depth > 0 ? opts.depth : 2 * pool->size();
+        const int  lvl     = static_cast<int>(compr_lvl);
+        const int  mem     = static_cast<int>(mem_level);
+        const bool indexed = opts.indexed;
+
+        unsigned char head[HEAD_SZ];
+        _put_header(head, false);
+        if(!indexed && !dst.write(head, HEAD_SZ))
+            return err::write_buffer_error;
+
+        std::deque<std::shared_ptr<_block>> blocks;
+        std::deque<std::future<err>>        pending;
+        err                                 ec    = err::ok;
+        uLong                               crc   = crc32(0L, Z_NULL, 0);
+        uint32_t                            isize = 0;
+        auto on_block = [&](const _block &b) {
+            crc = crc32_combine(crc, b.crc, static_cast<z_off_t>(b.in.size()));
+            isize += static_cast<uint32_t>(b.in.size());
+            return err::ok;
+        };
+
+        // the last 32KB of input, dictionary of the next block
+        std::vector<unsigned char> tail;
+        for(bool final = false; !final && ec == err::ok;)
+        {
+            auto   b   = std::make_shared<_block>();
+            size_t got = 0;
+            b->in.resize(opts.block_size);
+            if(!src.read(b->in.data(), opts.block_size, got))
+            {
+                ec = err::read_buffer_error;
+                break;
+            }
+
+            // empty input still ends the stream with one empty block
+            b->in.resize(got);
+            b->final = final = got < opts.block_size || src.at_end();
+            if(!indexed)
+            {
+                b->dict = tail;
+                size_t keep = (std::min) (got, DICT_SZ);
+                tail.insert(tail.end(), b->in.end() - keep, b->in.end());
+                if(tail.size() > DICT_SZ)
+                    tail.erase(tail.begin(), tail.end() - DICT_SZ);
+            }
+
+            while(pending.size() >= depth && ec == err::ok)
+                _write_front(blocks, pending, dst, ec, on_block);
+            if(ec != err::ok)
+                break;
+
+            auto fut = pool->enqueue([b, lvl, mem, indexed]() {
+                return _deflate_block(*b, lvl, mem, indexed);
+            });
+            if(!fut.valid())
+            {
+                ec = err::stream_error;
+                break;
+            }
+
+            pending.push_back(std::move(fut));
+            blocks.push_back(b);
+        }
+
+        while(!pending.empty())
+            _write_front(blocks, pending, dst, ec, on_block);
+        if(ec != err::ok || indexed)
+            return ec;
+
+        unsigned char trailer[TRAILER_SZ];
+        _put_le32(trailer, static_cast<uint32_t>(crc));
+        _put_le32(trailer + 4, isize);
+        return dst.write(trailer, TRAILER_SZ) ? err::ok
+                                              : err::write_buffer_error;
+    }
+
+    template <typename Src, typename Dst>
+    static err _inflate_parallel(Src                    &src,
+                                 Dst                    &dst,
+                                 const size_t            max_output_sz,
+                                 const parallel_options &opts)
+    {
+        std::unique_ptr<thread_pool> own_pool;
+        thread_pool                 *pool  = _pool_of(opts, own_pool);
+        const size_t                 depth =
+            opts.depth > 0 ? opts.depth : 2 * pool->size();
+
+        std::deque<std::shared_ptr<_block>> blocks;
+        std::deque<std::future<err>>        pending;
+        err                                 ec        = err::ok;
+        size_t                              total_out = 0;
+        size_t                              claimed   = 0;
+        auto on_block = [&](const _block &b) {
+            total_out += b.out.size();
+            return (max_output_sz > 0 && total_out > max_output_sz)
+                       ? err::max_output_sz_exceeded
+                       : err::ok;
+        };
+
+        for(size_t index = 0; ec == err::ok; ++index)
+        {
+            unsigned char head[INDEX_HEAD_SZ];
+            size_t        got = 0;
+            if(!src.read(head, INDEX_HEAD_SZ, got))
+            {
+                ec = err::read_buffer_error;
+                break;
+            }
+            if(got == 0 && index > 0)
+                break;
+
+            // not written by compress_parallel: the rest is sequential
+            if(got < INDEX_HEAD_SZ || !_is_indexed_header(head))
+            {
+                while(!pending.empty())
+                    _write_front(blocks, pending, dst, ec, on_block);
+                if(ec == err::ok)
+                    ec = _inflate_seq(src,
+                                      dst,
+                                      head,
+                                      got,
+                                      max_output_sz,
+                                      16384,
+                                      total_out,
+                                      index > 0);
+                break;
+            }
+
+            const size_t member = _get_le32(head + 16);
+            if(member < INDEX_HEAD_SZ + 2 + TRAILER_SZ)
+            {
+                ec = err::data_error;
+                break;
+            }
+
+            // the member size is untrusted, only grow as the bytes arrive
+            auto b = std::make_shared<_block>();
+            b->in.assign(head, head + INDEX_HEAD_SZ);
+            while(ec == err::ok && b->in.size() < member)
+            {
+                const size_t off  = b->in.size();
+                const size_t want = (std::min) (member - off, READ_CHUNK_SZ);
+                b->in.resize(off + want);
+                if(!src.read(b->in.data() + off, want, got))
+                    ec = err::read_buffer_error;
+                else if(got != want)
+                    ec = err::data_error;
+            }
+            if(ec != err::ok)
+                break;
+
+            // the trailer size is checked against what is left before the
+            // block allocates its output
+            size_t budget = (std::numeric_limits<size_t>::max)();
+            if(max_output_sz > 0)
+                budget = claimed < max_output_sz ? max_output_sz - claimed : 0;
+            claimed += _get_le32(b->in.data() + member - 4);
+
+            while(pending.size() >= depth && ec == err::ok)
+                _write_front(blocks, pending, dst, ec, on_block);
+            if(ec != err::ok)
+                break;
+
+            auto fut = pool->enqueue(
+                [b, budget]() { return _inflate_block(*b, budget); });
+            if(!fut.valid())
+            {
+                ec = err::stream_error;
+                break;
+            }
+
+            pending.push_back(std::move(fut));
+            blocks.push_back(b);
+
+            // this block fails on its budget, no point reading further
+            if(max_output_sz > 0 && claimed > max_output_sz)
+                break;
+        }
+
+        while(!pending.empty())
+            _write_front(blocks, pending, dst, ec, on_block);
+        return ec;
+    }
+
+    // head: bytes already taken from src; between: src starts after a
+    // member, so bytes that do not start another one are ignored
+    template <typename Src, typename Dst>
+    static err _inflate_seq(Src                 &src,
+                            Dst                 &dst,
+                            const unsigned char *head,
+                            const size_t         head_len,
+                            const size_t         max_output_sz,
+                            const size_t         chunk_size,
+                            size_t              &total_out,
+                            bool                 between)
+    {
+        if(chunk_size == 0)
+            return err::input_invalid;
+
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        int ret = inflateInit2(&stream, GZIP_WINDOW_BITS);
+        if(ret != Z_OK)
+            return static_cast<err>(ret);
+
+        std::vector<unsigned char> inbuf((std::max) (chunk_size, head_len));
+        std::vector<unsigned char> outbuf(chunk_size);
+        size_t                     avail = head_len;
+        if(head_len > 0)
+            std::memcpy(inbuf.data(), head, head_len);
+
+        err  result = err::ok;
+        bool done   = false;
+        while(!done && result == err::ok)
+        {
+            if(avail == 0 && !src.read(inbuf.data(), chunk_size, avail))
+            {
+                result = err::read_buffer_error;
+                break;
+            }
+            if(avail == 0)
+                break;
+
+            stream.next_in  = inbuf.data();
+            stream.avail_in = static_cast<uInt>(avail);
+            avail           = 0;
+            for(;;)
+            {
+                if(between)
+                {
+                    if(stream.next_in[0] != 0x1f)
+                    {
+                        done = true;
+                        break;
+                    }
+                    inflateReset(&stream);
+                    between = false;
+                }
+
+                stream.avail_out = static_cast<uInt>(chunk_size);
+                stream.next_out  = outbuf.data();
+                ret              = inflate(&stream, Z_NO_FLUSH);
+                if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR
+                   || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+                {
+                    result = static_cast<err>(ret);
+                    break;
+                }
+
+                size_t have = chunk_size - stream.avail_out;
+                total_out += have;
+                if(max_output_sz > 0 && total_out > max_output_sz)
+                {
+                    result = err::max_output_sz_exceeded;
+                    break;
+                }
+                if(have > 0 && !dst.write(outbuf.data(), have))
+                {
+                    result = err::write_buffer_error;
+                    break;
+                }
+
+                if(ret == Z_STREAM_END)
+                {
+                    between = true;
+                    if(stream.avail_in == 0)
+                        break;
+                } else if(stream.avail_out != 0)
+                {
+                    break;
+                }
+            }
+        }
+        inflateEnd(&stream);
+
+        // truncated member
+        if(result == err::ok && !between && !done)
+            result = err::data_error;
+        return result;
+    }
 };
 
 } // namespace hj
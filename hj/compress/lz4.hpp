@@ -0,0 +1,420 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LZ4_HPP
+#define LZ4_HPP
+
+#include <lz4frame.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+namespace hj
+{
+
+// LZ4 frame format (what the lz4 cli reads and writes), one-shot, stream and
+// file variants like hj::gzip. Much faster than gzip at a lower ratio.
+//
+// Every thread keeps one compression and one decompression context and
+// reuses them, so small messages do not pay for context setup.
+class lz4
+{
+  public:
+    enum class err : int
+    {
+        ok = 0,
+        stream_error,
+        data_error,
+        mem_error,
+
+        input_invalid,
+        buffer_too_small,
+        max_output_sz_exceeded,
+        read_buffer_error,
+        write_buffer_error
+    };
+
+    // negative levels trade ratio for speed, above 2 is lz4hc
+    enum class compression_lvl : int
+    {
+        default_compression = 0,
+        best_speed          = -8,
+        high_compression    = 9,
+        best_compression    = 12
+    };
+
+    static size_t compress_reserve_sz(const size_t src_sz)
+    {
+        LZ4F_preferences_t prefs = _prefs(compression_lvl::default_compression,
+                                          src_sz);
+        return LZ4F_compressFrameBound(src_sz, &prefs);
+    }
+
+    static size_t decompress_reserve_sz(const size_t src_sz,
+                                        const size_t max_output_sz)
+    {
+        const size_t MIN_ALLOC      = 4096;              // 4KB
+        const size_t MAX_SAFE_ALLOC = 1024 * 1024 * 256; // 256MB
+        if(max_output_sz > 0)
+            return (std::min) (max_output_sz, MAX_SAFE_ALLOC);
+
+        if(src_sz == 0)
+            return MIN_ALLOC;
+
+        size_t estimated =
+            (src_sz <= MAX_SAFE_ALLOC / 4) ? src_sz * 4 : MAX_SAFE_ALLOC;
+
+        return (std::max) (MIN_ALLOC, (std::min) (estimated, MAX_SAFE_ALLOC));
+    }
+
+    static err compress(
+        std::vector<unsigned char> &dst,
+        const void                 *src,
+        const size_t                src_sz,
+        const compression_lvl compr_lvl = compression_lvl::default_compression)
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        LZ4F_cctx *cctx = _cctx();
+        if(!cctx)
+            return err::mem_error;
+
+        LZ4F_preferences_t prefs = _prefs(compr_lvl, src_sz);
+        dst.resize(LZ4F_compressFrameBound(src_sz, &prefs));
+
+        size_t cap = dst.size();
+        size_t n   = LZ4F_compressBegin(cctx, dst.data(), cap, &prefs);
+        if(LZ4F_isError(n))
+            return _fail(dst, err::stream_error);
+
+        size_t ret = LZ4F_compressUpdate(
+            cctx, dst.data() + n, cap - n, src, src_sz, nullptr);
+        if(LZ4F_isError(ret))
+            return _fail(dst, err::stream_error);
+
+        n += ret;
+        ret = LZ4F_compressEnd(cctx, dst.data() + n, cap - n, nullptr);
+        if(LZ4F_isError(ret))
+            return _fail(dst, err::stream_error);
+
+        dst.resize(n + ret);
+        return err::ok;
+    }
+
+    static err compress(
+        std::ostream         &out,
+        std::istream         &in,
+        const compression_lvl compr_lvl  = compression_lvl::default_compression,
+        const size_t          chunk_size = 65536)
+    {
+        if(!in || !out || chunk_size == 0)
+            return err::input_invalid;
+
+        LZ4F_cctx *cctx = _cctx();
+        if(!cctx)
+            return err::mem_error;
+
+        LZ4F_preferences_t prefs = _prefs(compr_lvl, 0);
+        std::vector<unsigned char> inbuf(chunk_size);
+        std::vector<unsigned char> outbuf(
+            (std::max) (LZ4F_compressBound(chunk_size, &prefs),
+                        size_t(LZ4F_HEADER_SIZE_MAX)));
+
+        size_t n =
+            LZ4F_compressBegin(cctx, outbuf.data(), outbuf.size(), &prefs);
+        if(LZ4F_isError(n))
+            return err::stream_error;
+        if(!_write(out, outbuf.data(), n))
+            return err::write_buffer_error;
+
+        while(in)
+        {
+            in.read(reinterpret_cast<char *>(inbuf.data()), chunk_size);
+            std::streamsize read_sz = in.gcount();
+            if(read_sz <= 0)
+                break;
+
+            n = LZ4F_compressUpdate(cctx,
+                                    outbuf.data(),
+                                    outbuf.size(),
+                                    inbuf.data(),
+                                    static_cast<size_t>(read_sz),
+                                    nullptr);
+            if(LZ4F_isError(n))
+                return err::stream_error;
+            if(!_write(out, outbuf.data(), n))
+                return err::write_buffer_error;
+        }
+
+        n = LZ4F_compressEnd(cctx, outbuf.data(), outbuf.size(), nullptr);
+        if(LZ4F_isError(n))
+            return err::stream_error;
+        if(!_write(out, outbuf.data(), n))
+            return err::write_buffer_error;
+
+        return err::ok;
+    }
+
+    // concatenated frames are decompressed one after another
+    static err decompress(std::vector<unsigned char> &dst,
+                          const void                 *src,
+                          const size_t                src_sz,
+                          const size_t                max_output_sz = 0)
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        LZ4F_dctx *dctx = _dctx();
+        if(!dctx)
+            return err::mem_error;
+
+        LZ4F_resetDecompressionContext(dctx);
+        const unsigned char *in     = static_cast<const unsigned char *>(src);
+        size_t               in_pos = src_sz;
+        LZ4F_frameInfo_t     info;
+        std::memset(&info, 0, sizeof(info));
+        size_t hint = LZ4F_getFrameInfo(dctx, &info, in, &in_pos);
+        if(LZ4F_isError(hint))
+            return _fail(dst, err::data_error);
+
+        // the exact size when the frame carries it and src_sz can hold it,
+        // a header claiming more than lz4's ratio allows is not trusted;
+        // else start from the src_sz estimate, max_output_sz bounds growth
+        size_t reserve = decompress_reserve_sz(src_sz, 0);
+        if(max_output_sz > 0)
+            reserve = (std::min) (reserve, max_output_sz);
+        if(info.contentSize > 0)
+        {
+            if(max_output_sz > 0 && info.contentSize > max_output_sz)
+                return _fail(dst, err::max_output_sz_exceeded);
+
+            if(info.contentSize / MAX_RATIO <= src_sz)
+                reserve = static_cast<size_t>(info.contentSize);
+        }
+        dst.resize(reserve);
+
+        size_t out_pos = 0;
+        while(hint != 0 || in_pos < src_sz)
+        {
+            if(out_pos == dst.size())
+            {
+                if(max_output_sz > 0 && dst.size() >= max_output_sz)
+                    return _fail(dst, err::max_output_sz_exceeded);
+
+                size_t grow = (std::max) (dst.size() * 2, size_t(4096));
+                if(max_output_sz > 0)
+                    grow = (std::min) (grow, max_output_sz);
+                dst.resize(grow);
+            }
+
+            size_t out_sz = dst.size() - out_pos;
+            size_t in_sz  = src_sz - in_pos;
+            hint          = LZ4F_decompress(dctx,
+                                   dst.data() + out_pos,
+                                   &out_sz,
+                                   in + in_pos,
+                                   &in_sz,
+                                   nullptr);
+            if(LZ4F_isError(hint))
+                return _fail(dst, err::data_error);
+
+            in_pos += in_sz;
+            out_pos += out_sz;
+
+            // truncated frame
+            if(hint != 0 && in_pos == src_sz && out_pos < dst.size())
+                return _fail(dst, err::data_error);
+        }
+
+        dst.resize(out_pos);
+        return err::ok;
+    }
+
+    static err decompress(std::ostream &out,
+                          std::istream &in,
+                          const size_t  max_output_sz = 0,
+                          const size_t  chunk_size    = 65536)
+    {
+        if(!in || !out || chunk_size == 0)
+            return err::input_invalid;
+
+        LZ4F_dctx *dctx = _dctx();
+        if(!dctx)
+            return err::mem_error;
+
+        LZ4F_resetDecompressionContext(dctx);
+        std::vector<unsigned char> inbuf(chunk_size), outbuf(chunk_size);
+        size_t                     total_out = 0;
+        size_t                     hint      = 1;
+        bool                       any       = false;
+        while(in)
+        {
+            in.read(reinterpret_cast<char *>(inbuf.data()), chunk_size);
+            std::streamsize read_sz = in.gcount();
+            if(read_sz <= 0)
+                break;
+
+            any           = true;
+            size_t in_pos = 0;
+            size_t in_len = static_cast<size_t>(read_sz);
+            size_t out_sz = 0;
+            do
+            {
+                out_sz       = outbuf.size();
+                size_t in_sz = in_len - in_pos;
+                hint          = LZ4F_decompress(dctx,
+                                       outbuf.data(),
+                                       &out_sz,
+                                       inbuf.data() + in_pos,
+                                       &in_sz,
+                                       nullptr);
+                if(LZ4F_isError(hint))
+                    return err::data_error;
+
+                in_pos += in_sz;
+                total_out += out_sz;
+                if(max_output_sz > 0 && total_out > max_output_sz)
+                    return err::max_output_sz_exceeded;
+                if(!_write(out, outbuf.data(), out_sz))
+                    return err::write_buffer_error;
+
+                // the context may still hold output for this input
+            } while(in_pos < in_len || out_sz == outbuf.size());
+        }
+
+        return (any && hint == 0) ? err::ok : err::data_error;
+    }
+
+    static err compress_file(
+        const std::string    &dst_file_path,
+        const std::string    &src_file_path,
+        const compression_lvl compr_lvl = compression_lvl::default_compression)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return compress(out, in, compr_lvl);
+    }
+
+    static err decompress_file(const std::string &dst_file_path,
+                               const std::string &src_file_path,
+                               const size_t       max_output_sz = 0)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return decompress(out, in, max_output_sz);
+    }
+
+    static double compression_ratio(const size_t original_sz,
+                                    const size_t compressed_sz)
+    {
+        if(original_sz == 0)
+            return 0.0;
+
+        return 1.0
+               - (static_cast<double>(compressed_sz)
+                  / static_cast<double>(original_sz));
+    }
+
+    static bool is_lz4_format(const void *data, size_t size)
+    {
+        if(!data || size < 7)
+            return false;
+
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        return bytes[0] == 0x04 && bytes[1] == 0x22 && bytes[2] == 0x4d
+               && bytes[3] == 0x18;
+    }
+
+  private:
+    // a match length byte adds at most 255 output bytes, nothing in an lz4
+    // frame expands further
+    static constexpr unsigned long long MAX_RATIO = 255;
+
+    static LZ4F_preferences_t _prefs(const compression_lvl compr_lvl,
+                                     const size_t          content_sz)
+    {
+        LZ4F_preferences_t prefs;
+        std::memset(&prefs, 0, sizeof(prefs));
+        prefs.compressionLevel              = static_cast<int>(compr_lvl);
+        prefs.frameInfo.contentSize         = content_sz;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        prefs.frameInfo.blockMode           = LZ4F_blockLinked;
+        prefs.frameInfo.blockSizeID         = LZ4F_max64KB;
+        prefs.autoFlush                     = 1;
+        return prefs;
+    }
+
+    static LZ4F_cctx *_cctx()
+    {
+        struct holder
+        {
+            holder() { LZ4F_createCompressionContext(&ctx, LZ4F_VERSION); }
+            ~holder() { LZ4F_freeCompressionContext(ctx); }
+            LZ4F_cctx *ctx = nullptr;
+        };
+        thread_local holder h;
+        return h.ctx;
+    }
+
+    static LZ4F_dctx *_dctx()
+    {
+        struct holder
+        {
+            holder() { LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION); }
+            ~holder() { LZ4F_freeDecompressionContext(ctx); }
+            LZ4F_dctx *ctx = nullptr;
+        };
+        thread_local holder h;
+        return h.ctx;
+    }
+
+    static inline err _fail(std::vector<unsigned char> &dst, const err e)
+    {
+        dst.clear();
+        return e;
+    }
+
+    static inline bool
+    _write(std::ostream &out, const unsigned char *data, const size_t len)
+    {
+        if(len > 0)
+            out.write(reinterpret_cast<const char *>(data),
+                      static_cast<std::streamsize>(len));
+        return static_cast<bool>(out);
+    }
+};
+
+} // namespace hj
+
+#endif // LZ4_HPP
@@ -0,0 +1,683 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZSTD_HPP
+#define ZSTD_HPP
+
+#include <zstd.h>
+#include <zstd_errors.h>
+#include <zdict.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+
+namespace hj
+{
+
+// Zstandard frames (what the zstd cli reads and writes), one-shot, stream
+// and file variants like hj::gzip. Better ratio than gzip at several times
+// the speed; frames carry the content size and a checksum.
+//
+// Every thread keeps one ZSTD_CCtx and one ZSTD_DCtx and only resets them
+// between calls, so small messages do not pay for context setup. For
+// messages of a few hundred bytes, also use a zstd::dictionary.
+class zstd
+{
+  public:
+    enum class err : int
+    {
+        ok = 0,
+        stream_error,
+        data_error,
+        mem_error,
+
+        input_invalid,
+        buffer_too_small,
+        max_output_sz_exceeded,
+        read_buffer_error,
+        write_buffer_error,
+        dictionary_wrong
+    };
+
+    // any level in [ZSTD_minCLevel(), ZSTD_maxCLevel()] can be cast in,
+    // negative ones are faster than best_speed
+    enum class compression_lvl : int
+    {
+        default_compression = ZSTD_CLEVEL_DEFAULT,
+        best_speed          = 1,
+        best_compression    = 19
+    };
+
+    // Dictionary for small messages: a frame of a few hundred bytes has
+    // too little history of its own, a dictionary trained on samples of
+    // the traffic supplies it. The digested CDict and DDict are built once
+    // and only read afterwards, so one dictionary (and its copies, which
+    // share them) serves every thread.
+    //
+    // Frames compressed with it carry id() in their header; the receiver
+    // reads it back with frame_dict_id() to pick the matching dictionary.
+    class dictionary
+    {
+      public:
+        dictionary() = default;
+
+        // samples: messages like the ones to compress, ideally ~100 x
+        // capacity bytes in total. id 0 lets zstd pick a random one,
+        // otherwise use one above 32767 (lower ones are reserved).
+        static err
+        train(dictionary                     &dst,
+              const std::vector<std::string> &samples,
+              const size_t                    capacity = 16 * 1024,
+              const unsigned                  id       = 0,
+              const compression_lvl compr_lvl =
+                  compression_lvl::default_compression)
+        {
+            std::string         flat;
+            std::vector<size_t> sizes;
+            sizes.reserve(samples.size());
+            for(const auto &sample : samples)
+            {
+                flat += sample;
+                sizes.push_back(sample.size());
+            }
+            return train(dst,
+                         flat.data(),
+                         sizes.data(),
+                         sizes.size(),
+                         capacity,
+                         id,
+                         compr_lvl);
+        }
+
+        // samples: n messages back to back, sample_sizes[i] bytes each
+        static err
+        train(dictionary    &dst,
+              const void    *samples,
+              const size_t  *sample_sizes,
+              const size_t   n,
+              const size_t   capacity = 16 * 1024,
+              const unsigned id       = 0,
+              const compression_lvl compr_lvl =
+                  compression_lvl::default_compression)
+        {
+            if(!samples || !sample_sizes || n == 0 || n > UINT_MAX
+               || capacity < 256)
+                return err::input_invalid;
+
+            std::vector<unsigned char> buf(capacity);
+            size_t sz = ZDICT_trainFromBuffer(buf.data(),
+                                              capacity,
+                                              samples,
+                                              sample_sizes,
+                                              static_cast<unsigned>(n));
+
+            // too few or too small samples
+            if(ZDICT_isError(sz))
+                return err::input_invalid;
+
+            buf.resize(sz);
+            if(id != 0)
+            {
+                // rebuild the header around the trained content with the id
+                size_t hdr = ZDICT_getDictHeaderSize(buf.data(), sz);
+                if(ZDICT_isError(hdr))
+                    return err::data_error;
+
+                ZDICT_params_t params;
+                std::memset(&params, 0, sizeof(params));
+                params.compressionLevel = static_cast<int>(compr_lvl);
+                params.dictID           = id;
+
+                std::vector<unsigned char> out(capacity);
+                sz = ZDICT_finalizeDictionary(out.data(),
+                                              capacity,
+                                              buf.data() + hdr,
+                                              sz - hdr,
+                                              samples,
+                                              sample_sizes,
+                                              static_cast<unsigned>(n),
+                                              params);
+                if(ZDICT_isError(sz))
+                    return err::input_invalid;
+
+                out.resize(sz);
+                buf.swap(out);
+            }
+            return dst.load(buf.data(), buf.size(), compr_lvl);
+        }
+
+        // a dictionary from train(), data() or `zstd --train`; bytes
+        // without the dictionary header are used as raw content, id 0
+        err load(
+            const void           *data,
+            const size_t          sz,
+            const compression_lvl compr_lvl =
+                compression_lvl::default_compression)
+        {
+            if(!data || sz == 0)
+                return err::input_invalid;
+
+            auto st = std::make_shared<_state>();
+            st->bytes.assign(static_cast<const unsigned char *>(data),
+                             static_cast<const unsigned char *>(data) + sz);
+            st->id    = ZDICT_getDictID(data, sz);
+            st->lvl   = compr_lvl;
+            st->cdict = ZSTD_createCDict(data, sz, static_cast<int>(compr_lvl));
+            st->ddict = ZSTD_createDDict(data, sz);
+            if(!st->cdict || !st->ddict)
+                return err::data_error;
+
+            _st = std::move(st);
+            return err::ok;
+        }
+
+        err load_file(
+            const std::string    &file_path,
+            const compression_lvl compr_lvl =
+                compression_lvl::default_compression)
+        {
+            std::ifstream in(file_path, std::ios::binary);
+            if(!in)
+                return err::read_buffer_error;
+
+            std::vector<unsigned char> buf(
+                (std::istreambuf_iterator<char>(in)),
+                std::istreambuf_iterator<char>());
+            if(in.bad())
+                return err::read_buffer_error;
+
+            return load(buf.data(), buf.size(), compr_lvl);
+        }
+
+        err save_file(const std::string &file_path) const
+        {
+            if(empty())
+                return err::input_invalid;
+
+            std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+            if(!out || !_write(out, data(), size()))
+                return err::write_buffer_error;
+
+            return err::ok;
+        }
+
+        inline bool     empty() const noexcept { return !_st; }
+        inline unsigned id() const noexcept { return _st ? _st->id : 0; }
+        inline size_t   size() const noexcept
+        {
+            return _st ? _st->bytes.size() : 0;
+        }
+        inline const unsigned char *data() const noexcept
+        {
+            return _st ? _st->bytes.data() : nullptr;
+        }
+        inline compression_lvl level() const noexcept
+        {
+            return _st ? _st->lvl : compression_lvl::default_compression;
+        }
+        inline const ZSTD_CDict *cdict() const noexcept
+        {
+            return _st ? _st->cdict : nullptr;
+        }
+        inline const ZSTD_DDict *ddict() const noexcept
+        {
+            return _st ? _st->ddict : nullptr;
+        }
+
+      private:
+        struct _state
+        {
+            ~_state()
+            {
+                ZSTD_freeCDict(cdict);
+                ZSTD_freeDDict(ddict);
+            }
+
+            std::vector<unsigned char> bytes;
+            unsigned                   id = 0;
+            compression_lvl            lvl =
+                compression_lvl::default_compression;
+            ZSTD_CDict *cdict = nullptr;
+            ZSTD_DDict *ddict = nullptr;
+        };
+
+        std::shared_ptr<const _state> _st;
+    };
+
+    static size_t compress_reserve_sz(const size_t src_sz)
+    {
+        return ZSTD_compressBound(src_sz);
+    }
+
+    static size_t decompress_reserve_sz(const size_t src_sz,
+                                        const size_t max_output_sz)
+    {
+        const size_t MIN_ALLOC      = 4096;              // 4KB
+        const size_t MAX_SAFE_ALLOC = 1024 * 1024 * 256; // 256MB
+        if(max_output_sz > 0)
+            return (std::min) (max_output_sz, MAX_SAFE_ALLOC);
+
+        if(src_sz == 0)
+            return MIN_ALLOC;
+
+        size_t estimated =
+            (src_sz <= MAX_SAFE_ALLOC / 4) ? src_sz * 4 : MAX_SAFE_ALLOC;
+
+        return (std::max) (MIN_ALLOC, (std::min) (estimated, MAX_SAFE_ALLOC));
+    }
+
+    static err compress(
+        std::vector<unsigned char> &dst,
+        const void                 *src,
+        const size_t                src_sz,
+        const compression_lvl compr_lvl = compression_lvl::default_compression)
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        ZSTD_CCtx *cctx = _cctx(compr_lvl);
+        if(!cctx)
+            return err::mem_error;
+
+        return _compress(cctx, dst, src, src_sz);
+    }
+
+    // the level is the one dict was loaded with
+    static err compress(std::vector<unsigned char> &dst,
+                        const void                 *src,
+                        const size_t                src_sz,
+                        const dictionary           &dict)
+    {
+        if(!src || src_sz == 0 || dict.empty())
+            return err::input_invalid;
+
+        ZSTD_CCtx *cctx = _cctx(dict.level());
+        if(!cctx)
+            return err::mem_error;
+        if(ZSTD_isError(ZSTD_CCtx_refCDict(cctx, dict.cdict())))
+            return err::stream_error;
+
+        return _compress(cctx, dst, src, src_sz);
+    }
+
+    static err compress(
+        std::ostream         &out,
+        std::istream         &in,
+        const compression_lvl compr_lvl  = compression_lvl::default_compression,
+        const size_t          chunk_size = ZSTD_CStreamInSize())
+    {
+        if(!in || !out || chunk_size == 0)
+            return err::input_invalid;
+
+        ZSTD_CCtx *cctx = _cctx(compr_lvl);
+        if(!cctx)
+            return err::mem_error;
+
+        std::vector<unsigned char> inbuf(chunk_size);
+        std::vector<unsigned char> outbuf(ZSTD_CStreamOutSize());
+        bool                       last = false;
+        while(!last)
+        {
+            in.read(reinterpret_cast<char *>(inbuf.data()), chunk_size);
+            std::streamsize read_sz = in.gcount();
+            if(in.bad())
+                return err::read_buffer_error;
+
+            last                     = !in;
+            ZSTD_EndDirective mode   = last ? ZSTD_e_end : ZSTD_e_continue;
+            ZSTD_inBuffer     input  = {inbuf.data(),
+                                        static_cast<size_t>(read_sz),
+                                        0};
+            size_t            remain = 0;
+            do
+            {
+                ZSTD_outBuffer output = {outbuf.data(), outbuf.size(), 0};
+                remain = ZSTD_compressStream2(cctx, &output, &input, mode);
+                if(ZSTD_isError(remain))
+                    return _to_err(remain);
+                if(!_write(out, outbuf.data(), output.pos))
+                    return err::write_buffer_error;
+            } while(last ? remain != 0 : input.pos < input.size);
+        }
+
+        return err::ok;
+    }
+
+    // concatenated frames are decompressed one after another
+    static err decompress(std::vector<unsigned char> &dst,
+                          const void                 *src,
+                          const size_t                src_sz,
+                          const size_t                max_output_sz = 0)
+    {
+        if(!src || src_sz == 0)
+            return err::input_invalid;
+
+        ZSTD_DCtx *dctx = _dctx();
+        if(!dctx)
+            return err::mem_error;
+
+        return _decompress(dctx, dst, src, src_sz, max_output_sz);
+    }
+
+    // dictionary_wrong when the frame names another dictionary
+    static err decompress(std::vector<unsigned char> &dst,
+                          const void                 *src,
+                          const size_t                src_sz,
+                          const dictionary           &dict,
+                          const size_t                max_output_sz = 0)
+    {
+        if(!src || src_sz == 0 || dict.empty())
+            return err::input_invalid;
+
+        unsigned id = frame_dict_id(src, src_sz);
+        if(id != 0 && id != dict.id())
+            return _fail(dst, err::dictionary_wrong);
+
+        ZSTD_DCtx *dctx = _dctx();
+        if(!dctx)
+            return err::mem_error;
+        if(ZSTD_isError(ZSTD_DCtx_refDDict(dctx, dict.ddict())))
+            return err::stream_error;
+
+        return _decompress(dctx, dst, src, src_sz, max_output_sz);
+    }
+
+    static err decompress(std::ostream &out,
+                          std::istream &in,
+                          const size_t  max_output_sz = 0,
+                          const size_t  chunk_size    = ZSTD_DStreamInSize())
+    {
+        if(!in || !out || chunk_size == 0)
+            return err::input_invalid;
+
+        ZSTD_DCtx *dctx = _dctx();
+        if(!dctx)
+            return err::mem_error;
+
+        std::vector<unsigned char> inbuf(chunk_size);
+        std::vector<unsigned char> outbuf(ZSTD_DStreamOutSize());
+        size_t                     total_out = 0;
+        size_t                     hint      = 1;
+        bool                       any       = false;
+        while(in)
+        {
+            in.read(reinterpret_cast<char *>(inbuf.data()), chunk_size);
+            std::streamsize read_sz = in.gcount();
+            if(read_sz <= 0)
+                break;
+
+            any                 = true;
+            ZSTD_inBuffer input = {inbuf.data(),
+                                   static_cast<size_t>(read_sz),
+                                   0};
+            ZSTD_outBuffer output;
+            do
+            {
+                output = {outbuf.data(), outbuf.size(), 0};
+                hint   = ZSTD_decompressStream(dctx, &output, &input);
+                if(ZSTD_isError(hint))
+                    return _to_err(hint);
+
+                total_out += output.pos;
+                if(max_output_sz > 0 && total_out > max_output_sz)
+                    return err::max_output_sz_exceeded;
+                if(!_write(out, outbuf.data(), output.pos))
+                    return err::write_buffer_error;
+
+                // a full output may leave data inside the context
+            } while(input.pos < input.size || output.pos == output.size);
+        }
+
+        return (any && hint == 0) ? err::ok : err::data_error;
+    }
+
+    static err compress_file(
+        const std::string    &dst_file_path,
+        const std::string    &src_file_path,
+        const compression_lvl compr_lvl = compression_lvl::default_compression)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return compress(out, in, compr_lvl);
+    }
+
+    static err decompress_file(const std::string &dst_file_path,
+                               const std::string &src_file_path,
+                               const size_t       max_output_sz = 0)
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        if(!in)
+            return err::read_buffer_error;
+
+        std::ofstream out(dst_file_path, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return err::write_buffer_error;
+
+        return decompress(out, in, max_output_sz);
+    }
+
+    static double compression_ratio(const size_t original_sz,
+                                    const size_t compressed_sz)
+    {
+        if(original_sz == 0)
+            return 0.0;
+
+        return 1.0
+               - (static_cast<double>(compressed_sz)
+                  / static_cast<double>(original_sz));
+    }
+
+    // id of the dictionary a frame was compressed with, 0 for none
+    static unsigned frame_dict_id(const void *src, const size_t src_sz)
+    {
+        if(!src || src_sz == 0)
+            return 0;
+
+        return ZSTD_getDictID_fromFrame(src, src_sz);
+    }
+
+    static bool is_zstd_format(const void *data, size_t size)
+    {
+        if(!data || size < 4)
+            return false;
+
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        return bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f
+               && bytes[3] == 0xfd;
+    }
+
+  private:
+    // largest declared ratio decoded in one shot; zstd goes beyond it only
+    // on degenerate input, which still decodes through the growing path
+    static constexpr unsigned long long MAX_TRUSTED_RATIO = 1024;
+
+    // the thread's context, reset to a fresh session at compr_lvl
+    static ZSTD_CCtx *_cctx(const compression_lvl compr_lvl)
+    {
+        struct holder
+        {
+            ~holder() { ZSTD_freeCCtx(ctx); }
+            ZSTD_CCtx *ctx = ZSTD_createCCtx();
+        };
+        thread_local holder h;
+        if(!h.ctx)
+            return nullptr;
+
+        ZSTD_CCtx_reset(h.ctx, ZSTD_reset_session_and_parameters);
+        if(ZSTD_isError(ZSTD_CCtx_setParameter(h.ctx,
+                                               ZSTD_c_compressionLevel,
+                                               static_cast<int>(compr_lvl)))
+           || ZSTD_isError(
+               ZSTD_CCtx_setParameter(h.ctx, ZSTD_c_checksumFlag, 1)))
+            return nullptr;
+
+        return h.ctx;
+    }
+
+    static ZSTD_DCtx *_dctx()
+    {
+        struct holder
+        {
+            ~holder() { ZSTD_freeDCtx(ctx); }
+            ZSTD_DCtx *ctx = ZSTD_createDCtx();
+        };
+        thread_local holder h;
+        if(!h.ctx)
+            return nullptr;
+
+        // parameters too, that drops a dictionary of the last call
+        ZSTD_DCtx_reset(h.ctx, ZSTD_reset_session_and_parameters);
+        return h.ctx;
+    }
+
+    static err _compress(ZSTD_CCtx                  *cctx,
+                         std::vector<unsigned char> &dst,
+                         const void                 *src,
+                         const size_t                src_sz)
+    {
+        dst.resize(ZSTD_compressBound(src_sz));
+        size_t n = ZSTD_compress2(cctx, dst.data(), dst.size(), src, src_sz);
+        if(ZSTD_isError(n))
+            return _fail(dst, _to_err(n));
+
+        dst.resize(n);
+        return err::ok;
+    }
+
+    static err _decompress(ZSTD_DCtx                  *dctx,
+                           std::vector<unsigned char> &dst,
+                           const void                 *src,
+                           const size_t                src_sz,
+                           const size_t                max_output_sz)
+    {
+        // single frame with a known size: decode straight into place
+        unsigned long long content = ZSTD_getFrameContentSize(src, src_sz);
+        if(content == ZSTD_CONTENTSIZE_ERROR)
+            return _fail(dst, err::data_error);
+        if(content != ZSTD_CONTENTSIZE_UNKNOWN
+           && ZSTD_findFrameCompressedSize(src, src_sz) == src_sz)
+        {
+            if(max_output_sz > 0 && content > max_output_sz)
+                return _fail(dst, err::max_output_sz_exceeded);
+
+            // the header is not checked against the data, a size no real
+            // frame of src_sz reaches goes the growing way below instead
+            if(content / MAX_TRUSTED_RATIO <= src_sz)
+            {
+                dst.resize(static_cast<size_t>(content));
+                size_t n = ZSTD_decompressDCtx(
+                    dctx, dst.data(), dst.size(), src, src_sz);
+                if(ZSTD_isError(n))
+                    return _fail(dst, _to_err(n));
+
+                dst.resize(n);
+                return err::ok;
+            }
+        }
+
+        // start from the src_sz estimate, max_output_sz only bounds growth
+        size_t reserve = decompress_reserve_sz(src_sz, 0);
+        if(max_output_sz > 0)
+            reserve = (std::min) (reserve, max_output_sz);
+        dst.resize(reserve);
+        ZSTD_inBuffer input   = {src, src_sz, 0};
+        size_t        out_pos = 0;
+        size_t        hint    = 1;
+        while(input.pos < input.size || hint != 0)
+        {
+            if(out_pos == dst.size())
+            {
+                if(max_output_sz > 0 && dst.size() >= max_output_sz)
+                    return _fail(dst, err::max_output_sz_exceeded);
+
+                size_t grow = dst.size() * 2;
+                if(max_output_sz > 0)
+                    grow = (std::min) (grow, max_output_sz);
+                dst.resize(grow);
+            }
+
+            ZSTD_outBuffer output = {dst.data(), dst.size(), out_pos};
+            hint = ZSTD_decompressStream(dctx, &output, &input);
+            if(ZSTD_isError(hint))
+                return _fail(dst, _to_err(hint));
+
+            // truncated frame
+            if(hint != 0 && input.pos == input.size && output.pos < dst.size())
+                return _fail(dst, err::data_error);
+
+            out_pos = output.pos;
+        }
+
+        dst.resize(out_pos);
+        return err::ok;
+    }
+
+    static err _to_err(const size_t code)
+    {
+        switch(ZSTD_getErrorCode(code))
+        {
+            case ZSTD_error_no_error:
+                return err::ok;
+            case ZSTD_error_memory_allocation:
+                return err::mem_error;
+            case ZSTD_error_dstSize_tooSmall:
+                return err::buffer_too_small;
+            case ZSTD_error_dictionary_wrong:
+                return err::dictionary_wrong;
+            case ZSTD_error_srcSize_wrong:
+            case ZSTD_error_corruption_detected:
+            case ZSTD_error_checksum_wrong:
+            case ZSTD_error_prefix_unknown:
+            case ZSTD_error_frameParameter_unsupported:
+            case ZSTD_error_frameParameter_windowTooLarge:
+            case ZSTD_error_dictionary_corrupted:
+                return err::data_error;
+            default:
+                return err::stream_error;
+        }
+    }
+
+    static inline err _fail(std::vector<unsigned char> &dst, const err e)
+    {
+        dst.clear();
+        return e;
+    }
+
+    static inline bool
+    _write(std::ostream &out, const unsigned char *data, const size_t len)
+    {
+        if(len > 0)
+            out.write(reinterpret_cast<const char *>(data),
+                      static_cast<std::streamsize>(len));
+        return static_cast<bool>(out);
+    }
+};
+
+} // namespace hj
+
+#endif // ZSTD_HPP
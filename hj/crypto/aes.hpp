@@ -34,11 +34,18 @@
 #include <vector>
 #include <algorithm>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
 
 #include <openssl/aes.h>
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 
+#include <hj/sync/thread_pool.hpp>
+
 #ifndef AES_BUF_SIZE
 #define AES_BUF_SIZE 16384 // 16KB
 #endif
@@ -46,6 +53,15 @@
 namespace hj
 {
 
+// options of aes::encrypt_parallel / aes::decrypt_parallel
+struct aes_parallel_options
+{
+    std::size_t  chunk_size = 1 << 20; // multiple of 16
+    std::size_t  threads    = 0;       // 0 = hardware_concurrency
+    std::size_t  depth      = 0;       // chunks in flight, 0 = 2 x pool
+    thread_pool *pool       = nullptr; // shared pool instead of own
+};
+
 class aes
 {
   public:
@@ -77,6 +93,9 @@ class aes
         decrypt_init_failed,
         decrypt_update_failed,
         decrypt_final_failed,
+
+        session_invalid,
+        format_invalid,
     };
 
   public:
@@ -167,7 +186,7 @@ class aes
             }
         }
 
-        if(EVP_EncryptInit_ex(ctx, cipher, NULL, key, iv) != 1)
+        if(EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv) != 1)
         {
             EVP_CIPHER_CTX_free(ctx);
             return error_code::encrypt_init_failed;
@@ -262,7 +281,7 @@ class aes
             }
         }
 
-        if(EVP_EncryptInit_ex(ctx, cipher, NULL, key, iv) != 1)
+        if(EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv) != 1)
         {
             EVP_CIPHER_CTX_free(ctx);
             return error_code::encrypt_init_failed;
@@ -585,7 +604,7 @@ class aes
             }
         }
 
-        if(1 != EVP_DecryptInit_ex(ctx, cipher, NULL, key, iv))
+        if(1 != EVP_DecryptInit_ex(ctx, NULL, NULL, key, iv))
         {
             EVP_CIPHER_CTX_free(ctx);
             return error_code::decrypt_init_failed;
@@ -943,7 +962,831 @@ class aes
         }
     }
 
+  public:
+    // one message of a batch, dst_len and ec are written back
+    struct batch_item
+    {
+        unsigned char       *dst     = nullptr;
+        std::size_t          dst_len = 0;
+        const unsigned char *src     = nullptr;
+        std::size_t          src_len = 0;
+        const unsigned char *iv      = nullptr;
+        std::size_t          iv_len  = 0;
+        const unsigned char *aad     = nullptr;
+        std::size_t          aad_len = 0;
+        error_code           ec      = error_code::ok;
+    };
+
+    // Keeps the cipher contexts (and so the expanded key) of one key, every
+    // message only resets the iv/nonce; the static api pays a context
+    // allocation, cipher lookup and key schedule per call. Output is the
+    // same as the static api (AEAD: cipher text + 16 bytes tag), aad is
+    // only accepted by gcm/ccm.
+    //
+    // Not thread safe, use one session per thread.
+    class session
+    {
+      public:
+        session() = default;
+        session(const unsigned char *key,
+                const std::size_t    key_len,
+                const mode           mod       = mode::gcm,
+                const padding        pad_style = padding::pkcs7)
+        {
+            init(key, key_len, mod, pad_style);
+        }
+        ~session() { _release(); }
+
+        session(const session &)            = delete;
+        session &operator=(const session &) = delete;
+        session(session &&other) noexcept { _swap(other); }
+        session &operator=(session &&other) noexcept
+        {
+            if(this != &other)
+            {
+                _release();
+                _swap(other);
+            }
+            return *this;
+        }
+
+        inline bool is_valid() const noexcept { return _enc != nullptr; }
+        inline mode get_mode() const noexcept { return _mod; }
+
+        error_code init(const unsigned char *key,
+                        const std::size_t    key_len,
+                        const mode           mod       = mode::gcm,
+                        const padding        pad_style = padding::pkcs7)
+        {
+            _release();
+            if(!is_key_valid(mod, key, key_len))
+                return error_code::key_invalid;
+
+            const EVP_CIPHER *cipher = _select_cipher(mod, key_len);
+            if(!cipher)
+                return error_code::encrypt_init_failed;
+
+            _enc = EVP_CIPHER_CTX_new();
+            _dec = EVP_CIPHER_CTX_new();
+            if(!_enc || !_dec)
+            {
+                _release();
+                return error_code::ctx_alloc_failed;
+            }
+
+            _mod = mod;
+            if(mod == mode::ccm)
+                _ccm_key.assign(key, key + key_len);
+            if(!_init_key(_enc, cipher, key, 1))
+            {
+                _release();
+                return error_code::encrypt_init_failed;
+            }
+            if(!_init_key(_dec, cipher, key, 0))
+            {
+                _release();
+                return error_code::decrypt_init_failed;
+            }
+
+            if(!is_aead_mode(mod))
+            {
+                EVP_CIPHER_CTX_set_padding(_enc, 0);
+                EVP_CIPHER_CTX_set_padding(_dec, 0);
+            }
+
+            _pad_style  = pad_style;
+            _key_len    = key_len;
+            _block_size = _get_block_size(mod, key_len);
+            _enc_iv_len = EVP_CIPHER_CTX_iv_length(_enc);
+            _dec_iv_len = _enc_iv_len;
+            return error_code::ok;
+        }
+
+        error_code encrypt(unsigned char       *dst,
+                           std::size_t         &dst_len,
+                           const unsigned char *src,
+                           const std::size_t    src_len,
+                           const unsigned char *iv      = nullptr,
+                           const std::size_t    iv_len  = 16,
+                           const unsigned char *aad     = nullptr,
+                           const std::size_t    aad_len = 0)
+        {
+            if(!is_valid())
+                return error_code::session_invalid;
+            if(!is_plain_valid(_mod, _key_len, _pad_style, src_len))
+                return error_code::plain_invalid;
+            if(!is_iv_valid(_mod, iv, iv_len))
+                return error_code::iv_invalid;
+
+            error_code ec =
+                _begin(_enc, _enc_iv_len, iv, iv_len, nullptr, src_len);
+            if(ec != error_code::ok)
+                return ec;
+            if(!_update_aad(_enc, aad, aad_len))
+                return error_code::param_invalid;
+
+            // only the tail is padded, on the stack
+            std::size_t   body     = src_len;
+            std::size_t   tail_len = 0;
+            unsigned char tail[32] = {0};
+            if(_pad_style != padding::no_padding && _block_size > 1)
+            {
+                std::size_t rem = src_len % _block_size;
+                body            = src_len - rem;
+                tail_len        = rem + (_block_size - rem);
+                memcpy(tail, src + body, rem);
+                _fill_padding(tail,
+                              rem,
+                              tail_len,
+                              static_cast<unsigned char>(_block_size - rem),
+                              _pad_style);
+            }
+
+            int outlen1 = 0, outlen2 = 0, outlen3 = 0;
+            if(body > 0
+               && EVP_EncryptUpdate(_enc,
+                                    dst,
+                                    &outlen1,
+                                    src,
+                                    static_cast<int>(body))
+                      != 1)
+                return error_code::encrypt_update_failed;
+            if(tail_len > 0
+               && EVP_EncryptUpdate(_enc,
+                                    dst + outlen1,
+                                    &outlen2,
+                                    tail,
+                                    static_cast<int>(tail_len))
+                      != 1)
+                return error_code::encrypt_update_failed;
+            if(EVP_EncryptFinal_ex(_enc, dst + outlen1 + outlen2, &outlen3)
+               != 1)
+                return error_code::encrypt_final_failed;
+
+            dst_len = outlen1 + outlen2 + outlen3;
+            if(is_aead_mode(_mod))
+            {
+                if(EVP_CIPHER_CTX_ctrl(_enc,
+                                       EVP_CTRL_AEAD_GET_TAG,
+                                       16,
+                                       dst + dst_len)
+                   != 1)
+                    return error_code::get_tag_failed;
+
+                dst_len += 16;
+            }
+            return error_code::ok;
+        }
+
+        error_code decrypt(unsigned char       *dst,
+                           std::size_t         &dst_len,
+                           const unsigned char *src,
+                           const std::size_t    src_len,
+                           const unsigned char *iv      = nullptr,
+                           const std::size_t    iv_len  = 16,
+                           const unsigned char *aad     = nullptr,
+                           const std::size_t    aad_len = 0)
+        {
+            if(!is_valid())
+                return error_code::session_invalid;
+            if(!is_iv_valid(_mod, iv, iv_len))
+                return error_code::iv_invalid;
+            if(_pad_style == padding::no_padding && _block_size > 1
+               && src_len % _block_size != 0)
+                return error_code::padding_style_invalid;
+
+            std::size_t          cipher_len = src_len;
+            const unsigned char *tag        = nullptr;
+            if(is_aead_mode(_mod))
+            {
+                if(src_len < 16)
+                    return error_code::param_invalid;
+
+                cipher_len = src_len - 16;
+                tag        = src + cipher_len;
+            }
+
+            error_code ec =
+                _begin(_dec, _dec_iv_len, iv, iv_len, tag, cipher_len);
+            if(ec != error_code::ok)
+                return ec;
+            if(!_update_aad(_dec, aad, aad_len))
+                return error_code::param_invalid;
+
+            int outlen1 = 0, outlen2 = 0;
+            if(cipher_len > 0
+               && EVP_DecryptUpdate(_dec,
+                                    dst,
+                                    &outlen1,
+                                    src,
+                                    static_cast<int>(cipher_len))
+                      != 1)
+                return error_code::decrypt_update_failed;
+
+            // ccm verified the tag in update and has nothing to finish
+            if(_mod != mode::ccm
+               && EVP_DecryptFinal_ex(_dec, dst + outlen1, &outlen2) != 1)
+                return error_code::decrypt_final_failed;
+
+            dst_len = outlen1 + outlen2;
+            _unpadding_block(dst, dst_len, _mod, _pad_style, _block_size);
+            return error_code::ok;
+        }
+
+        error_code encrypt(std::string       &dst,
+                           const std::string &src,
+                           const std::string &iv  = std::string(),
+                           const std::string &aad = std::string())
+        {
+            if(!is_valid())
+                return error_code::session_invalid;
+
+            std::size_t dst_len =
+                encrypt_len_reserve(src.size(), _mod, _key_len);
+            dst.resize(dst_len);
+            auto ec = encrypt(reinterpret_cast<unsigned char *>(&dst[0]),
+                              dst_len,
+                              _bytes(src),
+                              src.size(),
+                              iv.empty() ? nullptr : _bytes(iv),
+                              iv.size(),
+                              _bytes(aad),
+                              aad.size());
+            dst.resize(ec == error_code::ok ? dst_len : 0);
+            return ec;
+        }
+
+        error_code decrypt(std::string       &dst,
+                           const std::string &src,
+                           const std::string &iv  = std::string(),
+                           const std::string &aad = std::string())
+        {
+            std::size_t dst_len = decrypt_len_reserve(src.size());
+            dst.resize(dst_len);
+            auto ec = decrypt(reinterpret_cast<unsigned char *>(&dst[0]),
+                              dst_len,
+                              _bytes(src),
+                              src.size(),
+                              iv.empty() ? nullptr : _bytes(iv),
+                              iv.size(),
+                              _bytes(aad),
+                              aad.size());
+            dst.resize(ec == error_code::ok ? dst_len : 0);
+            return ec;
+        }
+
+        // ok when every item succeeded, else the first failure; each
+        // item keeps its own ec and the rest of the batch still runs
+        error_code encrypt_batch(batch_item *items, const std::size_t n)
+        {
+            error_code first = error_code::ok;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                batch_item &it = items[i];
+                it.ec          = encrypt(it.dst,
+                                         it.dst_len,
+                                         it.src,
+                                         it.src_len,
+                                         it.iv,
+                                         it.iv_len,
+                                         it.aad,
+                                         it.aad_len);
+                if(first == error_code::ok)
+                    first = it.ec;
+            }
+            return first;
+        }
+
+        error_code decrypt_batch(batch_item *items, const std::size_t n)
+        {
+            error_code first = error_code::ok;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                batch_item &it = items[i];
+                it.ec          = decrypt(it.dst,
+                                         it.dst_len,
+                                         it.src,
+                                         it.src_len,
+                                         it.iv,
+                                         it.iv_len,
+                                         it.aad,
+                                         it.aad_len);
+                if(first == error_code::ok)
+                    first = it.ec;
+            }
+            return first;
+        }
+
+      private:
+        static inline const unsigned char *_bytes(const std::string &s)
+        {
+            return reinterpret_cast<const unsigned char *>(s.data());
+        }
+
+        // resets the context to a new iv, the key schedule is kept
+        error_code _begin(EVP_CIPHER_CTX      *ctx,
+                          int                 &cur_iv_len,
+                          const unsigned char *iv,
+                          const std::size_t    iv_len,
+                          const unsigned char *tag,
+                          const std::size_t    data_len)
+        {
+            bool enc = (ctx == _enc);
+            if(is_aead_mode(_mod) && static_cast<int>(iv_len) != cur_iv_len)
+            {
+                if(EVP_CIPHER_CTX_ctrl(ctx,
+                                       EVP_CTRL_AEAD_SET_IVLEN,
+                                       static_cast<int>(iv_len),
+                                       NULL)
+                   != 1)
+                    return error_code::cipher_ctl_failed;
+
+                // ccm derives its length field from the nonce at key setup
+                if(_mod == mode::ccm
+                   && !_init_key(ctx, NULL, _ccm_key.data(), enc ? 1 : 0))
+                    return enc ? error_code::encrypt_init_failed
+                               : error_code::decrypt_init_failed;
+
+                cur_iv_len = static_cast<int>(iv_len);
+            }
+
+            // ccm takes the expected tag before the nonce
+            if(_mod == mode::ccm && !enc
+               && EVP_CIPHER_CTX_ctrl(ctx,
+                                      EVP_CTRL_AEAD_SET_TAG,
+                                      16,
+                                      const_cast<unsigned char *>(tag))
+                      != 1)
+                return error_code::cipher_ctl_failed;
+
+            if(EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, -1) != 1)
+                return enc ? error_code::encrypt_init_failed
+                           : error_code::decrypt_init_failed;
+
+            int len = 0;
+            if(_mod == mode::ccm
+               && EVP_CipherUpdate(ctx,
+                                   NULL,
+                                   &len,
+                                   NULL,
+                                   static_cast<int>(data_len))
+                      != 1)
+                return enc ? error_code::encrypt_update_failed
+                           : error_code::decrypt_update_failed;
+
+            if(_mod == mode::gcm && !enc
+               && EVP_CIPHER_CTX_ctrl(ctx,
+                                      EVP_CTRL_AEAD_SET_TAG,
+                                      16,
+                                      const_cast<unsigned char *>(tag))
+                      != 1)
+                return error_code::cipher_ctl_failed;
+            return error_code::ok;
+        }
+
+        // ccm fixes its tag length at key setup, so it goes first
+        bool _init_key(EVP_CIPHER_CTX      *ctx,
+                       const EVP_CIPHER    *cipher,
+                       const unsigned char *key,
+                       const int            enc)
+        {
+            if(_mod != mode::ccm)
+                return EVP_CipherInit_ex(ctx, cipher, NULL, key, NULL, enc)
+                       == 1;
+
+            return EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, enc) == 1
+                   && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16, NULL)
+                          == 1
+                   && EVP_CipherInit_ex(ctx, NULL, NULL, key, NULL, enc) == 1;
+        }
+
+        bool _update_aad(EVP_CIPHER_CTX      *ctx,
+                         const unsigned char *aad,
+                         const std::size_t    aad_len)
+        {
+            if(aad_len == 0)
+                return true;
+            if(aad == nullptr || !is_aead_mode(_mod))
+                return false;
+
+            int len = 0;
+            return EVP_CipherUpdate(ctx,
+                                    NULL,
+                                    &len,
+                                    aad,
+                                    static_cast<int>(aad_len))
+                   == 1;
+        }
+
+        void _release() noexcept
+        {
+            if(_enc)
+                EVP_CIPHER_CTX_free(_enc);
+            if(_dec)
+                EVP_CIPHER_CTX_free(_dec);
+            _enc = nullptr;
+            _dec = nullptr;
+            if(!_ccm_key.empty())
+                OPENSSL_cleanse(_ccm_key.data(), _ccm_key.size());
+            _ccm_key.clear();
+        }
+
+        void _swap(session &other) noexcept
+        {
+            std::swap(_enc, other._enc);
+            std::swap(_dec, other._dec);
+            std::swap(_mod, other._mod);
+            std::swap(_pad_style, other._pad_style);
+            std::swap(_key_len, other._key_len);
+            std::swap(_block_size, other._block_size);
+            std::swap(_enc_iv_len, other._enc_iv_len);
+            std::swap(_dec_iv_len, other._dec_iv_len);
+            _ccm_key.swap(other._ccm_key);
+        }
+
+      private:
+        EVP_CIPHER_CTX *_enc        = nullptr;
+        EVP_CIPHER_CTX *_dec        = nullptr;
+        mode            _mod        = mode::gcm;
+        padding         _pad_style  = padding::pkcs7;
+        std::size_t     _key_len    = 0;
+        int             _block_size = 1;
+        int             _enc_iv_len = 0;
+        int             _dec_iv_len = 0;
+
+        std::vector<unsigned char> _ccm_key;
+    };
+
+    // n messages under one key with a single key setup
+    static error_code encrypt_batch(batch_item          *items,
+                                    const std::size_t    n,
+                                    const unsigned char *key,
+                                    const std::size_t    key_len,
+                                    const mode           mod = mode::gcm,
+                                    const padding pad_style  = padding::pkcs7)
+    {
+        session sess;
+        auto    ec = sess.init(key, key_len, mod, pad_style);
+        if(ec != error_code::ok)
+            return ec;
+
+        return sess.encrypt_batch(items, n);
+    }
+
+    static error_code decrypt_batch(batch_item          *items,
+                                    const std::size_t    n,
+                                    const unsigned char *key,
+                                    const std::size_t    key_len,
+                                    const mode           mod = mode::gcm,
+                                    const padding pad_style  = padding::pkcs7)
+    {
+        session sess;
+        auto    ec = sess.init(key, key_len, mod, pad_style);
+        if(ec != error_code::ok)
+            return ec;
+
+        return sess.decrypt_batch(items, n);
+    }
+
+  public:
+    // Parallel chunked ctr/gcm for large files and streams: the input is
+    // cut into chunk_size pieces that are encrypted on a thread pool while
+    // the calling thread reads ahead and writes finished chunks in order,
+    // at most depth chunks are in memory.
+    //
+    // ctr: plain ctr stream, chunk i starts at counter iv + i * chunk_size
+    //      / 16, so the output equals one sequential ctr pass over the
+    //      whole input (no padding, any length).
+    // gcm: framed format, not the one shot gcm layout:
+    //        "HJGC" | version 1 | 3 reserved | chunk_size (u32 be)
+    //        per chunk: cipher text | 16 bytes tag
+    //      chunk i uses the 12 bytes iv with i (u64 be) xored into its
+    //      last 8 bytes and authenticates header | i (u64 be) | final
+    //      flag, so reordered, dropped or truncated chunks fail to
+    //      decrypt. chunk_size is read back from the header.
+    //
+    // On error the output written so far must be discarded.
+    using parallel_options = aes_parallel_options;
+
+    static error_code
+    encrypt_parallel(std::ostream           &out,
+                     std::istream           &in,
+                     const unsigned char    *key,
+                     const std::size_t       key_len,
+                     const mode              mod,
+                     const unsigned char    *iv,
+                     const std::size_t       iv_len,
+                     const parallel_options &opts = parallel_options())
+    {
+        return _crypt_parallel(out, in, key, key_len, mod, iv, iv_len, opts, 1);
+    }
+
+    static error_code
+    decrypt_parallel(std::ostream           &out,
+                     std::istream           &in,
+                     const unsigned char    *key,
+                     const std::size_t       key_len,
+                     const mode              mod,
+                     const unsigned char    *iv,
+                     const std::size_t       iv_len,
+                     const parallel_options &opts = parallel_options())
+    {
+        return _crypt_parallel(out, in, key, key_len, mod, iv, iv_len, opts, 0);
+    }
+
+    static error_code
+    encrypt_file_parallel(const char             *dst_file_path,
+                          const char             *src_file_path,
+                          const unsigned char    *key,
+                          const std::size_t       key_len,
+                          const mode              mod,
+                          const unsigned char    *iv,
+                          const std::size_t       iv_len,
+                          const parallel_options &opts = parallel_options())
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        std::ofstream out(dst_file_path, std::ios::binary);
+        if(!in.is_open() || !out.is_open())
+            return error_code::file_open_failed;
+
+        return encrypt_parallel(out, in, key, key_len, mod, iv, iv_len, opts);
+    }
+
+    static error_code
+    decrypt_file_parallel(const char             *dst_file_path,
+                          const char             *src_file_path,
+                          const unsigned char    *key,
+                          const std::size_t       key_len,
+                          const mode              mod,
+                          const unsigned char    *iv,
+                          const std::size_t       iv_len,
+                          const parallel_options &opts = parallel_options())
+    {
+        std::ifstream in(src_file_path, std::ios::binary);
+        std::ofstream out(dst_file_path, std::ios::binary);
+        if(!in.is_open() || !out.is_open())
+            return error_code::file_open_failed;
+
+        return decrypt_parallel(out, in, key, key_len, mod, iv, iv_len, opts);
+    }
+
   private:
+    // one chunk of encrypt_parallel/decrypt_parallel
+    struct _chunk
+    {
+        std::vector<unsigned char> in;
+        std::size_t                in_len = 0;
+        std::vector<unsigned char> out;
+        std::size_t                out_len = 0;
+        uint64_t                   index   = 0;
+        bool                       final   = false;
+    };
+
+    static error_code _crypt_parallel(std::ostream           &out,
+                                      std::istream           &in,
+                                      const unsigned char    *key,
+                                      const std::size_t       key_len,
+                                      const mode              mod,
+                                      const unsigned char    *iv,
+                                      const std::size_t       iv_len,
+                                      const parallel_options &opts,
+                                      const int               enc)
+    {
+        if(!in)
+            return error_code::input_stream_invalid;
+        if(!out)
+            return error_code::output_stream_invalid;
+        if(mod != mode::ctr && mod != mode::gcm)
+            return error_code::param_invalid;
+        if(!is_key_valid(mod, key, key_len))
+            return error_code::key_invalid;
+        if(iv == nullptr || iv_len != (mod == mode::ctr ? 16u : 12u))
+            return error_code::iv_invalid;
+
+        std::size_t   chunk_size = opts.chunk_size;
+        unsigned char header[12] = {'H', 'J', 'G', 'C', 1, 0, 0, 0};
+        if(mod == mode::gcm && !enc)
+        {
+            in.read(reinterpret_cast<char *>(header), sizeof(header));
+            if(in.gcount() != static_cast<std::streamsize>(sizeof(header))
+               || memcmp(header, "HJGC\x01", 5) != 0)
+                return error_code::format_invalid;
+
+            chunk_size = (std::size_t(header[8]) << 24)
+                         | (std::size_t(header[9]) << 16)
+                         | (std::size_t(header[10]) << 8) | header[11];
+        }
+        if(chunk_size == 0 || chunk_size % 16 != 0 || chunk_size > (1u << 30))
+            return error_code::param_invalid;
+
+        if(mod == mode::gcm && enc)
+        {
+            for(int i = 0; i < 4; ++i)
+                header[8 + i] =
+                    static_cast<unsigned char>(chunk_size >> (24 - 8 * i));
+            out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        }
+
+        std::unique_ptr<thread_pool> own_pool;
+        thread_pool                 *pool = opts.pool;
+        if(pool == nullptr)
+        {
+            std::size_t n = opts.threads > 0
+                                ? opts.threads
+                                : std::thread::hardware_concurrency();
+            own_pool.reset(new thread_pool(n));
+            pool = own_pool.get();
+        }
+        const std::size_t depth =
+            opts.depth > 0 ? opts.depth : 2 * pool->size();
+
+        // gcm frames carry a tag behind the cipher text
+        const std::size_t frame =
+            (mod == mode::gcm && !enc) ? chunk_size + 16 : chunk_size;
+
+        std::deque<std::shared_ptr<_chunk>> chunks;
+        std::deque<std::future<error_code>> pending;
+        error_code                          ec = error_code::ok;
+
+        // waits for the oldest chunk and writes it, chunks finish in any
+        // order but leave in input order
+        auto write_front = [&]() {
+            error_code r = pending.front().get();
+            if(ec == error_code::ok && r != error_code::ok)
+                ec = r;
+            if(ec == error_code::ok)
+            {
+                const _chunk &c = *chunks.front();
+                out.write(reinterpret_cast<const char *>(c.out.data()),
+                          static_cast<std::streamsize>(c.out_len));
+                if(!out)
+                    ec = error_code::file_write_failed;
+            }
+            pending.pop_front();
+            chunks.pop_front();
+        };
+
+        std::vector<unsigned char> key_copy(key, key + key_len);
+        std::vector<unsigned char> iv_copy(iv, iv + iv_len);
+        for(uint64_t index = 0; ec == error_code::ok; ++index)
+        {
+            auto c = std::make_shared<_chunk>();
+            c->in.resize(frame);
+            in.read(reinterpret_cast<char *>(c->in.data()),
+                    static_cast<std::streamsize>(frame));
+            c->in_len = static_cast<std::size_t>(in.gcount());
+            if(in.bad())
+            {
+                ec = error_code::file_read_failed;
+                break;
+            }
+
+            c->index = index;
+            c->final = c->in_len < frame
+                       || in.peek() == std::char_traits<char>::eof();
+
+            // gcm always writes a final chunk, even for empty input
+            if(c->in_len == 0 && (mod == mode::ctr || index > 0))
+                break;
+            if(c->in_len == 0 && !enc)
+            {
+                ec = error_code::format_invalid;
+                break;
+            }
+
+            while(pending.size() >= depth && ec == error_code::ok)
+                write_front();
+            if(ec != error_code::ok)
+                break;
+
+            auto fut = pool->enqueue([c, &key_copy, &iv_copy, &header, mod,
+                                      chunk_size, enc]() {
+                return _crypt_chunk(*c,
+                                    key_copy,
+                                    mod,
+                                    iv_copy.data(),
+                                    header,
+                                    chunk_size,
+                                    enc);
+            });
+            if(!fut.valid())
+            {
+                ec = error_code::param_invalid;
+                break;
+            }
+
+            pending.push_back(std::move(fut));
+            chunks.push_back(c);
+            if(c->final)
+                break;
+        }
+
+        // workers still reference key_copy and iv_copy
+        while(!pending.empty())
+            write_front();
+
+        OPENSSL_cleanse(key_copy.data(), key_copy.size());
+        return ec;
+    }
+
+    static error_code _crypt_chunk(_chunk                           &c,
+                                   const std::vector<unsigned char> &key,
+                                   const mode                        mod,
+                                   const unsigned char              *iv,
+                                   const unsigned char              *header,
+                                   const std::size_t                 chunk_size,
+                                   const int                         enc)
+    {
+        std::unique_ptr<EVP_CIPHER_CTX, void (*)(EVP_CIPHER_CTX *)> ctx{
+            EVP_CIPHER_CTX_new(),
+            EVP_CIPHER_CTX_free};
+        if(!ctx)
+            return error_code::ctx_alloc_failed;
+
+        const EVP_CIPHER *cipher = _select_cipher(mod, key.size());
+        unsigned char     nonce[16];
+        std::size_t       data_len = c.in_len;
+        memcpy(nonce, iv, mod == mode::ctr ? 16 : 12);
+        if(mod == mode::ctr)
+        {
+            // 128 bit big endian counter + blocks before this chunk
+            uint64_t add   = c.index * (chunk_size / 16);
+            unsigned carry = 0;
+            for(int i = 15; i >= 0; --i)
+            {
+                unsigned sum = nonce[i] + static_cast<unsigned>(add & 0xff)
+                               + carry;
+                nonce[i] = static_cast<unsigned char>(sum);
+                carry    = sum >> 8;
+                add >>= 8;
+            }
+        } else
+        {
+            for(int i = 0; i < 8; ++i)
+                nonce[4 + i] ^= static_cast<unsigned char>(c.index
+                                                           >> (56 - 8 * i));
+            if(!enc)
+            {
+                if(c.in_len < 16)
+                    return error_code::format_invalid;
+                data_len = c.in_len - 16;
+            }
+        }
+
+        if(EVP_CipherInit_ex(ctx.get(), cipher, NULL, key.data(), nonce, enc)
+           != 1)
+            return enc ? error_code::encrypt_init_failed
+                       : error_code::decrypt_init_failed;
+
+        int len = 0;
+        if(mod == mode::gcm)
+        {
+            unsigned char aad[21];
+            memcpy(aad, header, 12);
+            for(int i = 0; i < 8; ++i)
+                aad[12 + i] =
+                    static_cast<unsigned char>(c.index >> (56 - 8 * i));
+            aad[20] = c.final ? 1 : 0;
+            if(EVP_CipherUpdate(ctx.get(), NULL, &len, aad, sizeof(aad)) != 1)
+                return error_code::cipher_ctl_failed;
+            if(!enc
+               && EVP_CIPHER_CTX_ctrl(ctx.get(),
+                                      EVP_CTRL_AEAD_SET_TAG,
+                                      16,
+                                      c.in.data() + data_len)
+                      != 1)
+                return error_code::cipher_ctl_failed;
+        }
+
+        c.out.resize(data_len + 16);
+        int outlen1 = 0, outlen2 = 0;
+        if(data_len > 0
+           && EVP_CipherUpdate(ctx.get(),
+                               c.out.data(),
+                               &outlen1,
+                               c.in.data(),
+                               static_cast<int>(data_len))
+                  != 1)
+            return enc ? error_code::encrypt_update_failed
+                       : error_code::decrypt_update_failed;
+        if(EVP_CipherFinal_ex(ctx.get(), c.out.data() + outlen1, &outlen2) != 1)
+            return enc ? error_code::encrypt_final_failed
+                       : error_code::decrypt_final_failed;
+
+        c.out_len = static_cast<std::size_t>(outlen1 + outlen2);
+        if(mod == mode::gcm && enc)
+        {
+            if(EVP_CIPHER_CTX_ctrl(ctx.get(),
+                                   EVP_CTRL_AEAD_GET_TAG,
+                                   16,
+                                   c.out.data() + c.out_len)
+               != 1)
+                return error_code::get_tag_failed;
+            c.out_len += 16;
+        }
+        return error_code::ok;
+    }
+
     static const EVP_CIPHER *_select_cipher(const mode        mod,
                                             const std::size_t key_len)
     {
@@ -1185,30 +2028,11 @@ class aes
             padded_len = src_len + pad_val;
             padded_src.resize(padded_len, 0);
             memcpy(padded_src.data(), src, src_len);
-            switch(pad_style)
-            {
-                case padding::pkcs5:
-                case padding::pkcs7:
-                    for(std::size_t i = src_len; i < padded_len; ++i)
-                        padded_src[i] = pad_val;
-                    break;
-                case padding::zero:
-                    break;
-                case padding::iso10126:
-                    for(std::size_t i = src_len; i < padded_len - 1; ++i)
-                        padded_src[i] =
-                            static_cast<unsigned char>(rand() % 256);
-                    padded_src[padded_len - 1] = pad_val;
-                    break;
-                case padding::ansix923:
-                    padded_src[padded_len - 1] = pad_val;
-                    break;
-                case padding::iso_iec_7816_4:
-                    padded_src[src_len] = 0x80;
-                    break;
-                default:
-                    break;
-            }
+            _fill_padding(padded_src.data(),
+                          src_len,
+                          padded_len,
+                          pad_val,
+                          pad_style);
         } else
         {
             // no padding
@@ -1217,6 +2041,38 @@ class aes
         }
     }
 
+    // pad buf[src_len, padded_len), the bytes there start zeroed
+    static void _fill_padding(unsigned char      *buf,
+                              const std::size_t   src_len,
+                              const std::size_t   padded_len,
+                              const unsigned char pad_val,
+                              const padding       pad_style)
+    {
+        switch(pad_style)
+        {
+            case padding::pkcs5:
+            case padding::pkcs7:
+                for(std::size_t i = src_len; i < padded_len; ++i)
+                    buf[i] = pad_val;
+                break;
+            case padding::zero:
+                break;
+            case padding::iso10126:
+                for(std::size_t i = src_len; i < padded_len - 1; ++i)
+                    buf[i] = static_cast<unsigned char>(rand() % 256);
+                buf[padded_len - 1] = pad_val;
+                break;
+            case padding::ansix923:
+                buf[padded_len - 1] = pad_val;
+                break;
+            case padding::iso_iec_7816_4:
+                buf[src_len] = 0x80;
+                break;
+            default:
+                break;
+        }
+    }
+
     // unpad block
     static void _unpadding_block(unsigned char    *dst,
                                  std::size_t      &dst_len,
@@ -24,20 +24,22 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
-// support deprecated api for low version openssl
-#ifndef OPENSSL_SUPPRESS_DEPRECATED
-#define OPENSSL_SUPPRESS_DEPRECATED
-#endif
-
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
 
-#include <openssl/bio.h>
-#include <openssl/evp.h>
-#include <openssl/buffer.h>
+#include <hj/hardware/simd.h>
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+#elif defined(SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 #ifndef BASE64_BUF_SIZE
 #define BASE64_BUF_SIZE 16384 // 16KB
@@ -46,6 +48,11 @@
 namespace hj
 {
 
+// Native base64 (RFC 4648). Bulk input runs through an AVX2, SSE4.1 or
+// NEON kernel picked from the cpu at startup, tails and padding through
+// the scalar code. Decoding validates as it goes: any byte outside the
+// alphabet or misplaced padding fails with invalid_input, so there is no
+// need for an is_valid() pass first.
 class base64
 {
   public:
@@ -61,57 +68,258 @@ class base64
         file_write_failed
     };
 
+    enum class alphabet
+    {
+        standard, // A-Z a-z 0-9 + /, '=' padded
+        url,      // A-Z a-z 0-9 - _, unpadded on encode, optional on decode
+    };
+
+    enum class engine
+    {
+        scalar,
+        sse41,
+        avx2,
+        neon,
+    };
+
   public:
-    // bytes -> base64 bytes
-    static error_code encode(unsigned char       *dst,
-                             std::size_t         &dst_len,
-                             const unsigned char *src,
-                             const std::size_t    src_len)
+    static bool is_engine_supported(const engine e)
     {
-        if(src_len == 0 || dst_len == 0)
-            return error_code::invalid_input; // Invalid input or output length
+        switch(e)
+        {
+            case engine::scalar:
+                return true;
+            case engine::sse41:
+                return simd_has_sse41() != 0;
+            case engine::avx2:
+                return simd_has_avx2() != 0;
+            case engine::neon:
+                return simd_has_neon() != 0;
+            default:
+                return false;
+        }
+    }
+
+    static engine get_engine() { return _engine_slot().load(); }
 
-        BUF_MEM *buffer_ptr;
-        BIO     *bio = BIO_new(BIO_s_mem());
-        if(!bio)
-            return error_code::
-                encode_failed; // Failed to create BIO from memory buffer
+    // process wide, false when the cpu lacks it; meant for tests/benches
+    static bool set_engine(const engine e)
+    {
+        if(!is_engine_supported(e))
+            return false;
 
-        BIO *b64 = BIO_new(BIO_f_base64());
-        if(!b64)
+        _engine_slot().store(e);
+        return true;
+    }
+
+    // Streaming encoder, carries up to 2 bytes between update() calls.
+    // update() needs dst_len >= encode_len_reserve(src_len + 2), finish()
+    // writes the last 2..4 chars (padding included).
+    class encoder
+    {
+      public:
+        explicit encoder(const alphabet alpha = alphabet::standard)
+            : _alpha{alpha}
         {
-            BIO_free(bio);
-            return error_code::encode_failed; // Failed to create base64 BIO
         }
 
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        BIO_push(b64, bio);
-        BIO_write(b64, src, static_cast<int>(src_len));
-        BIO_flush(b64);
-        BIO_get_mem_ptr(b64, &buffer_ptr);
-        if(buffer_ptr->length > dst_len)
+        error_code update(unsigned char       *dst,
+                          std::size_t         &dst_len,
+                          const unsigned char *src,
+                          const std::size_t    src_len)
+        {
+            if(!src && src_len > 0)
+                return error_code::invalid_input;
+            if(dst_len < (_carry_len + src_len) / 3 * 4)
+                return error_code::buffer_overflow;
+
+            std::size_t i = 0;
+            std::size_t o = 0;
+            if(_carry_len > 0)
+            {
+                while(_carry_len < 3 && i < src_len)
+                    _carry[_carry_len++] = src[i++];
+                if(_carry_len < 3)
+                {
+                    dst_len = 0;
+                    return error_code::ok;
+                }
+
+                o += _encode_run(dst, _carry, 3, _alpha);
+                _carry_len = 0;
+            }
+
+            std::size_t full = (src_len - i) / 3 * 3;
+            o += _encode_run(dst + o, src + i, full, _alpha);
+            for(i += full; i < src_len; ++i)
+                _carry[_carry_len++] = src[i];
+
+            dst_len = o;
+            return error_code::ok;
+        }
+
+        error_code finish(unsigned char *dst, std::size_t &dst_len)
+        {
+            if(dst_len < 4 && _carry_len > 0)
+                return error_code::buffer_overflow;
+
+            dst_len    = _encode_tail(dst, _carry, _carry_len, _alpha);
+            _carry_len = 0;
+            return error_code::ok;
+        }
+
+        inline void reset() noexcept { _carry_len = 0; }
+
+      private:
+        alphabet      _alpha;
+        unsigned char _carry[3];
+        std::size_t   _carry_len = 0;
+    };
+
+    // Streaming decoder, carries up to 3 chars between update() calls.
+    // update() needs dst_len >= decode_len_reserve(src_len + 3); finish()
+    // writes at most 2 bytes, the tail of unpadded url input. Anything
+    // after the padding is an error; reset() after an error.
+    class decoder
+    {
+      public:
+        explicit decoder(const alphabet alpha = alphabet::standard)
+            : _alpha{alpha}
+        {
+        }
+
+        error_code update(unsigned char       *dst,
+                          std::size_t         &dst_len,
+                          const unsigned char *src,
+                          const std::size_t    src_len)
+        {
+            if(src_len == 0)
+            {
+                dst_len = 0;
+                return error_code::ok;
+            }
+            if(!src || _done)
+                return error_code::invalid_input;
+            if(dst_len < (_quad_len + src_len) / 4 * 3)
+                return error_code::buffer_overflow;
+
+            std::size_t i = 0;
+            std::size_t o = 0;
+            if(_quad_len > 0)
+            {
+                while(_quad_len < 4 && i < src_len)
+                    _quad[_quad_len++] = src[i++];
+                if(_quad_len < 4)
+                {
+                    dst_len = 0;
+                    return error_code::ok;
+                }
+
+                int n = _decode_quad(dst, _quad, _table(_alpha));
+                if(n < 0)
+                    return error_code::invalid_input;
+
+                o += static_cast<std::size_t>(n);
+                _quad_len = 0;
+                _done     = n < 3;
+            }
+
+            std::size_t full = (src_len - i) / 4 * 4;
+            if(full > 0)
+            {
+                if(_done)
+                    return error_code::invalid_input;
+
+                std::size_t n = 0;
+                if(!_decode_run(dst + o, n, src + i, full, _alpha, _done))
+                    return error_code::invalid_input;
+                o += n;
+            }
+            for(i += full; i < src_len; ++i)
+            {
+                if(_done)
+                    return error_code::invalid_input;
+                _quad[_quad_len++] = src[i];
+            }
+
+            dst_len = o;
+            return error_code::ok;
+        }
+
+        error_code finish(unsigned char *dst, std::size_t &dst_len)
+        {
+            std::size_t n = _quad_len;
+            _quad_len     = 0;
+            if(n == 0)
+            {
+                dst_len = 0;
+                return error_code::ok;
+            }
+
+            // only url input may drop its padding
+            if(_alpha != alphabet::url || n == 1)
+                return error_code::invalid_input;
+            if(dst_len < n - 1)
+                return error_code::buffer_overflow;
+
+            int len = _decode_tail(dst, _quad, n, _table(_alpha));
+            if(len < 0)
+                return error_code::invalid_input;
+
+            _done   = true;
+            dst_len = static_cast<std::size_t>(len);
+            return error_code::ok;
+        }
+
+        inline void reset() noexcept
         {
-            BIO_free_all(b64);
-            return error_code::
-                buffer_overflow; // Not enough space in destination buffer
+            _quad_len = 0;
+            _done     = false;
         }
 
-        memcpy(dst, buffer_ptr->data, buffer_ptr->length);
-        dst_len = buffer_ptr->length;
-        BIO_free_all(b64);
+      private:
+        alphabet      _alpha;
+        unsigned char _quad[4];
+        std::size_t   _quad_len = 0;
+        bool          _done     = false;
+    };
+
+  public:
+    // bytes -> base64 bytes
+    static error_code encode(unsigned char       *dst,
+                             std::size_t         &dst_len,
+                             const unsigned char *src,
+                             const std::size_t    src_len,
+                             const alphabet       alpha = alphabet::standard)
+    {
+        if(src_len == 0 || dst_len == 0 || !src || !dst)
+            return error_code::invalid_input; // Invalid input or output length
+
+        std::size_t tail = src_len % 3;
+        std::size_t need = src_len / 3 * 4;
+        if(tail > 0)
+            need += (alpha == alphabet::url) ? tail + 1 : 4;
+        if(need > dst_len)
+            return error_code::buffer_overflow;
+
+        std::size_t o = _encode_run(dst, src, src_len - tail, alpha);
+        o += _encode_tail(dst + o, src + src_len - tail, tail, alpha);
+        dst_len = o;
         return error_code::ok;
     }
 
     // string -> base64 string
-    static error_code encode(std::string &dst, const std::string &src)
+    static error_code encode(std::string       &dst,
+                             const std::string &src,
+                             const alphabet     alpha = alphabet::standard)
     {
         std::size_t dst_len = encode_len_reserve(src.size());
         dst.resize(dst_len); // Base64 encoding increases size by ~33%
-        auto ec = encode(
-            reinterpret_cast<unsigned char *>(const_cast<char *>(dst.data())),
-            dst_len,
-            reinterpret_cast<const unsigned char *>(src.c_str()),
-            src.size());
+        auto ec = encode(reinterpret_cast<unsigned char *>(&dst[0]),
+                         dst_len,
+                         reinterpret_cast<const unsigned char *>(src.c_str()),
+                         src.size(),
+                         alpha);
         if(ec != error_code::ok)
         {
             dst.clear();
@@ -123,48 +331,40 @@ class base64
     }
 
     // base64 stream -> stream
-    static error_code encode(std::ostream &out, std::istream &in)
+    static error_code encode(std::ostream  &out,
+                             std::istream  &in,
+                             const alphabet alpha = alphabet::standard)
     {
         if(!in || !out)
             return error_code::invalid_input;
 
-        BIO *b64 = BIO_new(BIO_f_base64());
-        if(!b64)
-            return error_code::encode_failed;
-
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        BIO *bio_out = BIO_new(BIO_s_mem());
-        if(!bio_out)
-        {
-            BIO_free(b64);
-            return error_code::encode_failed;
-        }
-
-        BIO_push(b64, bio_out);
-        char buffer[BASE64_BUF_SIZE];
+        encoder       enc(alpha);
+        char          buffer[BASE64_BUF_SIZE];
+        unsigned char outbuf[(BASE64_BUF_SIZE + 2) / 3 * 4 + 4];
+        std::size_t   n;
         while(in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
         {
-            std::streamsize n = in.gcount();
-            if(BIO_write(b64, buffer, static_cast<int>(n)) != n)
-            {
-                BIO_free_all(b64);
+            n = sizeof(outbuf);
+            enc.update(outbuf,
+                       n,
+                       reinterpret_cast<const unsigned char *>(buffer),
+                       static_cast<std::size_t>(in.gcount()));
+            if(!out.write(reinterpret_cast<const char *>(outbuf), n))
                 return error_code::encode_failed;
-            }
         }
 
-        BIO_flush(b64);
-        BUF_MEM *mem_ptr = nullptr;
-        BIO_get_mem_ptr(b64, &mem_ptr);
-        if(mem_ptr && mem_ptr->length > 0)
-            out.write(mem_ptr->data, mem_ptr->length);
+        n = sizeof(outbuf);
+        enc.finish(outbuf, n);
+        if(!out.write(reinterpret_cast<const char *>(outbuf), n))
+            return error_code::encode_failed;
 
-        BIO_free_all(b64);
         return error_code::ok;
     }
 
     // file -> base64 file
-    static error_code encode_file(const char *dst_file_path,
-                                  const char *src_file_path)
+    static error_code encode_file(const char    *dst_file_path,
+                                  const char    *src_file_path,
+                                  const alphabet alpha = alphabet::standard)
     {
         FILE *in = fopen(src_file_path, "rb");
         if(!in)
@@ -177,91 +377,102 @@ class base64
             return error_code::file_open_failed;
         }
 
-        BIO *bio_out = BIO_new_fp(out, BIO_NOCLOSE);
-        BIO *b64     = BIO_new(BIO_f_base64());
-        if(!b64)
+        encoder       enc(alpha);
+        unsigned char buffer[BASE64_BUF_SIZE];
+        unsigned char outbuf[(BASE64_BUF_SIZE + 2) / 3 * 4 + 4];
+        std::size_t   n;
+        std::size_t   len;
+        error_code    ec = error_code::ok;
+        while((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
         {
-            BIO_free(bio_out);
-            fclose(in);
-            fclose(out);
-            return error_code::encode_failed;
+            len = sizeof(outbuf);
+            enc.update(outbuf, len, buffer, n);
+            if(fwrite(outbuf, 1, len, out) != len)
+            {
+                ec = error_code::file_write_failed;
+                break;
+            }
         }
 
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        BIO_push(b64, bio_out);
-
-        char        buffer[BASE64_BUF_SIZE];
-        std::size_t n;
-        while((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        if(ec == error_code::ok && ferror(in))
+            ec = error_code::file_read_failed;
+        if(ec == error_code::ok)
         {
-            if(BIO_write(b64, buffer, static_cast<int>(n)) == (int) n)
-                continue;
-
-            BIO_free_all(b64);
-            fclose(in);
-            fclose(out);
-            return error_code::encode_failed;
+            len = sizeof(outbuf);
+            enc.finish(outbuf, len);
+            if(fwrite(outbuf, 1, len, out) != len)
+                ec = error_code::file_write_failed;
         }
 
-        BIO_flush(b64);
-        BIO_free_all(b64);
         fclose(in);
         fclose(out);
-        return error_code::ok;
+        return ec;
     }
 
     // file -> base64 file
     static error_code encode_file(const std::string &dst_file_path,
-                                  const std::string &src_file_path)
+                                  const std::string &src_file_path,
+                                  const alphabet     alpha = alphabet::standard)
     {
-        return encode_file(dst_file_path.c_str(), src_file_path.c_str());
+        return encode_file(dst_file_path.c_str(), src_file_path.c_str(), alpha);
     }
 
     // base64 bytes -> bytes
     static error_code decode(unsigned char       *dst,
                              std::size_t         &dst_len,
                              const unsigned char *src,
-                             const std::size_t    src_len)
+                             const std::size_t    src_len,
+                             const alphabet       alpha = alphabet::standard)
     {
-        if(src_len % 4 != 0)
+        if(src_len % 4 != 0 && (alpha != alphabet::url || src_len % 4 == 1))
             return error_code::invalid_input; // Invalid base64 input length
-
-        BIO *bio = BIO_new_mem_buf(src, static_cast<int>(src_len));
-        if(!bio)
-            return error_code::
-                decode_failed; // Failed to create BIO from memory buffer
-
-        BIO *b64 = BIO_new(BIO_f_base64());
-        if(!b64)
+        if(src_len == 0)
         {
-            BIO_free(bio);
-            return error_code::decode_failed; // Failed to create base64 BIO
+            dst_len = 0;
+            return error_code::ok;
         }
+        if(!src || !dst)
+            return error_code::invalid_input;
 
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        BIO_push(b64, bio);
-        int decoded_length = BIO_read(b64, dst, static_cast<int>(dst_len));
-        if(decoded_length < 0)
+        std::size_t pad = 0;
+        if(src_len % 4 == 0)
+            pad = (src[src_len - 1] == '=') + (src[src_len - 2] == '=');
+        if(dst_len < (src_len - pad) * 3 / 4)
+            return error_code::buffer_overflow;
+
+        std::size_t full = src_len / 4 * 4;
+        std::size_t o    = 0;
+        bool        done = false;
+        if(!_decode_run(dst, o, src, full, alpha, done))
+            return error_code::invalid_input;
+        if(full < src_len)
         {
-            BIO_free_all(b64);
-            return error_code::decode_failed;
+            int n = _decode_tail(dst + o,
+                                 src + full,
+                                 src_len - full,
+                                 _table(alpha));
+            if(n < 0)
+                return error_code::invalid_input;
+            o += static_cast<std::size_t>(n);
         }
 
-        dst_len = static_cast<std::size_t>(decoded_length);
-        BIO_free_all(b64);
+        dst_len = o;
         return error_code::ok;
     }
 
     // base64 string -> string
-    static error_code decode(std::string &dst, const std::string &src)
+    static error_code decode(std::string       &dst,
+                             const std::string &src,
+                             const alphabet     alpha = alphabet::standard)
     {
         dst.resize(decode_len_reserve(src.size()));
         std::size_t dst_len = dst.size();
         auto        ec      = decode(
-            reinterpret_cast<unsigned char *>(const_cast<char *>(dst.data())),
+            reinterpret_cast<unsigned char *>(&dst[0]),
             dst_len,
             reinterpret_cast<const unsigned char *>(src.c_str()),
-            src.size());
+            src.size(),
+            alpha);
         if(ec != error_code::ok)
         {
             dst.clear(); // Clear the string if decoding fails
@@ -273,39 +484,45 @@ class base64
     }
 
     // base64 stream -> stream
-    static error_code decode(std::ostream &out, std::istream &in)
+    static error_code decode(std::ostream  &out,
+                             std::istream  &in,
+                             const alphabet alpha = alphabet::standard)
     {
-        BIO *b64 = BIO_new(BIO_f_base64());
-        if(!b64)
-            return error_code::decode_failed;
+        if(!in || !out)
+            return error_code::invalid_input;
 
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        std::string input_buf;
-        char        buffer[BASE64_BUF_SIZE];
+        decoder       dec(alpha);
+        char          buffer[BASE64_BUF_SIZE];
+        unsigned char outbuf[(BASE64_BUF_SIZE + 3) / 4 * 3 + 3];
+        std::size_t   n;
+        error_code    ec;
         while(in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
-            input_buf.append(buffer, static_cast<size_t>(in.gcount()));
-
-        BIO *bio_in = BIO_new_mem_buf(input_buf.data(),
-                                      static_cast<int>(input_buf.size()));
-        if(!bio_in)
         {
-            BIO_free(b64);
-            return error_code::decode_failed;
+            n  = sizeof(outbuf);
+            ec = dec.update(outbuf,
+                            n,
+                            reinterpret_cast<const unsigned char *>(buffer),
+                            static_cast<std::size_t>(in.gcount()));
+            if(ec != error_code::ok)
+                return ec;
+            if(!out.write(reinterpret_cast<const char *>(outbuf), n))
+                return error_code::decode_failed;
         }
 
-        BIO_push(b64, bio_in);
-        char outbuf[BASE64_BUF_SIZE];
-        int  n;
-        while((n = BIO_read(b64, outbuf, sizeof(outbuf))) > 0)
-            out.write(outbuf, n);
+        n  = sizeof(outbuf);
+        ec = dec.finish(outbuf, n);
+        if(ec != error_code::ok)
+            return ec;
+        if(!out.write(reinterpret_cast<const char *>(outbuf), n))
+            return error_code::decode_failed;
 
-        BIO_free_all(b64);
         return error_code::ok;
     }
 
     // base64 file -> file
-    static error_code decode_file(const char *dst_file_path,
-                                  const char *src_file_path)
+    static error_code decode_file(const char    *dst_file_path,
+                                  const char    *src_file_path,
+                                  const alphabet alpha = alphabet::standard)
     {
         FILE *in = fopen(src_file_path, "rb");
         if(!in)
@@ -318,42 +535,46 @@ class base64
             return error_code::file_open_failed;
         }
 
-        BIO *bio_in = BIO_new_fp(in, BIO_NOCLOSE);
-        BIO *b64    = BIO_new(BIO_f_base64());
-        if(!b64)
+        decoder       dec(alpha);
+        unsigned char buffer[BASE64_BUF_SIZE];
+        unsigned char outbuf[(BASE64_BUF_SIZE + 3) / 4 * 3 + 3];
+        std::size_t   n;
+        std::size_t   len;
+        error_code    ec = error_code::ok;
+        while((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
         {
-            BIO_free(bio_in);
-            fclose(in);
-            fclose(out);
-            return error_code::decode_failed;
+            len = sizeof(outbuf);
+            ec  = dec.update(outbuf, len, buffer, n);
+            if(ec != error_code::ok)
+                break;
+            if(fwrite(outbuf, 1, len, out) != len)
+            {
+                ec = error_code::file_write_failed;
+                break;
+            }
         }
 
-        BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-        BIO_push(b64, bio_in);
-        char buffer[4096];
-        int  n;
-        while((n = BIO_read(b64, buffer, sizeof(buffer))) > 0)
+        if(ec == error_code::ok && ferror(in))
+            ec = error_code::file_read_failed;
+        if(ec == error_code::ok)
         {
-            if(fwrite(buffer, 1, n, out) == (size_t) n)
-                continue;
-
-            BIO_free_all(b64);
-            fclose(in);
-            fclose(out);
-            return error_code::file_write_failed;
+            len = sizeof(outbuf);
+            ec  = dec.finish(outbuf, len);
+            if(ec == error_code::ok && fwrite(outbuf, 1, len, out) != len)
+                ec = error_code::file_write_failed;
         }
 
-        BIO_free_all(b64);
         fclose(in);
         fclose(out);
-        return error_code::ok;
+        return ec;
     }
 
     // base64 file -> file
     static error_code decode_file(const std::string &dst_file_path,
-                                  const std::string &src_file_path)
+                                  const std::string &src_file_path,
+                                  const alphabet     alpha = alphabet::standard)
     {
-        return decode_file(dst_file_path.c_str(), src_file_path.c_str());
+        return decode_file(dst_file_path.c_str(), src_file_path.c_str(), alpha);
     }
 
     // reserve encode dst buf size
@@ -362,12 +583,14 @@ class base64
         return (src_len + 2) / 3 * 4;
     }
 
-    // reserve decode dst buf size
+    // reserve decode dst buf size (unpadded url input included)
     static std::size_t decode_len_reserve(const std::size_t src_len)
     {
-        return (src_len / 4) * 3;
+        return (src_len + 3) / 4 * 3;
     }
 
+    // padded standard base64; decode() already validates, this is for
+    // checking without keeping the output
     static bool is_valid(const unsigned char *buf, const std::size_t len)
     {
         if(len == 0 || buf == nullptr)
@@ -376,33 +599,20 @@ class base64
         if(len % 4 != 0)
             return false;
 
-        std::size_t pad = 0;
-        for(std::size_t i = 0; i < len; ++i)
+        decoder       dec;
+        unsigned char scratch[BASE64_BUF_SIZE];
+        std::size_t   step = BASE64_BUF_SIZE / 4 * 4;
+        std::size_t   n;
+        for(std::size_t i = 0; i < len; i += step)
         {
-            char c = buf[i];
-            if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')
-               || (c >= '0' && c <= '9') || c == '+' || c == '/')
-            {
-                if(pad > 0)
-                    return false;
-
-                continue;
-            }
-
-            if(c == '=')
-            {
-                ++pad;
-                if(pad > 2)
-                    return false;
-
-                if(i < len - 2)
-                    return false;
-            } else
-            {
+            n = sizeof(scratch);
+            if(dec.update(scratch, n, buf + i, std::min(step, len - i))
+               != error_code::ok)
                 return false;
-            }
         }
-        return true;
+
+        n = sizeof(scratch);
+        return dec.finish(scratch, n) == error_code::ok;
     }
 
     static bool is_valid(const std::string &str)
@@ -456,8 +666,532 @@ class base64
     base64 &operator=(const base64 &) = delete;
     base64(base64 &&)                 = delete;
     base64 &operator=(base64 &&)      = delete;
+
+    static std::atomic<engine> &_engine_slot()
+    {
+        static std::atomic<engine> e{_detect_engine()};
+        return e;
+    }
+
+    static engine _detect_engine()
+    {
+        if(is_engine_supported(engine::avx2))
+            return engine::avx2;
+        if(is_engine_supported(engine::sse41))
+            return engine::sse41;
+        if(is_engine_supported(engine::neon))
+            return engine::neon;
+        return engine::scalar;
+    }
+
+    static const char *_chars(const alphabet alpha)
+    {
+        return alpha == alphabet::url
+                   ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+                     "0123456789-_"
+                   : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+                     "0123456789+/";
+    }
+
+    // char -> 6 bit value, 0xff for anything outside the alphabet
+    static const unsigned char *_table(const alphabet alpha)
+    {
+        struct table
+        {
+            explicit table(const char *chars)
+            {
+                memset(v, 0xff, sizeof(v));
+                for(int i = 0; i < 64; ++i)
+                    v[static_cast<unsigned char>(chars[i])] =
+                        static_cast<unsigned char>(i);
+            }
+
+            unsigned char v[256];
+        };
+
+        static const table standard(_chars(alphabet::standard));
+        static const table url(_chars(alphabet::url));
+        return alpha == alphabet::url ? url.v : standard.v;
+    }
+
+    // len a multiple of 3, returns chars written
+    static std::size_t _encode_run(unsigned char       *dst,
+                                   const unsigned char *src,
+                                   const std::size_t    len,
+                                   const alphabet       alpha)
+    {
+        std::size_t i = 0;
+        switch(get_engine())
+        {
+#if defined(SIMD_X86)
+            case engine::avx2:
+                i = _encode_avx2(dst, src, len, alpha);
+                break;
+            case engine::sse41:
+                i = _encode_sse41(dst, src, len, alpha);
+                break;
+#elif defined(SIMD_NEON)
+            case engine::neon:
+                i = _encode_neon(dst, src, len, alpha);
+                break;
+#endif
+            default:
+                break;
+        }
+
+        const char *chars = _chars(alpha);
+        std::size_t o     = i / 3 * 4;
+        for(; i + 3 <= len; i += 3, o += 4)
+        {
+            uint32_t v = (uint32_t(src[i]) << 16) | (uint32_t(src[i + 1]) << 8)
+                         | src[i + 2];
+            dst[o]     = chars[(v >> 18) & 0x3f];
+            dst[o + 1] = chars[(v >> 12) & 0x3f];
+            dst[o + 2] = chars[(v >> 6) & 0x3f];
+            dst[o + 3] = chars[v & 0x3f];
+        }
+        return o;
+    }
+
+    // last 0..2 bytes, returns chars written
+    static std::size_t _encode_tail(unsigned char       *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const alphabet       alpha)
+    {
+        if(len == 0)
+            return 0;
+
+        const char *chars = _chars(alpha);
+        uint32_t    v     = uint32_t(src[0]) << 16;
+        if(len > 1)
+            v |= uint32_t(src[1]) << 8;
+
+        dst[0] = chars[(v >> 18) & 0x3f];
+        dst[1] = chars[(v >> 12) & 0x3f];
+        dst[2] = len > 1 ? chars[(v >> 6) & 0x3f] : '=';
+        dst[3] = '=';
+        if(alpha == alphabet::url)
+            return len + 1;
+        return 4;
+    }
+
+    // one quad, returns the bytes written (3, or 1..2 when padded) or -1
+    static int _decode_quad(unsigned char       *dst,
+                            const unsigned char *q,
+                            const unsigned char *table)
+    {
+        uint32_t a = table[q[0]];
+        uint32_t b = table[q[1]];
+        uint32_t c = table[q[2]];
+        uint32_t d = table[q[3]];
+        if((a | b | c | d) < 64)
+        {
+            uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+            dst[0]     = static_cast<unsigned char>(v >> 16);
+            dst[1]     = static_cast<unsigned char>(v >> 8);
+            dst[2]     = static_cast<unsigned char>(v);
+            return 3;
+        }
+        if(q[3] != '=')
+            return -1;
+
+        return _decode_tail(dst, q, q[2] == '=' ? 2 : 3, table);
+    }
+
+    // 2 or 3 chars without padding, returns the bytes written or -1
+    static int _decode_tail(unsigned char       *dst,
+                            const unsigned char *q,
+                            const std::size_t    len,
+                            const unsigned char *table)
+    {
+        if(len < 2 || len > 3)
+            return -1;
+
+        uint32_t a = table[q[0]];
+        uint32_t b = table[q[1]];
+        uint32_t c = len > 2 ? table[q[2]] : 0;
+        if(a > 63 || b > 63 || c > 63)
+            return -1;
+
+        uint32_t v = (a << 18) | (b << 12) | (c << 6);
+        dst[0]     = static_cast<unsigned char>(v >> 16);
+        if(len > 2)
+            dst[1] = static_cast<unsigned char>(v >> 8);
+        return static_cast<int>(len) - 1;
+    }
+
+    // len a multiple of 4; false on a bad char or data after the padding
+    static bool _decode_run(unsigned char       *dst,
+                            std::size_t         &dst_len,
+                            const unsigned char *src,
+                            const std::size_t    len,
+                            const alphabet       alpha,
+                            bool                &done)
+    {
+        std::size_t i = 0;
+        switch(get_engine())
+        {
+#if defined(SIMD_X86)
+            case engine::avx2:
+                i = _decode_avx2(dst, src, len, alpha);
+                break;
+            case engine::sse41:
+                i = _decode_sse41(dst, src, len, alpha);
+                break;
+#elif defined(SIMD_NEON)
+            case engine::neon:
+                i = _decode_neon(dst, src, len, alpha);
+                break;
+#endif
+            default:
+                break;
+        }
+
+        // the kernels stop at the first block holding padding or a bad
+        // char, the scalar code pins down which
+        const unsigned char *table = _table(alpha);
+        std::size_t          o     = i / 4 * 3;
+        for(; i < len; i += 4)
+        {
+            if(done)
+                return false;
+
+            int n = _decode_quad(dst + o, src + i, table);
+            if(n < 0)
+                return false;
+
+            o += static_cast<std::size_t>(n);
+            done = n < 3;
+        }
+        dst_len = o;
+        return true;
+    }
+
+#if defined(SIMD_X86)
+    // Encode (W. Muła): pshufb spreads every 3 bytes over a 32-bit lane,
+    // mulhi/mullo move the four 6-bit fields into their own bytes and a
+    // 16-entry pshufb table turns the values into chars.
+    SIMD_TARGET("sse4.1")
+    static inline __m128i _encode_block_sse41(__m128i in, const __m128i lut)
+    {
+        const __m128i shuf =
+            _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+        in         = _mm_shuffle_epi8(in, shuf);
+        __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        t0         = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        t1         = _mm_mullo_epi16(t1, _mm_set1_epi32(0x01000010));
+        __m128i v  = _mm_or_si128(t0, t1);
+
+        // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+        __m128i r  = _mm_subs_epu8(v, _mm_set1_epi8(51));
+        __m128i lt = _mm_cmpgt_epi8(_mm_set1_epi8(26), v);
+        r          = _mm_or_si128(r, _mm_and_si128(lt, _mm_set1_epi8(13)));
+        return _mm_add_epi8(_mm_shuffle_epi8(lut, r), v);
+    }
+
+    SIMD_TARGET("avx2")
+    static inline __m256i _encode_block_avx2(__m256i in, const __m256i lut)
+    {
+        const __m256i shuf = _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+        in         = _mm256_shuffle_epi8(in, shuf);
+        __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        t0         = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        t1         = _mm256_mullo_epi16(t1, _mm256_set1_epi32(0x01000010));
+        __m256i v  = _mm256_or_si256(t0, t1);
+
+        __m256i r  = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+        __m256i lt = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), v);
+        r = _mm256_or_si256(r, _mm256_and_si256(lt, _mm256_set1_epi8(13)));
+        return _mm256_add_epi8(_mm256_shuffle_epi8(lut, r), v);
+    }
+
+    SIMD_TARGET("sse4.1")
+    static std::size_t _encode_sse41(unsigned char       *dst,
+                                     const unsigned char *src,
+                                     const std::size_t    len,
+                                     const alphabet       alpha)
+    {
+        const char    c62 = alpha == alphabet::url ? -17 : -19;
+        const char    c63 = alpha == alphabet::url ? 32 : -16;
+        const __m128i lut = _mm_setr_epi8(
+            71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, c62, c63, 65, 0, 0);
+
+        // loads 16 bytes, uses 12
+        std::size_t i = 0;
+        for(; i + 16 <= len; i += 12)
+        {
+            __m128i in = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i / 3 * 4),
+                             _encode_block_sse41(in, lut));
+        }
+        return i;
+    }
+
+    SIMD_TARGET("avx2")
+    static std::size_t _encode_avx2(unsigned char       *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const alphabet       alpha)
+    {
+        const char    c62 = alpha == alphabet::url ? -17 : -19;
+        const char    c63 = alpha == alphabet::url ? 32 : -16;
+        const __m256i lut = _mm256_setr_epi8(
+            71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, c62, c63, 65, 0, 0,
+            71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, c62, c63, 65, 0, 0);
+
+        // two 16 byte loads 12 bytes apart, 24 bytes used
+        std::size_t i = 0;
+        for(; i + 28 <= len; i += 24)
+        {
+            __m128i lo = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + i));
+            __m128i hi = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + i + 12));
+            __m256i in =
+                _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 3 * 4),
+                                _encode_block_avx2(in, lut));
+        }
+        return i;
+    }
+
+    // Decode: every char is range checked against the alphabet, the
+    // matching range gives the offset to its 6-bit value; maddubs/madd
+    // then pack 4 values into 3 bytes. A block with any other byte
+    // (padding included) is left to the scalar code.
+    SIMD_TARGET("sse4.1")
+    static inline __m128i _in_range_sse41(__m128i c, char lo, char n)
+    {
+        // (c - lo) < n as unsigned, via a signed compare shifted by 128
+        __m128i x = _mm_add_epi8(c, _mm_set1_epi8(char(128 - lo)));
+        return _mm_cmplt_epi8(x, _mm_set1_epi8(char(-128 + n)));
+    }
+
+    // false when a byte is outside the alphabet, else in -> 6-bit values
+    SIMD_TARGET("sse4.1")
+    static inline bool
+    _decode_lookup_sse41(__m128i &in, const char c62, const char c63)
+    {
+        __m128i up = _in_range_sse41(in, 'A', 26);
+        __m128i lo = _in_range_sse41(in, 'a', 26);
+        __m128i dg = _in_range_sse41(in, '0', 10);
+        __m128i p  = _mm_cmpeq_epi8(in, _mm_set1_epi8(c62));
+        __m128i s  = _mm_cmpeq_epi8(in, _mm_set1_epi8(c63));
+        __m128i ok = _mm_or_si128(_mm_or_si128(up, lo), dg);
+        ok         = _mm_or_si128(ok, _mm_or_si128(p, s));
+        if(_mm_movemask_epi8(ok) != 0xffff)
+            return false;
+
+        __m128i shift = _mm_and_si128(up, _mm_set1_epi8(-65));
+        shift = _mm_or_si128(shift, _mm_and_si128(lo, _mm_set1_epi8(-71)));
+        shift = _mm_or_si128(shift, _mm_and_si128(dg, _mm_set1_epi8(4)));
+        shift = _mm_or_si128(shift,
+                             _mm_and_si128(p, _mm_set1_epi8(char(62 - c62))));
+        shift = _mm_or_si128(shift,
+                             _mm_and_si128(s, _mm_set1_epi8(char(63 - c63))));
+        in    = _mm_add_epi8(in, shift);
+        return true;
+    }
+
+    SIMD_TARGET("sse4.1")
+    static std::size_t _decode_sse41(unsigned char       *dst,
+                                     const unsigned char *src,
+                                     const std::size_t    len,
+                                     const alphabet       alpha)
+    {
+        const char    c62  = alpha == alphabet::url ? '-' : '+';
+        const char    c63  = alpha == alphabet::url ? '_' : '/';
+        const __m128i pack = _mm_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        std::size_t i = 0;
+        for(; i + 16 <= len; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + i));
+            if(!_decode_lookup_sse41(v, c62, c63))
+                break;
+
+            v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+            v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+            v = _mm_shuffle_epi8(v, pack);
+
+            unsigned char *out = dst + i / 4 * 3;
+            uint32_t       w   = uint32_t(_mm_extract_epi32(v, 2));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), v);
+            memcpy(out + 8, &w, 4);
+        }
+        return i;
+    }
+
+    SIMD_TARGET("avx2")
+    static inline __m256i _in_range_avx2(__m256i c, char lo, char n)
+    {
+        __m256i x = _mm256_add_epi8(c, _mm256_set1_epi8(char(128 - lo)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + n)), x);
+    }
+
+    SIMD_TARGET("avx2")
+    static inline bool
+    _decode_lookup_avx2(__m256i &in, const char c62, const char c63)
+    {
+        __m256i up = _in_range_avx2(in, 'A', 26);
+        __m256i lo = _in_range_avx2(in, 'a', 26);
+        __m256i dg = _in_range_avx2(in, '0', 10);
+        __m256i p  = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(c62));
+        __m256i s  = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(c63));
+        __m256i ok = _mm256_or_si256(_mm256_or_si256(up, lo), dg);
+        ok         = _mm256_or_si256(ok, _mm256_or_si256(p, s));
+        if(_mm256_movemask_epi8(ok) != -1)
+            return false;
+
+        __m256i m62   = _mm256_set1_epi8(char(62 - c62));
+        __m256i m63   = _mm256_set1_epi8(char(63 - c63));
+        __m256i shift = _mm256_and_si256(up, _mm256_set1_epi8(-65));
+        shift = _mm256_or_si256(shift,
+                                _mm256_and_si256(lo, _mm256_set1_epi8(-71)));
+        shift = _mm256_or_si256(shift,
+                                _mm256_and_si256(dg, _mm256_set1_epi8(4)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(p, m62));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(s, m63));
+        in    = _mm256_add_epi8(in, shift);
+        return true;
+    }
+
+    SIMD_TARGET("avx2")
+    static std::size_t _decode_avx2(unsigned char       *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const alphabet       alpha)
+    {
+        const char    c62  = alpha == alphabet::url ? '-' : '+';
+        const char    c63  = alpha == alphabet::url ? '_' : '/';
+        const __m256i pack = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+        std::size_t i = 0;
+        for(; i + 32 <= len; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(src + i));
+            if(!_decode_lookup_avx2(v, c62, c63))
+                break;
+
+            v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+            v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+            v = _mm256_shuffle_epi8(v, pack);
+            v = _mm256_permutevar8x32_epi32(v, lanes);
+
+            unsigned char *out = dst + i / 4 * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                             _mm256_castsi256_si128(v));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16),
+                             _mm256_extracti128_si256(v, 1));
+        }
+        return i;
+    }
+#elif defined(SIMD_NEON)
+    // 48 bytes per round: vld3 splits them into the 3 byte positions,
+    // shifts build the four 6-bit fields and vqtbl4 looks up the chars
+    static std::size_t _encode_neon(unsigned char       *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const alphabet       alpha)
+    {
+        const uint8_t *chars = reinterpret_cast<const uint8_t *>(_chars(alpha));
+        uint8x16x4_t   lut;
+        lut.val[0]            = vld1q_u8(chars);
+        lut.val[1]            = vld1q_u8(chars + 16);
+        lut.val[2]            = vld1q_u8(chars + 32);
+        lut.val[3]            = vld1q_u8(chars + 48);
+        const uint8x16_t mask = vdupq_n_u8(0x3f);
+
+        std::size_t i = 0;
+        for(; i + 48 <= len; i += 48)
+        {
+            uint8x16x3_t in = vld3q_u8(src + i);
+            uint8x16_t   a  = in.val[0];
+            uint8x16_t   b  = in.val[1];
+            uint8x16_t   c  = in.val[2];
+            uint8x16x4_t out;
+            out.val[0] = vshrq_n_u8(a, 2);
+            out.val[1] = vorrq_u8(vshlq_n_u8(a, 4), vshrq_n_u8(b, 4));
+            out.val[2] = vorrq_u8(vshlq_n_u8(b, 2), vshrq_n_u8(c, 6));
+            out.val[3] = c;
+            for(int k = 0; k < 4; ++k)
+                out.val[k] = vqtbl4q_u8(lut, vandq_u8(out.val[k], mask));
+            vst4q_u8(dst + i / 3 * 4, out);
+        }
+        return i;
+    }
+
+    static inline uint8x16_t _in_range_neon(uint8x16_t c, uint8_t lo, uint8_t n)
+    {
+        return vcltq_u8(vsubq_u8(c, vdupq_n_u8(lo)), vdupq_n_u8(n));
+    }
+
+    // 0xff lanes where c is in the alphabet, c -> 6-bit value
+    static inline uint8x16_t
+    _decode_lookup_neon(uint8x16_t &c, const uint8_t c62, const uint8_t c63)
+    {
+        uint8x16_t up = _in_range_neon(c, 'A', 26);
+        uint8x16_t lo = _in_range_neon(c, 'a', 26);
+        uint8x16_t dg = _in_range_neon(c, '0', 10);
+        uint8x16_t p  = vceqq_u8(c, vdupq_n_u8(c62));
+        uint8x16_t s  = vceqq_u8(c, vdupq_n_u8(c63));
+
+        uint8x16_t shift = vandq_u8(up, vdupq_n_u8(uint8_t(-65)));
+        shift = vorrq_u8(shift, vandq_u8(lo, vdupq_n_u8(uint8_t(-71))));
+        shift = vorrq_u8(shift, vandq_u8(dg, vdupq_n_u8(4)));
+        shift = vorrq_u8(shift, vandq_u8(p, vdupq_n_u8(uint8_t(62 - c62))));
+        shift = vorrq_u8(shift, vandq_u8(s, vdupq_n_u8(uint8_t(63 - c63))));
+        c     = vaddq_u8(c, shift);
+        return vorrq_u8(vorrq_u8(vorrq_u8(up, lo), dg), vorrq_u8(p, s));
+    }
+
+    // 64 chars per round, vld4 splits them into the 4 char positions
+    static std::size_t _decode_neon(unsigned char       *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const alphabet       alpha)
+    {
+        const uint8_t c62 = alpha == alphabet::url ? '-' : '+';
+        const uint8_t c63 = alpha == alphabet::url ? '_' : '/';
+
+        std::size_t i = 0;
+        for(; i + 64 <= len; i += 64)
+        {
+            uint8x16x4_t in = vld4q_u8(src + i);
+            uint8x16_t   ok = vdupq_n_u8(0xff);
+            for(int k = 0; k < 4; ++k)
+                ok = vandq_u8(ok, _decode_lookup_neon(in.val[k], c62, c63));
+            if(vminvq_u8(ok) != 0xff)
+                break;
+
+            uint8x16_t   a = in.val[0];
+            uint8x16_t   b = in.val[1];
+            uint8x16_t   c = in.val[2];
+            uint8x16x3_t out;
+            out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+            out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+            out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), in.val[3]);
+            vst3q_u8(dst + i / 4 * 3, out);
+        }
+        return i;
+    }
+#endif
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
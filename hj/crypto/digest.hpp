@@ -0,0 +1,318 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIGEST_HPP
+#define DIGEST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+
+#include <hj/sync/thread_pool.hpp>
+
+#ifndef DIGEST_FILE_BUF_SIZE
+#define DIGEST_FILE_BUF_SIZE (1 << 20) // 1 MiB
+#endif
+
+#ifndef DIGEST_FILE_BUF_ALIGN
+#define DIGEST_FILE_BUF_ALIGN 4096
+#endif
+
+namespace hj
+{
+
+// Incremental message digest on one reused EVP_MD_CTX, the digest is
+// fetched once (OpenSSL 3 otherwise looks it up on every one-shot call).
+// finish() leaves the hasher ready for the next message; the context is
+// only re-initialised when that message starts. Not thread safe, give
+// every thread its own.
+class digest_hasher
+{
+  public:
+    // name: "SHA256", "MD5", ... as known by OpenSSL
+    explicit digest_hasher(const char *name)
+        : _ctx{EVP_MD_CTX_new()}
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        _md = EVP_MD_fetch(nullptr, name, nullptr);
+#else
+        _md = EVP_get_digestbyname(name);
+#endif
+        if(!_md || !_ctx)
+            _release();
+    }
+
+    ~digest_hasher() noexcept { _release(); }
+
+    digest_hasher(const digest_hasher &)            = delete;
+    digest_hasher &operator=(const digest_hasher &) = delete;
+
+    digest_hasher(digest_hasher &&other) noexcept
+        : _md{other._md}
+        , _ctx{other._ctx}
+        , _started{other._started}
+    {
+        other._md      = nullptr;
+        other._ctx     = nullptr;
+        other._started = false;
+    }
+
+    digest_hasher &operator=(digest_hasher &&other) noexcept
+    {
+        if(this != &other)
+        {
+            _release();
+            _md            = other._md;
+            _ctx           = other._ctx;
+            _started       = other._started;
+            other._md      = nullptr;
+            other._ctx     = nullptr;
+            other._started = false;
+        }
+        return *this;
+    }
+
+    inline bool        is_valid() const noexcept { return _ctx != nullptr; }
+    inline std::size_t size() const noexcept
+    {
+        return _md ? static_cast<std::size_t>(EVP_MD_size(_md)) : 0;
+    }
+
+    bool update(const void *data, const std::size_t len)
+    {
+        if(!_begin())
+            return false;
+        if(len == 0)
+            return true;
+
+        return data && EVP_DigestUpdate(_ctx, data, len) == 1;
+    }
+
+    // dst_len in: capacity, out: digest length
+    bool finish(unsigned char *dst, std::size_t &dst_len)
+    {
+        if(!dst || dst_len < size() || !_begin())
+            return false;
+
+        unsigned int len = 0;
+        _started         = false;
+        if(EVP_DigestFinal_ex(_ctx, dst, &len) != 1)
+            return false;
+
+        dst_len = len;
+        return true;
+    }
+
+    // drops the input of the current message
+    inline void reset() noexcept { _started = false; }
+
+  private:
+    inline bool _begin()
+    {
+        if(_started)
+            return true;
+        if(!_ctx || EVP_DigestInit_ex(_ctx, _md, nullptr) != 1)
+            return false;
+
+        _started = true;
+        return true;
+    }
+
+    void _release() noexcept
+    {
+        EVP_MD_CTX_free(_ctx);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        EVP_MD_free(_md);
+#endif
+        _ctx     = nullptr;
+        _md      = nullptr;
+        _started = false;
+    }
+
+  private:
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    EVP_MD *_md = nullptr;
+#else
+    const EVP_MD *_md = nullptr;
+#endif
+    EVP_MD_CTX *_ctx     = nullptr;
+    bool        _started = false;
+};
+
+namespace detail
+{
+
+// fn(from, to) on contiguous slices of [0, n), one per pool thread; all
+// on the caller thread without a pool
+template <typename F>
+void digest_for_each(const std::size_t n, thread_pool *pool, F &&fn)
+{
+    std::size_t slices = pool ? std::min(pool->size(), n) : 1;
+    if(slices <= 1)
+    {
+        fn(std::size_t(0), n);
+        return;
+    }
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(slices);
+    for(std::size_t i = 0; i < slices; ++i)
+    {
+        std::size_t from = n * i / slices;
+        std::size_t to   = n * (i + 1) / slices;
+        auto        fut = pool->enqueue([&fn, from, to]() { fn(from, to); });
+        if(fut.valid())
+            pending.push_back(std::move(fut));
+        else
+            fn(from, to); // pool stopped
+    }
+    for(auto &fut : pending)
+        fut.get();
+}
+
+// large aligned read buffer, unbuffered FILE so reads go straight into it
+struct digest_file_buf
+{
+    digest_file_buf()
+        : data{static_cast<unsigned char *>(::operator new(
+            DIGEST_FILE_BUF_SIZE, std::align_val_t(DIGEST_FILE_BUF_ALIGN)))}
+    {
+    }
+
+    ~digest_file_buf()
+    {
+        ::operator delete(data, std::align_val_t(DIGEST_FILE_BUF_ALIGN));
+    }
+
+    digest_file_buf(const digest_file_buf &)            = delete;
+    digest_file_buf &operator=(const digest_file_buf &) = delete;
+
+    unsigned char *data;
+};
+
+inline bool digest_file(digest_hasher   &h,
+                        const char      *path,
+                        digest_file_buf &buf,
+                        std::string     &dst)
+{
+    dst.clear();
+    std::FILE *f = std::fopen(path, "rb");
+    if(!f)
+        return false;
+
+    std::setvbuf(f, nullptr, _IONBF, 0);
+    h.reset();
+    bool        ok = true;
+    std::size_t sz;
+    while((sz = std::fread(buf.data, 1, DIGEST_FILE_BUF_SIZE, f)) > 0)
+    {
+        if(!h.update(buf.data, sz))
+        {
+            ok = false;
+            break;
+        }
+    }
+    ok = ok && !std::ferror(f);
+    std::fclose(f);
+    if(!ok)
+    {
+        h.reset();
+        return false;
+    }
+
+    unsigned char md[EVP_MAX_MD_SIZE];
+    std::size_t   md_len = sizeof(md);
+    if(!h.finish(md, md_len))
+        return false;
+
+    dst.assign(reinterpret_cast<const char *>(md), md_len);
+    return true;
+}
+
+// n messages into dst, md_len bytes each, back to back
+inline bool digest_many(const char                 *name,
+                        unsigned char              *dst,
+                        const std::size_t           md_len,
+                        const unsigned char *const *src,
+                        const std::size_t          *src_len,
+                        const std::size_t           n,
+                        thread_pool                *pool)
+{
+    std::atomic<bool> ok{true};
+    digest_for_each(n, pool, [&](std::size_t from, std::size_t to) {
+        digest_hasher h(name);
+        for(std::size_t i = from; i < to; ++i)
+        {
+            std::size_t len = md_len;
+            if(!h.update(src[i], src_len[i])
+               || !h.finish(dst + i * md_len, len))
+            {
+                h.reset();
+                ok.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    return ok.load();
+}
+
+// files are handed out one by one so a large one does not hold up a
+// whole slice; a file that cannot be read leaves its digest empty
+inline bool digest_files(const char                     *name,
+                         std::vector<std::string>       &dst,
+                         const std::vector<std::string> &paths,
+                         thread_pool                    *pool)
+{
+    dst.assign(paths.size(), std::string());
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool>        ok{true};
+    auto                     work = [&]() {
+        digest_hasher   h(name);
+        digest_file_buf buf;
+        for(std::size_t i = next++; i < paths.size(); i = next++)
+            if(!digest_file(h, paths[i].c_str(), buf, dst[i]))
+                ok.store(false, std::memory_order_relaxed);
+    };
+
+    std::size_t workers = pool ? std::min(pool->size(), paths.size()) : 1;
+    std::vector<std::future<void>> pending;
+    for(std::size_t i = 1; i < workers; ++i)
+    {
+        auto fut = pool->enqueue(work);
+        if(fut.valid())
+            pending.push_back(std::move(fut));
+    }
+    work(); // the caller reads too
+    for(auto &fut : pending)
+        fut.get();
+    return ok.load();
+}
+
+} // namespace detail
+
+} // namespace hj
+
+#endif // DIGEST_HPP
@@ -41,6 +41,8 @@
 
 #include <openssl/md5.h>
 
+#include <hj/crypto/digest.hpp>
+
 #ifndef MD5_BUF_SZ
 #define MD5_BUF_SZ 128 * 1024
 #endif
@@ -200,6 +202,148 @@ class md5
     // reserve encode dst buf size
     static std::size_t encode_len_reserve() { return MD5_DIGEST_LENGTH; }
 
+    // incremental md5 on one reused context, finish() starts the next
+    // message and reset() drops the current one
+    class hasher
+    {
+      public:
+        hasher()
+            : _h{"MD5"}
+        {
+        }
+
+        inline bool is_valid() const noexcept { return _h.is_valid(); }
+        inline void reset() noexcept { _h.reset(); }
+
+        error_code update(const unsigned char *src, const std::size_t src_len)
+        {
+            if(!src && src_len > 0)
+                return error_code::invalid_input;
+
+            return _h.update(src, src_len) ? error_code::ok
+                                           : error_code::unknown;
+        }
+
+        error_code update(const std::string &src)
+        {
+            return update(reinterpret_cast<const unsigned char *>(src.data()),
+                          src.size());
+        }
+
+        error_code finish(unsigned char *dst, std::size_t &dst_len)
+        {
+            if(!dst)
+                return error_code::invalid_output;
+            if(dst_len < MD5_DIGEST_LENGTH)
+                return error_code::buffer_too_small;
+
+            return _h.finish(dst, dst_len) ? error_code::ok
+                                           : error_code::unknown;
+        }
+
+        error_code finish(std::string &dst)
+        {
+            dst.resize(MD5_DIGEST_LENGTH);
+            std::size_t len = dst.size();
+            auto ec = finish(reinterpret_cast<unsigned char *>(&dst[0]), len);
+            if(ec != error_code::ok)
+                dst.clear();
+            return ec;
+        }
+
+        error_code finish(std::array<uint8_t, MD5_DIGEST_LENGTH> &dst)
+        {
+            std::size_t len = dst.size();
+            auto        ec  = finish(dst.data(), len);
+            if(ec != error_code::ok)
+                dst.fill(0);
+            return ec;
+        }
+
+      private:
+        digest_hasher _h;
+    };
+
+    // n small buffers at once, dst gets the n digests back to back
+    // (n * MD5_DIGEST_LENGTH bytes); see sha::hash_many
+    static error_code hash_many(unsigned char              *dst,
+                                const std::size_t           dst_len,
+                                const unsigned char *const *src,
+                                const std::size_t          *src_len,
+                                const std::size_t           n,
+                                thread_pool                *pool = nullptr)
+    {
+        if(n == 0)
+            return error_code::ok;
+        if(!src || !src_len)
+            return error_code::invalid_input;
+        if(!dst)
+            return error_code::invalid_output;
+        if(dst_len < n * MD5_DIGEST_LENGTH)
+            return error_code::buffer_too_small;
+
+        return detail::digest_many("MD5",
+                                   dst,
+                                   MD5_DIGEST_LENGTH,
+                                   src,
+                                   src_len,
+                                   n,
+                                   pool)
+                   ? error_code::ok
+                   : error_code::unknown;
+    }
+
+    static error_code hash_many(std::vector<std::string>       &dst,
+                                const std::vector<std::string> &src,
+                                thread_pool                    *pool = nullptr)
+    {
+        std::vector<const unsigned char *> ptrs(src.size());
+        std::vector<std::size_t>           lens(src.size());
+        for(std::size_t i = 0; i < src.size(); ++i)
+        {
+            ptrs[i] = reinterpret_cast<const unsigned char *>(src[i].data());
+            lens[i] = src[i].size();
+        }
+
+        std::string buf(src.size() * MD5_DIGEST_LENGTH, '\0');
+        auto        ec = hash_many(reinterpret_cast<unsigned char *>(&buf[0]),
+                            buf.size(),
+                            ptrs.data(),
+                            lens.data(),
+                            src.size(),
+                            pool);
+        dst.clear();
+        if(ec != error_code::ok)
+            return ec;
+
+        dst.reserve(src.size());
+        for(std::size_t i = 0; i < src.size(); ++i)
+            dst.emplace_back(buf, i * MD5_DIGEST_LENGTH, MD5_DIGEST_LENGTH);
+        return error_code::ok;
+    }
+
+    // digest of a file, read in large aligned blocks (DIGEST_FILE_BUF_SIZE)
+    static error_code hash_file(std::string       &dst,
+                                const std::string &src_file_path)
+    {
+        digest_hasher           h("MD5");
+        detail::digest_file_buf buf;
+        return detail::digest_file(h, src_file_path.c_str(), buf, dst)
+                   ? error_code::ok
+                   : error_code::invalid_input;
+    }
+
+    // digests of many files, hashed concurrently on the pool (and the
+    // caller); a failed file leaves dst[i] empty
+    static error_code hash_files(std::vector<std::string>       &dst,
+                                 const std::vector<std::string> &src_file_paths,
+                                 thread_pool *pool = nullptr)
+    {
+        return detail::digest_files("MD5", dst, src_file_paths, pool)
+                   ? error_code::ok
+                   : error_code::invalid_input;
+    }
+
   private:
     md5()                       = default;
     ~md5()                      = default;
@@ -34,6 +34,13 @@
 #include <sstream>
 #include <iostream>
 #include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <future>
+#include <thread>
+#include <algorithm>
 
 #include <openssl/opensslconf.h>
 #include <openssl/evp.h>
@@ -42,6 +49,8 @@
 #include <openssl/pem.h>
 #include <openssl/err.h>
 
+#include <hj/sync/thread_pool.hpp>
+
 #ifndef RSA_MAX_KEY_LENGTH
 #define RSA_MAX_KEY_LENGTH 4096
 #endif
@@ -593,6 +602,269 @@ class rsa
         return error_code::ok;
     }
 
+    // Parsed key: the PEM is read once into an EVP_PKEY that is shared by
+    // every copy, the pem based api parses it again on each call (which
+    // costs more than a verify). Safe to use from many threads at once.
+    class key
+    {
+      public:
+        key() = default;
+
+        inline bool is_valid() const noexcept { return _pkey != nullptr; }
+        inline bool is_private() const noexcept { return _private; }
+        inline EVP_PKEY *get() const noexcept { return _pkey.get(); }
+        inline uint64_t  id() const noexcept { return _id; }
+
+        // modulus size in bytes, also the size of a cipher or signature
+        inline std::size_t size() const noexcept
+        {
+            return _pkey ? static_cast<std::size_t>(EVP_PKEY_size(_pkey.get()))
+                         : 0;
+        }
+
+        // accepts the same pem styles as encrypt/verify_signature
+        static key load_public(const unsigned char *pubkey_pem,
+                               const std::size_t    pubkey_pem_len)
+        {
+            return key(_load_public_key(pubkey_pem, pubkey_pem_len), false);
+        }
+
+        static key load_public(const std::string &pubkey_pem)
+        {
+            return key(_load_public_key(pubkey_pem), false);
+        }
+
+        // accepts the same pem styles as decrypt/signature
+        static key load_private(const unsigned char *prikey_pem,
+                                const std::size_t    prikey_pem_len,
+                                const unsigned char *password     = nullptr,
+                                const std::size_t    password_len = 0)
+        {
+            return key(_load_private_key(prikey_pem,
+                                         static_cast<int>(prikey_pem_len),
+                                         password,
+                                         password_len),
+                       true);
+        }
+
+        static key load_private(const std::string &prikey_pem,
+                                const std::string &password = std::string())
+        {
+            return key(_load_private_key(prikey_pem, password), true);
+        }
+
+      private:
+        key(RSA *rsa, const bool is_pri)
+        {
+            if(!rsa)
+                return;
+
+            EVP_PKEY *pkey = EVP_PKEY_new();
+            if(!pkey || EVP_PKEY_assign_RSA(pkey, rsa) != 1)
+            {
+                EVP_PKEY_free(pkey);
+                RSA_free(rsa);
+                return;
+            }
+
+            static std::atomic<uint64_t> next_id{1};
+            _pkey.reset(pkey, EVP_PKEY_free);
+            _private = is_pri;
+            _id      = next_id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+      private:
+        std::shared_ptr<EVP_PKEY> _pkey;
+        bool                      _private = false;
+        uint64_t                  _id      = 0;
+    };
+
+    // use parsed pubkey to encrypt
+    static error_code encrypt(unsigned char       *dst,
+                              std::size_t         &dst_len,
+                              const unsigned char *src,
+                              const std::size_t    src_len,
+                              const key           &pubkey,
+                              const padding        padding = padding::pkcs1)
+    {
+        if(!dst)
+            return error_code::invalid_output;
+        if(!src)
+            return error_code::invalid_input;
+        if(!pubkey.is_valid())
+            return error_code::key_loading_failed;
+        if(dst_len < pubkey.size())
+            return error_code::buffer_too_small;
+
+        EVP_PKEY_CTX *ctx = _cached_ctx(pubkey, _op::encrypt, padding);
+        if(!ctx || EVP_PKEY_encrypt(ctx, dst, &dst_len, src, src_len) != 1)
+        {
+            ERR_clear_error();
+            return error_code::encryption_failed;
+        }
+        return error_code::ok;
+    }
+
+    // use parsed prikey to decrypt
+    static error_code decrypt(unsigned char       *dst,
+                              std::size_t         &dst_len,
+                              const unsigned char *src,
+                              const std::size_t    src_len,
+                              const key           &prikey,
+                              const padding        padding = padding::pkcs1)
+    {
+        if(!dst || dst_len == 0)
+            return error_code::invalid_output;
+        if(!src || src_len == 0)
+            return error_code::invalid_input;
+        if(!prikey.is_valid() || !prikey.is_private())
+            return error_code::key_loading_failed;
+        if(dst_len < prikey.size())
+            return error_code::buffer_too_small;
+
+        EVP_PKEY_CTX *ctx = _cached_ctx(prikey, _op::decrypt, padding);
+        if(!ctx || EVP_PKEY_decrypt(ctx, dst, &dst_len, src, src_len) != 1)
+        {
+            ERR_clear_error();
+            memset(dst, 0, dst_len);
+            return error_code::decryption_failed;
+        }
+        return error_code::ok;
+    }
+
+    // use parsed prikey to signature, same output as the pem version
+    static error_code signature(unsigned char       *dst,
+                                std::size_t         &dst_len,
+                                const unsigned char *src,
+                                const std::size_t    src_len,
+                                const key           &prikey,
+                                const padding        padding = padding::pkcs1)
+    {
+        if(!dst)
+            return error_code::invalid_output;
+        if(!src)
+            return error_code::invalid_input;
+        if(!prikey.is_valid() || !prikey.is_private())
+            return error_code::key_loading_failed;
+        if(dst_len < prikey.size())
+            return error_code::buffer_too_small;
+
+        EVP_PKEY_CTX *ctx = _cached_ctx(prikey, _op::sign, padding);
+        if(!ctx || EVP_PKEY_sign(ctx, dst, &dst_len, src, src_len) != 1)
+        {
+            ERR_clear_error();
+            return error_code::signing_failed;
+        }
+        return error_code::ok;
+    }
+
+    // use parsed pubkey to recover the signed data, same output as the pem
+    // version
+    static error_code verify_signature(unsigned char       *dst,
+                                       std::size_t         &dst_len,
+                                       const unsigned char *src,
+                                       const std::size_t    src_len,
+                                       const key           &pubkey,
+                                       const padding padding = padding::pkcs1)
+    {
+        if(!dst)
+            return error_code::invalid_output;
+        if(!src)
+            return error_code::invalid_input;
+        if(!pubkey.is_valid())
+            return error_code::key_loading_failed;
+        if(dst_len < pubkey.size())
+            return error_code::buffer_too_small;
+
+        EVP_PKEY_CTX *ctx = _cached_ctx(pubkey, _op::recover, padding);
+        if(!ctx
+           || EVP_PKEY_verify_recover(ctx, dst, &dst_len, src, src_len) != 1)
+        {
+            ERR_clear_error();
+            return error_code::verification_failed;
+        }
+        return error_code::ok;
+    }
+
+    // ok when sig is the signature of msg
+    static error_code verify(const unsigned char *msg,
+                             const std::size_t    msg_len,
+                             const unsigned char *sig,
+                             const std::size_t    sig_len,
+                             const key           &pubkey,
+                             const padding        padding = padding::pkcs1)
+    {
+        if(!msg || !sig)
+            return error_code::invalid_input;
+        if(!pubkey.is_valid())
+            return error_code::key_loading_failed;
+
+        EVP_PKEY_CTX *ctx = _cached_ctx(pubkey, _op::verify, padding);
+        if(!ctx || EVP_PKEY_verify(ctx, sig, sig_len, msg, msg_len) != 1)
+        {
+            ERR_clear_error();
+            return error_code::verification_failed;
+        }
+        return error_code::ok;
+    }
+
+    // one message of sign_batch, dst_len and ec are written back
+    struct sign_item
+    {
+        unsigned char       *dst     = nullptr;
+        std::size_t          dst_len = 0;
+        const unsigned char *src     = nullptr;
+        std::size_t          src_len = 0;
+        error_code           ec      = error_code::ok;
+    };
+
+    // one message of verify_batch, ec is written back
+    struct verify_item
+    {
+        const unsigned char *msg     = nullptr;
+        std::size_t          msg_len = 0;
+        const unsigned char *sig     = nullptr;
+        std::size_t          sig_len = 0;
+        error_code           ec      = error_code::ok;
+    };
+
+    // Spread n items over the pool in contiguous slices, one per thread,
+    // every thread reuses its own cached contexts of the key. Without a
+    // pool the batch runs on a shared one of hardware_concurrency threads,
+    // created by the first such call and kept until exit.
+    //
+    // ok when every item succeeded, else the first failure in item order;
+    // each item keeps its own ec and the rest of the batch still runs
+    static error_code sign_batch(sign_item        *items,
+                                 const std::size_t n,
+                                 const key        &prikey,
+                                 const padding     padding = padding::pkcs1,
+                                 thread_pool      *pool    = nullptr)
+    {
+        return _run_batch(items, n, pool, [&](sign_item &it) {
+            it.ec = signature(it.dst,
+                              it.dst_len,
+                              it.src,
+                              it.src_len,
+                              prikey,
+                              padding);
+            return it.ec;
+        });
+    }
+
+    static error_code verify_batch(verify_item      *items,
+                                   const std::size_t n,
+                                   const key        &pubkey,
+                                   const padding     padding = padding::pkcs1,
+                                   thread_pool      *pool    = nullptr)
+    {
+        return _run_batch(items, n, pool, [&](verify_item &it) {
+            it.ec =
+                verify(it.msg, it.msg_len, it.sig, it.sig_len, pubkey, padding);
+            return it.ec;
+        });
+    }
+
     // generate rsa key pair
     static error_code keygen(unsigned char       *pubkey_pem,
                              std::size_t         &pubkey_pem_len,
@@ -967,6 +1239,141 @@ class rsa
     }
 
   private:
+    enum class _op
+    {
+        encrypt,
+        decrypt,
+        sign,
+        recover,
+        verify,
+    };
+
+    // Per thread cache of initialised EVP_PKEY_CTX, keyed by key id,
+    // operation and padding. A ctx holds a reference on its EVP_PKEY, so
+    // an entry of a dropped key stays valid until it is evicted or the
+    // thread exits.
+    static EVP_PKEY_CTX *
+    _cached_ctx(const key &k, const _op op, const padding pad)
+    {
+        struct slot
+        {
+            uint64_t      id  = 0;
+            _op           op  = _op::encrypt;
+            padding       pad = padding::pkcs1;
+            EVP_PKEY_CTX *ctx = nullptr;
+        };
+        struct cache
+        {
+            ~cache()
+            {
+                for(auto &s : slots)
+                    EVP_PKEY_CTX_free(s.ctx);
+            }
+
+            slot        slots[8];
+            std::size_t next = 0;
+        };
+        thread_local cache c;
+
+        for(auto &s : c.slots)
+            if(s.ctx && s.id == k.id() && s.op == op && s.pad == pad)
+                return s.ctx;
+
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(k.get(), nullptr);
+        if(!ctx)
+            return nullptr;
+
+        int ret = 0;
+        switch(op)
+        {
+            case _op::encrypt:
+                ret = EVP_PKEY_encrypt_init(ctx);
+                break;
+            case _op::decrypt:
+                ret = EVP_PKEY_decrypt_init(ctx);
+                break;
+            case _op::sign:
+                ret = EVP_PKEY_sign_init(ctx);
+                break;
+            case _op::recover:
+                ret = EVP_PKEY_verify_recover_init(ctx);
+                break;
+            case _op::verify:
+                ret = EVP_PKEY_verify_init(ctx);
+                break;
+        }
+        if(ret != 1
+           || EVP_PKEY_CTX_set_rsa_padding(ctx, static_cast<int>(pad)) != 1)
+        {
+            EVP_PKEY_CTX_free(ctx);
+            ERR_clear_error();
+            return nullptr;
+        }
+
+        slot &s = c.slots[c.next++ % (sizeof(c.slots) / sizeof(c.slots[0]))];
+        EVP_PKEY_CTX_free(s.ctx);
+        s.id  = k.id();
+        s.op  = op;
+        s.pad = pad;
+        s.ctx = ctx;
+        return ctx;
+    }
+
+    // spawning and joining threads per batch would cost more than a small
+    // batch of verifies, so callers without a pool share this one
+    static thread_pool &_batch_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    template <typename T, typename F>
+    static error_code
+    _run_batch(T *items, const std::size_t n, thread_pool *pool, F &&fn)
+    {
+        if(n == 0)
+            return error_code::ok;
+        if(!items)
+            return error_code::invalid_input;
+
+        if(pool == nullptr && n > 1)
+            pool = &_batch_pool();
+
+        auto run = [&](const std::size_t from, const std::size_t to) {
+            for(std::size_t i = from; i < to; ++i)
+                fn(items[i]);
+        };
+
+        std::size_t slices = pool ? std::min(pool->size(), n) : 1;
+        if(slices <= 1)
+        {
+            run(0, n);
+        } else
+        {
+            std::vector<std::future<void>> pending;
+            pending.reserve(slices);
+            for(std::size_t i = 0; i < slices; ++i)
+            {
+                std::size_t from = n * i / slices;
+                std::size_t to   = n * (i + 1) / slices;
+                auto        fut  = pool->enqueue([&run, from, to]() {
+                    run(from, to);
+                });
+                if(fut.valid())
+                    pending.push_back(std::move(fut));
+                else
+                    run(from, to); // pool stopped
+            }
+            for(auto &fut : pending)
+                fut.get();
+        }
+
+        for(std::size_t i = 0; i < n; ++i)
+            if(items[i].ec != error_code::ok)
+                return items[i].ec;
+        return error_code::ok;
+    }
+
     static RSA *_load_public_key(const unsigned char *pubkey_pem,
                                  const std::size_t    pubkey_pem_len)
     {
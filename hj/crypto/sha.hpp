@@ -38,6 +38,8 @@
 #include <array>
 #include <openssl/sha.h>
 
+#include <hj/crypto/digest.hpp>
+
 #ifndef SHA_BUF_SIZE
 #define SHA_BUF_SIZE 131072 // 128 KiB
 #endif
@@ -292,7 +294,184 @@ class sha
         return encode(dst, src, algorithm::sha512);
     }
 
+    // incremental sha on one reused context:
+    //     sha::hasher h(sha::algorithm::sha256);
+    //     h.update(part1); h.update(part2); h.finish(digest);
+    // finish() starts the next message, reset() drops the current one
+    class hasher
+    {
+      public:
+        explicit hasher(const algorithm algo = algorithm::sha256)
+            : _h{_md_name(algo)}
+            , _algo{algo}
+        {
+        }
+
+        inline bool      is_valid() const noexcept { return _h.is_valid(); }
+        inline algorithm algo() const noexcept { return _algo; }
+        inline void      reset() noexcept { _h.reset(); }
+
+        error_code update(const unsigned char *src, const std::size_t src_len)
+        {
+            if(!src && src_len > 0)
+                return error_code::invalid_input;
+
+            return _h.update(src, src_len) ? error_code::ok
+                                           : error_code::unknown;
+        }
+
+        error_code update(const std::string &src)
+        {
+            return update(reinterpret_cast<const unsigned char *>(src.data()),
+                          src.size());
+        }
+
+        error_code finish(unsigned char *dst, std::size_t &dst_len)
+        {
+            if(!dst)
+                return error_code::invalid_output;
+            if(dst_len < get_digest_length(_algo))
+                return error_code::buffer_too_small;
+
+            return _h.finish(dst, dst_len) ? error_code::ok
+                                           : error_code::unknown;
+        }
+
+        error_code finish(std::string &dst)
+        {
+            dst.resize(get_digest_length(_algo));
+            std::size_t len = dst.size();
+            auto ec = finish(reinterpret_cast<unsigned char *>(&dst[0]), len);
+            if(ec != error_code::ok)
+                dst.clear();
+            return ec;
+        }
+
+        template <std::size_t N>
+        error_code finish(hash_array<N> &dst)
+        {
+            std::size_t len = dst.size();
+            auto        ec  = finish(dst.data(), len);
+            if(ec != error_code::ok)
+                dst.fill(0);
+            return ec;
+        }
+
+      private:
+        digest_hasher _h;
+        algorithm     _algo;
+    };
+
+    // Hashes n small buffers at once, dst gets the n digests back to back
+    // (n * get_digest_length(algo) bytes). Every pool thread takes a
+    // contiguous slice with its own hasher; without a pool the caller
+    // hashes them all on one reused context. OpenSSL keeps its
+    // multi-buffer sha code internal to TLS, so threads are the batch
+    // path here.
+    static error_code hash_many(unsigned char              *dst,
+                                const std::size_t           dst_len,
+                                const unsigned char *const *src,
+                                const std::size_t          *src_len,
+                                const std::size_t           n,
+                                const algorithm  algo = algorithm::sha256,
+                                thread_pool     *pool = nullptr)
+    {
+        std::size_t md_len = get_digest_length(algo);
+        if(n == 0)
+            return error_code::ok;
+        if(!src || !src_len)
+            return error_code::invalid_input;
+        if(!dst)
+            return error_code::invalid_output;
+        if(dst_len < n * md_len)
+            return error_code::buffer_too_small;
+
+        return detail::digest_many(_md_name(algo),
+                                   dst,
+                                   md_len,
+                                   src,
+                                   src_len,
+                                   n,
+                                   pool)
+                   ? error_code::ok
+                   : error_code::unknown;
+    }
+
+    static error_code hash_many(std::vector<std::string>       &dst,
+                                const std::vector<std::string> &src,
+                                const algorithm  algo = algorithm::sha256,
+                                thread_pool     *pool = nullptr)
+    {
+        std::size_t                        md_len = get_digest_length(algo);
+        std::vector<const unsigned char *> ptrs(src.size());
+        std::vector<std::size_t>           lens(src.size());
+        for(std::size_t i = 0; i < src.size(); ++i)
+        {
+            ptrs[i] = reinterpret_cast<const unsigned char *>(src[i].data());
+            lens[i] = src[i].size();
+        }
+
+        std::string buf(src.size() * md_len, '\0');
+        auto        ec = hash_many(reinterpret_cast<unsigned char *>(&buf[0]),
+                            buf.size(),
+                            ptrs.data(),
+                            lens.data(),
+                            src.size(),
+                            algo,
+                            pool);
+        dst.clear();
+        if(ec != error_code::ok)
+            return ec;
+
+        dst.reserve(src.size());
+        for(std::size_t i = 0; i < src.size(); ++i)
+            dst.emplace_back(buf, i * md_len, md_len);
+        return error_code::ok;
+    }
+
+    // digest of a file, read in large aligned blocks (DIGEST_FILE_BUF_SIZE)
+    static error_code hash_file(std::string       &dst,
+                                const std::string &src_file_path,
+                                const algorithm    algo = algorithm::sha256)
+    {
+        digest_hasher           h(_md_name(algo));
+        detail::digest_file_buf buf;
+        return detail::digest_file(h, src_file_path.c_str(), buf, dst)
+                   ? error_code::ok
+                   : error_code::invalid_input;
+    }
+
+    // digests of many files, hashed concurrently on the pool (and the
+    // caller); one sha stream can not be split, so a single large file
+    // still runs on one thread. A failed file leaves dst[i] empty.
+    static error_code hash_files(std::vector<std::string>       &dst,
+                                 const std::vector<std::string> &src_file_paths,
+                                 const algorithm algo = algorithm::sha256,
+                                 thread_pool    *pool = nullptr)
+    {
+        return detail::digest_files(_md_name(algo), dst, src_file_paths, pool)
+                   ? error_code::ok
+                   : error_code::invalid_input;
+    }
+
   private:
+    static const char *_md_name(const algorithm algo)
+    {
+        switch(algo)
+        {
+            case algorithm::sha1:
+                return "SHA1";
+            case algorithm::sha224:
+                return "SHA224";
+            case algorithm::sha384:
+                return "SHA384";
+            case algorithm::sha512:
+                return "SHA512";
+            default:
+                return "SHA256";
+        }
+    }
+
     static bool _encode_stream_sha1(std::string &dst, std::istream &in)
     {
         SHA_CTX ctx;
@@ -29,6 +29,12 @@
 #include <vector>
 #include <type_traits>
 
+#include <hj/hardware/simd.h>
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+#endif
+
 #ifndef HEX_BUF_SZ
 #define HEX_BUF_SZ 4096
 #endif
@@ -118,6 +124,14 @@ class hex
     template <typename T = std::string>
     static T decode(const std::string &str)
     {
+        // clean input (even length, hex chars only) goes straight through
+        // decode_to, only the rest is filtered char by char
+        T           result{};
+        std::size_t len = str.length() / 2;
+        if(str.length() % 2 == 0
+           && _decode_fast(result, str, len, hex_detail::get_type_tag<T>()))
+            return result;
+
         std::string hex_str;
         hex_str.reserve(str.length());
 
@@ -163,6 +177,11 @@ class hex
     template <typename T>
     static std::string encode(const T &value, bool upper_case = true)
     {
+        std::string result;
+        auto        tag = hex_detail::get_type_tag<T>();
+        if(_encode_fast(result, value, upper_case, tag))
+            return result;
+
         std::ostringstream oss;
         oss << (upper_case ? std::uppercase : std::nouppercase) << std::hex;
 
@@ -194,6 +213,92 @@ class hex
         return encode(fout, fin);
     }
 
+    // bytes -> hex chars into the caller's buffer, no allocation and no
+    // terminating '\0'; dst_len in: capacity, out: chars written
+    // (src_len * 2). false when dst is too small, dst_len is then set to
+    // the size needed.
+    static bool encode_to(char                *dst,
+                          std::size_t         &dst_len,
+                          const unsigned char *src,
+                          const std::size_t    src_len,
+                          bool                 upper_case = true)
+    {
+        if(dst_len < src_len * 2)
+        {
+            dst_len = src_len * 2;
+            return false;
+        }
+
+        const char *digits = upper_case ? "0123456789ABCDEF"
+                                        : "0123456789abcdef";
+        std::size_t i      = 0;
+#if defined(SIMD_X86)
+        // the 16 byte kernel also takes what the 32 byte one leaves
+        if(_simd_level() >= 2)
+            i = _encode_avx2(dst, src, src_len, digits);
+        if(_simd_level() >= 1)
+            i += _encode_ssse3(dst + 2 * i, src + i, src_len - i, digits);
+#endif
+        for(; i < src_len; ++i)
+        {
+            dst[2 * i]     = digits[src[i] >> 4];
+            dst[2 * i + 1] = digits[src[i] & 0x0f];
+        }
+
+        dst_len = src_len * 2;
+        return true;
+    }
+
+    // hex chars -> bytes into the caller's buffer. Strict: src_len must be
+    // even and every char in [0-9a-fA-F], nothing is skipped or padded
+    // (decode() keeps doing that). dst_len in: capacity, out: bytes
+    // written. On a bad char or odd length returns false and sets err_pos
+    // (if given) to the offending index, src_len for a missing last char;
+    // when dst is too small returns false with dst_len set to the size
+    // needed and err_pos untouched.
+    static bool decode_to(unsigned char     *dst,
+                          std::size_t       &dst_len,
+                          const char        *src,
+                          const std::size_t  src_len,
+                          std::size_t       *err_pos = nullptr)
+    {
+        if(dst_len < src_len / 2)
+        {
+            dst_len = src_len / 2;
+            return false;
+        }
+
+        std::size_t i = 0;
+#if defined(SIMD_X86)
+        if(_simd_level() >= 2)
+            i = _decode_avx2(dst, src, src_len);
+        if(_simd_level() >= 1)
+            i += _decode_ssse3(dst + i / 2, src + i, src_len - i);
+#endif
+        // the kernels stop before the first block with a bad char
+        for(; i + 2 <= src_len; i += 2)
+        {
+            int high = _hex_char_to_value(src[i]);
+            int low  = _hex_char_to_value(src[i + 1]);
+            if(high < 0 || low < 0)
+            {
+                if(err_pos)
+                    *err_pos = high < 0 ? i : i + 1;
+                return false;
+            }
+            dst[i / 2] = static_cast<unsigned char>((high << 4) | low);
+        }
+        if(i < src_len)
+        {
+            if(err_pos)
+                *err_pos = _hex_char_to_value(src[i]) < 0 ? i : src_len;
+            return false;
+        }
+
+        dst_len = src_len / 2;
+        return true;
+    }
+
     static bool is_valid(const unsigned char *buf, const std::size_t len)
     {
         if(len == 0 || buf == nullptr)
@@ -388,6 +493,235 @@ class hex
         }
     }
 
+    static bool _encode_fast(std::string         &result,
+                             const std::string   &value,
+                             bool                 upper_case,
+                             hex_detail::string_tag)
+    {
+        std::size_t len = value.size() * 2;
+        result.resize(len);
+        return encode_to(&result[0],
+                         len,
+                         reinterpret_cast<const unsigned char *>(value.data()),
+                         value.size(),
+                         upper_case);
+    }
+
+    static bool _encode_fast(std::string                      &result,
+                             const std::vector<unsigned char> &value,
+                             bool                              upper_case,
+                             hex_detail::vector_tag)
+    {
+        std::size_t len = value.size() * 2;
+        result.resize(len);
+        return encode_to(&result[0],
+                         len,
+                         value.data(),
+                         value.size(),
+                         upper_case);
+    }
+
+    template <typename T, typename Tag>
+    static bool _encode_fast(std::string &, const T &, bool, Tag)
+    {
+        return false;
+    }
+
+    template <typename T>
+    static bool _decode_fast(T                 &result,
+                             const std::string &str,
+                             std::size_t        len,
+                             hex_detail::string_tag)
+    {
+        result.resize(len);
+        if(decode_to(reinterpret_cast<unsigned char *>(&result[0]),
+                     len,
+                     str.data(),
+                     str.size()))
+            return true;
+
+        result.clear();
+        return false;
+    }
+
+    template <typename T>
+    static bool _decode_fast(T                 &result,
+                             const std::string &str,
+                             std::size_t        len,
+                             hex_detail::vector_tag)
+    {
+        result.resize(len);
+        if(decode_to(result.data(), len, str.data(), str.size()))
+            return true;
+
+        result.clear();
+        return false;
+    }
+
+    template <typename T, typename Tag>
+    static bool _decode_fast(T &, const std::string &, std::size_t, Tag)
+    {
+        return false;
+    }
+
+    // 0: scalar, 1: ssse3 (checked as sse4.1), 2: avx2
+    static int _simd_level()
+    {
+        static const int level = simd_has_avx2()    ? 2
+                                 : simd_has_sse41() ? 1
+                                                    : 0;
+        return level;
+    }
+
+#if defined(SIMD_X86)
+    // pshufb looks up all 32 nibbles of 16 bytes at once, unpack puts the
+    // high nibble char before the low one
+    SIMD_TARGET("ssse3")
+    static std::size_t _encode_ssse3(char                *dst,
+                                     const unsigned char *src,
+                                     const std::size_t    len,
+                                     const char          *digits)
+    {
+        const __m128i lut =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits));
+        const __m128i mask = _mm_set1_epi8(0x0f);
+
+        std::size_t i = 0;
+        for(; i + 16 <= len; i += 16)
+        {
+            __m128i v  = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + i));
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+            __m128i lo = _mm_and_si128(v, mask);
+            hi         = _mm_shuffle_epi8(lut, hi);
+            lo         = _mm_shuffle_epi8(lut, lo);
+
+            __m128i *out = reinterpret_cast<__m128i *>(dst + 2 * i);
+            _mm_storeu_si128(out, _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(hi, lo));
+        }
+        return i;
+    }
+
+    SIMD_TARGET("avx2")
+    static std::size_t _encode_avx2(char                *dst,
+                                    const unsigned char *src,
+                                    const std::size_t    len,
+                                    const char          *digits)
+    {
+        const __m256i lut = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+
+        std::size_t i = 0;
+        for(; i + 32 <= len; i += 32)
+        {
+            __m256i v  = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(src + i));
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+            __m256i lo = _mm256_and_si256(v, mask);
+            hi         = _mm256_shuffle_epi8(lut, hi);
+            lo         = _mm256_shuffle_epi8(lut, lo);
+
+            // unpack works per 128-bit lane, put the halves back in order
+            __m256i a = _mm256_unpacklo_epi8(hi, lo);
+            __m256i b = _mm256_unpackhi_epi8(hi, lo);
+
+            __m256i *out = reinterpret_cast<__m256i *>(dst + 2 * i);
+            _mm256_storeu_si256(out, _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(out + 1,
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+        return i;
+    }
+
+    // nibble values of 16 chars, false if any of them is not hex:
+    // '0'-'9' -> c - '0', 'a'-'f' / 'A'-'F' -> (c | 0x20) - 'a' + 10
+    SIMD_TARGET("ssse3")
+    static inline bool _nibbles_ssse3(__m128i c, __m128i &v)
+    {
+        __m128i l    = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        __m128i d    = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i a    = _mm_sub_epi8(l, _mm_set1_epi8('a'));
+        __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+        __m128i is_a = _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+        if(_mm_movemask_epi8(_mm_or_si128(is_d, is_a)) != 0xffff)
+            return false;
+
+        a = _mm_add_epi8(a, _mm_set1_epi8(10));
+        v = _mm_or_si128(_mm_and_si128(is_d, d), _mm_andnot_si128(is_d, a));
+        return true;
+    }
+
+    // maddubs folds every (high, low) nibble pair into high * 16 + low
+    SIMD_TARGET("ssse3")
+    static std::size_t
+    _decode_ssse3(unsigned char *dst, const char *src, const std::size_t len)
+    {
+        const __m128i mul = _mm_set1_epi16(0x0110);
+
+        std::size_t i = 0;
+        for(; i + 32 <= len; i += 32)
+        {
+            __m128i v0, v1;
+            const __m128i *in = reinterpret_cast<const __m128i *>(src + i);
+            if(!_nibbles_ssse3(_mm_loadu_si128(in), v0)
+               || !_nibbles_ssse3(_mm_loadu_si128(in + 1), v1))
+                break;
+
+            v0 = _mm_maddubs_epi16(v0, mul);
+            v1 = _mm_maddubs_epi16(v1, mul);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i / 2),
+                             _mm_packus_epi16(v0, v1));
+        }
+        return i;
+    }
+
+    SIMD_TARGET("avx2")
+    static inline bool _nibbles_avx2(__m256i c, __m256i &v)
+    {
+        __m256i l    = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+        __m256i d    = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i a    = _mm256_sub_epi8(l, _mm256_set1_epi8('a'));
+        __m256i is_d = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+        __m256i is_a = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+        if(_mm256_movemask_epi8(_mm256_or_si256(is_d, is_a)) != -1)
+            return false;
+
+        a = _mm256_add_epi8(a, _mm256_set1_epi8(10));
+        v = _mm256_or_si256(_mm256_and_si256(is_d, d),
+                            _mm256_andnot_si256(is_d, a));
+        return true;
+    }
+
+    SIMD_TARGET("avx2")
+    static std::size_t
+    _decode_avx2(unsigned char *dst, const char *src, const std::size_t len)
+    {
+        const __m256i mul = _mm256_set1_epi16(0x0110);
+
+        std::size_t i = 0;
+        for(; i + 64 <= len; i += 64)
+        {
+            __m256i v0, v1;
+            const __m256i *in = reinterpret_cast<const __m256i *>(src + i);
+            if(!_nibbles_avx2(_mm256_loadu_si256(in), v0)
+               || !_nibbles_avx2(_mm256_loadu_si256(in + 1), v1))
+                break;
+
+            // packus works per 128-bit lane as well
+            v0 = _mm256_maddubs_epi16(v0, mul);
+            v1 = _mm256_maddubs_epi16(v1, mul);
+            __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v0, v1),
+                                                 0xd8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 2), v);
+        }
+        return i;
+    }
+#endif
+
     static int _hex_char_to_value(char c)
     {
         if(c >= '0' && c <= '9')
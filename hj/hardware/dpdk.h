@@ -18,6 +18,29 @@
 #ifndef DPDK_H
 #define DPDK_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu.h"
+
+#if defined(__linux__)
+#define PKT_PLATFORM_LINUX 1
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#endif
+
 #ifdef DPDK_ENABLE
 
 #ifdef __cplusplus
@@ -28,6 +51,7 @@ extern "C" {
 #include <rte_eal.h>
 #include <rte_ethdev.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
 
 #ifdef __cplusplus
 }
@@ -35,4 +59,778 @@ extern "C" {
 
 #endif // DPDK_ENABLE
 
-#endif
\ No newline at end of file
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packet ring I/O
+ *
+ * Batched rx/tx on one NIC queue without a syscall per packet. Received
+ * packets are handed out as views into the ring (no copy), the caller
+ * gives the ring back with pkt_rx_release() once it is done with them.
+ *
+ * Backends:
+ *   PKT_BACKEND_AF_PACKET  TPACKET_V3 rings mmapped from an AF_PACKET
+ *                          socket, works on any linux interface (veth, lo,
+ *                          real NICs), needs CAP_NET_RAW
+ *   PKT_BACKEND_DPDK       rte_eth_rx_burst/rte_eth_tx_burst on a port the
+ *                          caller already configured and started, only
+ *                          with DPDK_ENABLE
+ *
+ * A queue is not thread safe, give every polling thread its own queue
+ * (same fanout_group to spread one interface over several of them) and
+ * call pkt_queue_bind_core() from that thread.
+ */
+
+#define PKT_MAX_BURST 256
+
+/* ------------------------ Error Codes ------------------------ */
+typedef enum
+{
+    PKT_OK                = 0,
+    PKT_ERR_INVALID_ARG   = -1,
+    PKT_ERR_NOT_SUPPORTED = -2,
+    PKT_ERR_PERMISSION    = -3,
+    PKT_ERR_SYSTEM        = -4,
+    PKT_ERR_ALLOC         = -5,
+    PKT_ERR_AGAIN         = -6
+} pkt_error_t;
+
+/* ------------------------ Backends ------------------------ */
+typedef enum
+{
+    PKT_BACKEND_AF_PACKET = 0,
+    PKT_BACKEND_DPDK      = 1
+} pkt_backend_t;
+
+/* ------------------------ Structures ------------------------ */
+typedef struct
+{
+    pkt_backend_t backend;
+    const char   *ifname;           /* AF_PACKET: interface, e.g. "eth0" */
+    uint32_t      block_size;       /* AF_PACKET: rx block, page multiple */
+    uint32_t      block_count;      /* AF_PACKET: rx blocks, 0 = no rx */
+    uint32_t      frame_size;       /* AF_PACKET: tx frame (incl. header) */
+    uint32_t      tx_frame_count;   /* AF_PACKET: tx frames, 0 = no tx */
+    uint32_t      block_timeout_ms; /* AF_PACKET: retire partial blocks */
+    int           fanout_group;     /* AF_PACKET: hash fanout, <0 = off */
+    bool          promisc;          /* AF_PACKET: promiscuous mode */
+    bool          qdisc_bypass;     /* AF_PACKET: tx skips the qdisc */
+    bool          ignore_outgoing;  /* AF_PACKET: rx skips own tx */
+    uint16_t      port_id;          /* DPDK: started ethdev port */
+    uint16_t      queue_id;         /* DPDK: rx/tx queue of port_id */
+    void         *mempool;          /* DPDK: rte_mempool for tx */
+    int           cpu_core;         /* pkt_queue_bind_core(), <0 = none */
+    bool          hw_timestamp;     /* ask for NIC timestamps */
+} pkt_queue_conf_t;
+
+typedef struct
+{
+    const uint8_t *data;     /* frame from the L2 header, inside the ring */
+    uint32_t       len;      /* captured bytes at data */
+    uint32_t       wire_len; /* bytes on the wire */
+    uint64_t       ts_ns;    /* rx timestamp, 0 if none */
+    bool           ts_hw;    /* ts_ns comes from the NIC clock */
+} pkt_view_t;
+
+typedef struct
+{
+    pkt_backend_t backend;
+    int           cpu_core;
+    bool          hw_timestamp; /* NIC stamps were turned on */
+
+#if defined(PKT_PLATFORM_LINUX)
+    int      fd;
+    uint8_t *map;
+    size_t   map_size;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t rx_block;   /* next block to walk */
+    uint32_t rx_left;    /* packets left in the walked block */
+    uint8_t *rx_next;    /* next packet in the walked block */
+    uint32_t rx_held;    /* walked blocks not released yet */
+    uint8_t *tx_ring;
+    uint32_t frame_size;
+    uint32_t tx_frame_count;
+    uint32_t tx_head;    /* next frame to fill */
+    uint32_t tx_pending; /* filled frames not kicked yet */
+#endif
+
+#ifdef DPDK_ENABLE
+    uint16_t            port_id;
+    uint16_t            queue_id;
+    struct rte_mempool *mempool;
+    struct rte_mbuf    *rx_mbufs[PKT_MAX_BURST];
+    uint16_t            rx_mbuf_count;
+    struct rte_mbuf    *tx_mbufs[PKT_MAX_BURST];
+    uint16_t            tx_mbuf_count;
+    struct rte_mbuf    *tx_open; /* handed out by pkt_tx_frame, uncommitted */
+    int                 ts_offset;
+    uint64_t            ts_flag;
+#endif
+} pkt_queue_t;
+
+/* ------------------------ Packet Ring API ------------------------ */
+inline void pkt_queue_conf_default(pkt_queue_conf_t *conf)
+{
+    if(conf == NULL)
+        return;
+
+    memset(conf, 0, sizeof(*conf));
+    conf->backend          = PKT_BACKEND_AF_PACKET;
+    conf->block_size       = 1 << 20;
+    conf->block_count      = 64;
+    conf->frame_size       = 2048;
+    conf->tx_frame_count   = 1024;
+    conf->block_timeout_ms = 1;
+    conf->fanout_group     = -1;
+    conf->ignore_outgoing  = true;
+    conf->cpu_core         = -1;
+}
+
+#if defined(PKT_PLATFORM_LINUX)
+/* offset of the payload in a tx frame (TPACKET_V3 without PACKET_TX_HAS_OFF) */
+#define PKT_TX_DATA_OFFSET (TPACKET3_HDRLEN - sizeof(struct sockaddr_ll))
+
+inline pkt_error_t _pkt_errno()
+{
+    return (errno == EPERM || errno == EACCES) ? PKT_ERR_PERMISSION
+                                               : PKT_ERR_SYSTEM;
+}
+
+/* NIC stamping is per device, SIOCSHWTSTAMP fails on most virtual ones */
+inline bool _pkt_enable_hw_timestamp(int fd, const char *ifname)
+{
+    struct hwtstamp_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.tx_type   = HWTSTAMP_TX_OFF;
+    cfg.rx_filter = HWTSTAMP_FILTER_ALL;
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    ifr.ifr_data = (char *) &cfg;
+    if(ioctl(fd, SIOCSHWTSTAMP, &ifr) != 0)
+        return false;
+
+    int req = SOF_TIMESTAMPING_RAW_HARDWARE;
+    return setsockopt(fd, SOL_PACKET, PACKET_TIMESTAMP, &req, sizeof(req))
+           == 0;
+}
+
+inline pkt_error_t _pkt_af_packet_open(pkt_queue_t            *q,
+                                       const pkt_queue_conf_t *conf)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    if(conf->ifname == NULL || conf->ifname[0] == '\0'
+       || (conf->block_count == 0 && conf->tx_frame_count == 0))
+        return PKT_ERR_INVALID_ARG;
+    if(conf->block_count > 0
+       && (conf->block_size == 0 || conf->block_size % page != 0))
+        return PKT_ERR_INVALID_ARG;
+    if(conf->tx_frame_count > 0
+       && (conf->frame_size <= PKT_TX_DATA_OFFSET
+           || conf->frame_size % TPACKET_ALIGNMENT != 0))
+        return PKT_ERR_INVALID_ARG;
+
+    int ifindex = (int) if_nametoindex(conf->ifname);
+    if(ifindex == 0)
+        return PKT_ERR_INVALID_ARG;
+
+    q->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if(q->fd < 0)
+        return _pkt_errno();
+
+    int ver = TPACKET_V3;
+    if(setsockopt(q->fd, SOL_PACKET, PACKET_VERSION, &ver, sizeof(ver)) != 0)
+        return PKT_ERR_NOT_SUPPORTED;
+
+    if(conf->hw_timestamp)
+        q->hw_timestamp = _pkt_enable_hw_timestamp(q->fd, conf->ifname);
+
+    size_t rx_size = 0;
+    if(conf->block_count > 0)
+    {
+        struct tpacket_req3 req;
+        memset(&req, 0, sizeof(req));
+        req.tp_block_size       = conf->block_size;
+        req.tp_block_nr         = conf->block_count;
+        req.tp_frame_size       = TPACKET_ALIGNMENT << 7;
+        req.tp_frame_nr         = (conf->block_size / req.tp_frame_size)
+                                  * conf->block_count;
+        req.tp_retire_blk_tov   = conf->block_timeout_ms;
+        req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+        if(setsockopt(q->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))
+           != 0)
+            return _pkt_errno();
+
+        q->block_size  = conf->block_size;
+        q->block_count = conf->block_count;
+        rx_size        = (size_t) conf->block_size * conf->block_count;
+    }
+
+    size_t tx_size = 0;
+    if(conf->tx_frame_count > 0)
+    {
+        /* small blocks keep the frame count close to the asked one */
+        uint32_t block =
+            (conf->frame_size + (uint32_t) page - 1) / page * page;
+        uint32_t per_block = block / conf->frame_size;
+        uint32_t blocks =
+            (conf->tx_frame_count + per_block - 1) / per_block;
+
+        struct tpacket_req3 req;
+        memset(&req, 0, sizeof(req));
+        req.tp_block_size = block;
+        req.tp_block_nr   = blocks;
+        req.tp_frame_size = conf->frame_size;
+        req.tp_frame_nr   = blocks * per_block;
+        if(setsockopt(q->fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req))
+           != 0)
+            return _pkt_errno();
+
+        q->frame_size     = conf->frame_size;
+        q->tx_frame_count = req.tp_frame_nr;
+        tx_size           = (size_t) block * blocks;
+    }
+
+    /* the kernel maps the rx ring first, the tx ring right after it */
+    void *map = mmap(NULL,
+                     rx_size + tx_size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     q->fd,
+                     0);
+    if(map == MAP_FAILED)
+        return PKT_ERR_ALLOC;
+
+    q->map      = (uint8_t *) map;
+    q->map_size = rx_size + tx_size;
+    q->tx_ring  = tx_size > 0 ? q->map + rx_size : NULL;
+
+    int one = 1;
+    if(conf->qdisc_bypass)
+        setsockopt(q->fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one));
+    if(conf->ignore_outgoing)
+        setsockopt(q->fd,
+                   SOL_PACKET,
+                   PACKET_IGNORE_OUTGOING,
+                   &one,
+                   sizeof(one));
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family   = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex  = ifindex;
+    if(bind(q->fd, (struct sockaddr *) &addr, sizeof(addr)) != 0)
+        return _pkt_errno();
+
+    if(conf->promisc)
+    {
+        struct packet_mreq mreq;
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.mr_ifindex = ifindex;
+        mreq.mr_type    = PACKET_MR_PROMISC;
+        if(setsockopt(q->fd,
+                      SOL_PACKET,
+                      PACKET_ADD_MEMBERSHIP,
+                      &mreq,
+                      sizeof(mreq))
+           != 0)
+            return _pkt_errno();
+    }
+
+    if(conf->fanout_group >= 0)
+    {
+        int arg = (conf->fanout_group & 0xffff) | (PACKET_FANOUT_HASH << 16);
+        if(setsockopt(q->fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg))
+           != 0)
+            return _pkt_errno();
+    }
+    return PKT_OK;
+}
+
+inline struct tpacket_block_desc *_pkt_block(pkt_queue_t *q, uint32_t idx)
+{
+    return (struct tpacket_block_desc *) (q->map
+                                          + (size_t) idx * q->block_size);
+}
+
+inline bool _pkt_block_ready(struct tpacket_block_desc *bd)
+{
+    return (__atomic_load_n(&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE)
+            & TP_STATUS_USER)
+           != 0;
+}
+
+inline uint8_t *_pkt_tx_frame(pkt_queue_t *q, uint32_t idx)
+{
+    return q->tx_ring + (size_t) idx * q->frame_size;
+}
+
+/* a frame is free once the kernel sent it (or refused its format) */
+inline bool _pkt_tx_free(struct tpacket3_hdr *hdr)
+{
+    uint32_t st = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+    return st == TP_STATUS_AVAILABLE || (st & TP_STATUS_WRONG_FORMAT) != 0;
+}
+#endif // PKT_PLATFORM_LINUX
+
+inline void pkt_queue_close(pkt_queue_t *q)
+{
+    if(q == NULL)
+        return;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->map != NULL)
+            munmap(q->map, q->map_size);
+        if(q->fd >= 0)
+            close(q->fd);
+        q->map = NULL;
+        q->fd  = -1;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        for(uint16_t i = 0; i < q->rx_mbuf_count; ++i)
+            rte_pktmbuf_free(q->rx_mbufs[i]);
+        for(uint16_t i = 0; i < q->tx_mbuf_count; ++i)
+            rte_pktmbuf_free(q->tx_mbufs[i]);
+        if(q->tx_open != NULL)
+            rte_pktmbuf_free(q->tx_open);
+        q->rx_mbuf_count = 0;
+        q->tx_mbuf_count = 0;
+        q->tx_open       = NULL;
+    }
+#endif
+}
+
+inline pkt_error_t pkt_queue_open(pkt_queue_t *q, const pkt_queue_conf_t *conf)
+{
+    if(q == NULL || conf == NULL)
+        return PKT_ERR_INVALID_ARG;
+
+    memset(q, 0, sizeof(*q));
+    q->backend  = conf->backend;
+    q->cpu_core = conf->cpu_core;
+#if defined(PKT_PLATFORM_LINUX)
+    q->fd = -1;
+#endif
+
+    pkt_error_t err = PKT_ERR_NOT_SUPPORTED;
+    if(conf->backend == PKT_BACKEND_AF_PACKET)
+    {
+#if defined(PKT_PLATFORM_LINUX)
+        err = _pkt_af_packet_open(q, conf);
+#endif
+    } else if(conf->backend == PKT_BACKEND_DPDK)
+    {
+#ifdef DPDK_ENABLE
+        err = PKT_ERR_INVALID_ARG;
+        if(rte_eth_dev_is_valid_port(conf->port_id))
+        {
+            q->port_id  = conf->port_id;
+            q->queue_id = conf->queue_id;
+            q->mempool  = (struct rte_mempool *) conf->mempool;
+            if(conf->hw_timestamp)
+                q->hw_timestamp =
+                    rte_mbuf_dyn_rx_timestamp_register(&q->ts_offset,
+                                                       &q->ts_flag)
+                    == 0;
+            err = PKT_OK;
+        }
+#endif
+    } else
+    {
+        err = PKT_ERR_INVALID_ARG;
+    }
+
+    if(err != PKT_OK)
+        pkt_queue_close(q);
+    return err;
+}
+
+/* pins the calling thread to conf->cpu_core, call it from the poller */
+inline pkt_error_t pkt_queue_bind_core(const pkt_queue_t *q)
+{
+    if(q == NULL)
+        return PKT_ERR_INVALID_ARG;
+    if(q->cpu_core < 0)
+        return PKT_OK;
+
+    return cpu_core_bind((unsigned int) q->cpu_core) == CPU_OK
+               ? PKT_OK
+               : PKT_ERR_SYSTEM;
+}
+
+/*
+ * Up to max views of received packets, 0 when nothing is ready. The views
+ * stay valid until pkt_rx_release(), rx_burst can be called several times
+ * before that but the ring fills up while packets are held.
+ */
+inline uint32_t pkt_rx_burst(pkt_queue_t *q, pkt_view_t *pkts, uint32_t max)
+{
+    if(q == NULL || pkts == NULL)
+        return 0;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->block_count == 0)
+            return 0;
+
+        uint32_t n = 0;
+        while(n < max)
+        {
+            if(q->rx_left == 0)
+            {
+                /* the whole ring is walked and held */
+                if(q->rx_held == q->block_count)
+                    break;
+
+                struct tpacket_block_desc *bd = _pkt_block(q, q->rx_block);
+                if(!_pkt_block_ready(bd))
+                    break;
+
+                q->rx_left  = bd->hdr.bh1.num_pkts;
+                q->rx_next  = (uint8_t *) bd + bd->hdr.bh1.offset_to_first_pkt;
+                q->rx_block = (q->rx_block + 1) % q->block_count;
+                q->rx_held++;
+                continue;
+            }
+
+            struct tpacket3_hdr *hdr = (struct tpacket3_hdr *) q->rx_next;
+            pkts[n].data             = q->rx_next + hdr->tp_mac;
+            pkts[n].len              = hdr->tp_snaplen;
+            pkts[n].wire_len         = hdr->tp_len;
+            pkts[n].ts_ns = (uint64_t) hdr->tp_sec * 1000000000ULL
+                            + hdr->tp_nsec;
+            pkts[n].ts_hw = (hdr->tp_status & TP_STATUS_TS_RAW_HARDWARE) != 0;
+            ++n;
+
+            q->rx_next += hdr->tp_next_offset;
+            q->rx_left--;
+        }
+        return n;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        uint16_t room = PKT_MAX_BURST - q->rx_mbuf_count;
+        uint16_t want = max < room ? (uint16_t) max : room;
+        uint16_t got  = rte_eth_rx_burst(q->port_id,
+                                        q->queue_id,
+                                        q->rx_mbufs + q->rx_mbuf_count,
+                                        want);
+        for(uint16_t i = 0; i < got; ++i)
+        {
+            struct rte_mbuf *m = q->rx_mbufs[q->rx_mbuf_count + i];
+            pkts[i].data       = rte_pktmbuf_mtod(m, const uint8_t *);
+            pkts[i].len        = rte_pktmbuf_data_len(m);
+            pkts[i].wire_len   = rte_pktmbuf_pkt_len(m);
+            pkts[i].ts_ns      = 0;
+            pkts[i].ts_hw      = false;
+            if(q->hw_timestamp && (m->ol_flags & q->ts_flag))
+            {
+                /* NIC clock ticks, not necessarily nanoseconds */
+                pkts[i].ts_ns = *RTE_MBUF_DYNFIELD(m,
+                                                   q->ts_offset,
+                                                   rte_mbuf_timestamp_t *);
+                pkts[i].ts_hw = true;
+            }
+        }
+        q->rx_mbuf_count += got;
+        return got;
+    }
+#endif
+
+    (void) max;
+    return 0;
+}
+
+/* gives every packet returned by pkt_rx_burst() so far back to the ring */
+inline void pkt_rx_release(pkt_queue_t *q)
+{
+    if(q == NULL)
+        return;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        /* the block being walked stays held until it is exhausted */
+        uint32_t done = q->rx_left > 0 ? q->rx_held - 1 : q->rx_held;
+        uint32_t idx  = (q->rx_block + q->block_count - q->rx_held)
+                       % q->block_count;
+        for(uint32_t i = 0; i < done; ++i)
+        {
+            struct tpacket_block_desc *bd = _pkt_block(q, idx);
+            __atomic_store_n(&bd->hdr.bh1.block_status,
+                             TP_STATUS_KERNEL,
+                             __ATOMIC_RELEASE);
+            idx = (idx + 1) % q->block_count;
+        }
+        q->rx_held -= done;
+        return;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        for(uint16_t i = 0; i < q->rx_mbuf_count; ++i)
+            rte_pktmbuf_free(q->rx_mbufs[i]);
+        q->rx_mbuf_count = 0;
+    }
+#endif
+}
+
+/*
+ * Next free tx frame to build a packet in place, NULL when the ring is
+ * full; cap receives its capacity. pkt_tx_commit() queues it and
+ * pkt_tx_flush() hands all committed frames to the NIC at once. Until it
+ * is committed the same frame is returned again.
+ */
+inline uint8_t *pkt_tx_frame(pkt_queue_t *q, uint32_t *cap)
+{
+    if(q == NULL)
+        return NULL;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->tx_frame_count == 0)
+            return NULL;
+
+        uint8_t *frame = _pkt_tx_frame(q, q->tx_head);
+        if(!_pkt_tx_free((struct tpacket3_hdr *) frame))
+            return NULL;
+
+        if(cap != NULL)
+            *cap = q->frame_size - (uint32_t) PKT_TX_DATA_OFFSET;
+        return frame + PKT_TX_DATA_OFFSET;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        if(q->mempool == NULL || q->tx_mbuf_count == PKT_MAX_BURST)
+            return NULL;
+
+        /* a frame asked for again without a commit is handed out again */
+        if(q->tx_open == NULL)
+            q->tx_open = rte_pktmbuf_alloc(q->mempool);
+        struct rte_mbuf *m = q->tx_open;
+        if(m == NULL)
+            return NULL;
+
+        if(cap != NULL)
+            *cap = rte_pktmbuf_tailroom(m);
+        return rte_pktmbuf_mtod(m, uint8_t *);
+    }
+#endif
+
+    (void) cap;
+    return NULL;
+}
+
+inline pkt_error_t pkt_tx_commit(pkt_queue_t *q, uint32_t len)
+{
+    if(q == NULL || len == 0)
+        return PKT_ERR_INVALID_ARG;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->tx_frame_count == 0
+           || len > q->frame_size - (uint32_t) PKT_TX_DATA_OFFSET)
+            return PKT_ERR_INVALID_ARG;
+
+        struct tpacket3_hdr *hdr =
+            (struct tpacket3_hdr *) _pkt_tx_frame(q, q->tx_head);
+        if(!_pkt_tx_free(hdr))
+            return PKT_ERR_AGAIN;
+
+        hdr->tp_next_offset = 0;
+        hdr->tp_len         = len;
+        hdr->tp_snaplen     = len;
+        __atomic_store_n(&hdr->tp_status,
+                         TP_STATUS_SEND_REQUEST,
+                         __ATOMIC_RELEASE);
+        q->tx_head = (q->tx_head + 1) % q->tx_frame_count;
+        q->tx_pending++;
+        return PKT_OK;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        /* a rejected length keeps the mbuf open for the next frame */
+        struct rte_mbuf *m = q->tx_open;
+        if(m == NULL || len > rte_pktmbuf_tailroom(m)
+           || rte_pktmbuf_append(m, (uint16_t) len) == NULL)
+            return PKT_ERR_INVALID_ARG;
+
+        q->tx_mbufs[q->tx_mbuf_count++] = m;
+        q->tx_open                      = NULL;
+        return PKT_OK;
+    }
+#endif
+
+    return PKT_ERR_NOT_SUPPORTED;
+}
+
+/* committed frames the NIC accepted, the rest stays queued */
+inline uint32_t pkt_tx_flush(pkt_queue_t *q)
+{
+    if(q == NULL)
+        return 0;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->tx_pending == 0)
+            return 0;
+
+        /* one syscall for the whole batch */
+        if(sendto(q->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0
+           && errno != EAGAIN && errno != ENOBUFS)
+            return 0;
+
+        uint32_t n    = q->tx_pending;
+        q->tx_pending = 0;
+        return n;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        uint16_t sent = rte_eth_tx_burst(q->port_id,
+                                         q->queue_id,
+                                         q->tx_mbufs,
+                                         q->tx_mbuf_count);
+        memmove(q->tx_mbufs,
+                q->tx_mbufs + sent,
+                (q->tx_mbuf_count - sent) * sizeof(q->tx_mbufs[0]));
+        q->tx_mbuf_count -= sent;
+        return sent;
+    }
+#endif
+
+    return 0;
+}
+
+/* copies up to n packets into tx frames and flushes them, returns queued */
+inline uint32_t
+pkt_tx_burst(pkt_queue_t *q, const pkt_view_t *pkts, uint32_t n)
+{
+    if(q == NULL || pkts == NULL)
+        return 0;
+
+    uint32_t queued = 0;
+    for(; queued < n; ++queued)
+    {
+        uint32_t cap   = 0;
+        uint8_t *frame = pkt_tx_frame(q, &cap);
+        if(frame == NULL || pkts[queued].len > cap)
+            break;
+
+        memcpy(frame, pkts[queued].data, pkts[queued].len);
+        if(pkt_tx_commit(q, pkts[queued].len) != PKT_OK)
+            break;
+    }
+    pkt_tx_flush(q);
+    return queued;
+}
+
+/*
+ * waits up to timeout_ms (-1 = forever) for rx, PKT_ERR_AGAIN on timeout
+ * or while every block is held, pkt_rx_release() must run first
+ */
+inline pkt_error_t pkt_poll(pkt_queue_t *q, int timeout_ms)
+{
+    if(q == NULL)
+        return PKT_ERR_INVALID_ARG;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        if(q->block_count == 0)
+            return PKT_ERR_INVALID_ARG;
+        if(q->rx_left > 0)
+            return PKT_OK;
+
+        /* every block is walked and held, nothing new until a release */
+        if(q->rx_held == q->block_count)
+            return PKT_ERR_AGAIN;
+        if(_pkt_block_ready(_pkt_block(q, q->rx_block)))
+            return PKT_OK;
+
+        struct pollfd pfd;
+        pfd.fd      = q->fd;
+        pfd.events  = POLLIN | POLLERR;
+        pfd.revents = 0;
+        int ret     = poll(&pfd, 1, timeout_ms);
+        if(ret < 0)
+            return errno == EINTR ? PKT_ERR_AGAIN : PKT_ERR_SYSTEM;
+        return ret == 0 ? PKT_ERR_AGAIN : PKT_OK;
+    }
+#endif
+
+    /* DPDK queues are polled, there is nothing to sleep on */
+    (void) timeout_ms;
+    return q->backend == PKT_BACKEND_DPDK ? PKT_OK : PKT_ERR_NOT_SUPPORTED;
+}
+
+/* AF_PACKET counters restart on every call, DPDK ones are cumulative */
+inline pkt_error_t
+pkt_queue_stats(pkt_queue_t *q, uint64_t *packets, uint64_t *drops)
+{
+    if(q == NULL || packets == NULL || drops == NULL)
+        return PKT_ERR_INVALID_ARG;
+
+#if defined(PKT_PLATFORM_LINUX)
+    if(q->backend == PKT_BACKEND_AF_PACKET)
+    {
+        struct tpacket_stats_v3 st;
+        socklen_t               len = sizeof(st);
+        if(getsockopt(q->fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) != 0)
+            return PKT_ERR_SYSTEM;
+
+        *packets = st.tp_packets;
+        *drops   = st.tp_drops;
+        return PKT_OK;
+    }
+#endif
+
+#ifdef DPDK_ENABLE
+    if(q->backend == PKT_BACKEND_DPDK)
+    {
+        struct rte_eth_stats st;
+        if(rte_eth_stats_get(q->port_id, &st) != 0)
+            return PKT_ERR_SYSTEM;
+
+        *packets = st.ipackets;
+        *drops   = st.imissed;
+        return PKT_OK;
+    }
+#endif
+
+    return PKT_ERR_NOT_SUPPORTED;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
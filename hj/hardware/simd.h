@@ -31,6 +31,26 @@
 #define SIMD_AVX
 #endif
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)               \
+    || defined(_M_IX86)
+#define SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON
+#endif
+
+// kernels built for a wider instruction set than the compiler flags allow,
+// only call them after the matching simd_has_xxx() check
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -103,6 +123,73 @@ inline float simd_dot_f32(const float *a, const float *b, size_t n)
     return result;
 }
 
+// runtime cpu feature checks (cpu and os support), 1 when available
+inline int simd_has_sse41(void)
+{
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("sse4.1") ? 1 : 0;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 19) & 1;
+#else
+    return 0;
+#endif
+}
+
+inline int simd_has_sse42(void)
+{
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("sse4.2") ? 1 : 0;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 20) & 1;
+#else
+    return 0;
+#endif
+}
+
+inline int simd_has_pclmul(void)
+{
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("pclmul") ? 1 : 0;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 1) & 1;
+#else
+    return 0;
+#endif
+}
+
+inline int simd_has_avx2(void)
+{
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2") ? 1 : 0;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    // avx registers must be enabled by the os (osxsave + xcr0)
+    if(((info[2] >> 27) & 1) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+        return 0;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    return 0;
+#endif
+}
+
+inline int simd_has_neon(void)
+{
+#if defined(SIMD_NEON)
+    return 1; // mandatory on aarch64
+#else
+    return 0;
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -150,6 +150,46 @@ class chain_buffer
         return consumed;
     }
 
+    // Detach the oldest block holding unread bytes so it can be handed to
+    // another owner (e.g. a zmq frame) without a copy. The unread bytes
+    // start at blk.data() + offset. Returns false when the buffer is empty.
+    bool pop_block(std::vector<uint8_t> &blk, size_t &offset)
+    {
+        if(_total_size == 0)
+            return false;
+
+        while(_read_pos >= _blocks[_read_block].size())
+        {
+            ++_read_block;
+            _read_pos = 0;
+        }
+
+        blk    = std::move(_blocks[_read_block]);
+        offset = _read_pos;
+        _total_size -= blk.size() - offset;
+        _blocks.erase(_blocks.begin(), _blocks.begin() + _read_block + 1);
+        _read_block = 0;
+        _read_pos   = 0;
+        if(_blocks.empty())
+        {
+            _blocks.emplace_back();
+            _blocks.back().reserve(_block_size);
+        }
+        return true;
+    }
+
+    // Give back the block just taken by pop_block when it was not handed
+    // over; it becomes the oldest block again, unread bytes at offset.
+    void unpop_block(std::vector<uint8_t> &&blk, size_t offset)
+    {
+        if(offset >= blk.size())
+            return;
+
+        _total_size += blk.size() - offset;
+        _blocks.insert(_blocks.begin() + _read_block, std::move(blk));
+        _read_pos = offset;
+    }
+
     // Clear the buffer
     void clear()
     {
@@ -3,6 +3,8 @@
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/impl/service_type.h>
+#include <grpcpp/support/async_stream.h>
+#include <grpcpp/support/async_unary_call.h>
 #include <string>
 #include <memory>
 #include <functional>
@@ -10,6 +12,15 @@
 #include <atomic>
 #include <condition_variable>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <vector>
 
 namespace hj
 {
@@ -86,6 +97,733 @@ class grpc_server
     std::atomic<bool>                            _shutdown_requested;
 };
 
+struct grpc_async_server_options
+{
+    // completion queues, each drained by its own thread
+    std::size_t cq_num = std::max(1u, std::thread::hardware_concurrency());
+    // call objects armed per method and queue; bounds the calls in flight
+    std::size_t calls_per_cq = 16;
+    // serve the service's callback API on grpc's own threads, no queues
+    bool callback = false;
+    // in-flight calls are cancelled once this is over after stop()
+    std::chrono::milliseconds shutdown_grace{1000};
+};
+
+namespace detail
+{
+
+// the stream call a grpc_writer forwards to, gen tells which of the calls
+// served by the recycled object the writer belongs to
+template <typename Resp>
+class grpc_stream_sink
+{
+  public:
+    virtual ~grpc_stream_sink() = default;
+
+    virtual bool write(std::uint64_t gen, Resp msg)                    = 0;
+    virtual void finish(std::uint64_t gen, const grpc::Status &status) = 0;
+};
+
+// shared by the call object and its writers, sink is cleared when the call
+// object is destroyed on stop()
+template <typename Resp>
+struct grpc_stream_link
+{
+    std::shared_mutex       mu;
+    grpc_stream_sink<Resp> *sink = nullptr;
+};
+
+} // namespace detail
+
+// A server stream as seen from a handler. write() may be called from any
+// thread, messages are queued while a write is outstanding; finish() ends
+// the call once the queue is flushed. The reference a handler gets is only
+// valid while it runs, copy the writer to keep writing from elsewhere. A
+// copy stays bound to its own call: once that call is over and the object
+// behind it serves the next one, or the server is stopped, it does nothing.
+template <typename Resp>
+class grpc_writer
+{
+  public:
+    using link_ptr_t = std::shared_ptr<detail::grpc_stream_link<Resp>>;
+
+    grpc_writer() = default;
+    grpc_writer(link_ptr_t link, const std::uint64_t gen)
+        : _link{std::move(link)}
+        , _gen{gen}
+    {
+    }
+
+    // false once the call is finished or the client went away
+    bool write(Resp msg)
+    {
+        if(!_link)
+            return false;
+
+        std::shared_lock<std::shared_mutex> lock(_link->mu);
+        return _link->sink != nullptr
+               && _link->sink->write(_gen, std::move(msg));
+    }
+
+    void finish(const grpc::Status &status)
+    {
+        if(!_link)
+            return;
+
+        std::shared_lock<std::shared_mutex> lock(_link->mu);
+        if(_link->sink != nullptr)
+            _link->sink->finish(_gen, status);
+    }
+
+  private:
+    link_ptr_t    _link;
+    std::uint64_t _gen = 0;
+};
+
+namespace detail
+{
+
+class grpc_call_base;
+
+// completion queue tag: the call plus which of its operations completed
+struct grpc_call_tag
+{
+    grpc_call_base *call;
+    int             op;
+};
+
+struct grpc_cq_slot
+{
+    std::unique_ptr<grpc::ServerCompletionQueue> cq;
+    std::thread                                  th;
+
+    // no new operation may start on cq once it is shut down
+    std::shared_mutex mu;
+    bool              closed = false;
+};
+
+class grpc_call_base
+{
+  public:
+    enum op_t
+    {
+        op_request = 0,
+        op_read,
+        op_write,
+        op_finish,
+        op_num
+    };
+
+    explicit grpc_call_base(grpc_cq_slot *slot)
+        : _slot{slot}
+    {
+        for(int i = 0; i < op_num; ++i)
+            _tags[i] = grpc_call_tag{this, i};
+    }
+    virtual ~grpc_call_base() = default;
+
+    // (re)starts waiting for the next call of the method
+    virtual void arm()                    = 0;
+    virtual void proceed(int op, bool ok) = 0;
+
+  protected:
+    inline void *_tag(int op) { return &_tags[op]; }
+
+    // runs fn(cq) unless the queue is already shut down
+    template <typename Fn>
+    inline bool _start(Fn &&fn)
+    {
+        std::shared_lock<std::shared_mutex> lock(_slot->mu);
+        if(_slot->closed)
+            return false;
+
+        fn(_slot->cq.get());
+        return true;
+    }
+
+  protected:
+    grpc_cq_slot *_slot;
+    grpc_call_tag _tags[op_num];
+};
+
+template <typename Service, typename Req, typename Resp>
+class grpc_unary_call : public grpc_call_base
+{
+  public:
+    using writer_t     = grpc::ServerAsyncResponseWriter<Resp>;
+    using request_fn_t = void (Service::*)(grpc::ServerContext *,
+                                           Req *,
+                                           writer_t *,
+                                           grpc::CompletionQueue *,
+                                           grpc::ServerCompletionQueue *,
+                                           void *);
+    using handler_t    = std::function<
+        grpc::Status(grpc::ServerContext &, const Req &, Resp &)>;
+    using service_t    = Service;
+
+  public:
+    grpc_unary_call(grpc_cq_slot    *slot,
+                    Service         *svc,
+                    request_fn_t     fn,
+                    const handler_t *handler)
+        : grpc_call_base{slot}
+        , _svc{svc}
+        , _fn{fn}
+        , _handler{handler}
+    {
+    }
+
+    void arm() override
+    {
+        // the messages keep their capacity across calls
+        _req.Clear();
+        _resp.Clear();
+        _writer.reset();
+        _ctx.reset();
+        _ctx.emplace();
+        _writer.emplace(&*_ctx);
+        _start([this](grpc::ServerCompletionQueue *cq) {
+            (_svc->*_fn)(&*_ctx, &_req, &*_writer, cq, cq, _tag(op_request));
+        });
+    }
+
+    void proceed(int op, bool ok) override
+    {
+        if(op == op_finish)
+        {
+            arm();
+            return;
+        }
+        if(!ok)
+            return; // server shut down
+
+        grpc::Status status;
+        try
+        {
+            status = (*_handler)(*_ctx, _req, _resp);
+        }
+        catch(const std::exception &e)
+        {
+            status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+        }
+        _start([this, &status](grpc::ServerCompletionQueue *) {
+            _writer->Finish(_resp, status, _tag(op_finish));
+        });
+    }
+
+  private:
+    Service                            *_svc;
+    request_fn_t                        _fn;
+    const handler_t                    *_handler;
+    std::optional<grpc::ServerContext> _ctx;
+    std::optional<writer_t>            _writer;
+    Req                                 _req;
+    Resp                                _resp;
+};
+
+// server streaming (Stream = ServerAsyncWriter) and bidi streaming
+// (Stream = ServerAsyncReaderWriter) calls
+template <typename Service, typename Req, typename Resp, typename Stream>
+class grpc_stream_call : public grpc_call_base, public grpc_stream_sink<Resp>
+{
+  public:
+    static constexpr bool is_bidi =
+        std::is_same<Stream, grpc::ServerAsyncReaderWriter<Resp, Req>>::value;
+
+    using request_fn_t = std::conditional_t<
+        is_bidi,
+        void (Service::*)(grpc::ServerContext *,
+                          Stream *,
+                          grpc::CompletionQueue *,
+                          grpc::ServerCompletionQueue *,
+                          void *),
+        void (Service::*)(grpc::ServerContext *,
+                          Req *,
+                          Stream *,
+                          grpc::CompletionQueue *,
+                          grpc::ServerCompletionQueue *,
+                          void *)>;
+
+    // server streaming: called once; bidi: called per client message and
+    // with nullptr once the client half-closed
+    using handler_t = std::function<
+        void(grpc::ServerContext &, const Req *, grpc_writer<Resp> &)>;
+    using service_t = Service;
+
+  public:
+    grpc_stream_call(grpc_cq_slot    *slot,
+                     Service         *svc,
+                     request_fn_t     fn,
+                     const handler_t *handler)
+        : grpc_call_base{slot}
+        , _svc{svc}
+        , _fn{fn}
+        , _handler{handler}
+        , _link{std::make_shared<grpc_stream_link<Resp>>()}
+    {
+        _link->sink = this;
+    }
+
+    // writers still held by handlers must not reach a destroyed call
+    ~grpc_stream_call() override
+    {
+        std::unique_lock<std::shared_mutex> lock(_link->mu);
+        _link->sink = nullptr;
+    }
+
+    // writers of the previous call see another generation and back off
+    void arm() override
+    {
+        std::lock_guard<std::mutex> lock(_mu);
+        _gen++;
+        _req.Clear();
+        _queue.clear();
+        _writing   = false;
+        _finishing = false;
+        _finished  = false;
+        _inflight  = 1;
+        _stream.reset();
+        _ctx.reset();
+        _ctx.emplace();
+        _stream.emplace(&*_ctx);
+        _start([this](grpc::ServerCompletionQueue *cq) {
+            if constexpr(is_bidi)
+                (_svc->*_fn)(&*_ctx, &*_stream, cq, cq, _tag(op_request));
+            else
+                (_svc->*_fn)(&*_ctx,
+                             &_req,
+                             &*_stream,
+                             cq,
+                             cq,
+                             _tag(op_request));
+        });
+    }
+
+    void proceed(int op, bool ok) override
+    {
+        switch(op)
+        {
+            case op_request:
+                _on_request(ok);
+                break;
+            case op_read:
+                _on_read(ok);
+                break;
+            case op_write:
+                _on_write(ok);
+                break;
+            case op_finish: {
+                std::unique_lock<std::mutex> lock(_mu);
+                _inflight--;
+                _finished = true;
+                _done(lock);
+                break;
+            }
+        }
+    }
+
+    bool write(std::uint64_t gen, Resp msg) override
+    {
+        std::lock_guard<std::mutex> lock(_mu);
+        if(gen != _gen || _finishing)
+            return false;
+        if(_writing)
+        {
+            _queue.push_back(std::move(msg));
+            return true;
+        }
+
+        _out = std::move(msg);
+        _start_write();
+        return _writing;
+    }
+
+    void finish(std::uint64_t gen, const grpc::Status &status) override
+    {
+        std::lock_guard<std::mutex> lock(_mu);
+        if(gen != _gen || _finishing)
+            return;
+
+        _finishing = true;
+        _status    = status;
+        if(!_writing)
+            _start_finish();
+    }
+
+  private:
+    void _on_request(bool ok)
+    {
+        std::unique_lock<std::mutex> lock(_mu);
+        _inflight--;
+        if(!ok)
+            return; // server shut down
+
+        if constexpr(is_bidi)
+        {
+            _start_read();
+            return;
+        }
+
+        lock.unlock();
+        _call(&_req);
+    }
+
+    void _on_read(bool ok)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mu);
+            _inflight--;
+            if(_finishing)
+            {
+                _done(lock);
+                return;
+            }
+        }
+
+        _call(ok ? &_req : nullptr);
+        if(!ok)
+            return;
+
+        std::unique_lock<std::mutex> lock(_mu);
+        if(!_finishing)
+            _start_read();
+    }
+
+    void _on_write(bool ok)
+    {
+        std::unique_lock<std::mutex> lock(_mu);
+        _inflight--;
+        if(!ok)
+        {
+            // client gone: drop what is queued and end the call
+            _queue.clear();
+            if(!_finishing)
+            {
+                _finishing = true;
+                _status    = grpc::Status::CANCELLED;
+            }
+        }
+        else if(!_queue.empty())
+        {
+            _out = std::move(_queue.front());
+            _queue.pop_front();
+            _start_write();
+            return;
+        }
+
+        _writing = false;
+        if(_finishing)
+            _start_finish();
+    }
+
+    // _gen only changes in arm(), on this queue's thread
+    void _call(const Req *req)
+    {
+        grpc_writer<Resp> writer{_link, _gen};
+        try
+        {
+            (*_handler)(*_ctx, req, writer);
+        }
+        catch(const std::exception &e)
+        {
+            writer.finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
+        }
+    }
+
+    // all below run with _mu held
+    void _start_read()
+    {
+        if constexpr(is_bidi)
+        {
+            if(_start([this](grpc::ServerCompletionQueue *) {
+                   _stream->Read(&_req, _tag(op_read));
+               }))
+                _inflight++;
+        }
+    }
+
+    void _start_write()
+    {
+        _writing = _start([this](grpc::ServerCompletionQueue *) {
+            _stream->Write(_out, _tag(op_write));
+        });
+        if(_writing)
+            _inflight++;
+    }
+
+    void _start_finish()
+    {
+        if(_start([this](grpc::ServerCompletionQueue *) {
+               _stream->Finish(_status, _tag(op_finish));
+           }))
+            _inflight++;
+    }
+
+    // recycled once finished and no read is outstanding
+    void _done(std::unique_lock<std::mutex> &lock)
+    {
+        if(!_finished || _inflight > 0)
+            return;
+
+        lock.unlock();
+        arm();
+    }
+
+  private:
+    Service                            *_svc;
+    request_fn_t                        _fn;
+    const handler_t                    *_handler;
+    std::optional<grpc::ServerContext> _ctx;
+    std::optional<Stream>               _stream;
+    Req                                 _req;
+
+    std::shared_ptr<grpc_stream_link<Resp>> _link;
+    std::mutex                              _mu;
+    std::uint64_t                           _gen = 0;
+    Resp                                    _out;
+    std::deque<Resp>                        _queue;
+    grpc::Status                            _status;
+    bool                                    _writing   = false;
+    bool                                    _finishing = false;
+    bool                                    _finished  = false;
+    int                                     _inflight  = 0;
+};
+
+} // namespace detail
+
+// Asynchronous gRPC server: N completion queues, each drained by its own
+// thread, with a fixed set of call objects per method and queue that are
+// re-armed instead of reallocated when a call finishes. Handlers run on
+// the queue thread, slow ones should hand off and finish later.
+//
+//   GrpcService::AsyncService svc;
+//   hj::grpc_async_server     srv;
+//   srv.unary<HelloRequest, HelloReply>(
+//       &svc, &GrpcService::AsyncService::RequestSayHello,
+//       [](grpc::ServerContext &, const HelloRequest &req, HelloReply &rep) {
+//           rep.set_message("Hello, " + req.name());
+//           return grpc::Status::OK;
+//       });
+//   srv.start("0.0.0.0:50051", &svc);
+//
+// The service must outlive the server. With options.callback it is
+// expected to implement grpc's callback API instead (e.g.
+// GrpcService::CallbackService) and no queues are created.
+class grpc_async_server
+{
+  public:
+    template <typename Req, typename Resp>
+    using unary_handler_t = std::function<
+        grpc::Status(grpc::ServerContext &, const Req &, Resp &)>;
+
+    template <typename Req, typename Resp>
+    using stream_handler_t = std::function<
+        void(grpc::ServerContext &, const Req *, grpc_writer<Resp> &)>;
+
+  private:
+    template <typename Service, typename Req, typename Resp>
+    using _unary_call_t = detail::grpc_unary_call<Service, Req, Resp>;
+
+    template <typename Service, typename Req, typename Resp>
+    using _server_stream_call_t = detail::
+        grpc_stream_call<Service, Req, Resp, grpc::ServerAsyncWriter<Resp>>;
+
+    template <typename Service, typename Req, typename Resp>
+    using _bidi_stream_call_t =
+        detail::grpc_stream_call<Service,
+                                 Req,
+                                 Resp,
+                                 grpc::ServerAsyncReaderWriter<Resp, Req>>;
+
+  public:
+    explicit grpc_async_server(grpc_async_server_options opts = {})
+        : _opts{std::move(opts)}
+    {
+        if(_opts.cq_num == 0)
+            _opts.cq_num = 1;
+        if(_opts.calls_per_cq == 0)
+            _opts.calls_per_cq = 1;
+    }
+
+    ~grpc_async_server() { stop(); }
+
+    grpc_async_server(const grpc_async_server &)            = delete;
+    grpc_async_server &operator=(const grpc_async_server &) = delete;
+
+    template <typename Req, typename Resp, typename Service>
+    bool unary(
+        Service *svc,
+        typename _unary_call_t<Service, Req, Resp>::request_fn_t fn,
+        unary_handler_t<Req, Resp>                               handler)
+    {
+        return _add_method<_unary_call_t<Service, Req, Resp>>(
+            svc,
+            fn,
+            std::move(handler));
+    }
+
+    template <typename Req, typename Resp, typename Service>
+    bool server_stream(
+        Service *svc,
+        typename _server_stream_call_t<Service, Req, Resp>::request_fn_t fn,
+        stream_handler_t<Req, Resp> handler)
+    {
+        return _add_method<_server_stream_call_t<Service, Req, Resp>>(
+            svc,
+            fn,
+            std::move(handler));
+    }
+
+    template <typename Req, typename Resp, typename Service>
+    bool bidi_stream(
+        Service *svc,
+        typename _bidi_stream_call_t<Service, Req, Resp>::request_fn_t fn,
+        stream_handler_t<Req, Resp>                                    handler)
+    {
+        return _add_method<_bidi_stream_call_t<Service, Req, Resp>>(
+            svc,
+            fn,
+            std::move(handler));
+    }
+
+    // address may use port 0, port() tells the one picked; grpc binds an
+    // async service to one server for good, so this works once
+    bool start(const std::string &address, grpc::Service *service)
+    {
+        if(_started)
+            return false;
+
+        grpc::ServerBuilder builder;
+        builder.AddListeningPort(address,
+                                 grpc::InsecureServerCredentials(),
+                                 &_port);
+        builder.RegisterService(service);
+        if(!_opts.callback)
+        {
+            for(std::size_t i = 0; i < _opts.cq_num; ++i)
+            {
+                _slots.push_back(std::make_unique<detail::grpc_cq_slot>());
+                _slots.back()->cq = builder.AddCompletionQueue();
+            }
+        }
+        _server = builder.BuildAndStart();
+        if(!_server)
+        {
+            _slots.clear();
+            return false;
+        }
+
+        _started = true;
+        for(auto &slot : _slots)
+        {
+            for(auto &m : _methods)
+                for(std::size_t i = 0; i < _opts.calls_per_cq; ++i)
+                    m->calls.push_back(m->make_call(slot.get()));
+        }
+        for(auto &m : _methods)
+            for(auto &call : m->calls)
+                call->arm();
+        for(auto &slot : _slots)
+        {
+            auto *s = slot.get();
+            s->th   = std::thread([s]() { _poll(s); });
+        }
+        return true;
+    }
+
+    void stop()
+    {
+        if(!_server)
+            return;
+
+        // in-flight calls get the grace period, then they are cancelled
+        _server->Shutdown(std::chrono::system_clock::now()
+                          + _opts.shutdown_grace);
+        for(auto &slot : _slots)
+        {
+            {
+                std::unique_lock<std::shared_mutex> lock(slot->mu);
+                slot->closed = true;
+            }
+            slot->cq->Shutdown();
+        }
+        for(auto &slot : _slots)
+            slot->th.join();
+
+        for(auto &m : _methods)
+            m->calls.clear();
+        _slots.clear();
+        _server.reset();
+        _port = 0;
+    }
+
+    inline bool is_running() const { return _server != nullptr; }
+    inline int  port() const { return _port; }
+
+  private:
+    struct _method_base
+    {
+        virtual ~_method_base() = default;
+        virtual std::unique_ptr<detail::grpc_call_base>
+        make_call(detail::grpc_cq_slot *slot) = 0;
+
+        std::vector<std::unique_ptr<detail::grpc_call_base>> calls;
+    };
+
+    template <typename Call>
+    struct _method : public _method_base
+    {
+        _method(typename Call::request_fn_t fn,
+                typename Call::service_t   *svc,
+                typename Call::handler_t    handler)
+            : fn{fn}
+            , svc{svc}
+            , handler{std::move(handler)}
+        {
+        }
+
+        std::unique_ptr<detail::grpc_call_base>
+        make_call(detail::grpc_cq_slot *slot) override
+        {
+            return std::make_unique<Call>(slot, svc, fn, &handler);
+        }
+
+        typename Call::request_fn_t fn;
+        typename Call::service_t   *svc;
+        typename Call::handler_t    handler;
+    };
+
+    template <typename Call, typename Service, typename Fn, typename Handler>
+    bool _add_method(Service *svc, Fn fn, Handler handler)
+    {
+        if(_started || _opts.callback || !svc || !fn || !handler)
+            return false;
+
+        _methods.push_back(
+            std::make_unique<_method<Call>>(fn, svc, std::move(handler)));
+        return true;
+    }
+
+    static void _poll(detail::grpc_cq_slot *slot)
+    {
+        void *tag;
+        bool  ok;
+        while(slot->cq->Next(&tag, &ok))
+        {
+            auto *t = static_cast<detail::grpc_call_tag *>(tag);
+            t->call->proceed(t->op, ok);
+        }
+    }
+
+  private:
+    grpc_async_server_options                          _opts;
+    std::unique_ptr<grpc::Server>                      _server;
+    std::vector<std::unique_ptr<detail::grpc_cq_slot>> _slots;
+    std::vector<std::unique_ptr<_method_base>>         _methods;
+    int                                                _port    = 0;
+    bool                                               _started = false;
+};
+
 class grpc_channel
 {
   public:
@@ -1,6 +1,10 @@
 #ifndef HTTP_HPP
 #define HTTP_HPP
 
+#include <hj/net/http/http_async_client.hpp>
+
+#include <hj/net/http/http_async_server.hpp>
+
 #include <hj/net/http/http_client.hpp>
 
 #include <hj/net/http/http_request.hpp>
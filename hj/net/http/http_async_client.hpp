@@ -0,0 +1,636 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_ASYNC_CLIENT_HPP
+#define HTTP_ASYNC_CLIENT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <hj/compress/gzip.hpp>
+
+#ifndef MAX_HTTP_CLIENT_BODY_SZ
+#define MAX_HTTP_CLIENT_BODY_SZ (64 * 1024 * 1024)
+#endif
+
+namespace hj
+{
+
+struct http_async_client_options
+{
+    // connections kept per host:port, requests beyond that are queued
+    std::size_t max_conns_per_host = 8;
+    // >1 pipelines idempotent requests on connections known to keep alive
+    std::size_t pipeline_depth = 1;
+    // send Accept-Encoding: gzip and inflate gzip bodies with hj::gzip
+    bool                      decompress    = true;
+    std::size_t               max_body_size = MAX_HTTP_CLIENT_BODY_SZ;
+    std::chrono::milliseconds connect_timeout{5000};
+    std::chrono::milliseconds request_timeout{30000};
+    std::chrono::milliseconds idle_timeout{30000};
+};
+
+// Asynchronous HTTP/1.1 client with a keep-alive connection pool per
+// host:port. One client is meant to be shared: it is thread safe, all pool
+// state lives on a strand of the given io_context and handlers are invoked
+// there. Idempotent requests that hit a connection the server already
+// closed are retried once on a fresh connection. Plain http only.
+//
+//   hj::http_async_client cli{io};
+//   cli.async_get("http://127.0.0.1:8080/hello",
+//                 [](const auto &ec, hj::http_async_client::response_t res) {
+//                     if(!ec) std::cout << res.body();
+//                 });
+//   auto fut = cli.get("http://127.0.0.1:8080/hello"); // do not wait on it
+//                                                      // from an io thread
+class http_async_client
+{
+  public:
+    using io_t     = boost::asio::io_context;
+    using err_t    = boost::system::error_code;
+    using sock_t   = boost::asio::ip::tcp::socket;
+    using strand_t = boost::asio::strand<io_t::executor_type>;
+    using request_t =
+        boost::beast::http::request<boost::beast::http::string_body>;
+    using response_t =
+        boost::beast::http::response<boost::beast::http::string_body>;
+    using handler_t = std::function<void(const err_t &, response_t)>;
+
+  public:
+    explicit http_async_client(io_t &io, http_async_client_options opts = {})
+        : _impl{std::make_shared<_impl_t>(io, opts)}
+    {
+    }
+    ~http_async_client()
+    {
+        auto impl = _impl;
+        boost::asio::post(impl->strand, [impl]() { impl->shutdown(); });
+    }
+
+    http_async_client(const http_async_client &)            = delete;
+    http_async_client &operator=(const http_async_client &) = delete;
+
+    inline const http_async_client_options &options() const
+    {
+        return _impl->opts;
+    }
+    inline std::size_t connections_opened() const
+    {
+        return _impl->opened.load();
+    }
+
+    // url: http://host[:port]/target; method, headers and body come from req
+    void async_request(const std::string &url, request_t req, handler_t handler)
+    {
+        auto r     = std::make_shared<_req_t>();
+        r->msg     = std::move(req);
+        r->handler = std::move(handler);
+        if(!_parse_url(url, r->host, r->port, r->msg))
+        {
+            auto impl = _impl;
+            boost::asio::post(impl->strand, [r]() {
+                r->handler(boost::asio::error::invalid_argument, response_t{});
+            });
+            return;
+        }
+
+        namespace http = boost::beast::http;
+        r->idempotent  = _is_idempotent(r->msg.method());
+        r->msg.version(11);
+        if(_impl->opts.decompress
+           && r->msg.find(http::field::accept_encoding) == r->msg.end())
+            r->msg.set(http::field::accept_encoding, "gzip");
+        r->msg.prepare_payload();
+
+        auto impl = _impl;
+        boost::asio::post(impl->strand, [impl, r]() { impl->submit(r); });
+    }
+
+    inline void async_get(const std::string &url, handler_t handler)
+    {
+        async_request(url, _make(boost::beast::http::verb::get), handler);
+    }
+
+    void async_post(const std::string &url,
+                    std::string        body,
+                    const std::string &content_type,
+                    handler_t          handler)
+    {
+        request_t req = _make(boost::beast::http::verb::post);
+        req.set(boost::beast::http::field::content_type, content_type);
+        req.body() = std::move(body);
+        async_request(url, std::move(req), std::move(handler));
+    }
+
+    // future flavours; errors surface as boost::system::system_error
+    std::future<response_t> request(const std::string &url, request_t req)
+    {
+        auto promise = std::make_shared<std::promise<response_t>>();
+        auto fut     = promise->get_future();
+        async_request(url,
+                      std::move(req),
+                      [promise](const err_t &ec, response_t res) {
+                          if(ec)
+                              promise->set_exception(std::make_exception_ptr(
+                                  boost::system::system_error(ec)));
+                          else
+                              promise->set_value(std::move(res));
+                      });
+        return fut;
+    }
+
+    inline std::future<response_t> get(const std::string &url)
+    {
+        return request(url, _make(boost::beast::http::verb::get));
+    }
+
+    std::future<response_t> post(const std::string &url,
+                                 std::string        body,
+                                 const std::string &content_type)
+    {
+        request_t req = _make(boost::beast::http::verb::post);
+        req.set(boost::beast::http::field::content_type, content_type);
+        req.body() = std::move(body);
+        return request(url, std::move(req));
+    }
+
+  private:
+    struct _req_t
+    {
+        request_t   msg;
+        handler_t   handler;
+        std::string host;
+        std::string port;
+        bool        idempotent = false;
+        int         retries    = 0;
+    };
+
+    struct _conn_t
+    {
+        explicit _conn_t(strand_t &strand)
+            : sock{strand}
+            , timer{strand}
+        {
+        }
+
+        sock_t                    sock;
+        boost::asio::steady_timer timer;
+        boost::beast::flat_buffer buf;
+        std::optional<boost::beast::http::response_parser<
+            boost::beast::http::string_body>>
+                                            parser;
+        std::deque<std::shared_ptr<_req_t>> inflight;
+        std::size_t                         nwritten   = 0;
+        std::size_t                         served     = 0;
+        bool                                connected  = false;
+        bool                                writing    = false;
+        bool                                reading    = false;
+        bool                                keep_alive = false;
+        bool                                timed_out  = false;
+        bool                                dead       = false;
+    };
+
+    struct _host_t
+    {
+        std::string                                  host;
+        std::string                                  port;
+        boost::asio::ip::tcp::resolver::results_type eps;
+        bool                                         resolving = false;
+        std::deque<std::shared_ptr<_req_t>>          queue;
+        std::vector<std::shared_ptr<_conn_t>>        conns;
+        std::vector<std::shared_ptr<_conn_t>>        wait_resolve;
+    };
+
+    struct _impl_t : std::enable_shared_from_this<_impl_t>
+    {
+        _impl_t(io_t &io, const http_async_client_options &o)
+            : strand{io.get_executor()}
+            , resolver{strand}
+            , opts{o}
+        {
+            opts.max_conns_per_host = std::max<std::size_t>(
+                1,
+                opts.max_conns_per_host);
+            opts.pipeline_depth = std::max<std::size_t>(1, opts.pipeline_depth);
+        }
+
+        using resolve_results_t = boost::asio::ip::tcp::resolver::results_type;
+        using hosts_t =
+            std::unordered_map<std::string, std::shared_ptr<_host_t>>;
+
+        strand_t                       strand;
+        boost::asio::ip::tcp::resolver resolver;
+        http_async_client_options      opts;
+        hosts_t                        hosts;
+        std::atomic<std::size_t>       opened{0};
+        bool                           closed = false;
+
+        void submit(std::shared_ptr<_req_t> r)
+        {
+            if(closed)
+            {
+                r->handler(boost::asio::error::operation_aborted,
+                           response_t{});
+                return;
+            }
+
+            auto &h = hosts[r->host + ":" + r->port];
+            if(!h)
+            {
+                h       = std::make_shared<_host_t>();
+                h->host = r->host;
+                h->port = r->port;
+            }
+            h->queue.push_back(std::move(r));
+            pump(h);
+        }
+
+        // hand queued requests to idle connections, pipeline onto busy
+        // ones where safe and open new ones up to the per host limit
+        void pump(const std::shared_ptr<_host_t> &h)
+        {
+            while(!h->queue.empty() && !closed)
+            {
+                auto                     &r = h->queue.front();
+                std::shared_ptr<_conn_t>  c = pick(*h, *r);
+                if(!c)
+                {
+                    if(h->conns.size() >= opts.max_conns_per_host)
+                        return;
+
+                    c = std::make_shared<_conn_t>(strand);
+                    h->conns.push_back(c);
+                    connect(h, c);
+                }
+
+                c->inflight.push_back(std::move(r));
+                h->queue.pop_front();
+                write(h, c);
+            }
+        }
+
+        std::shared_ptr<_conn_t> pick(_host_t &h, const _req_t &r)
+        {
+            std::shared_ptr<_conn_t> best;
+            for(auto &c : h.conns)
+            {
+                if(c->dead)
+                    continue;
+                if(c->inflight.empty())
+                    return c;
+
+                if(!r.idempotent || !c->connected || !c->keep_alive
+                   || c->inflight.size() >= opts.pipeline_depth)
+                    continue;
+                bool safe = std::all_of(
+                    c->inflight.begin(),
+                    c->inflight.end(),
+                    [](const std::shared_ptr<_req_t> &q) {
+                        return q->idempotent;
+                    });
+                if(safe
+                   && (!best || c->inflight.size() < best->inflight.size()))
+                    best = c;
+            }
+
+            // prefer a new connection over pipelining behind others
+            if(best && h.conns.size() < opts.max_conns_per_host)
+                return nullptr;
+            return best;
+        }
+
+        void connect(const std::shared_ptr<_host_t> &h,
+                     const std::shared_ptr<_conn_t> &c)
+        {
+            if(h->eps.empty())
+            {
+                h->wait_resolve.push_back(c);
+                if(h->resolving)
+                    return;
+
+                h->resolving = true;
+                auto self    = this->shared_from_this();
+                resolver.async_resolve(
+                    h->host,
+                    h->port,
+                    [self, h](const err_t &ec, resolve_results_t eps) {
+                        h->resolving = false;
+                        auto waiting = std::move(h->wait_resolve);
+                        h->wait_resolve.clear();
+                        if(!ec)
+                            h->eps = eps;
+                        for(auto &c : waiting)
+                        {
+                            if(ec)
+                                self->fail(h, c, ec);
+                            else if(!c->dead)
+                                self->connect(h, c);
+                        }
+                    });
+                return;
+            }
+
+            opened++;
+            arm(h, c, opts.connect_timeout);
+            auto self = this->shared_from_this();
+            boost::asio::async_connect(
+                c->sock,
+                h->eps,
+                [self, h, c](const err_t &ec,
+                             const boost::asio::ip::tcp::endpoint &) {
+                    c->timer.cancel();
+                    if(ec)
+                    {
+                        self->fail(h, c, ec);
+                        return;
+                    }
+
+                    err_t ignore;
+                    c->sock.set_option(boost::asio::ip::tcp::no_delay(true),
+                                       ignore);
+                    c->connected = true;
+                    self->write(h, c);
+                });
+        }
+
+        void write(const std::shared_ptr<_host_t> &h,
+                   const std::shared_ptr<_conn_t> &c)
+        {
+            if(!c->connected || c->writing || c->dead
+               || c->nwritten >= c->inflight.size())
+                return;
+
+            // stop the idle deadline, but a pipelined write must leave the
+            // response deadline of the requests ahead of it armed
+            c->writing = true;
+            if(!c->reading)
+                c->timer.cancel();
+            auto self = this->shared_from_this();
+            boost::beast::http::async_write(
+                c->sock,
+                c->inflight[c->nwritten]->msg,
+                [self, h, c](const err_t &ec, std::size_t) {
+                    c->writing = false;
+                    if(ec)
+                    {
+                        self->fail(h, c, ec);
+                        return;
+                    }
+
+                    c->nwritten++;
+                    self->write(h, c);
+                    self->read(h, c);
+                });
+        }
+
+        void read(const std::shared_ptr<_host_t> &h,
+                  const std::shared_ptr<_conn_t> &c)
+        {
+            if(c->reading || c->dead || c->nwritten == 0)
+                return;
+
+            c->reading = true;
+            c->parser.emplace();
+            c->parser->body_limit(opts.max_body_size);
+            if(c->inflight.front()->msg.method()
+               == boost::beast::http::verb::head)
+                c->parser->skip(true);
+            arm(h, c, opts.request_timeout);
+
+            auto self = this->shared_from_this();
+            boost::beast::http::async_read(
+                c->sock,
+                c->buf,
+                *c->parser,
+                [self, h, c](const err_t &ec, std::size_t) {
+                    c->reading = false;
+                    c->timer.cancel();
+                    if(ec)
+                    {
+                        self->fail(h, c, ec);
+                        return;
+                    }
+
+                    auto r = std::move(c->inflight.front());
+                    c->inflight.pop_front();
+                    c->nwritten--;
+                    c->served++;
+                    response_t res = c->parser->release();
+                    c->keep_alive  = res.keep_alive();
+                    self->deliver(*r, std::move(res));
+
+                    if(!c->keep_alive)
+                        self->fail(h, c, boost::asio::error::eof);
+                    else if(!c->inflight.empty())
+                        self->read(h, c);
+                    else
+                        self->arm(h, c, self->opts.idle_timeout);
+                    self->pump(h);
+                });
+        }
+
+        // one timer per connection: connect, response or idle deadline
+        void arm(const std::shared_ptr<_host_t> &h,
+                 const std::shared_ptr<_conn_t> &c,
+                 std::chrono::milliseconds       timeout)
+        {
+            c->timer.expires_after(timeout);
+            auto self = this->shared_from_this();
+            c->timer.async_wait([self, h, c](const err_t &ec) {
+                if(ec
+                   || c->timer.expiry()
+                          > boost::asio::steady_timer::clock_type::now())
+                    return;
+
+                if(c->inflight.empty())
+                {
+                    self->fail(h, c, boost::asio::error::timed_out);
+                    return;
+                }
+                c->timed_out = true;
+                err_t ignore;
+                c->sock.close(ignore);
+            });
+        }
+
+        void deliver(_req_t &r, response_t &&res)
+        {
+            namespace http = boost::beast::http;
+            err_t ec;
+            auto  it = res.find(http::field::content_encoding);
+            if(opts.decompress && it != res.end() && it->value() == "gzip")
+            {
+                std::vector<unsigned char> out;
+                if(hj::gzip::decompress(out,
+                                        res.body().data(),
+                                        res.body().size(),
+                                        opts.max_body_size)
+                   == hj::gzip::err::ok)
+                {
+                    res.body().assign(out.begin(), out.end());
+                    res.erase(http::field::content_encoding);
+                    res.content_length(res.body().size());
+                } else
+                {
+                    ec = boost::system::errc::make_error_code(
+                        boost::system::errc::bad_message);
+                }
+            }
+
+            auto handler = std::move(r.handler);
+            handler(ec, std::move(res));
+        }
+
+        // drop the connection; requests it still owes are retried once when
+        // idempotent and the failure looks like a stale keep-alive
+        void fail(const std::shared_ptr<_host_t> &h,
+                  const std::shared_ptr<_conn_t> &c,
+                  err_t                           ec)
+        {
+            if(c->dead)
+                return;
+
+            c->dead = true;
+            err_t ignore;
+            c->timer.cancel();
+            c->sock.close(ignore);
+            h->conns.erase(std::remove(h->conns.begin(), h->conns.end(), c),
+                           h->conns.end());
+            if(c->timed_out)
+                ec = boost::asio::error::timed_out;
+
+            bool stale = ec == boost::asio::error::eof
+                         || ec == boost::asio::error::connection_reset
+                         || ec == boost::asio::error::broken_pipe
+                         || ec == boost::beast::http::error::end_of_stream;
+            auto inflight = std::move(c->inflight);
+            c->inflight.clear();
+            for(auto it = inflight.rbegin(); it != inflight.rend(); ++it)
+            {
+                auto &r = *it;
+                if(!closed && stale && r->idempotent && r->retries < 1)
+                {
+                    r->retries++;
+                    h->queue.push_front(std::move(r));
+                    continue;
+                }
+
+                auto handler = std::move(r->handler);
+                handler(closed ? boost::asio::error::operation_aborted : ec,
+                        response_t{});
+            }
+            pump(h);
+        }
+
+        void shutdown()
+        {
+            closed = true;
+            resolver.cancel();
+            for(auto &kv : hosts)
+            {
+                auto h = kv.second;
+                for(auto &r : h->queue)
+                    r->handler(boost::asio::error::operation_aborted,
+                               response_t{});
+                h->queue.clear();
+
+                auto conns = h->conns;
+                for(auto &c : conns)
+                    fail(h, c, boost::asio::error::operation_aborted);
+                for(auto &c : h->wait_resolve)
+                    fail(h, c, boost::asio::error::operation_aborted);
+            }
+            hosts.clear();
+        }
+    };
+
+    static request_t _make(boost::beast::http::verb method)
+    {
+        request_t req;
+        req.method(method);
+        return req;
+    }
+
+    static bool _is_idempotent(boost::beast::http::verb method)
+    {
+        namespace http = boost::beast::http;
+        return method == http::verb::get || method == http::verb::head
+               || method == http::verb::put || method == http::verb::delete_
+               || method == http::verb::options;
+    }
+
+    static bool _parse_url(const std::string &url,
+                           std::string       &host,
+                           std::string       &port,
+                           request_t         &req)
+    {
+        std::size_t pos = 0;
+        if(url.compare(0, 7, "http://") == 0)
+            pos = 7;
+        else if(url.find("://") != std::string::npos)
+            return false; // https and friends are not supported
+
+        std::size_t end = url.find_first_of("/?", pos);
+        if(end == std::string::npos)
+            end = url.size();
+        std::string authority = url.substr(pos, end - pos);
+        std::size_t colon     = authority.rfind(':');
+        if(colon != std::string::npos
+           && authority.find(']', colon) == std::string::npos)
+        {
+            host = authority.substr(0, colon);
+            port = authority.substr(colon + 1);
+        } else
+        {
+            host = authority;
+            port = "80";
+        }
+        if(host.size() > 1 && host.front() == '[' && host.back() == ']')
+            host = host.substr(1, host.size() - 2);
+        if(host.empty() || port.empty())
+            return false;
+
+        std::string target = url.substr(end);
+        if(target.empty() || target[0] == '?')
+            target.insert(0, "/");
+        req.target(target);
+        req.set(boost::beast::http::field::host, authority);
+        return true;
+    }
+
+  private:
+    std::shared_ptr<_impl_t> _impl;
+};
+
+}
+
+#endif
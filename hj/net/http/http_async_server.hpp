@@ -0,0 +1,1478 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_ASYNC_SERVER_HPP
+#define HTTP_ASYNC_SERVER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <hj/sync/thread_pool.hpp>
+
+#ifndef MAX_HTTP_ASYNC_PAYLOAD_SZ
+#define MAX_HTTP_ASYNC_PAYLOAD_SZ (64 * 1024 * 1024)
+#endif
+
+#ifndef HTTP_ASYNC_CHUNK_SZ
+#define HTTP_ASYNC_CHUNK_SZ 16384
+#endif
+
+// stop reading pipelined requests while this much output is still queued
+#ifndef HTTP_ASYNC_WRITE_HIGH_WATER
+#define HTTP_ASYNC_WRITE_HIGH_WATER (256 * 1024)
+#endif
+
+namespace hj
+{
+
+// radix tree keyed by path; supports "/:name" segment captures and a trailing
+// "/*name" catch-all. static edges win over captures, captures over
+// catch-alls, and the lookup backtracks when a branch has no value for the
+// requested method
+template <typename T>
+class http_radix_router
+{
+  public:
+    using params_t = std::unordered_map<std::string, std::string>;
+
+  public:
+    http_radix_router() = default;
+
+    inline std::size_t size() const noexcept { return _size; }
+
+    bool add(const std::string &method, const std::string &pattern, T value)
+    {
+        if(pattern.empty() || pattern[0] != '/')
+            return false;
+
+        node       *n = &_root;
+        std::size_t i = 0;
+        while(i < pattern.size())
+        {
+            if(_is_capture(pattern, i, ':'))
+            {
+                std::size_t end = pattern.find('/', i);
+                if(end == std::string::npos)
+                    end = pattern.size();
+                std::string name = pattern.substr(i + 1, end - i - 1);
+                if(name.empty())
+                    return false;
+                if(!n->param)
+                {
+                    n->param      = std::make_unique<node>();
+                    n->param_name = name;
+                } else if(n->param_name != name)
+                {
+                    return false;
+                }
+
+                n = n->param.get();
+                i = end;
+                continue;
+            }
+            if(_is_capture(pattern, i, '*'))
+            {
+                std::string name = pattern.substr(i + 1);
+                if(name.find('/') != std::string::npos)
+                    return false;
+                if(!n->wildcard)
+                {
+                    n->wildcard      = std::make_unique<node>();
+                    n->wildcard_name = name;
+                } else if(n->wildcard_name != name)
+                {
+                    return false;
+                }
+
+                n = n->wildcard.get();
+                break;
+            }
+
+            std::size_t end = i + 1;
+            while(end < pattern.size() && !_is_capture(pattern, end, ':')
+                  && !_is_capture(pattern, end, '*'))
+                end++;
+            n = _insert(n, std::string_view(pattern).substr(i, end - i));
+            i = end;
+        }
+
+        for(auto &v : n->values)
+        {
+            if(v.first == method)
+            {
+                v.second = std::move(value);
+                return true;
+            }
+        }
+        n->values.emplace_back(method, std::move(value));
+        _size++;
+        return true;
+    }
+
+    const T *find(const std::string &method,
+                  std::string_view   path,
+                  params_t          &params) const
+    {
+        captures_t caps;
+        const T   *out = nullptr;
+        if(!_find(&_root, path, method, caps, out))
+            return nullptr;
+
+        for(auto &cap : caps)
+            params[*cap.first] = std::string(cap.second);
+        return out;
+    }
+
+  private:
+    struct node
+    {
+        std::string                            prefix;
+        std::vector<std::unique_ptr<node>>     children;
+        std::unique_ptr<node>                  param;
+        std::string                            param_name;
+        std::unique_ptr<node>                  wildcard;
+        std::string                            wildcard_name;
+        std::vector<std::pair<std::string, T>> values;
+    };
+
+    static inline bool
+    _is_capture(const std::string &pattern, std::size_t i, char c)
+    {
+        return pattern[i] == c && i > 0 && pattern[i - 1] == '/';
+    }
+
+    // walk/split static edges so that siblings never share a first byte
+    static node *_insert(node *n, std::string_view label)
+    {
+        while(!label.empty())
+        {
+            auto it = std::find_if(n->children.begin(),
+                                   n->children.end(),
+                                   [&](const std::unique_ptr<node> &c) {
+                                       return c->prefix[0] == label[0];
+                                   });
+            if(it == n->children.end())
+            {
+                n->children.emplace_back(std::make_unique<node>());
+                n->children.back()->prefix = std::string(label);
+                return n->children.back().get();
+            }
+
+            node       *child = it->get();
+            std::size_t common = 0;
+            while(common < child->prefix.size() && common < label.size()
+                  && child->prefix[common] == label[common])
+                common++;
+
+            if(common < child->prefix.size())
+            {
+                auto mid    = std::make_unique<node>();
+                mid->prefix = child->prefix.substr(0, common);
+                child->prefix.erase(0, common);
+                mid->children.emplace_back(std::move(*it));
+                *it   = std::move(mid);
+                child = it->get();
+            }
+
+            label.remove_prefix(common);
+            n = child;
+        }
+        return n;
+    }
+
+    static const T *_value(const node *n, const std::string &method)
+    {
+        for(auto &v : n->values)
+            if(v.first == method)
+                return &v.second;
+        return nullptr;
+    }
+
+    using captures_t =
+        std::vector<std::pair<const std::string *, std::string_view>>;
+
+    bool _find(const node        *n,
+               std::string_view   path,
+               const std::string &method,
+               captures_t        &caps,
+               const T          *&out) const
+    {
+        if(path.empty())
+        {
+            if((out = _value(n, method)) != nullptr)
+                return true;
+        } else
+        {
+            for(auto &child : n->children)
+            {
+                if(child->prefix[0] != path[0])
+                    continue;
+
+                if(path.substr(0, child->prefix.size()) == child->prefix
+                   && _find(child.get(),
+                            path.substr(child->prefix.size()),
+                            method,
+                            caps,
+                            out))
+                    return true;
+                break;
+            }
+
+            if(n->param)
+            {
+                std::string_view seg = path.substr(0, path.find('/'));
+                if(!seg.empty())
+                {
+                    caps.emplace_back(&n->param_name, seg);
+                    if(_find(n->param.get(),
+                             path.substr(seg.size()),
+                             method,
+                             caps,
+                             out))
+                        return true;
+                    caps.pop_back();
+                }
+            }
+        }
+
+        if(n->wildcard && (out = _value(n->wildcard.get(), method)) != nullptr)
+        {
+            if(!n->wildcard_name.empty())
+                caps.emplace_back(&n->wildcard_name, path);
+            return true;
+        }
+        return false;
+    }
+
+  private:
+    node        _root;
+    std::size_t _size = 0;
+};
+
+// Asynchronous HTTP/1.1 server on boost.beast.
+//
+// Every io thread runs its own io_context; accepted connections are spread
+// over them round-robin and then never leave their thread, so a connection
+// needs no strand. Handlers run on a hj::thread_pool when handler_threads > 0
+// (blocking handlers are fine) or inline on the io thread otherwise.
+// Connections keep alive and pipeline: the next request is parsed as soon as
+// the previous response is queued, and queued responses are coalesced into a
+// single write. Write buffers are recycled per io thread.
+//
+// The handler API follows httplib:
+//   svr.Get("/users/:id", [](const auto &req, auto &res) {
+//       res.set_content(req.path_params.at("id"), "text/plain");
+//   });
+//   svr.listen("0.0.0.0", 8080);
+class http_async_server
+{
+  public:
+    using io_t       = boost::asio::io_context;
+    using sock_t     = boost::asio::ip::tcp::socket;
+    using endpoint_t = boost::asio::ip::tcp::endpoint;
+    using acceptor_t = boost::asio::ip::tcp::acceptor;
+    using err_t      = boost::system::error_code;
+
+    struct ci_less
+    {
+        bool operator()(const std::string &a, const std::string &b) const
+        {
+            return std::lexicographical_compare(
+                a.begin(),
+                a.end(),
+                b.begin(),
+                b.end(),
+                [](unsigned char x, unsigned char y) {
+                    return std::tolower(x) < std::tolower(y);
+                });
+        }
+    };
+
+    using headers_t     = std::multimap<std::string, std::string, ci_less>;
+    using params_t      = std::multimap<std::string, std::string>;
+    using path_params_t = std::unordered_map<std::string, std::string>;
+
+    struct request
+    {
+        std::string   method;
+        std::string   path;
+        std::string   target;
+        std::string   version;
+        headers_t     headers;
+        std::string   body;
+        params_t      params;
+        path_params_t path_params;
+        std::string   remote_addr;
+        int           remote_port = -1;
+
+        inline bool has_header(const std::string &key) const
+        {
+            return headers.find(key) != headers.end();
+        }
+        std::string get_header_value(const std::string &key,
+                                     const char        *def = "") const
+        {
+            auto it = headers.find(key);
+            return it == headers.end() ? std::string(def) : it->second;
+        }
+        inline bool has_param(const std::string &key) const
+        {
+            return params.find(key) != params.end();
+        }
+        std::string get_param_value(const std::string &key) const
+        {
+            auto it = params.find(key);
+            return it == params.end() ? std::string() : it->second;
+        }
+
+        void clear()
+        {
+            method.clear();
+            path.clear();
+            target.clear();
+            headers.clear();
+            body.clear();
+            params.clear();
+            path_params.clear();
+        }
+    };
+
+    // collects the bytes a content provider produces in one call
+    class data_sink
+    {
+      public:
+        bool write(const char *data, std::size_t len)
+        {
+            if(_done)
+                return false;
+
+            _buf->append(data, len);
+            return true;
+        }
+        inline void done() noexcept { _done = true; }
+        inline bool is_writable() const noexcept { return !_done; }
+
+      private:
+        friend class http_async_server;
+        explicit data_sink(std::string *buf)
+            : _buf{buf}
+        {
+        }
+
+        std::string *_buf;
+        bool         _done = false;
+    };
+
+    using content_provider_t =
+        std::function<bool(std::size_t offset, std::size_t len, data_sink &)>;
+    using chunked_content_provider_t =
+        std::function<bool(std::size_t offset, data_sink &)>;
+
+    struct response
+    {
+        int         status = -1;
+        headers_t   headers;
+        std::string body;
+
+        std::size_t                content_length_ = 0;
+        content_provider_t         content_provider_;
+        chunked_content_provider_t chunked_content_provider_;
+
+        inline bool has_header(const std::string &key) const
+        {
+            return headers.find(key) != headers.end();
+        }
+        std::string get_header_value(const std::string &key,
+                                     const char        *def = "") const
+        {
+            auto it = headers.find(key);
+            return it == headers.end() ? std::string(def) : it->second;
+        }
+        inline void set_header(const std::string &key, const std::string &val)
+        {
+            headers.emplace(key, val);
+        }
+
+        void set_content(const char        *data,
+                         std::size_t        len,
+                         const std::string &content_type)
+        {
+            body.assign(data, len);
+            _set_content_type(content_type);
+        }
+        void set_content(const std::string &s, const std::string &content_type)
+        {
+            set_content(s.data(), s.size(), content_type);
+        }
+        void set_content(std::string &&s, const std::string &content_type)
+        {
+            body = std::move(s);
+            _set_content_type(content_type);
+        }
+
+        void set_redirect(const std::string &url, int stat = 302)
+        {
+            headers.erase("Location");
+            set_header("Location", url);
+            status = stat;
+        }
+
+        // provider is called until len bytes were written to the sink
+        void set_content_provider(std::size_t        len,
+                                  const std::string &content_type,
+                                  content_provider_t provider)
+        {
+            content_length_   = len;
+            content_provider_ = std::move(provider);
+            _set_content_type(content_type);
+        }
+
+        // provider is called until it calls sink.done(); chunked encoding
+        void
+        set_chunked_content_provider(const std::string         &content_type,
+                                     chunked_content_provider_t provider)
+        {
+            chunked_content_provider_ = std::move(provider);
+            _set_content_type(content_type);
+        }
+
+        inline bool is_streaming() const noexcept
+        {
+            return content_provider_ || chunked_content_provider_;
+        }
+
+        void clear()
+        {
+            status = -1;
+            headers.clear();
+            body.clear();
+            content_length_ = 0;
+            content_provider_ = nullptr;
+            chunked_content_provider_ = nullptr;
+        }
+
+      private:
+        void _set_content_type(const std::string &content_type)
+        {
+            headers.erase("Content-Type");
+            if(!content_type.empty())
+                set_header("Content-Type", content_type);
+        }
+    };
+
+    using content_receiver_t = std::function<bool(const char *, std::size_t)>;
+    using content_reader_t   = std::function<bool(content_receiver_t)>;
+    using handler_t = std::function<void(const request &, response &)>;
+    using reader_handler_t = std::function<
+        void(const request &, response &, const content_reader_t &)>;
+
+  public:
+    explicit http_async_server(
+        std::size_t io_threads      = std::thread::hardware_concurrency(),
+        std::size_t handler_threads = 0)
+        : _handler_threads{handler_threads}
+    {
+        io_threads = io_threads < 1 ? 1 : io_threads;
+        for(std::size_t i = 0; i < io_threads; ++i)
+            _workers.emplace_back(std::make_unique<_worker>());
+    }
+    ~http_async_server() { stop(); }
+
+    http_async_server(const http_async_server &)            = delete;
+    http_async_server &operator=(const http_async_server &) = delete;
+
+    inline http_async_server &Get(const std::string &pattern, handler_t h)
+    {
+        return _route("GET", pattern, std::move(h));
+    }
+    inline http_async_server &Post(const std::string &pattern, handler_t h)
+    {
+        return _route("POST", pattern, std::move(h));
+    }
+    inline http_async_server &Post(const std::string &pattern,
+                                   reader_handler_t   h)
+    {
+        return _route("POST", pattern, std::move(h));
+    }
+    inline http_async_server &Put(const std::string &pattern, handler_t h)
+    {
+        return _route("PUT", pattern, std::move(h));
+    }
+    inline http_async_server &Put(const std::string &pattern,
+                                  reader_handler_t   h)
+    {
+        return _route("PUT", pattern, std::move(h));
+    }
+    inline http_async_server &Patch(const std::string &pattern, handler_t h)
+    {
+        return _route("PATCH", pattern, std::move(h));
+    }
+    inline http_async_server &Delete(const std::string &pattern, handler_t h)
+    {
+        return _route("DELETE", pattern, std::move(h));
+    }
+    inline http_async_server &Options(const std::string &pattern, handler_t h)
+    {
+        return _route("OPTIONS", pattern, std::move(h));
+    }
+
+    // called for responses with status >= 400 and an empty body
+    inline http_async_server &set_error_handler(handler_t h)
+    {
+        _error_handler = std::move(h);
+        return *this;
+    }
+    inline http_async_server &set_keep_alive_max_count(std::size_t n)
+    {
+        _keep_alive_max_count = n;
+        return *this;
+    }
+    inline http_async_server &set_keep_alive_timeout(time_t sec)
+    {
+        _keep_alive_timeout = std::chrono::seconds(sec);
+        return *this;
+    }
+    inline http_async_server &set_read_timeout(time_t sec, time_t usec = 0)
+    {
+        _read_timeout =
+            std::chrono::seconds(sec) + std::chrono::microseconds(usec);
+        return *this;
+    }
+    inline http_async_server &set_payload_max_length(std::size_t len)
+    {
+        _payload_max_length = len;
+        return *this;
+    }
+    inline http_async_server &set_tcp_nodelay(bool on)
+    {
+        _tcp_nodelay = on;
+        return *this;
+    }
+
+    inline bool        is_running() const noexcept { return _running.load(); }
+    inline int         port() const noexcept { return _port; }
+    inline std::size_t io_threads() const noexcept { return _workers.size(); }
+    inline std::size_t handler_threads() const noexcept
+    {
+        return _handler_threads;
+    }
+
+    void wait_until_ready() const
+    {
+        while(!_running.load() && !_stopped.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    bool bind_to_port(const std::string &host, int port)
+    {
+        err_t ec;
+        auto  addr = boost::asio::ip::make_address(host, ec);
+        if(ec)
+            return false;
+
+        endpoint_t ep{addr, static_cast<unsigned short>(port)};
+        auto acceptor = std::make_unique<acceptor_t>(*_workers[0]->io);
+        acceptor->open(ep.protocol(), ec);
+        if(!ec)
+            acceptor->set_option(acceptor_t::reuse_address(true), ec);
+        if(!ec)
+            acceptor->bind(ep, ec);
+        if(!ec)
+            acceptor->listen(boost::asio::socket_base::max_listen_connections,
+                             ec);
+        if(ec)
+            return false;
+
+        _port     = acceptor->local_endpoint().port();
+        _acceptor = std::move(acceptor);
+        return true;
+    }
+
+    inline int bind_to_any_port(const std::string &host)
+    {
+        return bind_to_port(host, 0) ? _port : -1;
+    }
+
+    // blocks until stop()
+    bool listen_after_bind()
+    {
+        if(!_acceptor || _running.exchange(true))
+            return false;
+
+        _stopped.store(false);
+        if(_handler_threads > 0)
+            _pool = std::make_unique<thread_pool>(_handler_threads);
+
+        std::vector<std::thread> threads;
+        for(auto &w : _workers)
+        {
+            w->guard.emplace(boost::asio::make_work_guard(*w->io));
+            threads.emplace_back([&w]() { w->io->run(); });
+        }
+        _accept();
+
+        for(auto &t : threads)
+            t.join();
+
+        // drain handlers still holding connections before their io_context
+        // goes away; the fresh io_context makes the server listenable again
+        _acceptor.reset();
+        _pool.reset();
+        for(auto &w : _workers)
+        {
+            w->guard.reset();
+            w->io = std::make_unique<io_t>();
+        }
+        _running.store(false);
+        return true;
+    }
+
+    inline bool listen(const std::string &host, int port)
+    {
+        return bind_to_port(host, port) && listen_after_bind();
+    }
+
+    void stop()
+    {
+        _stopped.store(true);
+        if(!_running.load())
+            return;
+
+        for(auto &w : _workers)
+            w->io->stop();
+    }
+
+  private:
+    struct _route_t
+    {
+        handler_t        handler;
+        reader_handler_t reader;
+    };
+
+    // per io thread state; the write buffer cache is shared with sessions
+    // that may be released from a handler thread, hence the mutex
+    struct _worker
+    {
+        std::mutex               mu;
+        std::vector<std::string> bufs;
+        std::unique_ptr<io_t>    io = std::make_unique<io_t>();
+        std::optional<boost::asio::executor_work_guard<io_t::executor_type>>
+            guard;
+
+        std::string acquire()
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if(bufs.empty())
+                return std::string();
+
+            std::string buf = std::move(bufs.back());
+            bufs.pop_back();
+            return buf;
+        }
+
+        void release(std::string &&buf)
+        {
+            if(buf.capacity() == 0 || buf.capacity() > 4 * HTTP_ASYNC_CHUNK_SZ)
+                return;
+
+            buf.clear();
+            std::lock_guard<std::mutex> lock(mu);
+            if(bufs.size() < 1024)
+                bufs.emplace_back(std::move(buf));
+        }
+    };
+
+    // request body handed to a reader handler chunk by chunk
+    struct _stream_in
+    {
+        std::mutex              mu;
+        std::condition_variable cond;
+        std::string             io_buf;
+        std::string             chunk;
+        bool                    ready  = false;
+        bool                    eof    = false;
+        bool                    failed = false;
+    };
+
+    class _session : public std::enable_shared_from_this<_session>
+    {
+      public:
+        _session(http_async_server &srv, _worker &w, sock_t &&sock)
+            : _srv{srv}
+            , _w{w}
+            , _sock{std::move(sock)}
+            , _timer{_sock.get_executor()}
+            , _wbuf{w.acquire()}
+            , _obuf{w.acquire()}
+        {
+        }
+        ~_session()
+        {
+            _w.release(std::move(_wbuf));
+            _w.release(std::move(_obuf));
+        }
+
+        void start()
+        {
+            err_t ec;
+            if(_srv._tcp_nodelay)
+                _sock.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+            auto ep = _sock.remote_endpoint(ec);
+            if(!ec)
+            {
+                _req.remote_addr = ep.address().to_string();
+                _req.remote_port = ep.port();
+            }
+            _read_header();
+        }
+
+      private:
+        using parser_t =
+            boost::beast::http::request_parser<boost::beast::http::buffer_body>;
+
+        enum class _next
+        {
+            none,
+            read,
+            provide,
+        };
+
+        void _arm_timer(std::chrono::microseconds d)
+        {
+            auto self = this->shared_from_this();
+            _timer.expires_after(d);
+            _timer.async_wait([self](const err_t &ec) {
+                // a completed read may have raced the expiry and re-armed it
+                if(!ec
+                   && self->_timer.expiry()
+                          <= boost::asio::steady_timer::clock_type::now())
+                    self->_close();
+            });
+        }
+
+        void _read_header()
+        {
+            _parser.emplace();
+            _parser->body_limit(_srv._payload_max_length);
+            _arm_timer(_nreq > 0 ? _srv._keep_alive_timeout
+                                 : _srv._read_timeout);
+
+            auto self = this->shared_from_this();
+            boost::beast::http::async_read_header(
+                _sock,
+                _rbuf,
+                *_parser,
+                [self](const err_t &ec, std::size_t) {
+                    self->_timer.cancel();
+                    self->_on_header(ec);
+                });
+        }
+
+        void _on_header(const err_t &ec)
+        {
+            namespace http = boost::beast::http;
+            if(ec)
+            {
+                if(ec == http::error::header_limit)
+                    _fail(431);
+                else if(ec == http::error::body_limit)
+                    _fail(413);
+                else
+                    _close();
+                return;
+            }
+
+            auto &msg = _parser->get();
+            _req.clear();
+            _res.clear();
+            _in.reset();
+            _req.method.assign(msg.method_string().data(),
+                               msg.method_string().size());
+            _req.target.assign(msg.target().data(), msg.target().size());
+            _req.version = msg.version() == 10 ? "HTTP/1.0" : "HTTP/1.1";
+            for(auto &field : msg)
+                _req.headers.emplace(
+                    std::string(field.name_string().data(),
+                                field.name_string().size()),
+                    std::string(field.value().data(), field.value().size()));
+            _parse_target();
+
+            _nreq++;
+            _head        = _req.method == "HEAD";
+            _keep_alive  = msg.keep_alive()
+                          && (_srv._keep_alive_max_count == 0
+                              || _nreq < _srv._keep_alive_max_count);
+            _route       = _srv._router.find(_req.method,
+                                             _req.path,
+                                             _req.path_params);
+            if(!_route && _head)
+                _route = _srv._router.find("GET", _req.path, _req.path_params);
+
+            if(msg[http::field::expect] == "100-continue")
+            {
+                _wbuf.append("HTTP/1.1 100 Continue\r\n\r\n");
+                _flush();
+            }
+
+            if(_route && _route->reader && _srv._pool)
+            {
+                _in = std::make_shared<_stream_in>();
+                _dispatch();
+                _read_stream();
+                return;
+            }
+            _read_body();
+        }
+
+        void _parse_target()
+        {
+            std::string_view target = _req.target;
+            std::size_t      q      = target.find('?');
+            _req.path = _decode(target.substr(0, q), false);
+            if(q == std::string_view::npos)
+                return;
+
+            std::string_view query = target.substr(q + 1);
+            while(!query.empty())
+            {
+                std::size_t      amp  = query.find('&');
+                std::string_view pair = query.substr(0, amp);
+                std::size_t      eq   = pair.find('=');
+                if(!pair.empty())
+                    _req.params.emplace(
+                        _decode(pair.substr(0, eq), true),
+                        eq == std::string_view::npos
+                            ? std::string()
+                            : _decode(pair.substr(eq + 1), true));
+                if(amp == std::string_view::npos)
+                    break;
+                query.remove_prefix(amp + 1);
+            }
+        }
+
+        // read the body straight into request::body
+        void _read_body()
+        {
+            namespace http = boost::beast::http;
+            if(_parser->is_done())
+            {
+                _dispatch();
+                return;
+            }
+
+            std::size_t old  = _req.body.size();
+            std::size_t want = HTTP_ASYNC_CHUNK_SZ;
+            if(auto remain = _parser->content_length_remaining())
+                want = std::max<std::size_t>(
+                    1,
+                    std::min<std::uint64_t>(*remain, 4 * HTTP_ASYNC_CHUNK_SZ));
+            _req.body.resize(old + want);
+            _parser->get().body().data = &_req.body[old];
+            _parser->get().body().size = want;
+            _arm_timer(_srv._read_timeout);
+
+            auto self = this->shared_from_this();
+            http::async_read(
+                _sock,
+                _rbuf,
+                *_parser,
+                [self, old, want](err_t ec, std::size_t) {
+                    self->_timer.cancel();
+                    if(ec == http::error::need_buffer)
+                        ec = {};
+                    self->_req.body.resize(
+                        old + want - self->_parser->get().body().size);
+                    if(ec == http::error::body_limit)
+                    {
+                        self->_fail(413);
+                        return;
+                    }
+                    if(ec)
+                    {
+                        self->_close();
+                        return;
+                    }
+                    self->_read_body();
+                });
+        }
+
+        // fetch one body chunk for a reader handler, the consumer asks for
+        // the next one
+        void _read_stream()
+        {
+            namespace http = boost::beast::http;
+            auto in = _in;
+            if(!in || in->failed)
+                return;
+
+            if(_parser->is_done())
+            {
+                std::lock_guard<std::mutex> lock(in->mu);
+                in->ready = true;
+                in->eof   = true;
+                in->cond.notify_all();
+                return;
+            }
+
+            in->io_buf.resize(HTTP_ASYNC_CHUNK_SZ);
+            _parser->get().body().data = &in->io_buf[0];
+            _parser->get().body().size = in->io_buf.size();
+            _arm_timer(_srv._read_timeout);
+
+            auto self = this->shared_from_this();
+            http::async_read(
+                _sock,
+                _rbuf,
+                *_parser,
+                [self, in](err_t ec, std::size_t) {
+                    self->_timer.cancel();
+                    if(ec == http::error::need_buffer)
+                        ec = {};
+
+                    std::lock_guard<std::mutex> lock(in->mu);
+                    if(ec)
+                    {
+                        in->failed = true;
+                    } else
+                    {
+                        in->io_buf.resize(in->io_buf.size()
+                                          - self->_parser->get().body().size);
+                        std::swap(in->io_buf, in->chunk);
+                        in->ready = true;
+                        in->eof   = self->_parser->is_done();
+                    }
+                    in->cond.notify_all();
+                });
+        }
+
+        content_reader_t _make_reader()
+        {
+            auto self = this->shared_from_this();
+            if(!_in)
+                return [self](content_receiver_t receiver) {
+                    auto &body = self->_req.body;
+                    return body.empty() || receiver(body.data(), body.size());
+                };
+
+            return [self](content_receiver_t receiver) {
+                auto        in = self->_in;
+                std::string data;
+                for(;;)
+                {
+                    bool eof = false;
+                    {
+                        std::unique_lock<std::mutex> lock(in->mu);
+                        while(!in->ready && !in->failed)
+                        {
+                            if(in->cond.wait_for(lock,
+                                                 std::chrono::milliseconds(100))
+                                   == std::cv_status::timeout
+                               && self->_srv._stopped.load())
+                                return false;
+                        }
+                        if(in->failed)
+                            return false;
+
+                        std::swap(data, in->chunk);
+                        in->ready = false;
+                        eof       = in->eof;
+                    }
+
+                    if(!eof)
+                        boost::asio::post(self->_sock.get_executor(),
+                                          [self]() { self->_read_stream(); });
+                    if(!data.empty() && !receiver(data.data(), data.size()))
+                    {
+                        std::lock_guard<std::mutex> lock(in->mu);
+                        in->failed = true;
+                        return false;
+                    }
+                    if(eof)
+                        return true;
+                }
+            };
+        }
+
+        void _dispatch()
+        {
+            if(!_srv._pool)
+            {
+                _handle();
+                _respond();
+                return;
+            }
+
+            auto self = this->shared_from_this();
+            _srv._pool->enqueue([self]() {
+                self->_handle();
+                boost::asio::post(self->_sock.get_executor(),
+                                  [self]() { self->_respond(); });
+            });
+        }
+
+        void _handle()
+        {
+            try
+            {
+                if(!_route)
+                    _res.status = 404;
+                else if(_route->reader)
+                    _route->reader(_req, _res, _make_reader());
+                else
+                    _route->handler(_req, _res);
+            }
+            catch(...)
+            {
+                _res.clear();
+                _res.status = 500;
+            }
+
+            if(_res.status == -1)
+                _res.status = 200;
+            if(_res.status >= 400 && _res.body.empty() && !_res.is_streaming()
+               && _srv._error_handler)
+            {
+                try
+                {
+                    _srv._error_handler(_req, _res);
+                }
+                catch(...)
+                {
+                }
+            }
+        }
+
+        // io thread: serialize the response behind any pipelined ones
+        void _respond()
+        {
+            if(!_sock.is_open())
+                return;
+
+            if(_in)
+            {
+                // body not fully consumed by the handler: cannot resync
+                std::lock_guard<std::mutex> lock(_in->mu);
+                if(!_in->eof || _in->ready || _in->failed)
+                    _keep_alive = false;
+                _in->failed = true;
+            }
+
+            bool no_body = _res.status == 204 || _res.status == 304
+                           || (_res.status >= 100 && _res.status < 200);
+            _write_head(no_body);
+            if(_res.is_streaming() && !_head && !no_body)
+            {
+                _provided = 0;
+                _provide();
+                return;
+            }
+
+            if(!_head && !no_body)
+                _wbuf.append(_res.body);
+            _finish();
+        }
+
+        void _write_head(bool no_body)
+        {
+            namespace http = boost::beast::http;
+            auto status    = http::int_to_status(
+                static_cast<unsigned int>(_res.status));
+            auto reason = http::obsolete_reason(status);
+
+            _wbuf.append("HTTP/1.1 ");
+            _append_int(static_cast<std::size_t>(_res.status));
+            _wbuf.push_back(' ');
+            _wbuf.append(reason.data(), reason.size());
+            _wbuf.append("\r\n");
+            for(auto &h : _res.headers)
+            {
+                if(_iequals(h.first, "Content-Length")
+                   || _iequals(h.first, "Transfer-Encoding")
+                   || _iequals(h.first, "Connection"))
+                    continue;
+
+                _wbuf.append(h.first);
+                _wbuf.append(": ");
+                _wbuf.append(h.second);
+                _wbuf.append("\r\n");
+            }
+
+            if(_res.chunked_content_provider_)
+            {
+                if(!no_body)
+                    _wbuf.append("Transfer-Encoding: chunked\r\n");
+            } else if(!no_body)
+            {
+                _wbuf.append("Content-Length: ");
+                _append_int(_res.content_provider_ ? _res.content_length_
+                                                   : _res.body.size());
+                _wbuf.append("\r\n");
+            }
+
+            if(!_keep_alive)
+                _wbuf.append("Connection: close\r\n");
+            else if(_req.version == "HTTP/1.0")
+                _wbuf.append("Connection: keep-alive\r\n");
+            _wbuf.append("\r\n");
+        }
+
+        // pull the next piece of a streamed response once the previous one
+        // was written
+        void _provide()
+        {
+            if(!_srv._pool)
+            {
+                _on_provided(_call_provider());
+                return;
+            }
+
+            auto self = this->shared_from_this();
+            _srv._pool->enqueue([self]() {
+                bool ok = self->_call_provider();
+                boost::asio::post(self->_sock.get_executor(),
+                                  [self, ok]() { self->_on_provided(ok); });
+            });
+        }
+
+        bool _call_provider()
+        {
+            _chunk.clear();
+            data_sink sink{&_chunk};
+            bool      ok = false;
+            try
+            {
+                if(_res.chunked_content_provider_)
+                    ok = _res.chunked_content_provider_(_provided, sink);
+                else
+                    ok = _res.content_provider_(_provided,
+                                                _res.content_length_
+                                                    - _provided,
+                                                sink);
+            }
+            catch(...)
+            {
+                ok = false;
+            }
+            _sink_done = sink._done;
+            return ok;
+        }
+
+        void _on_provided(bool ok)
+        {
+            if(!ok || !_sock.is_open())
+            {
+                _close();
+                return;
+            }
+
+            bool finished = false;
+            if(_res.chunked_content_provider_)
+            {
+                if(!_chunk.empty())
+                {
+                    char hex[2 * sizeof(std::size_t) + 1];
+                    auto r = std::to_chars(hex,
+                                           hex + sizeof(hex),
+                                           _chunk.size(),
+                                           16);
+                    _wbuf.append(hex, r.ptr);
+                    _wbuf.append("\r\n");
+                    _wbuf.append(_chunk);
+                    _wbuf.append("\r\n");
+                }
+                _provided += _chunk.size();
+                if(_sink_done)
+                {
+                    _wbuf.append("0\r\n\r\n");
+                    finished = true;
+                }
+            } else
+            {
+                std::size_t n = std::min(_chunk.size(),
+                                         _res.content_length_ - _provided);
+                _wbuf.append(_chunk, 0, n);
+                _provided += n;
+                finished = _provided >= _res.content_length_;
+                if(!finished && _sink_done)
+                {
+                    // provider gave up before content_length_ was reached
+                    _close();
+                    return;
+                }
+            }
+
+            if(finished)
+            {
+                _res.content_provider_         = nullptr;
+                _res.chunked_content_provider_ = nullptr;
+                _finish();
+                return;
+            }
+            _after_flush(_next::provide);
+        }
+
+        void _finish()
+        {
+            if(!_keep_alive)
+            {
+                _closing = true;
+                _flush();
+                return;
+            }
+
+            if(_wbuf.size() + _obuf.size() > HTTP_ASYNC_WRITE_HIGH_WATER)
+            {
+                _after_flush(_next::read);
+                return;
+            }
+            _flush();
+            _read_header();
+        }
+
+        // run next once everything queued so far hit the socket
+        void _after_flush(_next next)
+        {
+            _next_op = next;
+            _flush();
+            if(_writing)
+                return;
+
+            auto self = this->shared_from_this();
+            boost::asio::post(_sock.get_executor(),
+                              [self]() { self->_drained(); });
+        }
+
+        void _drained()
+        {
+            _next next = _next_op;
+            _next_op   = _next::none;
+            if(next == _next::read)
+                _read_header();
+            else if(next == _next::provide)
+                _provide();
+        }
+
+        void _flush()
+        {
+            if(_writing)
+                return;
+            if(_wbuf.empty())
+            {
+                if(_closing)
+                    _close();
+                return;
+            }
+
+            _writing = true;
+            std::swap(_wbuf, _obuf);
+            auto self = this->shared_from_this();
+            boost::asio::async_write(
+                _sock,
+                boost::asio::buffer(_obuf),
+                [self](const err_t &ec, std::size_t) {
+                    self->_writing = false;
+                    self->_obuf.clear();
+                    if(ec)
+                    {
+                        self->_close();
+                        return;
+                    }
+
+                    if(!self->_wbuf.empty() || self->_closing)
+                    {
+                        self->_flush();
+                        return;
+                    }
+                    if(self->_next_op != _next::none)
+                        self->_drained();
+                });
+        }
+
+        void _fail(int status)
+        {
+            _keep_alive = false;
+            _res.clear();
+            _res.status = status;
+            _write_head(false);
+            _closing = true;
+            _flush();
+        }
+
+        void _close()
+        {
+            err_t ec;
+            _timer.cancel();
+            if(_in)
+            {
+                std::lock_guard<std::mutex> lock(_in->mu);
+                _in->failed = true;
+                _in->cond.notify_all();
+            }
+            if(!_sock.is_open())
+                return;
+
+            _sock.shutdown(sock_t::shutdown_both, ec);
+            _sock.close(ec);
+        }
+
+        void _append_int(std::size_t n)
+        {
+            char buf[24];
+            auto r = std::to_chars(buf, buf + sizeof(buf), n);
+            _wbuf.append(buf, r.ptr);
+        }
+
+        static bool _iequals(const std::string &a, const char *b)
+        {
+            std::size_t i = 0;
+            for(; i < a.size() && b[i] != '\0'; ++i)
+                if(std::tolower(static_cast<unsigned char>(a[i]))
+                   != std::tolower(static_cast<unsigned char>(b[i])))
+                    return false;
+            return i == a.size() && b[i] == '\0';
+        }
+
+        static std::string _decode(std::string_view s, bool plus_as_space)
+        {
+            std::string out;
+            out.reserve(s.size());
+            for(std::size_t i = 0; i < s.size(); ++i)
+            {
+                if(s[i] == '%' && i + 2 < s.size()
+                   && std::isxdigit(static_cast<unsigned char>(s[i + 1]))
+                   && std::isxdigit(static_cast<unsigned char>(s[i + 2])))
+                {
+                    auto hex = [](char c) {
+                        return std::isdigit(static_cast<unsigned char>(c))
+                                   ? c - '0'
+                                   : std::tolower(static_cast<unsigned char>(c))
+                                         - 'a' + 10;
+                    };
+                    out.push_back(
+                        static_cast<char>(hex(s[i + 1]) * 16 + hex(s[i + 2])));
+                    i += 2;
+                } else if(plus_as_space && s[i] == '+')
+                {
+                    out.push_back(' ');
+                } else
+                {
+                    out.push_back(s[i]);
+                }
+            }
+            return out;
+        }
+
+      private:
+        http_async_server              &_srv;
+        _worker                        &_w;
+        sock_t                          _sock;
+        boost::asio::steady_timer       _timer;
+        boost::beast::flat_buffer       _rbuf;
+        std::optional<parser_t>         _parser;
+        request                         _req;
+        response                        _res;
+        const _route_t                 *_route = nullptr;
+        std::shared_ptr<_stream_in>     _in;
+        std::string                     _wbuf;
+        std::string                     _obuf;
+        std::string                     _chunk;
+        std::size_t                     _provided   = 0;
+        std::size_t                     _nreq       = 0;
+        bool                            _sink_done  = false;
+        bool                            _head       = false;
+        bool                            _keep_alive = false;
+        bool                            _writing    = false;
+        bool                            _closing    = false;
+        _next                           _next_op    = _next::none;
+    };
+
+    template <typename Handler>
+    http_async_server &
+    _route(const char *method, const std::string &pattern, Handler &&h)
+    {
+        _route_t route;
+        if constexpr(std::is_same_v<std::decay_t<Handler>, reader_handler_t>)
+            route.reader = std::forward<Handler>(h);
+        else
+            route.handler = std::forward<Handler>(h);
+        _router.add(method, pattern, std::move(route));
+        return *this;
+    }
+
+    void _accept()
+    {
+        if(!_acceptor || !_acceptor->is_open())
+            return;
+
+        _worker &w = *_workers[_next_worker++ % _workers.size()];
+        _acceptor->async_accept(
+            *w.io,
+            [this, &w](const err_t &ec, sock_t sock) {
+                if(ec == boost::asio::error::operation_aborted)
+                    return;
+
+                if(!ec)
+                {
+                    auto s =
+                        std::make_shared<_session>(*this, w, std::move(sock));
+                    boost::asio::post(*w.io, [s]() { s->start(); });
+                }
+                _accept();
+            });
+    }
+
+  private:
+    std::vector<std::unique_ptr<_worker>> _workers;
+    std::unique_ptr<acceptor_t>           _acceptor;
+    std::unique_ptr<thread_pool>          _pool;
+    http_radix_router<_route_t>           _router;
+    handler_t                             _error_handler;
+    std::size_t                           _handler_threads;
+    std::size_t                           _next_worker = 0;
+    std::size_t                           _keep_alive_max_count = 100;
+    std::chrono::microseconds _keep_alive_timeout = std::chrono::seconds(5);
+    std::chrono::microseconds _read_timeout       = std::chrono::seconds(5);
+    std::size_t               _payload_max_length = MAX_HTTP_ASYNC_PAYLOAD_SZ;
+    bool                      _tcp_nodelay        = true;
+    int                       _port               = -1;
+    std::atomic<bool>         _running{false};
+    std::atomic<bool>         _stopped{false};
+};
+
+}
+
+#endif
@@ -31,6 +31,9 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 
+#include <hj/net/http/ws_deflate.hpp>
+#include <hj/net/http/ws_message.hpp>
+
 namespace hj
 {
 
@@ -51,6 +54,9 @@ class ws_client : public std::enable_shared_from_this<ws_client>
     using close_handler_t = std::function<void(const err_t &)>;
     using send_handler_t  = std::function<void(const err_t &, std::size_t)>;
     using recv_handler_t  = std::function<void(const err_t &, std::string)>;
+    using messages_t      = std::vector<ws_message>;
+    using read_handler_t =
+        std::function<bool(const err_t &, const messages_t &)>;
 
   public:
     ws_client() = delete;
@@ -93,6 +99,12 @@ class ws_client : public std::enable_shared_from_this<ws_client>
         _ws->set_option(option);
     }
 
+    // offer permessage-deflate on the next connect
+    inline void set_deflate(const ws_deflate_options &opts)
+    {
+        _ws->set_option(make_permessage_deflate(opts));
+    }
+
     bool connect(const std::string &host,
                  const std::string &port,
                  const std::string &target = "/")
@@ -110,6 +122,8 @@ class ws_client : public std::enable_shared_from_this<ws_client>
         if(ec)
             return false;
 
+        // frames go out in several writes, do not let Nagle hold them
+        _ws->next_layer().set_option(boost::asio::ip::tcp::no_delay(true), ec);
         _ws->handshake(host, target, ec);
         if(ec)
             return false;
@@ -147,6 +161,10 @@ class ws_client : public std::enable_shared_from_this<ws_client>
                             handler(ec);
                             return;
                         }
+                        err_t ignored;
+                        self->_ws->next_layer().set_option(
+                            boost::asio::ip::tcp::no_delay(true),
+                            ignored);
                         self->_ws->async_handshake(
                             host,
                             target,
@@ -223,6 +241,23 @@ class ws_client : public std::enable_shared_from_this<ws_client>
             });
     }
 
+    // zero copy receive, see ws_server::async_read_loop
+    void async_read_loop(read_handler_t handler, std::size_t max_batch = 1)
+    {
+        auto self = shared_from_this();
+        if(!self->_connected)
+        {
+            handler(boost::asio::error::not_connected, messages_t{});
+            return;
+        }
+
+        auto loop = std::make_shared<ws_read_loop<ws_t>>(*self->_ws,
+                                                         self,
+                                                         std::move(handler),
+                                                         max_batch);
+        loop->start();
+    }
+
     void close()
     {
         if(!_connected)
@@ -285,6 +320,9 @@ class ws_client_ssl : public std::enable_shared_from_this<ws_client_ssl>
     using close_handler_t = std::function<void(const err_t &)>;
     using send_handler_t  = std::function<void(const err_t &, std::size_t)>;
     using recv_handler_t  = std::function<void(const err_t &, std::string)>;
+    using messages_t      = std::vector<ws_message>;
+    using read_handler_t =
+        std::function<bool(const err_t &, const messages_t &)>;
 
   public:
     ws_client_ssl() = delete;
@@ -352,6 +390,12 @@ class ws_client_ssl : public std::enable_shared_from_this<ws_client_ssl>
         _ws->set_option(option);
     }
 
+    // offer permessage-deflate on the next connect
+    inline void set_deflate(const ws_deflate_options &opts)
+    {
+        _ws->set_option(make_permessage_deflate(opts));
+    }
+
     bool connect(const std::string &host,
                  const std::string &port,
                  const std::string &target = "/")
@@ -369,6 +413,9 @@ class ws_client_ssl : public std::enable_shared_from_this<ws_client_ssl>
         if(ec)
             return false;
 
+        _ws->next_layer().next_layer().set_option(
+            boost::asio::ip::tcp::no_delay(true),
+            ec);
         _ws->next_layer().handshake(boost::asio::ssl::stream_base::client, ec);
         if(ec)
             return false;
@@ -409,6 +456,10 @@ class ws_client_ssl : public std::enable_shared_from_this<ws_client_ssl>
                             handler(ec);
                             return;
                         }
+                        err_t ignored;
+                        _ws->next_layer().next_layer().set_option(
+                            boost::asio::ip::tcp::no_delay(true),
+                            ignored);
                         _ws->next_layer().async_handshake(
                             boost::asio::ssl::stream_base::client,
                             [this, host, target, handler](const err_t &ec) {
@@ -486,6 +537,23 @@ class ws_client_ssl : public std::enable_shared_from_this<ws_client_ssl>
                         });
     }
 
+    // zero copy receive, see ws_server::async_read_loop
+    void async_read_loop(read_handler_t handler, std::size_t max_batch = 1)
+    {
+        auto self = shared_from_this();
+        if(!self->_connected)
+        {
+            handler(boost::asio::error::not_connected, messages_t{});
+            return;
+        }
+
+        auto loop = std::make_shared<ws_read_loop<ws_t>>(*self->_ws,
+                                                         self,
+                                                         std::move(handler),
+                                                         max_batch);
+        loop->start();
+    }
+
     void close()
     {
         if(!_connected)
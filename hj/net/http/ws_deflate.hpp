@@ -0,0 +1,77 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_WS_DEFLATE_HPP
+#define HTTP_WS_DEFLATE_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#include <boost/version.hpp>
+#include <boost/beast/websocket/option.hpp>
+
+namespace hj
+{
+
+// permessage-deflate (RFC 7692) settings for ws_server and ws_client.
+//
+// With context takeover the LZ77 window survives between messages, which is
+// where most of the ratio on small repetitive JSON comes from; turning it
+// off bounds the per connection state at the cost of ratio. Window bits and
+// mem level size that state: about (1 << (window + 2)) + (1 << (mem + 9))
+// bytes per direction.
+struct ws_deflate_options
+{
+    bool enable                  = true;
+    bool server_context_takeover = true;
+    bool client_context_takeover = true;
+    int  server_max_window_bits  = 15; // 9..15, zlib mishandles 8
+    int  client_max_window_bits  = 15; // 9..15, zlib mishandles 8
+    int  level                   = 6;  // zlib level, 0..9
+    int  mem_level               = 8;  // zlib memLevel, 1..9
+
+    // messages shorter than this go out uncompressed; needs Boost >= 1.79,
+    // older beast compresses every message once the extension is negotiated
+    std::size_t min_size = 64;
+};
+
+inline boost::beast::websocket::permessage_deflate
+make_permessage_deflate(const ws_deflate_options &opts)
+{
+    boost::beast::websocket::permessage_deflate pmd;
+    pmd.server_enable              = opts.enable;
+    pmd.client_enable              = opts.enable;
+    pmd.server_max_window_bits     = std::clamp(opts.server_max_window_bits,
+                                                9,
+                                                15);
+    pmd.client_max_window_bits     = std::clamp(opts.client_max_window_bits,
+                                                9,
+                                                15);
+    pmd.server_no_context_takeover = !opts.server_context_takeover;
+    pmd.client_no_context_takeover = !opts.client_context_takeover;
+    pmd.compLevel                  = std::clamp(opts.level, 0, 9);
+    pmd.memLevel                   = std::clamp(opts.mem_level, 1, 9);
+#if BOOST_VERSION >= 107900
+    pmd.msg_size_threshold = opts.min_size;
+#endif
+    return pmd;
+}
+
+} // namespace hj
+
+#endif // HTTP_WS_DEFLATE_HPP
@@ -0,0 +1,184 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HTTP_WS_MESSAGE_HPP
+#define HTTP_WS_MESSAGE_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+namespace hj
+{
+
+// A received websocket message: a view into the refcounted buffer it was
+// read into. Holding a ws_message keeps that buffer alive, otherwise the
+// read loop reuses it for the next messages.
+class ws_message
+{
+  public:
+    using buffer_t     = boost::beast::flat_buffer;
+    using buffer_ptr_t = std::shared_ptr<const buffer_t>;
+
+  public:
+    ws_message() = default;
+    ws_message(buffer_ptr_t buf,
+               std::size_t  offset,
+               std::size_t  len,
+               bool         binary)
+        : _buf{std::move(buf)}
+        , _offset{offset}
+        , _len{len}
+        , _binary{binary}
+    {
+    }
+
+    inline const char *data() const
+    {
+        return _buf ? static_cast<const char *>(_buf->data().data()) + _offset
+                    : nullptr;
+    }
+    inline std::size_t      size() const { return _len; }
+    inline bool             empty() const { return _len == 0; }
+    inline bool             binary() const { return _binary; }
+    inline std::string_view view() const { return {data(), _len}; }
+    inline std::string      str() const { return std::string(view()); }
+
+  private:
+    buffer_ptr_t _buf;
+    std::size_t  _offset = 0;
+    std::size_t  _len    = 0;
+    bool         _binary = false;
+};
+
+// Reads messages back to back into one buffer and hands them out as
+// ws_message views; used by ws_server::async_read_loop and
+// ws_client::async_read_loop. With max_batch > 1 it keeps reading while
+// the socket already has bytes and delivers the messages together. A
+// batch waits for a message whose first bytes already arrived, so keep
+// max_batch at 1 for peers that trickle large messages.
+template <typename Stream>
+class ws_read_loop : public std::enable_shared_from_this<ws_read_loop<Stream>>
+{
+  public:
+    using err_t       = boost::system::error_code;
+    using messages_t  = std::vector<ws_message>;
+    using handler_t   = std::function<bool(const err_t &, const messages_t &)>;
+    using buffer_t    = ws_message::buffer_t;
+    using owner_ptr_t = std::shared_ptr<void>;
+
+  public:
+    ws_read_loop(Stream     &ws,
+                 owner_ptr_t owner,
+                 handler_t   handler,
+                 std::size_t max_batch)
+        : _ws{ws}
+        , _owner{std::move(owner)}
+        , _handler{std::move(handler)}
+        , _max_batch{max_batch > 0 ? max_batch : 1}
+        , _buf{std::make_shared<buffer_t>()}
+    {
+    }
+
+    inline void start() { _read(); }
+
+  private:
+    struct _mark
+    {
+        std::size_t offset;
+        std::size_t len;
+        bool        binary;
+    };
+
+    void _read()
+    {
+        auto self = this->shared_from_this();
+        _ws.async_read(*_buf, [self](const err_t &ec, std::size_t n) {
+            self->_on_read(ec, n);
+        });
+    }
+
+    void _on_read(const err_t &ec, std::size_t n)
+    {
+        if(ec)
+        {
+            if(!_marks.empty())
+                _deliver();
+            _handler(ec, messages_t{});
+            return;
+        }
+
+        _marks.push_back({_buf->size() - n, n, _ws.got_binary()});
+        if(_marks.size() < _max_batch && _readable())
+        {
+            _read();
+            return;
+        }
+
+        if(_deliver())
+            _read();
+    }
+
+    bool _readable()
+    {
+        err_t ec;
+        auto  n = boost::beast::get_lowest_layer(_ws).available(ec);
+        return !ec && n > 0;
+    }
+
+    // returns the handler's verdict on reading further
+    bool _deliver()
+    {
+        for(auto &m : _marks)
+            _batch.emplace_back(_buf, m.offset, m.len, m.binary);
+        _marks.clear();
+        bool more = _handler(err_t{}, _batch);
+        _batch.clear();
+
+        // a retained message owns the old buffer, read into a fresh one
+        if(_buf.use_count() == 1)
+        {
+            _buf->consume(_buf->size());
+            return more;
+        }
+
+        auto cap = _buf->capacity();
+        _buf     = std::make_shared<buffer_t>();
+        _buf->reserve(cap);
+        return more;
+    }
+
+  private:
+    Stream                   &_ws;
+    owner_ptr_t               _owner;
+    handler_t                 _handler;
+    std::size_t               _max_batch;
+    std::shared_ptr<buffer_t> _buf;
+    std::vector<_mark>        _marks;
+    messages_t                _batch;
+};
+
+} // namespace hj
+
+#endif // HTTP_WS_MESSAGE_HPP
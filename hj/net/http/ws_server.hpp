@@ -28,6 +28,9 @@
 #include <queue>
 #include <condition_variable>
 #include <filesystem>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
@@ -37,6 +40,9 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/ssl/stream.hpp>
 
+#include <hj/net/http/ws_deflate.hpp>
+#include <hj/net/http/ws_message.hpp>
+
 // support for boost.beast websocket ssl teardown
 namespace boost
 {
@@ -58,10 +64,315 @@ void teardown(
 } // namespace beast
 } // namespace boost
 
-// ws_server / ws_server_ssl
+#ifndef WS_FANOUT_HIGH_WATER
+#define WS_FANOUT_HIGH_WATER (1024 * 1024) // queued bytes per subscriber
+#endif
+
+// ws_fanout / ws_server / ws_server_ssl
 namespace hj
 {
 
+// Broadcast to many websocket streams. A message is built once into a
+// refcounted buffer and the same buffer is queued to every subscriber, so
+// the per connection cost is a frame header and a pointer in a queue.
+// With permessage-deflate enabled each stream compresses the payload again
+// with its own context, the deflate cost stays per subscriber.
+//
+// Every write to a subscribed stream must go through the fanout (broadcast
+// or send), beast allows only one outstanding write per stream. Writes are
+// dispatched to the stream's executor, give the stream a strand if its
+// io_context runs on several threads.
+template <typename Stream>
+class ws_fanout
+{
+  public:
+    using stream_ptr_t = std::shared_ptr<Stream>;
+    using err_t        = boost::system::error_code;
+
+    struct message
+    {
+        std::string data;
+        bool        binary = false;
+    };
+    using message_ptr_t = std::shared_ptr<const message>;
+
+    // what happens to a subscriber whose queue is over the high water mark
+    enum class overflow_policy
+    {
+        drop,      // skip the message for this subscriber only
+        disconnect // close the subscriber's socket
+    };
+
+  public:
+    explicit ws_fanout(std::size_t     high_water = WS_FANOUT_HIGH_WATER,
+                       overflow_policy policy     = overflow_policy::drop)
+        : _st{std::make_shared<_state>()}
+    {
+        set_high_water(high_water, policy);
+    }
+    ~ws_fanout() { clear(); }
+
+    ws_fanout(const ws_fanout &)            = delete;
+    ws_fanout &operator=(const ws_fanout &) = delete;
+
+    static inline message_ptr_t make_message(std::string data,
+                                             bool        binary = false)
+    {
+        auto msg    = std::make_shared<message>();
+        msg->data   = std::move(data);
+        msg->binary = binary;
+        return msg;
+    }
+
+    void set_high_water(std::size_t bytes, overflow_policy policy)
+    {
+        std::lock_guard<std::mutex> lock(_st->mu);
+        _st->high_water = bytes;
+        _st->policy     = policy;
+    }
+
+    inline std::size_t dropped() const { return _st->dropped.load(); }
+    inline std::size_t disconnected() const
+    {
+        return _st->disconnected.load();
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_st->mu);
+        return _st->subs.size();
+    }
+
+    bool subscribe(stream_ptr_t ws)
+    {
+        if(!ws)
+            return false;
+
+        auto                        s = std::make_shared<_sub>(std::move(ws));
+        std::lock_guard<std::mutex> lock(_st->mu);
+        return _st->subs.emplace(s->ws.get(), s).second;
+    }
+
+    // messages already queued to the stream are still written
+    bool unsubscribe(const stream_ptr_t &ws)
+    {
+        std::lock_guard<std::mutex> lock(_st->mu);
+        return _st->subs.erase(ws.get()) > 0;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_st->mu);
+        _st->subs.clear();
+    }
+
+    // returns the number of subscribers the message was queued to
+    std::size_t broadcast(const message_ptr_t &msg)
+    {
+        if(!msg)
+            return 0;
+
+        std::size_t                        queued = 0;
+        std::vector<std::shared_ptr<_sub>> start;
+        std::vector<std::shared_ptr<_sub>> kick;
+        {
+            std::lock_guard<std::mutex> lock(_st->mu);
+            for(auto it = _st->subs.begin(); it != _st->subs.end();)
+            {
+                switch(_push(*it->second, msg))
+                {
+                    case _push_result::queued:
+                        queued++;
+                        break;
+                    case _push_result::start:
+                        queued++;
+                        start.push_back(it->second);
+                        break;
+                    case _push_result::overflow:
+                        if(_st->policy == overflow_policy::disconnect)
+                        {
+                            kick.push_back(it->second);
+                            it = _st->subs.erase(it);
+                            continue;
+                        }
+                        _st->dropped++;
+                        break;
+                }
+                ++it;
+            }
+        }
+
+        for(auto &s : start)
+            _start(_st, s);
+        for(auto &s : kick)
+            _kick(_st, s);
+        return queued;
+    }
+
+    inline std::size_t broadcast(std::string data, bool binary = false)
+    {
+        return broadcast(make_message(std::move(data), binary));
+    }
+
+    // unicast through the subscriber's queue, keeps ordering with broadcasts
+    bool send(const stream_ptr_t &ws, const message_ptr_t &msg)
+    {
+        std::shared_ptr<_sub> s;
+        _push_result          ret;
+        bool                  kick = false;
+        {
+            std::lock_guard<std::mutex> lock(_st->mu);
+            auto                        it = _st->subs.find(ws.get());
+            if(it == _st->subs.end() || !msg)
+                return false;
+
+            s   = it->second;
+            ret = _push(*s, msg);
+            if(ret == _push_result::overflow)
+            {
+                kick = _st->policy == overflow_policy::disconnect;
+                if(kick)
+                    _st->subs.erase(it);
+                else
+                    _st->dropped++;
+            }
+        }
+
+        if(ret == _push_result::start)
+            _start(_st, s);
+        if(ret != _push_result::overflow)
+            return true;
+
+        if(kick)
+            _kick(_st, s);
+        return false;
+    }
+
+  private:
+    struct _sub
+    {
+        explicit _sub(stream_ptr_t ws)
+            : ws{std::move(ws)}
+        {
+        }
+
+        stream_ptr_t              ws;
+        std::mutex                mu;
+        std::deque<message_ptr_t> q;
+        std::size_t               bytes   = 0;
+        bool                      writing = false;
+    };
+
+    struct _state
+    {
+        using subs_t = std::unordered_map<Stream *, std::shared_ptr<_sub>>;
+
+        mutable std::mutex       mu;
+        subs_t                   subs;
+        std::size_t              high_water = 0;
+        overflow_policy          policy     = overflow_policy::drop;
+        std::atomic<std::size_t> dropped{0};
+        std::atomic<std::size_t> disconnected{0};
+    };
+
+    enum class _push_result
+    {
+        queued,
+        start,
+        overflow
+    };
+
+    // caller holds _state::mu; an empty queue always takes one message so
+    // payloads larger than the high water mark still go out
+    _push_result _push(_sub &s, const message_ptr_t &msg)
+    {
+        std::lock_guard<std::mutex> lock(s.mu);
+        if(s.bytes > 0 && s.bytes + msg->data.size() > _st->high_water)
+            return _push_result::overflow;
+
+        s.q.push_back(msg);
+        s.bytes += msg->data.size();
+        if(s.writing)
+            return _push_result::queued;
+
+        s.writing = true;
+        return _push_result::start;
+    }
+
+    static void _start(std::shared_ptr<_state> st, std::shared_ptr<_sub> s)
+    {
+        auto ex = s->ws->get_executor();
+        boost::asio::dispatch(ex, [st, s]() { _write(st, s); });
+    }
+
+    // runs on the stream's executor, one write in flight per subscriber
+    static void _write(std::shared_ptr<_state> st, std::shared_ptr<_sub> s)
+    {
+        message_ptr_t msg;
+        {
+            std::lock_guard<std::mutex> lock(s->mu);
+            if(s->q.empty())
+            {
+                s->writing = false;
+                return;
+            }
+            msg = s->q.front();
+        }
+
+        s->ws->binary(msg->binary);
+        s->ws->async_write(
+            boost::asio::buffer(msg->data),
+            [st, s, msg](const err_t &ec, std::size_t) {
+                {
+                    std::lock_guard<std::mutex> lock(s->mu);
+                    s->q.pop_front();
+                    s->bytes -= msg->data.size();
+                    if(ec)
+                    {
+                        s->q.clear();
+                        s->bytes   = 0;
+                        s->writing = false;
+                    }
+                }
+
+                if(!ec)
+                {
+                    _write(st, s);
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(st->mu);
+                auto                        it = st->subs.find(s->ws.get());
+                if(it != st->subs.end() && it->second == s)
+                    st->subs.erase(it);
+            });
+    }
+
+    // the lowest layer is closed, a websocket close handshake would queue
+    // behind the backlog that made the subscriber slow in the first place;
+    // the front message stays for the write completion to pop, the queue is
+    // empty while writing only between that pop and the next _write
+    static void _kick(std::shared_ptr<_state> st, std::shared_ptr<_sub> s)
+    {
+        st->disconnected++;
+        {
+            std::lock_guard<std::mutex> lock(s->mu);
+            std::size_t keep = s->writing && !s->q.empty() ? 1 : 0;
+            s->q.erase(s->q.begin() + keep, s->q.end());
+            s->bytes = s->q.empty() ? 0 : s->q.front()->data.size();
+        }
+
+        auto ex = s->ws->get_executor();
+        boost::asio::post(ex, [s]() {
+            err_t ec;
+            boost::beast::get_lowest_layer(*s->ws).close(ec);
+        });
+    }
+
+  private:
+    std::shared_ptr<_state> _st;
+};
+
 class ws_server : public std::enable_shared_from_this<ws_server>
 {
   public:
@@ -74,7 +385,9 @@ class ws_server : public std::enable_shared_from_this<ws_server>
         boost::beast::websocket::stream<boost::asio::ip::tcp::socket>;
     using ws_stream_ptr_t = std::shared_ptr<
         boost::beast::websocket::stream<boost::asio::ip::tcp::socket>>;
-    using err_t = boost::system::error_code;
+    using err_t     = boost::system::error_code;
+    using fanout_t  = ws_fanout<ws_stream_t>;
+    using deflate_t = boost::beast::websocket::permessage_deflate;
 
     using opt_reuse_address = boost::asio::socket_base::reuse_address;
 
@@ -85,6 +398,9 @@ class ws_server : public std::enable_shared_from_this<ws_server>
     using send_handler_t =
         std::function<void(const err_t &, ws_stream_ptr_t, std::size_t)>;
     using close_handler_t = std::function<void(const err_t &)>;
+    using messages_t      = std::vector<ws_message>;
+    using read_handler_t  = std::function<
+        bool(const err_t &, ws_stream_ptr_t, const messages_t &)>;
 
   public:
     ws_server() = delete;
@@ -121,6 +437,13 @@ class ws_server : public std::enable_shared_from_this<ws_server>
 #endif
     }
 
+    // permessage-deflate offered to streams accepted after this call
+    inline void set_deflate(const ws_deflate_options &opts)
+    {
+        std::lock_guard<std::mutex> lock(_mu);
+        _pmd = make_permessage_deflate(opts);
+    }
+
     ws_stream_ptr_t accept(const uint16_t port, err_t &err)
     {
         endpoint_t ep{boost::asio::ip::tcp::v4(), port};
@@ -160,7 +483,12 @@ class ws_server : public std::enable_shared_from_this<ws_server>
 
         auto sock = std::make_shared<sock_t>(_io);
         _acceptor->accept(*sock);
+
+        // frames go out in several writes, Nagle would hold the tail of a
+        // large one until the peer's delayed ACK (~40ms on loopback)
+        sock->set_option(boost::asio::ip::tcp::no_delay(true), err);
         auto ws = std::make_shared<ws_stream_t>(std::move(*sock));
+        ws->set_option(_pmd);
 
         // handshake
         ws->accept(err);
@@ -207,17 +535,27 @@ class ws_server : public std::enable_shared_from_this<ws_server>
             return;
         }
 
+        // set_deflate may run concurrently, take the settings under the lock
+        deflate_t pmd;
+        {
+            std::lock_guard<std::mutex> lock(_mu);
+            pmd = _pmd;
+        }
+
         auto sock = std::make_shared<sock_t>(self->_io);
         self->_acceptor->async_accept(
             *sock,
-            [self, sock, handler](const err_t &ec) {
+            [self, sock, pmd, handler](const err_t &ec) {
                 if(ec)
                 {
                     handler(ec, nullptr);
                     return;
                 }
 
+                err_t ignored;
+                sock->set_option(boost::asio::ip::tcp::no_delay(true), ignored);
                 auto ws = std::make_shared<ws_stream_t>(std::move(*sock));
+                ws->set_option(pmd);
                 ws->async_accept([self, ws, handler](const err_t &ec2) {
                     handler(ec2, ws);
                 });
@@ -232,7 +570,7 @@ class ws_server : public std::enable_shared_from_this<ws_server>
             return std::string();
         }
 
-        boost::beast::flat_buffer buffer(1024);
+        boost::beast::flat_buffer buffer;
         auto                      sz = ws->read(buffer, err);
         if(err)
             return std::string();
@@ -263,6 +601,32 @@ class ws_server : public std::enable_shared_from_this<ws_server>
             });
     }
 
+    // Zero copy receive: reads until the handler returns false, errors are
+    // reported once with an empty batch. A message views the read buffer,
+    // which is reused after the handler returns unless a copy of the
+    // ws_message is kept. max_batch > 1 delivers already readable messages
+    // together, see ws_read_loop.
+    void async_read_loop(ws_stream_ptr_t ws,
+                         read_handler_t  handler,
+                         std::size_t     max_batch = 1)
+    {
+        auto self = shared_from_this();
+        if(self->_closed.load() || !ws)
+        {
+            handler(boost::asio::error::not_connected, ws, messages_t{});
+            return;
+        }
+
+        auto loop = std::make_shared<ws_read_loop<ws_stream_t>>(
+            *ws,
+            ws,
+            [self, ws, handler](const err_t &ec, const messages_t &msgs) {
+                return handler(ec, ws, msgs);
+            },
+            max_batch);
+        loop->start();
+    }
+
     size_t
     send(std::shared_ptr<ws_stream_t> ws, err_t &err, const std::string &msg)
     {
@@ -294,6 +658,25 @@ class ws_server : public std::enable_shared_from_this<ws_server>
             });
     }
 
+    // subscribers of broadcast(), see ws_fanout
+    inline fanout_t &fanout() { return _fanout; }
+    inline bool      subscribe(ws_stream_ptr_t ws)
+    {
+        return _fanout.subscribe(std::move(ws));
+    }
+    inline bool unsubscribe(const ws_stream_ptr_t &ws)
+    {
+        return _fanout.unsubscribe(ws);
+    }
+    inline std::size_t broadcast(const fanout_t::message_ptr_t &msg)
+    {
+        return _closed.load() ? 0 : _fanout.broadcast(msg);
+    }
+    inline std::size_t broadcast(const std::string &msg, bool binary = false)
+    {
+        return broadcast(fanout_t::make_message(msg, binary));
+    }
+
     void close()
     {
         if(_closed.load())
@@ -307,6 +690,7 @@ class ws_server : public std::enable_shared_from_this<ws_server>
             _acceptor.reset();
         }
         _binded_endpoint = endpoint_t();
+        _fanout.clear();
     }
 
     void async_close(close_handler_t              handler,
@@ -329,6 +713,7 @@ class ws_server : public std::enable_shared_from_this<ws_server>
         }
 
         _binded_endpoint = endpoint_t();
+        _fanout.clear();
         // wait all ws closed
         auto left = std::make_shared<size_t>(conns.size());
         for(auto &ws : conns)
@@ -356,6 +741,8 @@ class ws_server : public std::enable_shared_from_this<ws_server>
     std::unique_ptr<acceptor_t> _acceptor;
     endpoint_t                  _binded_endpoint;
     std::atomic<bool>           _closed;
+    fanout_t                    _fanout;
+    deflate_t                   _pmd;
 };
 
 class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
@@ -372,6 +759,8 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
     using ws_stream_t       = boost::beast::websocket::stream<ssl_stream_t>;
     using ws_stream_ptr_t   = std::shared_ptr<ws_stream_t>;
     using err_t             = boost::system::error_code;
+    using fanout_t          = ws_fanout<ws_stream_t>;
+    using deflate_t         = boost::beast::websocket::permessage_deflate;
     using opt_reuse_address = boost::asio::socket_base::reuse_address;
 
     using accept_handler_t =
@@ -381,6 +770,9 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
     using send_handler_t =
         std::function<void(const err_t &, ws_stream_ptr_t, std::size_t)>;
     using close_handler_t = std::function<void(const err_t &)>;
+    using messages_t      = std::vector<ws_message>;
+    using read_handler_t  = std::function<
+        bool(const err_t &, ws_stream_ptr_t, const messages_t &)>;
 
   public:
     ws_server_ssl() = delete;
@@ -431,6 +823,13 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
         return ctx;
     }
 
+    // permessage-deflate offered to streams accepted after this call
+    inline void set_deflate(const ws_deflate_options &opts)
+    {
+        std::lock_guard<std::mutex> lock(_mu);
+        _pmd = make_permessage_deflate(opts);
+    }
+
     ws_stream_ptr_t accept(const uint16_t port, err_t &err)
     {
         endpoint_t ep{boost::asio::ip::tcp::v4(), port};
@@ -470,6 +869,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
 
         auto sock = std::make_shared<sock_t>(_io);
         _acceptor->accept(*sock);
+        sock->set_option(boost::asio::ip::tcp::no_delay(true), err);
         auto ssl_stream =
             std::make_shared<ssl_stream_t>(std::move(*sock), *_ssl_ctx);
         ssl_stream->handshake(boost::asio::ssl::stream_base::server, err);
@@ -477,6 +877,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             return nullptr;
 
         auto ws = std::make_shared<ws_stream_t>(std::move(*ssl_stream));
+        ws->set_option(_pmd);
         ws->accept(err);
         if(err)
             return nullptr;
@@ -521,21 +922,30 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             return;
         }
 
+        // set_deflate may run concurrently, take the settings under the lock
+        deflate_t pmd;
+        {
+            std::lock_guard<std::mutex> lock(_mu);
+            pmd = _pmd;
+        }
+
         auto sock = std::make_shared<sock_t>(self->_io);
         self->_acceptor->async_accept(
             *sock,
-            [self, sock, handler](const err_t &ec) {
+            [self, sock, pmd, handler](const err_t &ec) {
                 if(ec)
                 {
                     handler(ec, nullptr);
                     return;
                 }
+                err_t ignored;
+                sock->set_option(boost::asio::ip::tcp::no_delay(true), ignored);
                 auto ssl_stream =
                     std::make_shared<ssl_stream_t>(std::move(*sock),
                                                    *self->_ssl_ctx);
                 ssl_stream->async_handshake(
                     boost::asio::ssl::stream_base::server,
-                    [self, ssl_stream, handler](const err_t &ec2) {
+                    [self, ssl_stream, pmd, handler](const err_t &ec2) {
                         if(ec2)
                         {
                             handler(ec2, nullptr);
@@ -543,6 +953,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
                         }
                         auto ws = std::make_shared<ws_stream_t>(
                             std::move(*ssl_stream));
+                        ws->set_option(pmd);
                         ws->async_accept([self, ws, handler](const err_t &ec3) {
                             handler(ec3, ws);
                         });
@@ -557,7 +968,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             err = boost::asio::error::not_connected;
             return std::string();
         }
-        boost::beast::flat_buffer buffer(1024);
+        boost::beast::flat_buffer buffer;
         auto                      sz = ws->read(buffer, err);
         if(err)
             return std::string();
@@ -586,6 +997,32 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             });
     }
 
+    // Zero copy receive: reads until the handler returns false, errors are
+    // reported once with an empty batch. A message views the read buffer,
+    // which is reused after the handler returns unless a copy of the
+    // ws_message is kept. max_batch > 1 delivers already readable messages
+    // together, see ws_read_loop.
+    void async_read_loop(ws_stream_ptr_t ws,
+                         read_handler_t  handler,
+                         std::size_t     max_batch = 1)
+    {
+        auto self = shared_from_this();
+        if(self->_closed.load() || !ws)
+        {
+            handler(boost::asio::error::not_connected, ws, messages_t{});
+            return;
+        }
+
+        auto loop = std::make_shared<ws_read_loop<ws_stream_t>>(
+            *ws,
+            ws,
+            [self, ws, handler](const err_t &ec, const messages_t &msgs) {
+                return handler(ec, ws, msgs);
+            },
+            max_batch);
+        loop->start();
+    }
+
     size_t
     send(std::shared_ptr<ws_stream_t> ws, err_t &err, const std::string &msg)
     {
@@ -615,6 +1052,25 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             });
     }
 
+    // subscribers of broadcast(), see ws_fanout
+    inline fanout_t &fanout() { return _fanout; }
+    inline bool      subscribe(ws_stream_ptr_t ws)
+    {
+        return _fanout.subscribe(std::move(ws));
+    }
+    inline bool unsubscribe(const ws_stream_ptr_t &ws)
+    {
+        return _fanout.unsubscribe(ws);
+    }
+    inline std::size_t broadcast(const fanout_t::message_ptr_t &msg)
+    {
+        return _closed.load() ? 0 : _fanout.broadcast(msg);
+    }
+    inline std::size_t broadcast(const std::string &msg, bool binary = false)
+    {
+        return broadcast(fanout_t::make_message(msg, binary));
+    }
+
     void close()
     {
         if(_closed.load())
@@ -628,6 +1084,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
             _acceptor.reset();
         }
         _binded_endpoint = endpoint_t();
+        _fanout.clear();
     }
 
     void async_close(close_handler_t              handler,
@@ -650,6 +1107,7 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
         }
 
         _binded_endpoint = endpoint_t();
+        _fanout.clear();
         // wait all ws closed
         auto left = std::make_shared<size_t>(conns.size());
         for(auto &ws : conns)
@@ -695,6 +1153,8 @@ class ws_server_ssl : public std::enable_shared_from_this<ws_server_ssl>
     std::unique_ptr<acceptor_t> _acceptor;
     endpoint_t                  _binded_endpoint;
     std::atomic<bool>           _closed;
+    fanout_t                    _fanout;
+    deflate_t                   _pmd;
 };
 
 } // namespace hj
@@ -17,6 +17,7 @@
 
 #ifdef HJ_ENABLE_ZMQ
 #include <hj/net/zmq.hpp>
+#include <hj/net/zmq_reactor.hpp>
 #endif
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef TCP_HPP
 #define TCP_HPP
 
+#include <hj/net/tcp/tcp_codec.hpp>
+
 #include <hj/net/tcp/tcp_conn.hpp>
 
 #include <hj/net/tcp/tcp_dialer.hpp>
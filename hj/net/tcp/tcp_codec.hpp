@@ -0,0 +1,599 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TCP_CODEC_HPP
+#define TCP_CODEC_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <hj/net/tcp/tcp_conn.hpp>
+
+#ifndef MAX_TCP_CODEC_FRAME_SZ
+#define MAX_TCP_CODEC_FRAME_SZ (16 * 1024 * 1024)
+#endif
+
+namespace hj
+{
+
+// message type of the built-in codecs: a header/body view
+// - decoded frames point into tcp_conn's receive buffer, valid until the
+//   recv handler returns; call retain() to keep them longer
+// - frames to encode point at caller memory, valid until encode returns
+// - a corrupted stream yields an invalid frame, close the connection
+// NOTE: tcp_conn encodes into an MTU sized buffer, bind() caps max_frame to it
+//       and to what the receive buffer can hold
+class tcp_frame
+{
+  public:
+    using byte_t = unsigned char;
+    using data_t = std::vector<byte_t>;
+
+    tcp_frame() = default;
+    tcp_frame(const void *body, const std::size_t body_len)
+        : _body{static_cast<const byte_t *>(body)}
+        , _body_len{body_len}
+    {
+    }
+    tcp_frame(const void       *head,
+              const std::size_t head_len,
+              const void       *body,
+              const std::size_t body_len)
+        : _head{static_cast<const byte_t *>(head)}
+        , _head_len{head_len}
+        , _body{static_cast<const byte_t *>(body)}
+        , _body_len{body_len}
+    {
+    }
+    explicit tcp_frame(std::string_view body)
+        : tcp_frame(body.data(), body.size())
+    {
+    }
+
+    inline const byte_t *head() const noexcept { return _head; }
+    inline std::size_t   head_size() const noexcept { return _head_len; }
+    inline const byte_t *data() const noexcept { return _body; }
+    inline std::size_t   size() const noexcept { return _body_len; }
+    inline bool          empty() const noexcept { return _body_len == 0; }
+    inline bool          valid() const noexcept { return _valid; }
+    inline bool          retained() const noexcept { return _owned != nullptr; }
+
+    inline std::string_view head_view() const noexcept
+    {
+        return std::string_view(reinterpret_cast<const char *>(_head),
+                                _head_len);
+    }
+    inline std::string_view view() const noexcept
+    {
+        return std::string_view(reinterpret_cast<const char *>(_body),
+                                _body_len);
+    }
+
+    // copy the viewed bytes once into shared storage, copies of a retained
+    // frame share it
+    tcp_frame &retain()
+    {
+        if(_owned || (_head_len == 0 && _body_len == 0))
+            return *this;
+
+        auto owned = std::make_shared<data_t>(_head_len + _body_len);
+        if(_head_len > 0)
+            std::memcpy(owned->data(), _head, _head_len);
+        if(_body_len > 0)
+            std::memcpy(owned->data() + _head_len, _body, _body_len);
+
+        _owned = std::move(owned);
+        _head  = _owned->data();
+        _body  = _owned->data() + _head_len;
+        return *this;
+    }
+
+    inline void reset(const byte_t *head,
+                      std::size_t   head_len,
+                      const byte_t *body,
+                      std::size_t   body_len) noexcept
+    {
+        _owned.reset();
+        _head     = head;
+        _head_len = head_len;
+        _body     = body;
+        _body_len = body_len;
+        _valid    = true;
+    }
+
+    // mark the stream corrupted, the connection should be closed
+    inline void invalidate() noexcept
+    {
+        reset(nullptr, 0, nullptr, 0);
+        _valid = false;
+    }
+
+  private:
+    const byte_t                 *_head     = nullptr;
+    std::size_t                   _head_len = 0;
+    const byte_t                 *_body     = nullptr;
+    std::size_t                   _body_len = 0;
+    bool                          _valid    = true;
+    std::shared_ptr<const data_t> _owned;
+};
+
+enum class byte_order
+{
+    big,
+    little,
+};
+
+enum class length_field
+{
+    u8,
+    u16,
+    u32,
+    varint, // unsigned LEB128
+};
+
+namespace detail
+{
+
+inline std::size_t length_field_size(const length_field field) noexcept
+{
+    switch(field)
+    {
+        case length_field::u8:
+            return 1;
+        case length_field::u16:
+            return 2;
+        case length_field::u32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+inline void
+put_uint(unsigned char *p, std::uint64_t v, std::size_t n, byte_order order)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::size_t shift = (order == byte_order::big ? n - 1 - i : i) * 8;
+        p[i]              = static_cast<unsigned char>(v >> shift);
+    }
+}
+
+inline std::uint64_t
+get_uint(const unsigned char *p, std::size_t n, byte_order order)
+{
+    std::uint64_t v = 0;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::size_t shift = (order == byte_order::big ? n - 1 - i : i) * 8;
+        v |= static_cast<std::uint64_t>(p[i]) << shift;
+    }
+    return v;
+}
+
+inline std::size_t varint_size(std::uint64_t v) noexcept
+{
+    std::size_t n = 1;
+    for(; v >= 0x80; v >>= 7)
+        ++n;
+    return n;
+}
+
+inline std::size_t put_varint(unsigned char *p, std::uint64_t v) noexcept
+{
+    std::size_t n = 0;
+    for(; v >= 0x80; v >>= 7)
+        p[n++] = static_cast<unsigned char>(v | 0x80);
+    p[n++] = static_cast<unsigned char>(v);
+    return n;
+}
+
+// 0: need more bytes, -1: malformed, else bytes consumed
+inline int
+get_varint(const unsigned char *p, std::size_t len, std::uint64_t &v) noexcept
+{
+    v = 0;
+    for(std::size_t i = 0; i < len && i < 10; ++i)
+    {
+        v |= static_cast<std::uint64_t>(p[i] & 0x7F) << (7 * i);
+        if((p[i] & 0x80) == 0)
+            return static_cast<int>(i + 1);
+    }
+    return len >= 10 ? -1 : 0;
+}
+
+// largest body that still fits room bytes next to overhead bytes of framing
+inline std::size_t clamp_frame(const std::size_t max_frame,
+                               const std::size_t room,
+                               const std::size_t overhead) noexcept
+{
+    return room > overhead ? std::min(max_frame, room - overhead) : 0;
+}
+
+} // namespace detail
+
+// <length><body>, length counts body bytes only
+class length_prefix_codec
+{
+  public:
+    using msg_ptr_t = hj::tcp_conn::msg_ptr_t;
+
+    explicit length_prefix_codec(
+        const length_field field     = length_field::u32,
+        const byte_order   order     = byte_order::big,
+        const std::size_t  max_frame = MAX_TCP_CODEC_FRAME_SZ)
+        : _field{field}
+        , _order{order}
+        , _max_frame{max_frame}
+    {
+        if(_field != length_field::varint)
+        {
+            std::uint64_t limit =
+                (std::uint64_t(1) << (8 * detail::length_field_size(_field)))
+                - 1;
+            _max_frame = static_cast<std::size_t>(
+                std::min<std::uint64_t>(_max_frame, limit));
+        }
+    }
+
+    inline std::size_t max_frame() const noexcept { return _max_frame; }
+
+    std::size_t
+    encode(unsigned char *buf, const std::size_t len, msg_ptr_t msg) const
+    {
+        const tcp_frame *f = static_cast<const tcp_frame *>(msg);
+        if(f == nullptr || f->size() > _max_frame)
+            return 0;
+
+        std::size_t prefix = _field == length_field::varint
+                                 ? detail::varint_size(f->size())
+                                 : detail::length_field_size(_field);
+        if(prefix + f->size() > len)
+            return 0;
+
+        if(_field == length_field::varint)
+            detail::put_varint(buf, f->size());
+        else
+            detail::put_uint(buf, f->size(), prefix, _order);
+        if(f->size() > 0)
+            std::memcpy(buf + prefix, f->data(), f->size());
+        return prefix + f->size();
+    }
+
+    std::size_t
+    decode(msg_ptr_t msg, const unsigned char *buf, const std::size_t len) const
+    {
+        tcp_frame    *f      = static_cast<tcp_frame *>(msg);
+        std::uint64_t body   = 0;
+        std::size_t   prefix = 0;
+        if(_field == length_field::varint)
+        {
+            int n = detail::get_varint(buf, len, body);
+            if(n == 0)
+                return 0;
+            if(n < 0)
+                return _corrupt(f, len);
+            prefix = static_cast<std::size_t>(n);
+        } else
+        {
+            prefix = detail::length_field_size(_field);
+            if(len < prefix)
+                return 0;
+            body = detail::get_uint(buf, prefix, _order);
+        }
+
+        if(body > _max_frame)
+            return _corrupt(f, len);
+        if(len - prefix < body)
+            return 0;
+
+        f->reset(nullptr, 0, buf + prefix, static_cast<std::size_t>(body));
+        return prefix + static_cast<std::size_t>(body);
+    }
+
+    hj::tcp_conn::encode_handler_t encoder() const
+    {
+        length_prefix_codec c = *this;
+        return [c](unsigned char *buf, const std::size_t len, msg_ptr_t msg) {
+            return c.encode(buf, len, msg);
+        };
+    }
+
+    hj::tcp_conn::decode_handler_t decoder() const
+    {
+        length_prefix_codec c = *this;
+        return [c](msg_ptr_t            msg,
+                   const unsigned char *buf,
+                   const std::size_t    len) {
+            return c.decode(msg, buf, len);
+        };
+    }
+
+    // frames are limited to what conn can encode and buffer, a longer
+    // length field then yields an invalid frame instead of overflowing
+    void bind(hj::tcp_conn &conn) const
+    {
+        length_prefix_codec enc  = *this;
+        length_prefix_codec dec  = *this;
+        std::size_t         send = conn.max_send_size();
+        std::size_t         recv = conn.max_recv_size();
+
+        enc._max_frame = detail::clamp_frame(_max_frame, send, _prefix(send));
+        dec._max_frame = detail::clamp_frame(_max_frame, recv, _prefix(recv));
+        conn.set_encode_handler(enc.encoder());
+        conn.set_decode_handler(dec.decoder());
+    }
+
+  private:
+    inline std::size_t _prefix(const std::size_t body) const noexcept
+    {
+        return _field == length_field::varint
+                   ? detail::varint_size(body)
+                   : detail::length_field_size(_field);
+    }
+
+    static std::size_t _corrupt(tcp_frame *f, std::size_t len)
+    {
+        f->invalidate();
+        return len;
+    }
+
+  private:
+    length_field _field;
+    byte_order   _order;
+    std::size_t  _max_frame;
+};
+
+// <body><delimiter>, the body must not contain the delimiter
+class delimiter_codec
+{
+  public:
+    using msg_ptr_t = hj::tcp_conn::msg_ptr_t;
+
+    explicit delimiter_codec(
+        std::string       delim     = "\r\n",
+        const std::size_t max_frame = MAX_TCP_CODEC_FRAME_SZ)
+        : _delim{std::move(delim)}
+        , _max_frame{max_frame}
+    {
+    }
+
+    inline const std::string &delimiter() const noexcept { return _delim; }
+    inline std::size_t        max_frame() const noexcept { return _max_frame; }
+
+    std::size_t
+    encode(unsigned char *buf, const std::size_t len, msg_ptr_t msg) const
+    {
+        const tcp_frame *f = static_cast<const tcp_frame *>(msg);
+        if(f == nullptr || _delim.empty() || f->size() > _max_frame
+           || f->size() + _delim.size() > len)
+            return 0;
+
+        if(f->size() > 0)
+            std::memcpy(buf, f->data(), f->size());
+        std::memcpy(buf + f->size(), _delim.data(), _delim.size());
+        return f->size() + _delim.size();
+    }
+
+    std::size_t
+    decode(msg_ptr_t msg, const unsigned char *buf, const std::size_t len) const
+    {
+        tcp_frame *f = static_cast<tcp_frame *>(msg);
+        if(_delim.empty())
+        {
+            f->invalidate();
+            return len;
+        }
+
+        std::string_view in(reinterpret_cast<const char *>(buf), len);
+        std::size_t      pos = in.find(_delim);
+        if(pos == std::string_view::npos)
+        {
+            if(len > _max_frame + _delim.size())
+            {
+                f->invalidate();
+                return len;
+            }
+            return 0;
+        }
+        if(pos > _max_frame)
+        {
+            f->invalidate();
+            return len;
+        }
+
+        f->reset(nullptr, 0, buf, pos);
+        return pos + _delim.size();
+    }
+
+    hj::tcp_conn::encode_handler_t encoder() const
+    {
+        delimiter_codec c = *this;
+        return [c](unsigned char *buf, const std::size_t len, msg_ptr_t msg) {
+            return c.encode(buf, len, msg);
+        };
+    }
+
+    hj::tcp_conn::decode_handler_t decoder() const
+    {
+        delimiter_codec c = *this;
+        return [c](msg_ptr_t            msg,
+                   const unsigned char *buf,
+                   const std::size_t    len) {
+            return c.decode(msg, buf, len);
+        };
+    }
+
+    // frames are limited to what conn can encode and buffer, a longer
+    // line then yields an invalid frame instead of overflowing
+    void bind(hj::tcp_conn &conn) const
+    {
+        delimiter_codec enc  = *this;
+        delimiter_codec dec  = *this;
+        std::size_t     send = conn.max_send_size();
+        std::size_t     recv = conn.max_recv_size();
+
+        enc._max_frame = detail::clamp_frame(_max_frame, send, _delim.size());
+        dec._max_frame = detail::clamp_frame(_max_frame, recv, _delim.size());
+        conn.set_encode_handler(enc.encoder());
+        conn.set_decode_handler(dec.decoder());
+    }
+
+  private:
+    std::string _delim;
+    std::size_t _max_frame;
+};
+
+// <fixed header><body>, the body length is a field inside the header;
+// decoded frames expose the header via head() and the body via data()
+class header_body_codec
+{
+  public:
+    using msg_ptr_t = hj::tcp_conn::msg_ptr_t;
+
+    header_body_codec(const std::size_t  head_size,
+                      const std::size_t  len_offset,
+                      const length_field field         = length_field::u32,
+                      const byte_order   order         = byte_order::big,
+                      const bool         len_with_head = false,
+                      const std::size_t  max_frame = MAX_TCP_CODEC_FRAME_SZ)
+        : _head_size{head_size}
+        , _len_offset{len_offset}
+        , _len_size{detail::length_field_size(field)}
+        , _order{order}
+        , _len_with_head{len_with_head}
+        , _max_frame{max_frame}
+    {
+    }
+
+    // a varint length field or one outside the header is rejected
+    inline bool valid() const noexcept
+    {
+        return _len_size > 0 && _len_offset + _len_size <= _head_size;
+    }
+    inline std::size_t head_size() const noexcept { return _head_size; }
+    inline std::size_t max_frame() const noexcept { return _max_frame; }
+
+    // the header is copied with its length field filled in
+    std::size_t
+    encode(unsigned char *buf, const std::size_t len, msg_ptr_t msg) const
+    {
+        const tcp_frame *f = static_cast<const tcp_frame *>(msg);
+        if(f == nullptr || !valid() || f->head_size() != _head_size
+           || f->size() > _max_frame || _head_size + f->size() > len)
+            return 0;
+
+        std::uint64_t field = f->size() + (_len_with_head ? _head_size : 0);
+        if(_len_size < 8 && (field >> (8 * _len_size)) != 0)
+            return 0;
+
+        std::memcpy(buf, f->head(), _head_size);
+        detail::put_uint(buf + _len_offset, field, _len_size, _order);
+        if(f->size() > 0)
+            std::memcpy(buf + _head_size, f->data(), f->size());
+        return _head_size + f->size();
+    }
+
+    std::size_t
+    decode(msg_ptr_t msg, const unsigned char *buf, const std::size_t len) const
+    {
+        tcp_frame *f = static_cast<tcp_frame *>(msg);
+        if(!valid())
+        {
+            f->invalidate();
+            return len;
+        }
+        if(len < _head_size)
+            return 0;
+
+        std::uint64_t body =
+            detail::get_uint(buf + _len_offset, _len_size, _order);
+        if(_len_with_head)
+        {
+            if(body < _head_size)
+            {
+                f->invalidate();
+                return len;
+            }
+            body -= _head_size;
+        }
+        if(body > _max_frame)
+        {
+            f->invalidate();
+            return len;
+        }
+        if(len - _head_size < body)
+            return 0;
+
+        f->reset(buf,
+                 _head_size,
+                 buf + _head_size,
+                 static_cast<std::size_t>(body));
+        return _head_size + static_cast<std::size_t>(body);
+    }
+
+    hj::tcp_conn::encode_handler_t encoder() const
+    {
+        header_body_codec c = *this;
+        return [c](unsigned char *buf, const std::size_t len, msg_ptr_t msg) {
+            return c.encode(buf, len, msg);
+        };
+    }
+
+    hj::tcp_conn::decode_handler_t decoder() const
+    {
+        header_body_codec c = *this;
+        return [c](msg_ptr_t            msg,
+                   const unsigned char *buf,
+                   const std::size_t    len) {
+            return c.decode(msg, buf, len);
+        };
+    }
+
+    // frames are limited to what conn can encode and buffer, a longer
+    // length field then yields an invalid frame instead of overflowing
+    void bind(hj::tcp_conn &conn) const
+    {
+        header_body_codec enc  = *this;
+        header_body_codec dec  = *this;
+        std::size_t       send = conn.max_send_size();
+        std::size_t       recv = conn.max_recv_size();
+
+        enc._max_frame = detail::clamp_frame(_max_frame, send, _head_size);
+        dec._max_frame = detail::clamp_frame(_max_frame, recv, _head_size);
+        conn.set_encode_handler(enc.encoder());
+        conn.set_decode_handler(dec.decoder());
+    }
+
+  private:
+    std::size_t _head_size;
+    std::size_t _len_offset;
+    std::size_t _len_size;
+    byte_order  _order;
+    bool        _len_with_head;
+    std::size_t _max_frame;
+};
+
+}
+
+#endif
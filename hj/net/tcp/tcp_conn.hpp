@@ -143,6 +143,15 @@ class tcp_conn : public std::enable_shared_from_this<tcp_conn>
     }
     inline bool is_w_closed() const noexcept { return _w_closed.load(); }
     inline bool is_r_closed() const noexcept { return _r_closed.load(); }
+
+    // largest frame encode can emit, sends are encoded into MTU bytes
+    inline std::size_t max_send_size() const noexcept { return MTU; }
+    // largest partial frame the receive buffer holds while keeping MTU
+    // bytes free for the next read, decode must not wait for more
+    inline std::size_t max_recv_size() const noexcept
+    {
+        return _r_buf.max_size() > MTU ? _r_buf.max_size() - MTU : 0;
+    }
     void        set_w_closed(bool is_closed)
     {
         _w_closed.store(is_closed);
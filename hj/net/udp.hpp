@@ -1,6 +1,8 @@
 #ifndef UDP_HPP
 #define UDP_HPP
 
+#include <hj/net/udp/udp_arq.hpp>
+
 #include <hj/net/udp/udp_socket.hpp>
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,1113 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDP_ARQ_HPP
+#define UDP_ARQ_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <hj/net/udp/udp_socket.hpp>
+
+#include <boost/version.hpp>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#ifndef MAX_UDP_ARQ_RBUF_SZ
+#define MAX_UDP_ARQ_RBUF_SZ 65535
+#endif
+
+namespace hj
+{
+namespace udp
+{
+
+struct arq_options
+{
+    std::uint32_t mtu         = 1400;  // max datagram size in bytes
+    std::uint32_t interval    = 10;    // timer wheel tick in ms
+    std::uint32_t snd_wnd     = 128;   // send window in segments
+    std::uint32_t rcv_wnd     = 128;   // receive window in segments
+    std::uint32_t fast_resend = 2;     // skipped acks before resend, 0 off
+    std::uint32_t min_rto     = 30;    // ms
+    std::uint32_t max_rto     = 60000; // ms
+    std::uint32_t dead_link   = 20;    // max transmissions of one segment
+    std::uint32_t wheel_slots = 512;   // timer wheel size
+    bool          nocwnd      = false; // disable congestion control
+};
+
+// hashed timer wheel keyed by absolute ms deadlines, entries are never
+// cancelled: the owner drops stale ones when they fire
+class timer_wheel
+{
+  public:
+    struct entry
+    {
+        std::uint32_t deadline;
+        std::uint32_t id;
+    };
+
+    timer_wheel(const std::size_t slots, const std::uint32_t tick)
+        : _tick{tick > 0 ? tick : 1}
+        , _slots(slots > 0 ? slots : 1)
+    {
+    }
+
+    inline std::uint32_t tick() const noexcept { return _tick; }
+
+    void reset(const std::uint32_t now) noexcept
+    {
+        for(auto &slot : _slots)
+            slot.clear();
+        _cur = now / _tick;
+    }
+
+    void schedule(const std::uint32_t deadline, const std::uint32_t id)
+    {
+        std::uint32_t t = deadline / _tick;
+        if(static_cast<std::int32_t>(t - _cur) < 0)
+            t = _cur;
+        _slots[t % _slots.size()].push_back(entry{deadline, id});
+    }
+
+    // fire fn(entry) for every entry due by now, at tick granularity
+    template <typename Fn>
+    void advance(const std::uint32_t now, Fn &&fn)
+    {
+        std::uint32_t target = now / _tick;
+        std::size_t   n      = 0;
+        for(; static_cast<std::int32_t>(target - _cur) >= 0
+              && n < _slots.size();
+            ++_cur, ++n)
+        {
+            auto &slot = _slots[_cur % _slots.size()];
+            if(slot.empty())
+                continue;
+
+            _fired.clear();
+            _fired.swap(slot);
+            for(const auto &e : _fired)
+            {
+                std::uint32_t t = e.deadline / _tick;
+                if(static_cast<std::int32_t>(t - target) > 0)
+                    _slots[t % _slots.size()].push_back(e); // later round
+                else
+                    fn(e);
+            }
+        }
+        if(static_cast<std::int32_t>(target - _cur) >= 0)
+            _cur = target + 1;
+    }
+
+  private:
+    std::uint32_t                   _tick;
+    std::uint32_t                   _cur = 0;
+    std::vector<std::vector<entry>> _slots;
+    std::vector<entry>              _fired;
+};
+
+// KCP-style ARQ protocol core without any I/O: selective acks, fast
+// retransmit, congestion window, fragmentation and a timer wheel for
+// retransmission timeouts
+class arq
+{
+  public:
+    using output_t = std::function<void(const char *, std::size_t)>;
+
+    static constexpr std::size_t   overhead   = 24;
+    static constexpr std::uint8_t  cmd_push   = 81;
+    static constexpr std::uint8_t  cmd_ack    = 82;
+    static constexpr std::uint8_t  cmd_wask   = 83;
+    static constexpr std::uint8_t  cmd_wins   = 84;
+    static constexpr std::uint32_t rto_def    = 200;
+    static constexpr std::uint32_t thresh_min = 2;
+    static constexpr std::uint32_t probe_init = 100;
+    static constexpr std::uint32_t probe_max  = 10000;
+
+  public:
+    arq(const std::uint32_t conv,
+        const arq_options  &opts   = arq_options(),
+        output_t          &&output = output_t())
+        : _conv{conv}
+        , _opts{checked(opts)}
+        , _mss{static_cast<std::uint32_t>(_opts.mtu - overhead)}
+        , _rmt_wnd{_opts.rcv_wnd}
+        , _rx_rto{std::max(rto_def, _opts.min_rto)}
+        , _buf(_opts.mtu)
+        , _rcv_buf(_opts.rcv_wnd)
+        , _wheel{_opts.wheel_slots, _opts.interval}
+        , _output{std::move(output)}
+    {
+    }
+
+    // opts with every value the protocol cannot run with raised to the
+    // smallest usable one: a header plus one byte, a 1 ms tick, windows
+    // of one segment
+    static arq_options checked(arq_options opts) noexcept
+    {
+        opts.mtu         = std::max<std::uint32_t>(opts.mtu, overhead + 1);
+        opts.interval    = std::max<std::uint32_t>(opts.interval, 1);
+        opts.snd_wnd     = std::max<std::uint32_t>(opts.snd_wnd, 1);
+        opts.rcv_wnd     = std::max<std::uint32_t>(opts.rcv_wnd, 1);
+        opts.wheel_slots = std::max<std::uint32_t>(opts.wheel_slots, 1);
+        return opts;
+    }
+
+    arq(const arq &)            = delete;
+    arq &operator=(const arq &) = delete;
+
+    inline void set_output(output_t &&fn) noexcept { _output = std::move(fn); }
+    inline void set_current(const std::uint32_t now) noexcept
+    {
+        _current = now;
+    }
+
+    inline std::uint32_t conv() const noexcept { return _conv; }
+    inline std::uint32_t mss() const noexcept { return _mss; }
+    inline std::uint32_t cwnd() const noexcept { return _cwnd; }
+    inline std::uint32_t rto() const noexcept { return _rx_rto; }
+    inline bool          is_dead() const noexcept { return _dead; }
+
+    // largest message send() accepts
+    inline std::size_t max_msg_size() const noexcept
+    {
+        return static_cast<std::size_t>(_mss)
+               * std::min<std::uint32_t>(255, _opts.rcv_wnd);
+    }
+
+    // segments queued or in flight
+    inline std::size_t wait_snd() const noexcept
+    {
+        return _snd_buf.size() + _snd_queue.size();
+    }
+
+    // sn the next queued segment will carry
+    inline std::uint32_t next_sn() const noexcept { return _snd_sn; }
+
+    // true once every segment up to and including sn is acknowledged
+    inline bool is_acked(const std::uint32_t sn) const noexcept
+    {
+        return _diff(sn, _snd_una) < 0;
+    }
+
+    // queue one message, split into fragments of at most mss bytes
+    bool send(const char *data, const std::size_t len)
+    {
+        if(len > max_msg_size() || (data == nullptr && len > 0))
+            return false;
+
+        std::size_t count = len == 0 ? 1 : (len + _mss - 1) / _mss;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            std::size_t off = i * _mss;
+            std::size_t sz  = std::min<std::size_t>(_mss, len - off);
+
+            segment seg;
+            seg.sn  = _snd_sn++;
+            seg.frg = static_cast<std::uint8_t>(count - i - 1);
+            seg.data.assign(data + off, sz);
+            _snd_queue.push_back(std::move(seg));
+        }
+        return true;
+    }
+
+    // size of the next complete message, -1 if none is ready
+    long peek_size() const noexcept
+    {
+        if(_rcv_queue.empty())
+            return -1;
+
+        const segment &front = _rcv_queue.front();
+        if(front.frg == 0)
+            return static_cast<long>(front.data.size());
+        if(_rcv_queue.size() < static_cast<std::size_t>(front.frg) + 1)
+            return -1;
+
+        long len = 0;
+        for(const auto &seg : _rcv_queue)
+        {
+            len += static_cast<long>(seg.data.size());
+            if(seg.frg == 0)
+                break;
+        }
+        return len;
+    }
+
+    // pop the next complete message into out
+    bool recv(std::string &out)
+    {
+        long len = peek_size();
+        if(len < 0)
+            return false;
+
+        bool was_full = _rcv_queue.size() >= _opts.rcv_wnd;
+        out.clear();
+        out.reserve(static_cast<std::size_t>(len));
+        while(!_rcv_queue.empty())
+        {
+            segment &seg = _rcv_queue.front();
+            out.append(seg.data);
+            bool last = seg.frg == 0;
+            _rcv_queue.pop_front();
+            if(last)
+                break;
+        }
+
+        _move_rcv_buf();
+        if(was_full && _rcv_queue.size() < _opts.rcv_wnd)
+            _tell_wnd = true;
+        return true;
+    }
+
+    // feed one datagram from the peer
+    bool input(const char *data, std::size_t size)
+    {
+        if(data == nullptr || size < overhead)
+            return false;
+
+        std::uint32_t prev_una = _snd_una;
+        std::uint32_t maxack   = 0;
+        bool          has_ack  = false;
+        const auto   *p        = reinterpret_cast<const unsigned char *>(data);
+        while(size >= overhead)
+        {
+            header hdr;
+            _decode(p, hdr);
+            p += overhead;
+            size -= overhead;
+            if(hdr.conv != _conv || hdr.len > size)
+                return false;
+
+            _rmt_wnd = hdr.wnd;
+            _parse_una(hdr.una);
+            _shrink_buf();
+            switch(hdr.cmd)
+            {
+                case cmd_ack: {
+                    std::int32_t rtt = _diff(_current, hdr.ts);
+                    if(rtt >= 0)
+                        _update_rtt(static_cast<std::uint32_t>(rtt));
+                    _parse_ack(hdr.sn);
+                    _shrink_buf();
+                    if(!has_ack || _diff(hdr.sn, maxack) > 0)
+                        maxack = hdr.sn;
+                    has_ack = true;
+                    break;
+                }
+                case cmd_push: {
+                    if(_diff(hdr.sn, _rcv_nxt + _opts.rcv_wnd) >= 0)
+                        break;
+
+                    _acklist.emplace_back(hdr.sn, hdr.ts);
+                    if(_diff(hdr.sn, _rcv_nxt) >= 0)
+                        _parse_data(hdr, p);
+                    break;
+                }
+                case cmd_wask: {
+                    _tell_wnd = true;
+                    break;
+                }
+                case cmd_wins:
+                    break;
+                default:
+                    return false;
+            }
+            p += hdr.len;
+            size -= hdr.len;
+        }
+
+        if(has_ack)
+            _parse_fastack(maxack);
+        if(_diff(_snd_una, prev_una) > 0)
+            _grow_cwnd();
+        return true;
+    }
+
+    // advance the timer wheel to now and flush everything due
+    void update(const std::uint32_t now)
+    {
+        _current = now;
+        _start_wheel();
+        _wheel.advance(now, [this](const timer_wheel::entry &e) {
+            segment *seg = _find_snd(e.id);
+            if(seg == nullptr || seg->acked || seg->resendts != e.deadline)
+                return; // stale: acked or retransmitted since
+
+            _timeouts.push_back(e);
+        });
+        flush();
+    }
+
+    // emit pending acks, window probes, new segments and retransmissions
+    void flush()
+    {
+        _len = 0;
+
+        header hdr;
+        hdr.conv = _conv;
+        hdr.wnd  = _wnd_unused();
+        hdr.una  = _rcv_nxt;
+
+        hdr.cmd = cmd_ack;
+        for(const auto &ack : _acklist)
+        {
+            hdr.sn = ack.first;
+            hdr.ts = ack.second;
+            _write(hdr, nullptr);
+        }
+        _acklist.clear();
+
+        _probe(hdr);
+
+        // move new segments into the send window
+        std::uint32_t cwnd = std::min(_opts.snd_wnd, _rmt_wnd);
+        if(!_opts.nocwnd)
+            cwnd = std::min(_cwnd, cwnd);
+        while(!_snd_queue.empty()
+              && _diff(_snd_nxt, _snd_una + std::max<std::uint32_t>(cwnd, 1))
+                     < 0)
+        {
+            _snd_buf.push_back(std::move(_snd_queue.front()));
+            _snd_queue.pop_front();
+            segment &seg = _snd_buf.back();
+            _snd_nxt     = seg.sn + 1;
+            seg.rto      = _rx_rto;
+            _transmit(seg, hdr);
+        }
+
+        // fast retransmit
+        bool          change = false;
+        std::uint32_t resent = 0;
+        for(std::uint32_t sn : _fasts)
+        {
+            segment *seg = _find_snd(sn);
+            if(seg == nullptr || seg->acked || seg->xmit == 0
+               || seg->fastack < _opts.fast_resend)
+                continue;
+
+            _transmit(seg, hdr);
+            change = true;
+            resent++;
+        }
+        _fasts.clear();
+
+        // retransmission timeouts fired by the timer wheel
+        bool lost = false;
+        for(const auto &e : _timeouts)
+        {
+            segment *seg = _find_snd(e.id);
+            if(seg == nullptr || seg->acked || seg->resendts != e.deadline)
+                continue;
+
+            seg->rto = std::min(seg->rto + seg->rto / 2, _opts.max_rto);
+            _transmit(seg, hdr);
+            lost = true;
+        }
+        _timeouts.clear();
+
+        _output_buf();
+
+        if(change)
+        {
+            std::uint32_t inflight = _snd_nxt - _snd_una;
+            _ssthresh              = std::max(inflight / 2, thresh_min);
+            _cwnd                  = _ssthresh + resent;
+            _incr                  = _cwnd * _mss;
+        }
+        if(lost)
+        {
+            _ssthresh = std::max(_cwnd / 2, thresh_min);
+            _cwnd     = 1;
+            _incr     = _mss;
+        }
+        if(_cwnd < 1)
+        {
+            _cwnd = 1;
+            _incr = _mss;
+        }
+    }
+
+  private:
+    struct header
+    {
+        std::uint32_t conv = 0;
+        std::uint8_t  cmd  = 0;
+        std::uint8_t  frg  = 0;
+        std::uint16_t wnd  = 0;
+        std::uint32_t ts   = 0;
+        std::uint32_t sn   = 0;
+        std::uint32_t una  = 0;
+        std::uint32_t len  = 0;
+    };
+
+    struct segment
+    {
+        std::uint32_t sn       = 0;
+        std::uint32_t ts       = 0;
+        std::uint32_t resendts = 0;
+        std::uint32_t rto      = 0;
+        std::uint32_t xmit     = 0;
+        std::uint32_t fastack  = 0;
+        std::uint8_t  frg      = 0;
+        bool          acked    = false;
+        bool          used     = false;
+        std::string   data;
+    };
+
+    static inline std::int32_t _diff(std::uint32_t later, std::uint32_t earlier)
+    {
+        return static_cast<std::int32_t>(later - earlier);
+    }
+
+    static inline void _put32(unsigned char *p, std::uint32_t v)
+    {
+        p[0] = static_cast<unsigned char>(v);
+        p[1] = static_cast<unsigned char>(v >> 8);
+        p[2] = static_cast<unsigned char>(v >> 16);
+        p[3] = static_cast<unsigned char>(v >> 24);
+    }
+
+    static inline std::uint32_t _get32(const unsigned char *p)
+    {
+        return static_cast<std::uint32_t>(p[0])
+               | (static_cast<std::uint32_t>(p[1]) << 8)
+               | (static_cast<std::uint32_t>(p[2]) << 16)
+               | (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+
+    // little-endian: conv|cmd|frg|wnd|ts|sn|una|len
+    static void _encode(unsigned char *p, const header &hdr)
+    {
+        _put32(p, hdr.conv);
+        p[4] = hdr.cmd;
+        p[5] = hdr.frg;
+        p[6] = static_cast<unsigned char>(hdr.wnd);
+        p[7] = static_cast<unsigned char>(hdr.wnd >> 8);
+        _put32(p + 8, hdr.ts);
+        _put32(p + 12, hdr.sn);
+        _put32(p + 16, hdr.una);
+        _put32(p + 20, hdr.len);
+    }
+
+    static void _decode(const unsigned char *p, header &hdr)
+    {
+        hdr.conv = _get32(p);
+        hdr.cmd  = p[4];
+        hdr.frg  = p[5];
+        hdr.wnd  = static_cast<std::uint16_t>(p[6] | (p[7] << 8));
+        hdr.ts   = _get32(p + 8);
+        hdr.sn   = _get32(p + 12);
+        hdr.una  = _get32(p + 16);
+        hdr.len  = _get32(p + 20);
+    }
+
+    inline std::uint16_t _wnd_unused() const noexcept
+    {
+        std::size_t used = _rcv_queue.size();
+        if(used >= _opts.rcv_wnd)
+            return 0;
+        return static_cast<std::uint16_t>(
+            std::min<std::uint32_t>(_opts.rcv_wnd - used, 0xFFFF));
+    }
+
+    segment *_find_snd(const std::uint32_t sn) noexcept
+    {
+        if(_snd_buf.empty())
+            return nullptr;
+
+        std::int32_t idx = _diff(sn, _snd_buf.front().sn);
+        if(idx < 0 || static_cast<std::size_t>(idx) >= _snd_buf.size())
+            return nullptr;
+        return &_snd_buf[static_cast<std::size_t>(idx)];
+    }
+
+    void _write(const header &hdr, const std::string *data)
+    {
+        std::size_t need = overhead + (data ? data->size() : 0);
+        if(_len + need > _buf.size())
+            _output_buf();
+
+        _encode(reinterpret_cast<unsigned char *>(&_buf[_len]), hdr);
+        _len += overhead;
+        if(data && !data->empty())
+        {
+            std::memcpy(&_buf[_len], data->data(), data->size());
+            _len += data->size();
+        }
+    }
+
+    void _output_buf()
+    {
+        if(_len > 0 && _output)
+            _output(_buf.data(), _len);
+        _len = 0;
+    }
+
+    void _transmit(segment *seg, header &hdr) { _transmit(*seg, hdr); }
+    void _transmit(segment &seg, header &hdr)
+    {
+        seg.xmit++;
+        seg.fastack  = 0;
+        seg.ts       = _current;
+        seg.resendts = _current + seg.rto;
+        if(seg.xmit > _opts.dead_link)
+            _dead = true;
+
+        header h = hdr;
+        h.cmd    = cmd_push;
+        h.frg    = seg.frg;
+        h.ts     = seg.ts;
+        h.sn     = seg.sn;
+        h.len    = static_cast<std::uint32_t>(seg.data.size());
+        _write(h, &seg.data);
+        _start_wheel();
+        _wheel.schedule(seg.resendts, seg.sn);
+    }
+
+    // the wheel starts at the first update() or transmit, whichever
+    // comes first; once it holds timers it is never reset
+    inline void _start_wheel() noexcept
+    {
+        if(_wheel_started)
+            return;
+
+        _wheel_started = true;
+        _wheel.reset(_current);
+    }
+
+    void _probe(header &hdr)
+    {
+        if(_rmt_wnd == 0)
+        {
+            if(_probe_wait == 0)
+            {
+                _probe_wait = probe_init;
+                _ts_probe   = _current + _probe_wait;
+            } else if(_diff(_current, _ts_probe) >= 0)
+            {
+                _probe_wait =
+                    std::min(_probe_wait + _probe_wait / 2, probe_max);
+                _ts_probe   = _current + _probe_wait;
+                _ask_wnd    = true;
+            }
+        } else
+        {
+            _probe_wait = 0;
+        }
+
+        if(_ask_wnd)
+        {
+            hdr.cmd = cmd_wask;
+            _write(hdr, nullptr);
+            _ask_wnd = false;
+        }
+        if(_tell_wnd)
+        {
+            hdr.cmd = cmd_wins;
+            _write(hdr, nullptr);
+            _tell_wnd = false;
+        }
+    }
+
+    void _update_rtt(const std::uint32_t rtt)
+    {
+        if(_rx_srtt == 0)
+        {
+            _rx_srtt   = rtt;
+            _rx_rttval = rtt / 2;
+        } else
+        {
+            std::uint32_t delta =
+                rtt > _rx_srtt ? rtt - _rx_srtt : _rx_srtt - rtt;
+            _rx_rttval = (3 * _rx_rttval + delta) / 4;
+            _rx_srtt   = (7 * _rx_srtt + rtt) / 8;
+            if(_rx_srtt < 1)
+                _rx_srtt = 1;
+        }
+
+        std::uint32_t rto = _rx_srtt + std::max(_opts.interval, 4 * _rx_rttval);
+        _rx_rto = std::min(std::max(rto, _opts.min_rto), _opts.max_rto);
+    }
+
+    void _parse_una(const std::uint32_t una)
+    {
+        while(!_snd_buf.empty() && _diff(_snd_buf.front().sn, una) < 0)
+            _snd_buf.pop_front();
+        _snd_una = _snd_buf.empty() ? _snd_nxt : _snd_buf.front().sn;
+    }
+
+    void _parse_ack(const std::uint32_t sn)
+    {
+        segment *seg = _find_snd(sn);
+        if(seg != nullptr)
+            seg->acked = true;
+    }
+
+    void _shrink_buf()
+    {
+        while(!_snd_buf.empty() && _snd_buf.front().acked)
+            _snd_buf.pop_front();
+        _snd_una = _snd_buf.empty() ? _snd_nxt : _snd_buf.front().sn;
+    }
+
+    void _parse_fastack(const std::uint32_t maxack)
+    {
+        if(_opts.fast_resend == 0)
+            return;
+
+        for(auto &seg : _snd_buf)
+        {
+            if(_diff(seg.sn, maxack) >= 0)
+                break;
+            if(seg.acked)
+                continue;
+
+            if(++seg.fastack == _opts.fast_resend)
+                _fasts.push_back(seg.sn);
+        }
+    }
+
+    void _parse_data(const header &hdr, const unsigned char *data)
+    {
+        segment &slot = _rcv_buf[hdr.sn % _rcv_buf.size()];
+        if(slot.used && slot.sn == hdr.sn)
+            return;
+
+        slot.used = true;
+        slot.sn   = hdr.sn;
+        slot.frg  = hdr.frg;
+        slot.data.assign(reinterpret_cast<const char *>(data), hdr.len);
+        _move_rcv_buf();
+    }
+
+    void _move_rcv_buf()
+    {
+        while(_rcv_queue.size() < _opts.rcv_wnd)
+        {
+            segment &slot = _rcv_buf[_rcv_nxt % _rcv_buf.size()];
+            if(!slot.used || slot.sn != _rcv_nxt)
+                break;
+
+            slot.used = false;
+            _rcv_queue.push_back(std::move(slot));
+            _rcv_nxt++;
+        }
+    }
+
+    void _grow_cwnd()
+    {
+        if(_cwnd >= _rmt_wnd)
+            return;
+
+        if(_cwnd < _ssthresh)
+        {
+            _cwnd++;
+            _incr += _mss;
+        } else
+        {
+            if(_incr < _mss)
+                _incr = _mss;
+            _incr += (_mss * _mss) / _incr + (_mss / 16);
+            if((_cwnd + 1) * _mss <= _incr)
+                _cwnd = (_incr + _mss - 1) / _mss;
+        }
+        if(_cwnd > _rmt_wnd)
+        {
+            _cwnd = _rmt_wnd;
+            _incr = _rmt_wnd * _mss;
+        }
+    }
+
+  private:
+    std::uint32_t _conv;
+    arq_options   _opts;
+    std::uint32_t _mss;
+    bool          _dead          = false;
+    bool          _wheel_started = false;
+    std::uint32_t _current       = 0;
+
+    std::uint32_t _snd_una = 0;
+    std::uint32_t _snd_nxt = 0;
+    std::uint32_t _snd_sn  = 0;
+    std::uint32_t _rcv_nxt = 0;
+
+    std::uint32_t _cwnd     = 1;
+    std::uint32_t _incr     = 0;
+    std::uint32_t _ssthresh = thresh_min;
+    std::uint32_t _rmt_wnd;
+
+    std::uint32_t _rx_srtt   = 0;
+    std::uint32_t _rx_rttval = 0;
+    std::uint32_t _rx_rto;
+
+    std::uint32_t _probe_wait = 0;
+    std::uint32_t _ts_probe   = 0;
+    bool          _ask_wnd    = false;
+    bool          _tell_wnd   = false;
+
+    std::vector<char> _buf;
+    std::size_t       _len = 0;
+
+    std::deque<segment>                                  _snd_queue;
+    std::deque<segment>                                  _snd_buf;
+    std::vector<segment>                                 _rcv_buf;
+    std::deque<segment>                                  _rcv_queue;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _acklist;
+    std::vector<std::uint32_t>                           _fasts;
+    std::vector<timer_wheel::entry>                      _timeouts;
+
+    timer_wheel _wheel;
+    output_t    _output;
+};
+
+// reliable message connection over hj::udp::socket, handlers follow
+// tcp_conn: messages are opaque pointers encoded/decoded by user handlers
+// NOTE: all handlers run on the io thread; drive io from a single thread
+class arq_conn
+{
+  public:
+    using io_t       = boost::asio::io_context;
+    using err_t      = std::error_code;
+    using msg_ptr_t  = void *;
+    using conn_ptr_t = hj::udp::arq_conn *;
+    using endpoint_t = hj::udp::socket::endpoint_t;
+    using timer_t    = boost::asio::steady_timer;
+
+    using send_handler_t    = std::function<void(conn_ptr_t, msg_ptr_t)>;
+    using recv_handler_t    = std::function<void(conn_ptr_t, msg_ptr_t)>;
+    using disconn_handler_t = std::function<void(conn_ptr_t)>;
+    using error_handler_t =
+        std::function<void(conn_ptr_t, msg_ptr_t, const err_t &)>;
+    using encode_handler_t = std::function<std::size_t(
+        unsigned char *, const std::size_t, msg_ptr_t)>;
+    using decode_handler_t = std::function<std::size_t(
+        msg_ptr_t, const unsigned char *, const std::size_t)>;
+
+  public:
+    arq_conn(io_t               &io,
+             const std::uint32_t conv,
+             const arq_options  &opts = arq_options())
+        : _io{io}
+        , _sock{io.get_executor()}
+        , _timer{io}
+        , _opts{arq::checked(opts)}
+        , _arq{conv, _opts}
+        , _r_buf(MAX_UDP_ARQ_RBUF_SZ)
+    {
+        _arq.set_output([this](const char *data, std::size_t len) {
+            _output(data, len);
+        });
+        _w_buf.resize(_arq.max_msg_size());
+    }
+    ~arq_conn() { close(); }
+
+    arq_conn()                            = delete;
+    arq_conn(const arq_conn &)            = delete;
+    arq_conn &operator=(const arq_conn &) = delete;
+
+    void set_send_handler(const send_handler_t &fn) noexcept
+    {
+        _send_handler = fn;
+    }
+    void set_recv_handler(const recv_handler_t &fn) noexcept
+    {
+        _recv_handler = fn;
+    }
+    void set_disconn_handler(const disconn_handler_t &fn) noexcept
+    {
+        _disconn_handler = fn;
+    }
+    // a message async_send could not queue (not_open, encode_failed,
+    // msg_too_large) or a received one the decoder rejected
+    // (decode_failed, the data is dropped and msg stays queued)
+    void set_error_handler(const error_handler_t &fn) noexcept
+    {
+        _error_handler = fn;
+    }
+    void set_encode_handler(const encode_handler_t &fn) noexcept
+    {
+        _encode_handler = fn;
+    }
+    void set_decode_handler(const decode_handler_t &fn) noexcept
+    {
+        _decode_handler = fn;
+    }
+
+    inline bool is_connected() const noexcept
+    {
+        return _started && _sock.is_open() && !_arq.is_dead();
+    }
+    inline std::size_t wait_snd() const noexcept { return _arq.wait_snd(); }
+    inline hj::udp::arq &protocol() noexcept { return _arq; }
+
+    // listen on port, the peer is learned from the first valid datagram
+    bool bind(const std::uint16_t port, err_t &ec)
+    {
+        _sock.bind(port, ec);
+        if(ec)
+            return false;
+
+        _start();
+        return true;
+    }
+
+    bool connect(const std::string &ip, const std::uint16_t port, err_t &ec)
+    {
+        if(!_sock.is_open())
+        {
+            ec = make_err(error_code::not_open);
+            return false;
+        }
+
+        _remote     = hj::udp::socket::endpoint(ip, port);
+        _has_remote = true;
+        _start();
+        ec.clear();
+        return true;
+    }
+
+    bool async_send(msg_ptr_t msg)
+    {
+        if(!is_connected() || msg == nullptr)
+            return false;
+
+        boost::asio::post(_io, [this, msg]() { _send(msg); });
+        return true;
+    }
+
+    bool async_recv(msg_ptr_t msg)
+    {
+        if(!is_connected() || msg == nullptr)
+            return false;
+
+        boost::asio::post(_io, [this, msg]() {
+            _r_msgs.push_back(msg);
+            _deliver();
+        });
+        return true;
+    }
+
+    bool disconnect()
+    {
+        if(!_started)
+            return false;
+
+        _started = false;
+        _timer.cancel();
+        _sock.close();
+        if(_disconn_handler)
+            _disconn_handler(this);
+        return true;
+    }
+
+    void close()
+    {
+        _started = false;
+        _timer.cancel();
+        _sock.close();
+    }
+
+  private:
+    static std::uint32_t _now()
+    {
+        return static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    void _start()
+    {
+        if(_started)
+            return;
+
+        _started = true;
+        _async_recv();
+        _tick();
+    }
+
+    void _output(const char *data, std::size_t len)
+    {
+        if(!_has_remote)
+            return;
+
+        err_t ec;
+        _sock.send(data, len, _remote, ec);
+    }
+
+    void _send(msg_ptr_t msg)
+    {
+        if(!is_connected())
+        {
+            _error(msg, error_code::not_open);
+            return;
+        }
+
+        std::size_t sz =
+            _encode_handler
+                ? _encode_handler(
+                      reinterpret_cast<unsigned char *>(_w_buf.data()),
+                      _w_buf.size(),
+                      msg)
+                : 0;
+        if(sz < 1 || sz > _w_buf.size())
+        {
+            _error(msg, error_code::encode_failed);
+            return;
+        }
+        if(!_arq.send(_w_buf.data(), sz))
+        {
+            _error(msg, error_code::msg_too_large);
+            return;
+        }
+
+        _w_msgs.emplace_back(_arq.next_sn() - 1, msg);
+        _arq.set_current(_now());
+        _arq.flush();
+    }
+
+    void _async_recv()
+    {
+        _sock.async_recv(_r_buf.data(),
+                         _r_buf.size(),
+                         _sender,
+                         [this](const err_t &err, std::size_t sz) {
+                             if(!_started)
+                                 return; // closed, the op was aborted
+
+                             if(!err)
+                                 _on_recv(sz);
+                             _async_recv();
+                         });
+    }
+
+    void _on_recv(std::size_t sz)
+    {
+        if(_has_remote && _sender != _remote)
+            return;
+
+        // only a datagram the protocol accepts may pick the peer
+        _arq.set_current(_now());
+        if(!_arq.input(_r_buf.data(), sz))
+            return;
+
+        if(!_has_remote)
+        {
+            _remote     = _sender;
+            _has_remote = true;
+        }
+
+        _deliver();
+        _notify_sent();
+        _arq.flush();
+    }
+
+    void _tick()
+    {
+        _timer.expires_after(std::chrono::milliseconds(_opts.interval));
+        _timer.async_wait([this](const boost::system::error_code &err) {
+            if(err || !_started)
+                return;
+
+            _arq.update(_now());
+            _notify_sent();
+            if(_arq.is_dead())
+            {
+                disconnect();
+                return;
+            }
+            _tick();
+        });
+    }
+
+    void _deliver()
+    {
+        while(!_r_msgs.empty() && _arq.peek_size() >= 0)
+        {
+            _arq.recv(_msg);
+            msg_ptr_t msg = _r_msgs.front();
+            if(!_decode_handler
+               || _decode_handler(
+                      msg,
+                      reinterpret_cast<const unsigned char *>(_msg.data()),
+                      _msg.size())
+                      < 1)
+            {
+                _error(msg, error_code::decode_failed);
+                continue;
+            }
+
+            _r_msgs.pop_front();
+            if(_recv_handler)
+                _recv_handler(this, msg);
+        }
+    }
+
+    void _error(msg_ptr_t msg, const error_code e)
+    {
+        if(_error_handler)
+            _error_handler(this, msg, make_err(e));
+    }
+
+    void _notify_sent()
+    {
+        while(!_w_msgs.empty() && _arq.is_acked(_w_msgs.front().first))
+        {
+            msg_ptr_t msg = _w_msgs.front().second;
+            _w_msgs.pop_front();
+            if(_send_handler)
+                _send_handler(this, msg);
+        }
+    }
+
+  private:
+    io_t           &_io;
+    hj::udp::socket _sock;
+    timer_t         _timer;
+    arq_options     _opts;
+    hj::udp::arq    _arq;
+    bool            _started    = false;
+    bool            _has_remote = false;
+    endpoint_t      _remote;
+    endpoint_t      _sender;
+
+    std::vector<char>                               _r_buf;
+    std::vector<char>                               _w_buf;
+    std::string                                     _msg;
+    std::deque<msg_ptr_t>                           _r_msgs;
+    std::deque<std::pair<std::uint32_t, msg_ptr_t>> _w_msgs;
+
+    disconn_handler_t _disconn_handler;
+    recv_handler_t    _recv_handler;
+    send_handler_t    _send_handler;
+    error_handler_t   _error_handler;
+    encode_handler_t  _encode_handler;
+    decode_handler_t  _decode_handler;
+};
+
+} // namespace udp
+} // namespace hj
+
+#endif
@@ -25,6 +25,26 @@
 #include <boost/version.hpp>
 #include <boost/asio.hpp>
 
+#if defined(__linux__)
+#include <vector>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 namespace hj
 {
 namespace udp
@@ -43,6 +63,9 @@ enum class error_code
     not_open,
     invalid_argument,
     other,
+    encode_failed,
+    decode_failed,
+    msg_too_large,
 };
 
 class error_category : public std::error_category
@@ -59,6 +82,12 @@ class error_category : public std::error_category
                 return "Invalid argument";
             case error_code::other:
                 return "Other error";
+            case error_code::encode_failed:
+                return "Encode failed";
+            case error_code::decode_failed:
+                return "Decode failed";
+            case error_code::msg_too_large:
+                return "Message too large";
             default:
                 return "Unknown error";
         }
@@ -71,6 +100,189 @@ static inline std::error_code make_err(error_code e)
     return std::error_code(static_cast<int>(e), cat);
 }
 
+#if defined(__linux__)
+// preallocated mmsghdr/iovec/sockaddr/cmsg arrays for recvmmsg/sendmmsg,
+// reuse one batch per socket to avoid any allocation on the hot path;
+// with UDP_GRO on a message can be up to 64KB, size pkt_sz for that or
+// check truncated()
+class mmsg_batch
+{
+  public:
+    using endpoint_t = boost::asio::ip::udp::endpoint;
+    using ns_t       = std::chrono::nanoseconds;
+
+    explicit mmsg_batch(const std::size_t n, const std::size_t pkt_sz = 2048)
+        : _pkt_sz{pkt_sz}
+        , _buf(n * pkt_sz)
+        , _hdrs(n)
+        , _iovs(n)
+        , _addrs(n)
+        , _ctrls(n)
+        , _stamps(n)
+        , _segs(n)
+    {
+    }
+
+    inline std::size_t capacity() const noexcept { return _hdrs.size(); }
+    inline std::size_t size() const noexcept { return _size; }
+    inline bool        empty() const noexcept { return _size == 0; }
+    inline std::size_t packet_size() const noexcept { return _pkt_sz; }
+    inline void        clear() noexcept { _size = 0; }
+
+    inline char *data(const std::size_t i) noexcept
+    {
+        return static_cast<char *>(_iovs[i].iov_base);
+    }
+    inline const char *data(const std::size_t i) const noexcept
+    {
+        return static_cast<const char *>(_iovs[i].iov_base);
+    }
+
+    // bytes received (or queued to send) of the i-th message
+    inline std::size_t length(const std::size_t i) const noexcept
+    {
+        return _hdrs[i].msg_len;
+    }
+
+    // kernel receive timestamp (CLOCK_REALTIME), zero if SO_TIMESTAMPNS is off
+    inline ns_t timestamp(const std::size_t i) const noexcept
+    {
+        return _stamps[i];
+    }
+
+    // GRO segment size of a coalesced message, zero if not coalesced
+    inline std::size_t segment_size(const std::size_t i) const noexcept
+    {
+        return _segs[i];
+    }
+
+    // the i-th message did not fit in packet_size() and was cut
+    inline bool truncated(const std::size_t i) const noexcept
+    {
+        return (_hdrs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    endpoint_t endpoint(const std::size_t i) const
+    {
+        endpoint_t ep;
+        std::size_t namelen = _hdrs[i].msg_hdr.msg_namelen;
+        if(namelen == 0 || namelen > ep.capacity())
+            return ep;
+
+        std::memcpy(ep.data(), &_addrs[i], namelen);
+        ep.resize(namelen);
+        return ep;
+    }
+
+    // queue a message for send_batch, data is referenced not copied
+    bool push(const char *data, const std::size_t len, const endpoint_t &ep)
+    {
+        if(_size >= capacity() || ep.size() > sizeof(sockaddr_storage))
+            return false;
+
+        std::memcpy(&_addrs[_size], ep.data(), ep.size());
+        return _push(data, len, ep.size());
+    }
+
+    // queue a message for send_batch on a connected socket
+    bool push(const char *data, const std::size_t len)
+    {
+        if(_size >= capacity())
+            return false;
+
+        return _push(data, len, 0);
+    }
+
+  private:
+    friend class socket;
+
+    struct ctrl_t
+    {
+        alignas(cmsghdr) char buf[CMSG_SPACE(sizeof(timespec))
+                                  + CMSG_SPACE(sizeof(int))];
+    };
+
+    bool _push(const char *data, const std::size_t len, socklen_t namelen)
+    {
+        _iovs[_size].iov_base = const_cast<char *>(data);
+        _iovs[_size].iov_len  = len;
+
+        msghdr &hdr        = _hdrs[_size].msg_hdr;
+        hdr.msg_name       = namelen > 0 ? &_addrs[_size] : nullptr;
+        hdr.msg_namelen    = namelen;
+        hdr.msg_iov        = &_iovs[_size];
+        hdr.msg_iovlen     = 1;
+        hdr.msg_control    = nullptr;
+        hdr.msg_controllen = 0;
+        hdr.msg_flags      = 0;
+        _hdrs[_size].msg_len = static_cast<unsigned int>(len);
+        _size++;
+        return true;
+    }
+
+    void _prepare_recv() noexcept
+    {
+        for(std::size_t i = 0; i < capacity(); ++i)
+        {
+            _iovs[i].iov_base = &_buf[i * _pkt_sz];
+            _iovs[i].iov_len  = _pkt_sz;
+
+            msghdr &hdr        = _hdrs[i].msg_hdr;
+            hdr.msg_name       = &_addrs[i];
+            hdr.msg_namelen    = sizeof(sockaddr_storage);
+            hdr.msg_iov        = &_iovs[i];
+            hdr.msg_iovlen     = 1;
+            hdr.msg_control    = _ctrls[i].buf;
+            hdr.msg_controllen = sizeof(ctrl_t);
+            hdr.msg_flags      = 0;
+            _hdrs[i].msg_len   = 0;
+        }
+        _size = 0;
+    }
+
+    void _finish_recv(const std::size_t n) noexcept
+    {
+        _size = n;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            _stamps[i] = ns_t::zero();
+            _segs[i]   = 0;
+
+            msghdr &hdr = _hdrs[i].msg_hdr;
+            for(cmsghdr *cm = CMSG_FIRSTHDR(&hdr); cm != nullptr;
+                cm          = CMSG_NXTHDR(&hdr, cm))
+            {
+                if(cm->cmsg_level == SOL_SOCKET
+                   && cm->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(cm), sizeof(ts));
+                    _stamps[i] = std::chrono::seconds(ts.tv_sec)
+                                 + ns_t(ts.tv_nsec);
+                } else if(cm->cmsg_level == SOL_UDP
+                          && cm->cmsg_type == UDP_GRO)
+                {
+                    int seg = 0;
+                    std::memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+                    _segs[i] = static_cast<std::size_t>(seg);
+                }
+            }
+        }
+    }
+
+  private:
+    std::size_t                   _pkt_sz;
+    std::size_t                   _size = 0;
+    std::vector<char>             _buf;
+    std::vector<mmsghdr>          _hdrs;
+    std::vector<iovec>            _iovs;
+    std::vector<sockaddr_storage> _addrs;
+    std::vector<ctrl_t>           _ctrls;
+    std::vector<ns_t>             _stamps;
+    std::vector<std::size_t>      _segs;
+};
+#endif
+
 class socket : public std::enable_shared_from_this<hj::udp::socket>
 {
   public:
@@ -86,6 +298,8 @@ class socket : public std::enable_shared_from_this<hj::udp::socket>
         std::function<void(const std::error_code &, std::size_t)>;
     using recv_handler_t =
         std::function<void(const std::error_code &, std::size_t)>;
+    using batch_handler_t =
+        std::function<void(const std::error_code &, std::size_t)>;
 
     socket(executor_t exec, bool ipv6 = false)
         : _exec(exec)
@@ -323,6 +537,137 @@ class socket : public std::enable_shared_from_this<hj::udp::socket>
         async_recv(buf, ep, std::move(fn));
     }
 
+#if defined(__linux__)
+    // send every queued message of batch through sendmmsg,
+    // return the number of messages sent
+    size_t send_batch(mmsg_batch &batch, std::error_code &ec) noexcept
+    {
+        if(!is_open())
+        {
+            ec = make_err(error_code::not_open);
+            return 0;
+        }
+        if(batch.empty())
+        {
+            ec = make_err(error_code::invalid_argument);
+            return 0;
+        }
+
+        ec.clear();
+        size_t sent = 0;
+        while(sent < batch.size())
+        {
+            int n = ::sendmmsg(_sock->native_handle(),
+                               &batch._hdrs[sent],
+                               static_cast<unsigned int>(batch.size() - sent),
+                               0);
+            if(n < 0)
+            {
+                if(errno == EINTR)
+                    continue;
+
+                ec = std::error_code(errno, std::system_category());
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return sent;
+    }
+
+    // receive up to batch.capacity() messages through recvmmsg,
+    // by default block for the first one only and drain what is queued
+    size_t recv_batch(mmsg_batch     &batch,
+                      std::error_code &ec,
+                      int              flags = MSG_WAITFORONE) noexcept
+    {
+        if(!is_open())
+        {
+            ec = make_err(error_code::not_open);
+            return 0;
+        }
+        if(batch.capacity() == 0)
+        {
+            ec = make_err(error_code::invalid_argument);
+            return 0;
+        }
+
+        batch._prepare_recv();
+        int n;
+        do
+        {
+            n = ::recvmmsg(_sock->native_handle(),
+                           batch._hdrs.data(),
+                           static_cast<unsigned int>(batch.capacity()),
+                           flags,
+                           nullptr);
+        } while(n < 0 && errno == EINTR);
+
+        if(n < 0)
+        {
+            ec = std::error_code(errno, std::system_category());
+            return 0;
+        }
+
+        ec.clear();
+        batch._finish_recv(static_cast<size_t>(n));
+        return static_cast<size_t>(n);
+    }
+
+    // NOTE: socket and batch must outlive the async operation
+    void async_recv_batch(mmsg_batch &batch, batch_handler_t &&fn)
+    {
+        if(!is_open())
+        {
+            fn(make_err(error_code::not_open), 0);
+            return;
+        }
+
+        _sock->async_wait(
+            sock_t::wait_read,
+            [this, &batch, fn = std::move(fn)](const err_t &err) mutable {
+                if(err)
+                {
+                    fn(err, 0);
+                    return;
+                }
+
+                std::error_code ec;
+                size_t          n = recv_batch(batch, ec, MSG_DONTWAIT);
+                if(ec == std::errc::resource_unavailable_try_again
+                   || ec == std::errc::operation_would_block)
+                {
+                    async_recv_batch(batch, std::move(fn));
+                    return;
+                }
+                fn(ec, n);
+            });
+    }
+
+    // UDP_SEGMENT: let the kernel split each send into seg_sz datagrams,
+    // 0 turns it off
+    void set_gso(const uint16_t seg_sz, std::error_code &ec) noexcept
+    {
+        int val = seg_sz;
+        _setsockopt(SOL_UDP, UDP_SEGMENT, val, ec);
+    }
+
+    // UDP_GRO: let the kernel coalesce received datagrams into messages of
+    // up to 64KB, receive them with an mmsg_batch of pkt_sz 65535 or they
+    // get cut, see mmsg_batch::segment_size and mmsg_batch::truncated
+    void set_gro(const bool enable, std::error_code &ec) noexcept
+    {
+        int val = enable ? 1 : 0;
+        _setsockopt(SOL_UDP, UDP_GRO, val, ec);
+    }
+
+    // SO_TIMESTAMPNS: kernel receive timestamps, see mmsg_batch::timestamp
+    void set_timestamp(const bool enable, std::error_code &ec) noexcept
+    {
+        int val = enable ? 1 : 0;
+        _setsockopt(SOL_SOCKET, SO_TIMESTAMPNS, val, ec);
+    }
+#endif
+
     void close() noexcept
     {
         if(_sock && _sock->is_open())
@@ -347,6 +692,26 @@ class socket : public std::enable_shared_from_this<hj::udp::socket>
         return endpoint_t(address(ip), port);
     }
 
+  private:
+#if defined(__linux__)
+    void _setsockopt(int level, int name, int val, std::error_code &ec) noexcept
+    {
+        if(!is_open())
+        {
+            ec = make_err(error_code::not_open);
+            return;
+        }
+
+        if(::setsockopt(_sock->native_handle(), level, name, &val, sizeof(val))
+           != 0)
+        {
+            ec = std::error_code(errno, std::system_category());
+            return;
+        }
+        ec.clear();
+    }
+#endif
+
   private:
     executor_t              _exec;
     std::unique_ptr<sock_t> _sock;
@@ -28,11 +28,14 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <zmq.h>
 
+#include <hj/io/chain_buffer.hpp>
+
 namespace hj
 {
 namespace zmq
@@ -146,6 +149,73 @@ class message
             throw zmq_error("zmq_msg_init_data failed");
     }
 
+    // Zero-copy: owner is moved to the heap and destroyed from the zmq free
+    // callback once the last reference to the frame is gone; data/size
+    // must point into memory the owner keeps alive
+    template <typename Owner>
+    static message adopt(Owner owner, const void *data, size_t size)
+    {
+        auto *holder = new Owner(std::move(owner));
+        try
+        {
+            return message(const_cast<void *>(data),
+                           size,
+                           &_free_owner<Owner>,
+                           holder);
+        }
+        catch(...)
+        {
+            delete holder;
+            throw;
+        }
+    }
+
+    // Zero-copy: takes a contiguous container (std::string, std::vector...)
+    template <typename Container,
+              typename = decltype(std::declval<Container &>().data())>
+    static message adopt(Container &&c)
+    {
+        static_assert(!std::is_lvalue_reference<Container>::value,
+                      "adopt takes ownership, pass an rvalue");
+        using value_t = typename Container::value_type;
+
+        // small strings live inside the object, find the bytes after moving
+        auto  *holder = new Container(std::move(c));
+        size_t len    = holder->size() * sizeof(value_t);
+        try
+        {
+            return message(static_cast<void *>(holder->data()),
+                           len,
+                           &_free_owner<Container>,
+                           holder);
+        }
+        catch(...)
+        {
+            delete holder;
+            throw;
+        }
+    }
+
+    // Zero-copy: shares a refcounted buffer (std::shared_ptr<std::string>...)
+    template <typename T>
+    static message adopt(std::shared_ptr<T> buf)
+    {
+        using value_t = typename std::decay_t<T>::value_type;
+
+        const void *data = buf->data();
+        size_t      size = buf->size() * sizeof(value_t);
+        return adopt(std::move(buf), data, size);
+    }
+
+    // Zero-copy: obj goes back to pool (hj::object_pool or anything with
+    // release(T *)) when zmq is done with the frame
+    template <typename Pool, typename T>
+    static message adopt(Pool &pool, T *obj, const void *data, size_t size)
+    {
+        using owner_t = std::unique_ptr<T, _pool_releaser<Pool, T>>;
+        return adopt(owner_t(obj, _pool_releaser<Pool, T>{&pool}), data, size);
+    }
+
     message(const message &)            = delete;
     message &operator=(const message &) = delete;
 
@@ -181,10 +251,84 @@ class message
         return std::string_view(static_cast<const char *>(data()), size());
     }
 
+  private:
+    template <typename Owner>
+    static void _free_owner(void *, void *hint)
+    {
+        delete static_cast<Owner *>(hint);
+    }
+
+    template <typename Pool, typename T>
+    struct _pool_releaser
+    {
+        Pool *pool;
+        void  operator()(T *obj) const { pool->release(obj); }
+    };
+
   private:
     zmq_msg_t _msg;
 };
 
+// -----------------------------------------------------------------------------
+// Multipart (Reusable Frame Array)
+// -----------------------------------------------------------------------------
+// Frame slots survive clear(), so a steady stream of multipart messages
+// reuses the same zmq_msg_t array instead of building new frames per call.
+class multipart
+{
+  public:
+    multipart() = default;
+
+    inline size_t           size() const noexcept { return _n; }
+    inline bool             empty() const noexcept { return _n == 0; }
+    inline message         &operator[](size_t i) noexcept { return _frames[i]; }
+    inline const message   &operator[](size_t i) const noexcept
+    {
+        return _frames[i];
+    }
+    inline std::string_view view(size_t i) const noexcept
+    {
+        return _frames[i].to_string_view();
+    }
+
+    // next free slot, empty or holding a stale frame zmq_msg_recv releases
+    inline message &add()
+    {
+        if(_n == _frames.size())
+            _frames.emplace_back();
+        return _frames[_n++];
+    }
+    inline void add(message &&msg) { add() = std::move(msg); }
+    inline bool add(std::string_view sv)
+    {
+        zmq_msg_t *msg = add().get();
+        zmq_msg_close(msg);
+        if(zmq_msg_init_size(msg, sv.size()) != 0)
+        {
+            zmq_msg_init(msg);
+            return false;
+        }
+        if(!sv.empty())
+            std::memcpy(zmq_msg_data(msg), sv.data(), sv.size());
+        return true;
+    }
+
+    // releases the frames, keeps the slots
+    void clear() noexcept
+    {
+        for(size_t i = 0; i < _n; ++i)
+        {
+            zmq_msg_close(_frames[i].get());
+            zmq_msg_init(_frames[i].get());
+        }
+        _n = 0;
+    }
+
+  private:
+    std::vector<message> _frames;
+    size_t               _n = 0;
+};
+
 // -----------------------------------------------------------------------------
 // Base Socket Class (Handles Option, Lifetime and Multipart Messaging)
 // -----------------------------------------------------------------------------
@@ -307,6 +451,115 @@ class socket_base
         return true;
     }
 
+    // Sends a frame; on success zmq owns its content and msg is left empty
+    bool send(message &msg, int flags = 0)
+    {
+        while(true)
+        {
+            if(zmq_msg_send(msg.get(), _sock, flags) >= 0)
+                return true;
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+    }
+
+    bool recv(message &msg, int flags = 0)
+    {
+        while(true)
+        {
+            if(zmq_msg_recv(msg.get(), _sock, flags) >= 0)
+                return true;
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+    }
+
+    // Zero-copy: every block of buf becomes one frame of a multipart
+    // message, ownership of the blocks passes to zmq; buf is left empty.
+    // On false buf keeps the blocks zmq did not take. A failure on the
+    // first frame sends nothing and the call can be retried; a later one
+    // (zmq only fails there when the socket is closing) leaves a partial
+    // multipart queued, the socket must be closed rather than reused.
+    bool send_blocks(chain_buffer &buf, int flags = 0)
+    {
+        std::vector<uint8_t> blk;
+        size_t               off = 0;
+        while(buf.pop_block(blk, off))
+        {
+            // moving a vector keeps its heap block where it is
+            auto *owner = new std::vector<uint8_t>(std::move(blk));
+            std::unique_ptr<std::vector<uint8_t>> guard(owner);
+            message msg(owner->data() + off,
+                        owner->size() - off,
+                        &_free_block,
+                        owner);
+            guard.release();
+
+            int more = buf.empty() ? 0 : ZMQ_SNDMORE;
+            if(!send(msg, flags | more))
+            {
+                // the frame still owns the block, take it back
+                int err = errno;
+                buf.unpop_block(std::move(*owner), off);
+                errno = err;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool send_multipart(multipart &parts, int flags = 0)
+    {
+        for(size_t i = 0; i < parts.size(); ++i)
+        {
+            int more = (i + 1 < parts.size()) ? ZMQ_SNDMORE : 0;
+            if(!send(parts[i], flags | more))
+                return false;
+        }
+        parts.clear();
+        return true;
+    }
+
+    // Frames land in parts' reused slots, no std::string per frame
+    bool recv_multipart(multipart &parts, int flags = 0)
+    {
+        parts.clear();
+        while(true)
+        {
+            message &msg = parts.add();
+            if(!recv(msg, flags))
+                return false;
+            if(!zmq_msg_more(msg.get()))
+                return true;
+        }
+    }
+
+    // Receives up to max multipart messages: the first one with flags, the
+    // rest only while already queued. Returns how many batch[0..n) hold.
+    size_t recv_batch(std::vector<multipart> &batch, size_t max, int flags = 0)
+    {
+        if(batch.size() < max)
+            batch.resize(max);
+
+        size_t n = 0;
+        while(n < max)
+        {
+            int f = n == 0 ? flags : (flags | ZMQ_DONTWAIT);
+            if(!recv_multipart(batch[n], f))
+                break;
+            ++n;
+        }
+        return n;
+    }
+
+  protected:
+    static void _free_block(void *, void *hint)
+    {
+        delete static_cast<std::vector<uint8_t> *>(hint);
+    }
+
   protected:
     context::ptr _ctx;
     void        *_sock;
@@ -427,6 +680,9 @@ class w_chan : public socket_base
         return *this << msg;
     }
 
+    // zero-copy when msg was built with message::adopt
+    inline bool operator<<(message &src) { return send(src, _flags); }
+
     inline r_chan make_r_chan(int flags = 0) const
     {
         return r_chan(_ctx, _addr, flags);
@@ -0,0 +1,260 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZMQ_REACTOR_HPP
+#define ZMQ_REACTOR_HPP
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <boost/asio.hpp>
+
+#include <hj/net/zmq.hpp>
+
+namespace hj
+{
+namespace zmq
+{
+
+// -----------------------------------------------------------------------------
+// Reactor (zmq sockets on an asio io_context)
+// -----------------------------------------------------------------------------
+// Watches the ZMQ_FD of every added socket with asio and calls on_readable /
+// on_writable while ZMQ_EVENTS reports ZMQ_POLLIN / ZMQ_POLLOUT.
+//
+// ZMQ_FD is edge triggered and only says "ZMQ_EVENTS may have changed": any
+// send or recv on the socket can swallow the edge of messages that arrived
+// meanwhile. So ZMQ_EVENTS is checked again after every handler call and
+// the fd is only waited on once the socket is idle. A handler should drain
+// what it wants (or call modify() to drop its interest), a socket that
+// stays ready is rescheduled through post() so other work on the
+// io_context interleaves.
+//
+// Handlers run on the reactor's strand. Sockets are not thread safe: add,
+// remove, modify and any send/recv outside the handlers belong on
+// executor(); call notify() after such a send/recv.
+class reactor
+{
+  public:
+    using io_t       = boost::asio::io_context;
+    using executor_t = boost::asio::strand<io_t::executor_type>;
+    using handler_t  = std::function<void(socket_base &)>;
+
+#if defined(_WIN32)
+    using descriptor_t = boost::asio::ip::tcp::socket;
+#else
+    using descriptor_t = boost::asio::posix::stream_descriptor;
+#endif
+
+  public:
+    explicit reactor(io_t &io)
+        : _exec{boost::asio::make_strand(io)}
+    {
+    }
+
+    ~reactor() noexcept { clear(); }
+
+    reactor(const reactor &)            = delete;
+    reactor &operator=(const reactor &) = delete;
+
+    inline executor_t &executor() noexcept { return _exec; }
+    inline size_t      size() const noexcept { return _watches.size(); }
+
+    // false when sock is already watched or has no ZMQ_FD; sock must
+    // outlive the watch, remove() it before closing
+    bool add(socket_base &sock,
+             handler_t    on_readable,
+             handler_t    on_writable = nullptr)
+    {
+        if(_watches.count(sock.get()))
+            return false;
+
+        zmq_fd_t fd;
+        size_t   len = sizeof(fd);
+        if(zmq_getsockopt(sock.get(), ZMQ_FD, &fd, &len) != 0)
+            return false;
+
+        auto w         = std::make_shared<_watch>(_exec, sock);
+        w->on_readable = std::move(on_readable);
+        w->on_writable = std::move(on_writable);
+        w->events      = (w->on_readable ? ZMQ_POLLIN : 0)
+                         | (w->on_writable ? ZMQ_POLLOUT : 0);
+
+        boost::system::error_code ec;
+#if defined(_WIN32)
+        w->fd.assign(boost::asio::ip::tcp::v4(), fd, ec);
+#else
+        w->fd.assign(fd, ec);
+#endif
+        if(ec)
+            return false;
+
+        _watches.emplace(sock.get(), w);
+
+        // messages may already be queued, their edge is gone
+        _watch::schedule(w);
+        return true;
+    }
+
+    // events: any mix of ZMQ_POLLIN and ZMQ_POLLOUT, e.g. enable
+    // ZMQ_POLLOUT only while there is something to send
+    bool modify(socket_base &sock, short events)
+    {
+        auto itr = _watches.find(sock.get());
+        if(itr == _watches.end())
+            return false;
+
+        itr->second->events = events;
+        _watch::schedule(itr->second);
+        return true;
+    }
+
+    // re-checks ZMQ_EVENTS after a send/recv made outside the handlers
+    bool notify(socket_base &sock)
+    {
+        auto itr = _watches.find(sock.get());
+        if(itr == _watches.end())
+            return false;
+
+        _watch::schedule(itr->second);
+        return true;
+    }
+
+    bool remove(socket_base &sock)
+    {
+        auto itr = _watches.find(sock.get());
+        if(itr == _watches.end())
+            return false;
+
+        itr->second->close();
+        _watches.erase(itr);
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        for(auto &kv : _watches)
+            kv.second->close();
+        _watches.clear();
+    }
+
+  private:
+    // pending asio handlers hold the watch, never the reactor
+    struct _watch
+    {
+        _watch(const executor_t &exec, socket_base &s)
+            : fd{exec}
+            , sock{s}
+        {
+        }
+
+        // may run inside one of the handlers, so they are left alone
+        void close() noexcept
+        {
+            closed = true;
+
+            // the fd belongs to zmq, only detach it
+            boost::system::error_code ec;
+            fd.cancel(ec);
+#if defined(_WIN32)
+            fd.release(ec);
+#else
+            fd.release();
+#endif
+        }
+
+        int ready() noexcept
+        {
+            int    ev  = 0;
+            size_t len = sizeof(ev);
+            if(zmq_getsockopt(sock.get(), ZMQ_EVENTS, &ev, &len) != 0)
+                return 0;
+
+            int wanted = (on_readable ? ZMQ_POLLIN : 0)
+                         | (on_writable ? ZMQ_POLLOUT : 0);
+            return ev & events & wanted;
+        }
+
+        static void schedule(const std::shared_ptr<_watch> &w)
+        {
+            if(w->scheduled || w->closed)
+                return;
+
+            w->scheduled = true;
+            boost::asio::post(w->fd.get_executor(), [w]() {
+                w->scheduled = false;
+                process(w);
+            });
+        }
+
+        static void wait(const std::shared_ptr<_watch> &w)
+        {
+            if(w->waiting || w->closed)
+                return;
+
+            w->waiting = true;
+            w->fd.async_wait(descriptor_t::wait_read,
+                             [w](const boost::system::error_code &ec) {
+                                 w->waiting = false;
+                                 if(!ec)
+                                     process(w);
+                             });
+        }
+
+        static void process(const std::shared_ptr<_watch> &w)
+        {
+            if(w->closed)
+                return;
+
+            int ev = w->ready();
+            if(ev & ZMQ_POLLIN)
+                w->on_readable(w->sock);
+            if(w->closed)
+                return;
+            if(ev & ZMQ_POLLOUT)
+                w->on_writable(w->sock);
+            if(w->closed)
+                return;
+
+            // the handlers touched the socket, the fd edge may be gone
+            if(w->ready() != 0)
+                schedule(w);
+            else
+                wait(w);
+        }
+
+        descriptor_t fd;
+        socket_base &sock;
+        handler_t    on_readable;
+        handler_t    on_writable;
+        short        events    = 0;
+        bool         scheduled = false;
+        bool         waiting   = false;
+        bool         closed    = false;
+    };
+
+  private:
+    executor_t                                          _exec;
+    std::unordered_map<void *, std::shared_ptr<_watch>> _watches;
+};
+
+} // namespace zmq
+} // namespace hj
+
+#endif // ZMQ_REACTOR_HPP
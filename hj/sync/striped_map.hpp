@@ -28,6 +28,8 @@
 
 #include <shared_mutex>
 
+#include <hj/algo/hash.hpp>
+
 using shared_mutex_t = std::shared_mutex;
 using unique_lock_t  = std::unique_lock<shared_mutex_t>;
 using shared_lock_t  = std::shared_lock<shared_mutex_t>;
@@ -41,7 +43,8 @@ namespace hj
 
 template <typename Key,
           typename Value,
-          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+          typename Alloc = std::allocator<std::pair<const Key, Value>>,
+          typename Hash  = hj::hash<Key>>
 class striped_map
 {
   public:
@@ -49,9 +52,10 @@ class striped_map
     using strip_key_handler_t = std::function<int(const Key &)>;
     using allocator_type      = Alloc;
     using value_type          = std::pair<const Key, Value>;
+    using hasher              = Hash;
     using bucket_type         = std::unordered_map<Key,
                                            Value,
-                                           std::hash<Key>,
+                                           Hash,
                                            std::equal_to<Key>,
                                            allocator_type>;
 
@@ -146,11 +150,15 @@ class striped_map
     }
 
   public:
+    // the stripe comes from the re-mixed hash, the buckets inside it use
+    // the plain one; the same bits for both would crowd every stripe
+    // into 1/capa of its buckets
     explicit striped_map(std::size_t    capa,
                          allocator_type alloc = allocator_type())
         : striped_map(
             [capa](const Key &k) -> int {
-                return static_cast<int>(std::hash<Key>{}(k) % capa);
+                uint64_t h = static_cast<uint64_t>(Hash{}(k));
+                return static_cast<int>(hj::hash_mix(h) % capa);
             },
             capa,
             alloc)
@@ -0,0 +1,245 @@
+/*
+ *  This file is part of high-jump(hj).
+ *  Copyright (C) 2025 hanjingo <hehehunanchina@live.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HDR_HISTOGRAM_HPP
+#define HDR_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <hj/encoding/bits.hpp>
+
+namespace hj
+{
+
+// High Dynamic Range histogram (same bucket layout as HdrHistogram):
+// values in [lowest, highest] are kept with `digits` significant decimal
+// digits, so memory depends on the range, not on the number of samples.
+// Good for latencies where the tail matters (p99, p99.9, max), e.g. in
+// nanoseconds with lowest = 1 and highest = 1 hour.
+//
+// Not thread safe, give every thread its own and merge() them at the end.
+class hdr_histogram
+{
+  public:
+    explicit hdr_histogram(int64_t lowest  = 1,
+                           int64_t highest = 3600LL * 1000 * 1000 * 1000,
+                           int     digits  = 3)
+        : _lowest{lowest}
+        , _highest{highest}
+        , _digits{digits}
+    {
+        if(lowest < 1 || digits < 1 || digits > 5 || highest < 2 * lowest)
+            throw std::invalid_argument("hdr_histogram: invalid range");
+
+        int64_t single_unit = 2;
+        for(int i = 0; i < digits; ++i)
+            single_unit *= 10;
+
+        _unit_mag = static_cast<int>(std::floor(std::log2(lowest)));
+        int sub_mag =
+            static_cast<int>(std::ceil(std::log2(double(single_unit))));
+        _sub_half_mag   = (sub_mag > 1 ? sub_mag : 1) - 1;
+        _sub_count      = int64_t(1) << (_sub_half_mag + 1);
+        _sub_half_count = _sub_count / 2;
+        _sub_mask       = (_sub_count - 1) << _unit_mag;
+
+        int64_t untrackable = _sub_count << _unit_mag;
+        int     buckets     = 1;
+        while(untrackable <= highest)
+        {
+            if(untrackable > std::numeric_limits<int64_t>::max() / 2)
+            {
+                ++buckets;
+                break;
+            }
+            untrackable <<= 1;
+            ++buckets;
+        }
+        _counts.resize(static_cast<size_t>((buckets + 1) * _sub_half_count));
+        reset();
+    }
+
+    inline int64_t lowest() const noexcept { return _lowest; }
+    inline int64_t highest() const noexcept { return _highest; }
+    inline int     digits() const noexcept { return _digits; }
+    inline int64_t count() const noexcept { return _total; }
+    inline bool    empty() const noexcept { return _total == 0; }
+    inline int64_t min() const noexcept { return _total ? _min : 0; }
+    inline int64_t max() const noexcept { return _total ? _max : 0; }
+    inline double  mean() const noexcept
+    {
+        return _total ? _sum / static_cast<double>(_total) : 0.0;
+    }
+
+    // false when value is out of [0, highest]
+    bool record(int64_t value, int64_t n = 1) noexcept
+    {
+        if(value < 0 || value > _highest || n < 1)
+            return false;
+
+        _counts[_index_of(value)] += n;
+        _total += n;
+        _sum += static_cast<double>(value) * n;
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+        return true;
+    }
+
+    // for closed loop load generators: a stall of `value` also delayed the
+    // requests that should have been sent every `interval` meanwhile, record
+    // them too instead of hiding the stall (coordinated omission)
+    bool record_corrected(int64_t value, int64_t interval) noexcept
+    {
+        if(!record(value))
+            return false;
+
+        for(int64_t v = value - interval; interval > 0 && v >= interval;
+            v -= interval)
+            record(v);
+        return true;
+    }
+
+    // percentile in [0, 100]; highest value equivalent to the bucket that
+    // holds it, never above max()
+    int64_t percentile(double p) const noexcept
+    {
+        if(_total == 0)
+            return 0;
+
+        p            = std::min(std::max(p, 0.0), 100.0);
+        auto target  = static_cast<int64_t>(p / 100.0 * _total + 0.5);
+        target       = std::max<int64_t>(target, 1);
+        int64_t seen = 0;
+        for(size_t i = 0; i < _counts.size(); ++i)
+        {
+            seen += _counts[i];
+            if(seen >= target)
+                return std::min(_highest_equivalent(_value_at(i)), _max);
+        }
+        return _max;
+    }
+
+    // other may use another range or precision, its buckets are re-recorded
+    void merge(const hdr_histogram &other) noexcept
+    {
+        if(other._total == 0)
+            return;
+
+        if(_same_layout(other))
+        {
+            for(size_t i = 0; i < _counts.size(); ++i)
+                _counts[i] += other._counts[i];
+            _total += other._total;
+        } else
+        {
+            for(size_t i = 0; i < other._counts.size(); ++i)
+            {
+                int64_t n = other._counts[i];
+                if(n == 0)
+                    continue;
+
+                int64_t v = std::min(other._value_at(i), _highest);
+                _counts[_index_of(v)] += n;
+                _total += n;
+            }
+        }
+        _sum += other._sum;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, std::min(other._max, _highest));
+    }
+
+    void reset() noexcept
+    {
+        std::fill(_counts.begin(), _counts.end(), 0);
+        _total = 0;
+        _sum   = 0.0;
+        _min   = std::numeric_limits<int64_t>::max();
+        _max   = 0;
+    }
+
+  private:
+    inline int _bucket_of(int64_t value) const noexcept
+    {
+        auto v    = static_cast<uint64_t>(value | _sub_mask);
+        int  pow2 = 64 - bits::count_leading_zeros(v);
+        return pow2 - _unit_mag - (_sub_half_mag + 1);
+    }
+
+    inline size_t _index_of(int64_t value) const noexcept
+    {
+        int     bucket = _bucket_of(value);
+        int64_t sub    = value >> (bucket + _unit_mag);
+        int64_t base   = int64_t(bucket + 1) << _sub_half_mag;
+        return static_cast<size_t>(base + sub - _sub_half_count);
+    }
+
+    inline int64_t _value_at(size_t index) const noexcept
+    {
+        auto    i      = static_cast<int64_t>(index);
+        int     bucket = static_cast<int>(i >> _sub_half_mag) - 1;
+        int64_t sub    = (i & (_sub_half_count - 1)) + _sub_half_count;
+        if(bucket < 0)
+        {
+            sub -= _sub_half_count;
+            bucket = 0;
+        }
+        return sub << (bucket + _unit_mag);
+    }
+
+    inline int64_t _highest_equivalent(int64_t value) const noexcept
+    {
+        int     bucket = _bucket_of(value);
+        int64_t sub    = value >> (bucket + _unit_mag);
+        int     adjust = sub >= _sub_count ? bucket + 1 : bucket;
+        int64_t lowest = sub << (bucket + _unit_mag);
+        return lowest + (int64_t(1) << (_unit_mag + adjust)) - 1;
+    }
+
+    inline bool _same_layout(const hdr_histogram &other) const noexcept
+    {
+        return _unit_mag == other._unit_mag
+               && _sub_half_mag == other._sub_half_mag
+               && _counts.size() == other._counts.size();
+    }
+
+  private:
+    int64_t _lowest;
+    int64_t _highest;
+    int     _digits;
+
+    int     _unit_mag;
+    int     _sub_half_mag;
+    int64_t _sub_count;
+    int64_t _sub_half_count;
+    int64_t _sub_mask;
+
+    std::vector<int64_t> _counts;
+    int64_t              _total;
+    double               _sum;
+    int64_t              _min;
+    int64_t              _max;
+};
+
+} // namespace hj
+
+#endif // HDR_HISTOGRAM_HPP
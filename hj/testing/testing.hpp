@@ -17,6 +17,8 @@
 
 #include <hj/testing/exception.hpp>
 
+#include <hj/testing/hdr_histogram.hpp>
+
 #include <hj/testing/stacktrace.hpp>
 
 #ifdef HJ_ENABLE_TELEMETRY
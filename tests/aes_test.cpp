@@ -2957,4 +2957,406 @@ TEST(aes, is_aead_mode)
     ASSERT_TRUE(hj::aes::is_aead_mode(hj::aes::mode::ccm));
     ASSERT_FALSE(hj::aes::is_aead_mode(hj::aes::mode::ecb));
     ASSERT_FALSE(hj::aes::is_aead_mode(hj::aes::mode::cbc));
-}
\ No newline at end of file
+}
+TEST(aes, session_matches_static_api)
+{
+    const std::string key(32, 'k');
+    const std::string iv(16, 'i');
+    const std::string iv12(12, 'n');
+    struct
+    {
+        hj::aes::mode mod;
+        std::string   iv;
+    } cases[] = {{hj::aes::mode::ecb, ""},
+                 {hj::aes::mode::cbc, iv},
+                 {hj::aes::mode::ctr, iv},
+                 {hj::aes::mode::cfb8, iv},
+                 {hj::aes::mode::ofb, iv},
+                 {hj::aes::mode::gcm, iv12},
+                 {hj::aes::mode::gcm, iv}};
+
+    for(const auto &c : cases)
+    {
+        hj::aes::session sess{reinterpret_cast<const unsigned char *>(
+                                  key.data()),
+                              key.size(),
+                              c.mod,
+                              hj::aes::padding::pkcs7};
+        ASSERT_TRUE(sess.is_valid());
+        EXPECT_EQ(sess.get_mode(), c.mod);
+
+        // the context is reused across messages of any length
+        for(std::size_t len : {0, 1, 15, 16, 17, 1024, 2000})
+        {
+            std::string plain(len, 'p');
+            for(std::size_t i = 0; i < len; ++i)
+                plain[i] = static_cast<char>(i * 7);
+
+            std::string expect, cipher, back;
+            ASSERT_EQ(hj::aes::encrypt(expect,
+                                       plain,
+                                       key,
+                                       c.mod,
+                                       hj::aes::padding::pkcs7,
+                                       c.iv),
+                      hj::aes::error_code::ok);
+            ASSERT_EQ(sess.encrypt(cipher, plain, c.iv),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(cipher, expect);
+
+            ASSERT_EQ(sess.decrypt(back, cipher, c.iv),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(back, plain);
+        }
+    }
+}
+
+TEST(aes, session_aead)
+{
+    const std::string key(16, 'k');
+    const std::string plain = "order 42: buy 100 @ 99.5";
+    const std::string aad   = "header";
+
+    for(auto mod : {hj::aes::mode::gcm, hj::aes::mode::ccm})
+    {
+        hj::aes::session sess{reinterpret_cast<const unsigned char *>(
+                                  key.data()),
+                              key.size(),
+                              mod};
+        for(int i = 0; i < 3; ++i)
+        {
+            // a fresh nonce per message
+            std::string nonce(12, static_cast<char>('a' + i));
+            std::string cipher, back;
+            ASSERT_EQ(sess.encrypt(cipher, plain, nonce, aad),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(cipher.size(), plain.size() + 16);
+
+            ASSERT_EQ(sess.decrypt(back, cipher, nonce, aad),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(back, plain);
+
+            EXPECT_NE(sess.decrypt(back, cipher, nonce, "other"),
+                      hj::aes::error_code::ok);
+            std::string tampered = cipher;
+            tampered[0] ^= 1;
+            EXPECT_NE(sess.decrypt(back, tampered, nonce, aad),
+                      hj::aes::error_code::ok);
+
+            // still usable after a failed message
+            ASSERT_EQ(sess.decrypt(back, cipher, nonce, aad),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(back, plain);
+        }
+    }
+}
+
+TEST(aes, session_invalid)
+{
+    const std::string key(16, 'k');
+    const std::string iv(16, 'i');
+    std::string       out;
+
+    hj::aes::session none;
+    EXPECT_FALSE(none.is_valid());
+    EXPECT_EQ(none.encrypt(out, "x", iv), hj::aes::error_code::session_invalid);
+    EXPECT_EQ(none.decrypt(out, "x", iv), hj::aes::error_code::session_invalid);
+
+    EXPECT_EQ(none.init(reinterpret_cast<const unsigned char *>(key.data()),
+                        15,
+                        hj::aes::mode::cbc),
+              hj::aes::error_code::key_invalid);
+    ASSERT_EQ(none.init(reinterpret_cast<const unsigned char *>(key.data()),
+                        key.size(),
+                        hj::aes::mode::cbc),
+              hj::aes::error_code::ok);
+    EXPECT_EQ(none.encrypt(out, "x"), hj::aes::error_code::iv_invalid);
+    EXPECT_EQ(none.encrypt(out, "x", iv, "aad"),
+              hj::aes::error_code::param_invalid);
+
+    hj::aes::session moved{std::move(none)};
+    EXPECT_FALSE(none.is_valid());
+    ASSERT_TRUE(moved.is_valid());
+    EXPECT_EQ(moved.encrypt(out, "x", iv), hj::aes::error_code::ok);
+    EXPECT_EQ(out.size(), 16u);
+}
+
+TEST(aes, encrypt_batch)
+{
+    const std::string key(32, 'k');
+    const auto *k = reinterpret_cast<const unsigned char *>(key.data());
+
+    const std::size_t                       n = 16;
+    std::vector<std::string>                plains(n), nonces(n);
+    std::vector<std::vector<unsigned char>> ciphers(n), backs(n);
+    std::vector<hj::aes::batch_item>        enc(n), dec(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        plains[i] = std::string(100 + i * 50, static_cast<char>('a' + i));
+        nonces[i] = std::string(12, static_cast<char>(i));
+        ciphers[i].resize(plains[i].size() + 16);
+        backs[i].resize(plains[i].size() + 16);
+
+        enc[i].dst     = ciphers[i].data();
+        enc[i].src     = reinterpret_cast<const unsigned char *>(
+            plains[i].data());
+        enc[i].src_len = plains[i].size();
+        enc[i].iv      = reinterpret_cast<const unsigned char *>(
+            nonces[i].data());
+        enc[i].iv_len  = nonces[i].size();
+    }
+
+    // a bad item fails alone
+    enc[3].iv = nullptr;
+    EXPECT_EQ(hj::aes::encrypt_batch(enc.data(), n, k, key.size()),
+              hj::aes::error_code::iv_invalid);
+    EXPECT_EQ(enc[3].ec, hj::aes::error_code::iv_invalid);
+    enc[3].iv = reinterpret_cast<const unsigned char *>(nonces[3].data());
+    ASSERT_EQ(hj::aes::encrypt_batch(enc.data(), n, k, key.size()),
+              hj::aes::error_code::ok);
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(enc[i].ec, hj::aes::error_code::ok);
+        EXPECT_EQ(enc[i].dst_len, plains[i].size() + 16);
+        dec[i].dst     = backs[i].data();
+        dec[i].src     = ciphers[i].data();
+        dec[i].src_len = enc[i].dst_len;
+        dec[i].iv      = enc[i].iv;
+        dec[i].iv_len  = enc[i].iv_len;
+    }
+
+    hj::aes::session sess{k, key.size()};
+    ASSERT_EQ(sess.decrypt_batch(dec.data(), n), hj::aes::error_code::ok);
+    for(std::size_t i = 0; i < n; ++i)
+        EXPECT_EQ(std::string(backs[i].begin(),
+                              backs[i].begin() + dec[i].dst_len),
+                  plains[i]);
+
+    EXPECT_EQ(hj::aes::encrypt_batch(enc.data(), n, k, 5),
+              hj::aes::error_code::key_invalid);
+}
+
+static std::string aes_test_random(std::size_t len)
+{
+    std::string s(len, 0);
+    for(std::size_t i = 0; i < len; ++i)
+        s[i] = static_cast<char>((i * 2654435761u) >> 13);
+    return s;
+}
+
+TEST(aes, parallel_ctr)
+{
+    const std::string key(32, 'k');
+    const auto       *k = reinterpret_cast<const unsigned char *>(key.data());
+
+    // the low 64 bits of the counter wrap inside the stream
+    std::string iv(16, '\0');
+    for(int i = 8; i < 16; ++i)
+        iv[i] = '\xff';
+    iv[15]       = '\xf0';
+    const auto *v = reinterpret_cast<const unsigned char *>(iv.data());
+
+    hj::aes::parallel_options opts;
+    opts.chunk_size = 4096;
+    opts.threads    = 3;
+    for(std::size_t len : {0, 1, 4096, 4096 * 5, 4096 * 5 + 7, 100000})
+    {
+        const std::string  plain = aes_test_random(len);
+        std::istringstream in(plain);
+        std::ostringstream out;
+        ASSERT_EQ(hj::aes::encrypt_parallel(out,
+                                            in,
+                                            k,
+                                            key.size(),
+                                            hj::aes::mode::ctr,
+                                            v,
+                                            iv.size(),
+                                            opts),
+                  hj::aes::error_code::ok);
+        ASSERT_EQ(out.str().size(), len);
+
+        // same stream as one sequential ctr pass
+        if(len % 16 == 0 && len > 0)
+        {
+            std::string seq;
+            ASSERT_EQ(hj::aes::encrypt(seq,
+                                       plain,
+                                       key,
+                                       hj::aes::mode::ctr,
+                                       hj::aes::padding::no_padding,
+                                       iv),
+                      hj::aes::error_code::ok);
+            EXPECT_EQ(out.str(), seq);
+        }
+
+        std::istringstream in2(out.str());
+        std::ostringstream back;
+        ASSERT_EQ(hj::aes::decrypt_parallel(back,
+                                            in2,
+                                            k,
+                                            key.size(),
+                                            hj::aes::mode::ctr,
+                                            v,
+                                            iv.size(),
+                                            opts),
+                  hj::aes::error_code::ok);
+        EXPECT_EQ(back.str(), plain);
+    }
+}
+
+TEST(aes, parallel_gcm)
+{
+    const std::string key(16, 'k');
+    const std::string iv(12, 'n');
+    const auto       *k = reinterpret_cast<const unsigned char *>(key.data());
+    const auto       *v = reinterpret_cast<const unsigned char *>(iv.data());
+
+    hj::thread_pool           pool{2};
+    hj::aes::parallel_options opts;
+    opts.chunk_size = 1024;
+    opts.pool       = &pool;
+    opts.depth      = 3;
+
+    auto encrypt = [&](const std::string &plain) {
+        std::istringstream in(plain);
+        std::ostringstream out;
+        EXPECT_EQ(hj::aes::encrypt_parallel(out,
+                                            in,
+                                            k,
+                                            key.size(),
+                                            hj::aes::mode::gcm,
+                                            v,
+                                            iv.size(),
+                                            opts),
+                  hj::aes::error_code::ok);
+        return out.str();
+    };
+    auto decrypt = [&](const std::string &cipher, std::string &plain) {
+        std::istringstream in(cipher);
+        std::ostringstream out;
+        auto               ec = hj::aes::decrypt_parallel(out,
+                                                          in,
+                                                          k,
+                                                          key.size(),
+                                                          hj::aes::mode::gcm,
+                                                          v,
+                                                          iv.size());
+        plain                 = out.str();
+        return ec;
+    };
+
+    for(std::size_t len : {0, 1, 1024, 1024 * 3, 1024 * 3 + 5, 50000})
+    {
+        const std::string plain  = aes_test_random(len);
+        const std::string cipher = encrypt(plain);
+        std::size_t       chunks = len == 0 ? 1 : (len + 1023) / 1024;
+        EXPECT_EQ(cipher.size(), 12 + len + chunks * 16);
+
+        std::string back;
+        ASSERT_EQ(decrypt(cipher, back), hj::aes::error_code::ok);
+        EXPECT_EQ(back, plain);
+    }
+
+    const std::string plain  = aes_test_random(1024 * 4);
+    const std::string cipher = encrypt(plain);
+    const std::size_t frame  = 1024 + 16;
+    std::string       back;
+
+    std::string bad = cipher;
+    bad[12 + frame + 5] ^= 1;
+    EXPECT_EQ(decrypt(bad, back), hj::aes::error_code::decrypt_final_failed);
+
+    // truncated at a frame boundary
+    bad = cipher.substr(0, 12 + 3 * frame);
+    EXPECT_EQ(decrypt(bad, back), hj::aes::error_code::decrypt_final_failed);
+
+    // dropped and swapped frames
+    bad = cipher.substr(0, 12 + frame) + cipher.substr(12 + 2 * frame);
+    EXPECT_NE(decrypt(bad, back), hj::aes::error_code::ok);
+    bad = cipher.substr(0, 12) + cipher.substr(12 + frame, frame)
+          + cipher.substr(12, frame) + cipher.substr(12 + 2 * frame);
+    EXPECT_NE(decrypt(bad, back), hj::aes::error_code::ok);
+
+    bad = cipher;
+    bad[0] = 'X';
+    EXPECT_EQ(decrypt(bad, back), hj::aes::error_code::format_invalid);
+    EXPECT_EQ(decrypt(cipher.substr(0, 12), back),
+              hj::aes::error_code::format_invalid);
+
+    // chunk size is authenticated
+    bad = cipher;
+    bad[10] ^= 1;
+    EXPECT_NE(decrypt(bad, back), hj::aes::error_code::ok);
+}
+
+TEST(aes, parallel_invalid_and_file)
+{
+    const std::string key(32, 'k');
+    const std::string iv(12, 'n');
+    const auto       *k = reinterpret_cast<const unsigned char *>(key.data());
+    const auto       *v = reinterpret_cast<const unsigned char *>(iv.data());
+
+    std::istringstream        in("data");
+    std::ostringstream        out;
+    hj::aes::parallel_options opts;
+    EXPECT_EQ(hj::aes::encrypt_parallel(out,
+                                        in,
+                                        k,
+                                        key.size(),
+                                        hj::aes::mode::cbc,
+                                        v,
+                                        iv.size()),
+              hj::aes::error_code::param_invalid);
+    EXPECT_EQ(hj::aes::encrypt_parallel(out,
+                                        in,
+                                        k,
+                                        key.size(),
+                                        hj::aes::mode::ctr,
+                                        v,
+                                        iv.size()),
+              hj::aes::error_code::iv_invalid);
+    opts.chunk_size = 100;
+    EXPECT_EQ(hj::aes::encrypt_parallel(out,
+                                        in,
+                                        k,
+                                        key.size(),
+                                        hj::aes::mode::gcm,
+                                        v,
+                                        iv.size(),
+                                        opts),
+              hj::aes::error_code::param_invalid);
+
+    const std::string plain = aes_test_random(300000);
+    {
+        std::ofstream f("aes_parallel_plain.bin", std::ios::binary);
+        f << plain;
+    }
+    opts.chunk_size = 65536;
+    ASSERT_EQ(hj::aes::encrypt_file_parallel("aes_parallel_cipher.bin",
+                                             "aes_parallel_plain.bin",
+                                             k,
+                                             key.size(),
+                                             hj::aes::mode::gcm,
+                                             v,
+                                             iv.size(),
+                                             opts),
+              hj::aes::error_code::ok);
+    ASSERT_EQ(hj::aes::decrypt_file_parallel("aes_parallel_back.bin",
+                                             "aes_parallel_cipher.bin",
+                                             k,
+                                             key.size(),
+                                             hj::aes::mode::gcm,
+                                             v,
+                                             iv.size()),
+              hj::aes::error_code::ok);
+
+    std::ifstream      f("aes_parallel_back.bin", std::ios::binary);
+    std::ostringstream back;
+    back << f.rdbuf();
+    EXPECT_EQ(back.str(), plain);
+
+    std::filesystem::remove("aes_parallel_plain.bin");
+    std::filesystem::remove("aes_parallel_cipher.bin");
+    std::filesystem::remove("aes_parallel_back.bin");
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <hj/crypto/base64.hpp>
 #include <filesystem>
+#include <random>
 
 // for OpenSSL compatibility on Windows
 #ifdef _WIN32
@@ -181,4 +182,175 @@ TEST(base64, is_valid)
         std::remove("tmp_odd_b64.txt");
         std::remove("tmp_empty_b64.txt");
     }
-}
\ No newline at end of file
+}
+
+TEST(base64, engines)
+{
+    using hj::base64;
+    const base64::engine engines[] = {base64::engine::scalar,
+                                      base64::engine::sse41,
+                                      base64::engine::avx2,
+                                      base64::engine::neon};
+    const base64::engine def       = base64::get_engine();
+    EXPECT_TRUE(base64::is_engine_supported(base64::engine::scalar));
+    EXPECT_TRUE(base64::is_engine_supported(def));
+
+    std::mt19937 rng(42);
+    for(auto alpha : {base64::alphabet::standard, base64::alphabet::url})
+    {
+        for(std::size_t len = 1; len < 300; len += 7)
+        {
+            std::string src(len, '\0');
+            for(auto &c : src)
+                c = static_cast<char>(rng());
+
+            ASSERT_TRUE(base64::set_engine(base64::engine::scalar));
+            std::string want;
+            ASSERT_EQ(base64::encode(want, src, alpha), base64::error_code::ok);
+
+            for(auto e : engines)
+            {
+                if(!base64::set_engine(e))
+                    continue;
+
+                std::string enc, dec;
+                ASSERT_EQ(base64::encode(enc, src, alpha),
+                          base64::error_code::ok);
+                ASSERT_EQ(enc, want) << "engine " << int(e) << " len " << len;
+                ASSERT_EQ(base64::decode(dec, enc, alpha),
+                          base64::error_code::ok);
+                ASSERT_EQ(dec, src) << "engine " << int(e) << " len " << len;
+
+                // a bad char anywhere is caught, wherever the kernel stops
+                enc[rng() % enc.size()] = '*';
+                ASSERT_EQ(base64::decode(dec, enc, alpha),
+                          base64::error_code::invalid_input);
+            }
+        }
+    }
+    base64::set_engine(def);
+}
+
+TEST(base64, url)
+{
+    using hj::base64;
+    auto        url = base64::alphabet::url;
+    std::string out;
+
+    ASSERT_EQ(base64::encode(out, std::string("\xfb\xff\xbf", 3), url),
+              base64::error_code::ok);
+    EXPECT_EQ(out, "-_-_");
+    ASSERT_EQ(base64::encode(out, std::string("Ma"), url),
+              base64::error_code::ok);
+    EXPECT_EQ(out, "TWE");
+
+    // padding is optional on decode
+    ASSERT_EQ(base64::decode(out, std::string("TWE"), url),
+              base64::error_code::ok);
+    EXPECT_EQ(out, "Ma");
+    ASSERT_EQ(base64::decode(out, std::string("TQ=="), url),
+              base64::error_code::ok);
+    EXPECT_EQ(out, "M");
+    EXPECT_EQ(base64::decode(out, std::string("T"), url),
+              base64::error_code::invalid_input);
+
+    // the alphabets do not mix
+    EXPECT_EQ(base64::decode(out, std::string("-_-_")),
+              base64::error_code::invalid_input);
+    EXPECT_EQ(base64::decode(out, std::string("+/+/"), url),
+              base64::error_code::invalid_input);
+}
+
+TEST(base64, stream)
+{
+    using hj::base64;
+    std::string src(1000, '\0');
+    for(std::size_t i = 0; i < src.size(); ++i)
+        src[i] = static_cast<char>(i * 31);
+
+    std::string want;
+    base64::encode(want, src);
+
+    // odd chunk sizes make the carry bytes move around
+    for(std::size_t chunk : {1, 2, 5, 64, 333})
+    {
+        base64::encoder enc;
+        std::string     out;
+        unsigned char   buf[1024];
+        std::size_t     n;
+        for(std::size_t i = 0; i < src.size(); i += chunk)
+        {
+            n = sizeof(buf);
+            ASSERT_EQ(enc.update(buf,
+                                 n,
+                                 reinterpret_cast<const unsigned char *>(
+                                     src.data() + i),
+                                 std::min(chunk, src.size() - i)),
+                      base64::error_code::ok);
+            out.append(reinterpret_cast<char *>(buf), n);
+        }
+        n = sizeof(buf);
+        ASSERT_EQ(enc.finish(buf, n), base64::error_code::ok);
+        out.append(reinterpret_cast<char *>(buf), n);
+        ASSERT_EQ(out, want) << "chunk " << chunk;
+
+        base64::decoder dec;
+        std::string     back;
+        for(std::size_t i = 0; i < out.size(); i += chunk)
+        {
+            n = sizeof(buf);
+            ASSERT_EQ(dec.update(buf,
+                                 n,
+                                 reinterpret_cast<const unsigned char *>(
+                                     out.data() + i),
+                                 std::min(chunk, out.size() - i)),
+                      base64::error_code::ok);
+            back.append(reinterpret_cast<char *>(buf), n);
+        }
+        n = sizeof(buf);
+        ASSERT_EQ(dec.finish(buf, n), base64::error_code::ok);
+        ASSERT_EQ(back, src) << "chunk " << chunk;
+    }
+
+    // nothing may follow the padding, a cut quad is an error
+    base64::decoder dec;
+    unsigned char   buf[16];
+    std::size_t     n = sizeof(buf);
+    ASSERT_EQ(dec.update(buf, n, (const unsigned char *) "TQ==", 4),
+              base64::error_code::ok);
+    n = sizeof(buf);
+    EXPECT_EQ(dec.update(buf, n, (const unsigned char *) "TWFu", 4),
+              base64::error_code::invalid_input);
+
+    dec.reset();
+    n = sizeof(buf);
+    ASSERT_EQ(dec.update(buf, n, (const unsigned char *) "TWF", 3),
+              base64::error_code::ok);
+    n = sizeof(buf);
+    EXPECT_EQ(dec.finish(buf, n), base64::error_code::invalid_input);
+}
+
+TEST(base64, decode_invalid)
+{
+    using hj::base64;
+    std::string out;
+    EXPECT_EQ(base64::decode(out, std::string("TQ=A")),
+              base64::error_code::invalid_input);
+    EXPECT_EQ(base64::decode(out, std::string("T===")),
+              base64::error_code::invalid_input);
+    EXPECT_EQ(base64::decode(out, std::string("TQ==TWFu")),
+              base64::error_code::invalid_input);
+    EXPECT_EQ(base64::decode(out, std::string("TW\nFu")),
+              base64::error_code::invalid_input);
+    EXPECT_EQ(base64::decode(out, std::string(64, '\x80')),
+              base64::error_code::invalid_input);
+
+    unsigned char buf[2];
+    std::size_t   n = sizeof(buf);
+    EXPECT_EQ(base64::decode(buf, n, (const unsigned char *) "TWFu", 4),
+              base64::error_code::buffer_overflow);
+    n = sizeof(buf);
+    EXPECT_EQ(base64::decode(buf, n, (const unsigned char *) "TWE=", 4),
+              base64::error_code::ok);
+    EXPECT_EQ(n, 2);
+}
@@ -92,4 +92,19 @@ TEST(bloom_filter, type_support_int)
     EXPECT_TRUE(bf.contains(42));
     EXPECT_TRUE(bf.contains(7));
     EXPECT_FALSE(bf.contains(99));
-}
\ No newline at end of file
+}
+
+TEST(bloom_filter, false_positive_rate)
+{
+    // sequential integer keys used to defeat std::hash (the identity)
+    bloom_filter<uint64_t> bf(2000, 0.01);
+    for(uint64_t i = 0; i < 2000; ++i)
+        bf.add(i * 1024);
+    for(uint64_t i = 0; i < 2000; ++i)
+        ASSERT_TRUE(bf.contains(i * 1024));
+
+    int fp = 0;
+    for(uint64_t i = 0; i < 100000; ++i)
+        fp += bf.contains(i * 1024 + 7) ? 1 : 0;
+    EXPECT_LT(fp, 100000 * 0.03);
+}
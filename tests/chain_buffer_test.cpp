@@ -134,4 +134,24 @@ TEST(chain_buffer, multi_append_consume)
     n = buf.read(out, 5);
     ASSERT_EQ(n, 5u);
     ASSERT_EQ(std::string(out, 5), "efghi");
-}
\ No newline at end of file
+}
+
+TEST(chain_buffer, pop_unpop_block)
+{
+    chain_buffer buf(16);
+    std::string  data = "0123456789abcdefghijklmnopqrstuvwxyz";
+    buf.append(data.data(), data.size());
+    buf.consume(4);
+
+    std::vector<uint8_t> blk;
+    size_t               off = 0;
+    ASSERT_TRUE(buf.pop_block(blk, off));
+    ASSERT_EQ(off, 4u);
+    ASSERT_EQ(buf.size(), data.size() - 16);
+    buf.unpop_block(std::move(blk), off);
+    ASSERT_EQ(buf.size(), data.size() - 4);
+
+    std::string out(buf.size(), '\0');
+    ASSERT_EQ(buf.read(&out[0], out.size()), out.size());
+    ASSERT_EQ(out, data.substr(4));
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <hj/compress/codec.hpp>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+
+static std::vector<unsigned char> codec_payload()
+{
+    std::vector<unsigned char> data;
+    for(int i = 0; i < 2000; ++i)
+    {
+        std::string line = "2025-01-01 00:00:00 INFO order " + std::to_string(i)
+                           + " filled\n";
+        data.insert(data.end(), line.begin(), line.end());
+    }
+    return data;
+}
+
+TEST(codec, make_and_roundtrip)
+{
+    const auto data = codec_payload();
+    for(auto a : {hj::codec::algo::gzip,
+                  hj::codec::algo::lz4,
+                  hj::codec::algo::zstd})
+    {
+        auto c = hj::codec::make(a);
+        ASSERT_NE(c, nullptr);
+        EXPECT_EQ(c->type(), a);
+
+        std::vector<unsigned char> compressed, out;
+        ASSERT_EQ(c->compress(compressed, data.data(), data.size()),
+                  hj::codec::err::ok)
+            << c->name();
+        EXPECT_LT(compressed.size(), data.size() / 4) << c->name();
+        EXPECT_LE(compressed.size(), c->compress_reserve_sz(data.size()));
+
+        hj::codec::algo detected;
+        ASSERT_TRUE(
+            hj::codec::detect(detected, compressed.data(), compressed.size()));
+        EXPECT_EQ(detected, a);
+
+        ASSERT_EQ(c->decompress(out, compressed.data(), compressed.size()),
+                  hj::codec::err::ok);
+        EXPECT_EQ(out, data);
+
+        EXPECT_EQ(
+            c->decompress(out, compressed.data(), compressed.size(), 100),
+            hj::codec::err::max_output_sz_exceeded)
+            << c->name();
+        EXPECT_EQ(c->compress(out, nullptr, 0), hj::codec::err::input_invalid);
+    }
+}
+
+TEST(codec, by_name_and_level)
+{
+    EXPECT_EQ(hj::codec::make("unknown"), nullptr);
+
+    const auto data = codec_payload();
+    for(const char *name : {"gzip", "lz4", "zstd"})
+    {
+        auto fast = hj::codec::make(name, 1);
+        ASSERT_NE(fast, nullptr);
+        EXPECT_STREQ(fast->name(), name);
+        EXPECT_STREQ(hj::codec::get(fast->type()).name(), name);
+
+        std::vector<unsigned char> compressed, out;
+        ASSERT_EQ(fast->compress(compressed, data.data(), data.size()),
+                  hj::codec::err::ok);
+
+        // any codec of the same algorithm reads it back
+        ASSERT_EQ(hj::codec::get(fast->type())
+                      .decompress(out, compressed.data(), compressed.size()),
+                  hj::codec::err::ok);
+        EXPECT_EQ(out, data);
+    }
+}
+
+TEST(codec, stream_and_file)
+{
+    const auto  data = codec_payload();
+    std::string src(data.begin(), data.end());
+    {
+        std::ofstream out("codec_test_input.txt", std::ios::binary);
+        out << src;
+    }
+
+    for(auto a : {hj::codec::algo::gzip,
+                  hj::codec::algo::lz4,
+                  hj::codec::algo::zstd})
+    {
+        const hj::codec &c = hj::codec::get(a);
+
+        std::istringstream in(src, std::ios::binary);
+        std::ostringstream compressed(std::ios::binary);
+        ASSERT_EQ(c.compress(compressed, in), hj::codec::err::ok);
+
+        std::istringstream zin(compressed.str(), std::ios::binary);
+        std::ostringstream back(std::ios::binary);
+        ASSERT_EQ(c.decompress(back, zin), hj::codec::err::ok);
+        EXPECT_EQ(back.str(), src) << c.name();
+
+        ASSERT_EQ(c.compress_file("codec_test_output.bin",
+                                  "codec_test_input.txt"),
+                  hj::codec::err::ok);
+        ASSERT_EQ(c.decompress_file("codec_test_decompressed.txt",
+                                    "codec_test_output.bin"),
+                  hj::codec::err::ok);
+        std::ifstream file("codec_test_decompressed.txt", std::ios::binary);
+        std::string   dst((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+        EXPECT_EQ(dst, src) << c.name();
+    }
+
+    std::remove("codec_test_input.txt");
+    std::remove("codec_test_output.bin");
+    std::remove("codec_test_decompressed.txt");
+}
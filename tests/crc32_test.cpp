@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <hj/algo/crc32.h>
+#include <vector>
 
 TEST(crc32, standard_test_vectors)
 {
@@ -49,4 +50,72 @@ TEST(crc32, edge_cases)
 
     const char *data = "test";
     EXPECT_EQ(crc32(data, 0, 0), 0);
-}
\ No newline at end of file
+}
+
+static uint32_t crc_bitwise(const uint8_t *u, size_t len, uint32_t poly)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for(size_t i = 0; i < len; ++i)
+    {
+        crc ^= u[i];
+        for(int k = 0; k < 8; ++k)
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+TEST(crc32, matches_bitwise)
+{
+    // lengths and offsets around the 64 byte fold / 3-way lane sizes
+    std::vector<uint8_t> buf(4 * 3 * 1024 + 64);
+    for(size_t i = 0; i < buf.size(); ++i)
+        buf[i] = static_cast<uint8_t>(i * 131 + (i >> 8));
+
+    for(size_t off = 0; off < 8; off += 3)
+    {
+        for(size_t len : {0,   1,   7,   8,   15,   16,   63,   64,   65,
+                          127, 191, 192, 193, 1000, 3071, 3072, 3073, 12345})
+        {
+            const uint8_t *p = buf.data() + off;
+            EXPECT_EQ(crc32(p, len, 0), crc_bitwise(p, len, 0xEDB88320))
+                << "off " << off << " len " << len;
+            EXPECT_EQ(crc32c(p, len, 0), crc_bitwise(p, len, 0x82F63B78))
+                << "off " << off << " len " << len;
+        }
+    }
+}
+
+TEST(crc32, crc32c_test_vectors)
+{
+    EXPECT_EQ(crc32c("123456789", 9, 0), 0xE3069283);
+    EXPECT_EQ(crc32c("", 0, 0), 0);
+
+    // RFC 3720 B.4: 32 bytes of zeros / ones
+    std::vector<uint8_t> zeros(32, 0), ones(32, 0xFF);
+    EXPECT_EQ(crc32c(zeros.data(), zeros.size(), 0), 0x8A9136AA);
+    EXPECT_EQ(crc32c(ones.data(), ones.size(), 0), 0x62A8AB43);
+
+    uint32_t part = crc32c("1234", 4, 0);
+    EXPECT_EQ(crc32c("56789", 5, part), 0xE3069283);
+}
+
+TEST(crc32, combine)
+{
+    std::vector<uint8_t> buf(10000);
+    for(size_t i = 0; i < buf.size(); ++i)
+        buf[i] = static_cast<uint8_t>(i * 7 + 3);
+
+    uint32_t whole  = crc32(buf.data(), buf.size(), 0);
+    uint32_t wholec = crc32c(buf.data(), buf.size(), 0);
+    for(size_t cut : {0, 1, 100, 4096, 9999, 10000})
+    {
+        size_t   rest = buf.size() - cut;
+        uint32_t a    = crc32(buf.data(), cut, 0);
+        uint32_t b    = crc32(buf.data() + cut, rest, 0);
+        EXPECT_EQ(hj_crc32_combine(a, b, rest), whole) << "cut " << cut;
+
+        uint32_t ac = crc32c(buf.data(), cut, 0);
+        uint32_t bc = crc32c(buf.data() + cut, rest, 0);
+        EXPECT_EQ(hj_crc32c_combine(ac, bc, rest), wholec) << "cut " << cut;
+    }
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <hj/hardware/dpdk.h>
+#include <vector>
 
 #ifdef DPDK_ENABLE
 
@@ -99,4 +100,208 @@ TEST(dpdk, dpdk_dev_close)
     ASSERT_GE(ret, 0);
 }
 
-#endif // DPDK_ENABLE
\ No newline at end of file
+#endif // DPDK_ENABLE
+
+#if defined(PKT_PLATFORM_LINUX)
+
+// local experimental ethertype, other traffic on lo is skipped
+static const uint16_t pkt_test_ether = 0x88B5;
+
+static pkt_error_t pkt_test_open(pkt_queue_t *q, uint32_t blocks, uint32_t tx)
+{
+    pkt_queue_conf_t conf;
+    pkt_queue_conf_default(&conf);
+    conf.ifname         = "lo";
+    conf.block_size     = 4096;
+    conf.block_count    = blocks;
+    conf.tx_frame_count = tx;
+    return pkt_queue_open(q, &conf);
+}
+
+#define SKIP_IF_NO_RAW(err)                                                    \
+    if((err) == PKT_ERR_PERMISSION)                                            \
+        GTEST_SKIP() << "AF_PACKET needs CAP_NET_RAW";
+
+static void pkt_test_frame(uint8_t *buf, uint32_t seq)
+{
+    memset(buf, 0, 64);
+    buf[12] = pkt_test_ether >> 8;
+    buf[13] = pkt_test_ether & 0xff;
+    memcpy(buf + 14, &seq, sizeof(seq));
+}
+
+// receives until want test frames arrived, appends their seq to out
+static void
+pkt_test_recv(pkt_queue_t *q, size_t want, std::vector<uint32_t> &out)
+{
+    pkt_view_t views[PKT_MAX_BURST];
+    for(int spins = 0; out.size() < want && spins < 1000; ++spins)
+    {
+        if(pkt_poll(q, 10) != PKT_OK)
+            continue;
+
+        uint32_t n = pkt_rx_burst(q, views, PKT_MAX_BURST);
+        for(uint32_t i = 0; i < n; ++i)
+        {
+            ASSERT_GE(views[i].data, q->map);
+            ASSERT_LT(views[i].data, q->map + q->map_size);
+            if(views[i].len < 18
+               || views[i].data[12] != (pkt_test_ether >> 8)
+               || views[i].data[13] != (pkt_test_ether & 0xff))
+                continue;
+
+            EXPECT_EQ(views[i].len, 64u);
+            EXPECT_EQ(views[i].wire_len, 64u);
+            EXPECT_GT(views[i].ts_ns, 0u);
+            uint32_t seq;
+            memcpy(&seq, views[i].data + 14, sizeof(seq));
+            out.push_back(seq);
+        }
+        pkt_rx_release(q);
+    }
+}
+
+TEST(pkt, conf_default)
+{
+    pkt_queue_conf_t conf;
+    pkt_queue_conf_default(&conf);
+    EXPECT_EQ(conf.backend, PKT_BACKEND_AF_PACKET);
+    EXPECT_EQ(conf.block_size % 4096, 0u);
+    EXPECT_GT(conf.block_count, 0u);
+    EXPECT_EQ(conf.fanout_group, -1);
+    EXPECT_EQ(conf.cpu_core, -1);
+    EXPECT_FALSE(conf.hw_timestamp);
+}
+
+TEST(pkt, open_invalid)
+{
+    pkt_queue_t      q;
+    pkt_queue_conf_t conf;
+    pkt_queue_conf_default(&conf);
+    EXPECT_EQ(pkt_queue_open(NULL, &conf), PKT_ERR_INVALID_ARG);
+    EXPECT_EQ(pkt_queue_open(&q, &conf), PKT_ERR_INVALID_ARG);
+
+    conf.ifname = "hj-no-such-if0";
+    EXPECT_EQ(pkt_queue_open(&q, &conf), PKT_ERR_INVALID_ARG);
+
+    conf.ifname     = "lo";
+    conf.block_size = 1000;
+    EXPECT_EQ(pkt_queue_open(&q, &conf), PKT_ERR_INVALID_ARG);
+
+    pkt_queue_conf_default(&conf);
+    conf.ifname  = "lo";
+    conf.backend = PKT_BACKEND_DPDK;
+#ifndef DPDK_ENABLE
+    EXPECT_EQ(pkt_queue_open(&q, &conf), PKT_ERR_NOT_SUPPORTED);
+#endif
+
+    // a closed queue does nothing
+    pkt_view_t view;
+    EXPECT_EQ(pkt_rx_burst(&q, &view, 1), 0u);
+    EXPECT_EQ(pkt_tx_frame(&q, NULL), nullptr);
+    pkt_queue_close(&q);
+}
+
+TEST(pkt, af_packet_loopback)
+{
+    pkt_queue_t rx, tx;
+    pkt_error_t err = pkt_test_open(&rx, 4, 0);
+    SKIP_IF_NO_RAW(err);
+    ASSERT_EQ(err, PKT_OK);
+    ASSERT_EQ(pkt_test_open(&tx, 0, 64), PKT_OK);
+    EXPECT_EQ(pkt_tx_frame(&rx, NULL), nullptr);
+    EXPECT_EQ(pkt_rx_burst(&tx, NULL, 1), 0u);
+
+    // a 4 x 4KB ring is only ~100 frames, it has to be recycled
+    std::vector<uint32_t> seqs;
+    uint8_t               frames[32][64];
+    pkt_view_t            views[32];
+    for(uint32_t round = 0; round < 10; ++round)
+    {
+        for(uint32_t i = 0; i < 32; ++i)
+        {
+            pkt_test_frame(frames[i], round * 32 + i);
+            views[i].data = frames[i];
+            views[i].len  = 64;
+        }
+        ASSERT_EQ(pkt_tx_burst(&tx, views, 32), 32u);
+        pkt_test_recv(&rx, (round + 1) * 32, seqs);
+    }
+
+    ASSERT_EQ(seqs.size(), 320u);
+    for(uint32_t i = 0; i < seqs.size(); ++i)
+        EXPECT_EQ(seqs[i], i);
+
+    uint64_t packets = 0, drops = 0;
+    EXPECT_EQ(pkt_queue_stats(&rx, &packets, &drops), PKT_OK);
+    EXPECT_GE(packets, 320u);
+    EXPECT_EQ(drops, 0u);
+
+    pkt_queue_close(&tx);
+    pkt_queue_close(&rx);
+}
+
+TEST(pkt, af_packet_tx_in_place)
+{
+    pkt_queue_t rx, tx;
+    pkt_error_t err = pkt_test_open(&rx, 4, 0);
+    SKIP_IF_NO_RAW(err);
+    ASSERT_EQ(err, PKT_OK);
+    ASSERT_EQ(pkt_test_open(&tx, 0, 8), PKT_OK);
+
+    // 8 frames fill the tx ring until it is flushed
+    uint32_t cap = 0;
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        uint8_t *frame = pkt_tx_frame(&tx, &cap);
+        ASSERT_NE(frame, nullptr);
+        ASSERT_GE(cap, 64u);
+        pkt_test_frame(frame, i);
+        ASSERT_EQ(pkt_tx_commit(&tx, 64), PKT_OK);
+    }
+    EXPECT_EQ(pkt_tx_frame(&tx, &cap), nullptr);
+    EXPECT_EQ(pkt_tx_commit(&tx, cap + 1), PKT_ERR_INVALID_ARG);
+    EXPECT_EQ(pkt_tx_flush(&tx), 8u);
+
+    std::vector<uint32_t> seqs;
+    pkt_test_recv(&rx, 8, seqs);
+    ASSERT_EQ(seqs.size(), 8u);
+
+    // sent frames are free again
+    for(int i = 0; i < 100 && pkt_tx_frame(&tx, &cap) == nullptr; ++i)
+        usleep(1000);
+    EXPECT_NE(pkt_tx_frame(&tx, &cap), nullptr);
+
+    pkt_queue_close(&tx);
+    pkt_queue_close(&rx);
+}
+
+TEST(pkt, rx_only_and_bind_core)
+{
+    pkt_queue_t      q;
+    pkt_queue_conf_t conf;
+    pkt_queue_conf_default(&conf);
+    conf.ifname         = "lo";
+    conf.block_size     = 4096;
+    conf.block_count    = 2;
+    conf.tx_frame_count = 0;
+    conf.cpu_core       = 0;
+    pkt_error_t err     = pkt_queue_open(&q, &conf);
+    SKIP_IF_NO_RAW(err);
+    ASSERT_EQ(err, PKT_OK);
+
+    EXPECT_EQ(pkt_queue_bind_core(&q), PKT_OK);
+    EXPECT_EQ(pkt_queue_bind_core(NULL), PKT_ERR_INVALID_ARG);
+
+    // an rx only queue refuses tx
+    pkt_view_t views[PKT_MAX_BURST];
+    pkt_rx_burst(&q, views, PKT_MAX_BURST);
+    pkt_rx_release(&q);
+    EXPECT_EQ(pkt_tx_commit(&q, 64), PKT_ERR_INVALID_ARG);
+    EXPECT_EQ(pkt_tx_flush(&q), 0u);
+
+    pkt_queue_close(&q);
+    EXPECT_EQ(pkt_poll(NULL, 0), PKT_ERR_INVALID_ARG);
+}
+
+#endif // PKT_PLATFORM_LINUX
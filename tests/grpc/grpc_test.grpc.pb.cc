@@ -24,6 +24,8 @@ namespace GrpcLibrary {
 
 static const char* GrpcService_method_names[] = {
   "/GrpcLibrary.GrpcService/SayHello",
+  "/GrpcLibrary.GrpcService/SayHelloStream",
+  "/GrpcLibrary.GrpcService/Chat",
 };
 
 std::unique_ptr< GrpcService::Stub> GrpcService::NewStub(const std::shared_ptr< ::grpc::ChannelInterface>& channel, const ::grpc::StubOptions& options) {
@@ -34,6 +36,8 @@ std::unique_ptr< GrpcService::Stub> GrpcService::NewStub(const std::shared_ptr<
 
 GrpcService::Stub::Stub(const std::shared_ptr< ::grpc::ChannelInterface>& channel, const ::grpc::StubOptions& options)
   : channel_(channel), rpcmethod_SayHello_(GrpcService_method_names[0], options.suffix_for_stats(),::grpc::internal::RpcMethod::NORMAL_RPC, channel)
+  , rpcmethod_SayHelloStream_(GrpcService_method_names[1], options.suffix_for_stats(),::grpc::internal::RpcMethod::SERVER_STREAMING, channel)
+  , rpcmethod_Chat_(GrpcService_method_names[2], options.suffix_for_stats(),::grpc::internal::RpcMethod::BIDI_STREAMING, channel)
   {}
 
 ::grpc::Status GrpcService::Stub::SayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::GrpcLibrary::HelloReply* response) {
@@ -59,6 +63,38 @@ void GrpcService::Stub::async::SayHello(::grpc::ClientContext* context, const ::
   return result;
 }
 
+::grpc::ClientReader< ::GrpcLibrary::HelloReply>* GrpcService::Stub::SayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request) {
+  return ::grpc::internal::ClientReaderFactory< ::GrpcLibrary::HelloReply>::Create(channel_.get(), rpcmethod_SayHelloStream_, context, request);
+}
+
+void GrpcService::Stub::async::SayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::grpc::ClientReadReactor< ::GrpcLibrary::HelloReply>* reactor) {
+  ::grpc::internal::ClientCallbackReaderFactory< ::GrpcLibrary::HelloReply>::Create(stub_->channel_.get(), stub_->rpcmethod_SayHelloStream_, context, request, reactor);
+}
+
+::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>* GrpcService::Stub::AsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq, void* tag) {
+  return ::grpc::internal::ClientAsyncReaderFactory< ::GrpcLibrary::HelloReply>::Create(channel_.get(), cq, rpcmethod_SayHelloStream_, context, request, true, tag);
+}
+
+::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>* GrpcService::Stub::PrepareAsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) {
+  return ::grpc::internal::ClientAsyncReaderFactory< ::GrpcLibrary::HelloReply>::Create(channel_.get(), cq, rpcmethod_SayHelloStream_, context, request, false, nullptr);
+}
+
+::grpc::ClientReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* GrpcService::Stub::ChatRaw(::grpc::ClientContext* context) {
+  return ::grpc::internal::ClientReaderWriterFactory< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>::Create(channel_.get(), rpcmethod_Chat_, context);
+}
+
+void GrpcService::Stub::async::Chat(::grpc::ClientContext* context, ::grpc::ClientBidiReactor< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>* reactor) {
+  ::grpc::internal::ClientCallbackReaderWriterFactory< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>::Create(stub_->channel_.get(), stub_->rpcmethod_Chat_, context, reactor);
+}
+
+::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* GrpcService::Stub::AsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq, void* tag) {
+  return ::grpc::internal::ClientAsyncReaderWriterFactory< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>::Create(channel_.get(), cq, rpcmethod_Chat_, context, true, tag);
+}
+
+::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* GrpcService::Stub::PrepareAsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq) {
+  return ::grpc::internal::ClientAsyncReaderWriterFactory< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>::Create(channel_.get(), cq, rpcmethod_Chat_, context, false, nullptr);
+}
+
 GrpcService::Service::Service() {
   AddMethod(new ::grpc::internal::RpcServiceMethod(
       GrpcService_method_names[0],
@@ -70,6 +106,26 @@ GrpcService::Service::Service() {
              ::GrpcLibrary::HelloReply* resp) {
                return service->SayHello(ctx, req, resp);
              }, this)));
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      GrpcService_method_names[1],
+      ::grpc::internal::RpcMethod::SERVER_STREAMING,
+      new ::grpc::internal::ServerStreamingHandler< GrpcService::Service, ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>(
+          [](GrpcService::Service* service,
+             ::grpc::ServerContext* ctx,
+             const ::GrpcLibrary::HelloRequest* req,
+             ::grpc::ServerWriter<::GrpcLibrary::HelloReply>* writer) {
+               return service->SayHelloStream(ctx, req, writer);
+             }, this)));
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      GrpcService_method_names[2],
+      ::grpc::internal::RpcMethod::BIDI_STREAMING,
+      new ::grpc::internal::BidiStreamingHandler< GrpcService::Service, ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>(
+          [](GrpcService::Service* service,
+             ::grpc::ServerContext* ctx,
+             ::grpc::ServerReaderWriter<::GrpcLibrary::HelloReply,
+             ::GrpcLibrary::HelloRequest>* stream) {
+               return service->Chat(ctx, stream);
+             }, this)));
 }
 
 GrpcService::Service::~Service() {
@@ -82,6 +138,19 @@ GrpcService::Service::~Service() {
   return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
 }
 
+::grpc::Status GrpcService::Service::SayHelloStream(::grpc::ServerContext* context, const ::GrpcLibrary::HelloRequest* request, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* writer) {
+  (void) context;
+  (void) request;
+  (void) writer;
+  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+}
+
+::grpc::Status GrpcService::Service::Chat(::grpc::ServerContext* context, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* stream) {
+  (void) context;
+  (void) stream;
+  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+}
+
 
 }  // namespace GrpcLibrary
 #include <grpcpp/ports_undef.inc>
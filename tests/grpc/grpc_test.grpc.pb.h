@@ -48,11 +48,31 @@ class GrpcService final {
     std::unique_ptr< ::grpc::ClientAsyncResponseReaderInterface< ::GrpcLibrary::HelloReply>> PrepareAsyncSayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) {
       return std::unique_ptr< ::grpc::ClientAsyncResponseReaderInterface< ::GrpcLibrary::HelloReply>>(PrepareAsyncSayHelloRaw(context, request, cq));
     }
+    std::unique_ptr< ::grpc::ClientReaderInterface< ::GrpcLibrary::HelloReply>> SayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request) {
+      return std::unique_ptr< ::grpc::ClientReaderInterface< ::GrpcLibrary::HelloReply>>(SayHelloStreamRaw(context, request));
+    }
+    std::unique_ptr< ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>> AsyncSayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq, void* tag) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>>(AsyncSayHelloStreamRaw(context, request, cq, tag));
+    }
+    std::unique_ptr< ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>> PrepareAsyncSayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>>(PrepareAsyncSayHelloStreamRaw(context, request, cq));
+    }
+    std::unique_ptr< ::grpc::ClientReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> Chat(::grpc::ClientContext* context) {
+      return std::unique_ptr< ::grpc::ClientReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(ChatRaw(context));
+    }
+    std::unique_ptr<  ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> AsyncChat(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq, void* tag) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(AsyncChatRaw(context, cq, tag));
+    }
+    std::unique_ptr<  ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> PrepareAsyncChat(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(PrepareAsyncChatRaw(context, cq));
+    }
     class async_interface {
      public:
       virtual ~async_interface() {}
       virtual void SayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::GrpcLibrary::HelloReply* response, std::function<void(::grpc::Status)>) = 0;
       virtual void SayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::GrpcLibrary::HelloReply* response, ::grpc::ClientUnaryReactor* reactor) = 0;
+      virtual void SayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::grpc::ClientReadReactor< ::GrpcLibrary::HelloReply>* reactor) = 0;
+      virtual void Chat(::grpc::ClientContext* context, ::grpc::ClientBidiReactor< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>* reactor) = 0;
     };
     typedef class async_interface experimental_async_interface;
     virtual class async_interface* async() { return nullptr; }
@@ -60,6 +80,12 @@ class GrpcService final {
    private:
     virtual ::grpc::ClientAsyncResponseReaderInterface< ::GrpcLibrary::HelloReply>* AsyncSayHelloRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) = 0;
     virtual ::grpc::ClientAsyncResponseReaderInterface< ::GrpcLibrary::HelloReply>* PrepareAsyncSayHelloRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) = 0;
+    virtual ::grpc::ClientReaderInterface< ::GrpcLibrary::HelloReply>* SayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request) = 0;
+    virtual ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>* AsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq, void* tag) = 0;
+    virtual ::grpc::ClientAsyncReaderInterface< ::GrpcLibrary::HelloReply>* PrepareAsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) = 0;
+    virtual ::grpc::ClientReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* ChatRaw(::grpc::ClientContext* context) = 0;
+    virtual ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* AsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq, void* tag) = 0;
+    virtual ::grpc::ClientAsyncReaderWriterInterface< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* PrepareAsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq) = 0;
   };
   class Stub final : public StubInterface {
    public:
@@ -71,11 +97,31 @@ class GrpcService final {
     std::unique_ptr< ::grpc::ClientAsyncResponseReader< ::GrpcLibrary::HelloReply>> PrepareAsyncSayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) {
       return std::unique_ptr< ::grpc::ClientAsyncResponseReader< ::GrpcLibrary::HelloReply>>(PrepareAsyncSayHelloRaw(context, request, cq));
     }
+    std::unique_ptr< ::grpc::ClientReader< ::GrpcLibrary::HelloReply>> SayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request) {
+      return std::unique_ptr< ::grpc::ClientReader< ::GrpcLibrary::HelloReply>>(SayHelloStreamRaw(context, request));
+    }
+    std::unique_ptr< ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>> AsyncSayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq, void* tag) {
+      return std::unique_ptr< ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>>(AsyncSayHelloStreamRaw(context, request, cq, tag));
+    }
+    std::unique_ptr< ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>> PrepareAsyncSayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr< ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>>(PrepareAsyncSayHelloStreamRaw(context, request, cq));
+    }
+    std::unique_ptr< ::grpc::ClientReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> Chat(::grpc::ClientContext* context) {
+      return std::unique_ptr< ::grpc::ClientReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(ChatRaw(context));
+    }
+    std::unique_ptr<  ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> AsyncChat(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq, void* tag) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(AsyncChatRaw(context, cq, tag));
+    }
+    std::unique_ptr<  ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>> PrepareAsyncChat(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr< ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>>(PrepareAsyncChatRaw(context, cq));
+    }
     class async final :
       public StubInterface::async_interface {
      public:
       void SayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::GrpcLibrary::HelloReply* response, std::function<void(::grpc::Status)>) override;
       void SayHello(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::GrpcLibrary::HelloReply* response, ::grpc::ClientUnaryReactor* reactor) override;
+      void SayHelloStream(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest* request, ::grpc::ClientReadReactor< ::GrpcLibrary::HelloReply>* reactor) override;
+      void Chat(::grpc::ClientContext* context, ::grpc::ClientBidiReactor< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>* reactor) override;
      private:
       friend class Stub;
       explicit async(Stub* stub): stub_(stub) { }
@@ -89,7 +135,15 @@ class GrpcService final {
     class async async_stub_{this};
     ::grpc::ClientAsyncResponseReader< ::GrpcLibrary::HelloReply>* AsyncSayHelloRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) override;
     ::grpc::ClientAsyncResponseReader< ::GrpcLibrary::HelloReply>* PrepareAsyncSayHelloRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) override;
+    ::grpc::ClientReader< ::GrpcLibrary::HelloReply>* SayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request) override;
+    ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>* AsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq, void* tag) override;
+    ::grpc::ClientAsyncReader< ::GrpcLibrary::HelloReply>* PrepareAsyncSayHelloStreamRaw(::grpc::ClientContext* context, const ::GrpcLibrary::HelloRequest& request, ::grpc::CompletionQueue* cq) override;
+    ::grpc::ClientReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* ChatRaw(::grpc::ClientContext* context) override;
+    ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* AsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq, void* tag) override;
+    ::grpc::ClientAsyncReaderWriter< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* PrepareAsyncChatRaw(::grpc::ClientContext* context, ::grpc::CompletionQueue* cq) override;
     const ::grpc::internal::RpcMethod rpcmethod_SayHello_;
+    const ::grpc::internal::RpcMethod rpcmethod_SayHelloStream_;
+    const ::grpc::internal::RpcMethod rpcmethod_Chat_;
   };
   static std::unique_ptr<Stub> NewStub(const std::shared_ptr< ::grpc::ChannelInterface>& channel, const ::grpc::StubOptions& options = ::grpc::StubOptions());
 
@@ -98,6 +152,8 @@ class GrpcService final {
     Service();
     virtual ~Service();
     virtual ::grpc::Status SayHello(::grpc::ServerContext* context, const ::GrpcLibrary::HelloRequest* request, ::GrpcLibrary::HelloReply* response);
+    virtual ::grpc::Status SayHelloStream(::grpc::ServerContext* context, const ::GrpcLibrary::HelloRequest* request, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* writer);
+    virtual ::grpc::Status Chat(::grpc::ServerContext* context, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* stream);
   };
   template <class BaseClass>
   class WithAsyncMethod_SayHello : public BaseClass {
@@ -119,7 +175,47 @@ class GrpcService final {
       ::grpc::Service::RequestAsyncUnary(0, context, request, response, new_call_cq, notification_cq, tag);
     }
   };
-  typedef WithAsyncMethod_SayHello<Service > AsyncService;
+  template <class BaseClass>
+  class WithAsyncMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithAsyncMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodAsync(1);
+    }
+    ~WithAsyncMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestSayHelloStream(::grpc::ServerContext* context, ::GrpcLibrary::HelloRequest* request, ::grpc::ServerAsyncWriter< ::GrpcLibrary::HelloReply>* writer, ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void *tag) {
+      ::grpc::Service::RequestAsyncServerStreaming(1, context, request, writer, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
+  class WithAsyncMethod_Chat : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithAsyncMethod_Chat() {
+      ::grpc::Service::MarkMethodAsync(2);
+    }
+    ~WithAsyncMethod_Chat() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status Chat(::grpc::ServerContext* /*context*/, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* /*stream*/)  override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestChat(::grpc::ServerContext* context, ::grpc::ServerAsyncReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* stream, ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void *tag) {
+      ::grpc::Service::RequestAsyncBidiStreaming(2, context, stream, new_call_cq, notification_cq, tag);
+    }
+  };
+  typedef WithAsyncMethod_SayHello<WithAsyncMethod_SayHelloStream<WithAsyncMethod_Chat<Service > > > AsyncService;
   template <class BaseClass>
   class WithCallbackMethod_SayHello : public BaseClass {
    private:
@@ -147,7 +243,52 @@ class GrpcService final {
     virtual ::grpc::ServerUnaryReactor* SayHello(
       ::grpc::CallbackServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::GrpcLibrary::HelloReply* /*response*/)  { return nullptr; }
   };
-  typedef WithCallbackMethod_SayHello<Service > CallbackService;
+  template <class BaseClass>
+  class WithCallbackMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithCallbackMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodCallback(1,
+          new ::grpc::internal::CallbackServerStreamingHandler< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>(
+            [this](
+                   ::grpc::CallbackServerContext* context, const ::GrpcLibrary::HelloRequest* request) { return this->SayHelloStream(context, request); }));
+    }
+    ~WithCallbackMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerWriteReactor< ::GrpcLibrary::HelloReply>* SayHelloStream(
+      ::grpc::CallbackServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/)  { return nullptr; }
+  };
+  template <class BaseClass>
+  class WithCallbackMethod_Chat : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithCallbackMethod_Chat() {
+      ::grpc::Service::MarkMethodCallback(2,
+          new ::grpc::internal::CallbackBidiHandler< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>(
+            [this](
+                   ::grpc::CallbackServerContext* context) { return this->Chat(context); }));
+    }
+    ~WithCallbackMethod_Chat() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status Chat(::grpc::ServerContext* /*context*/, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* /*stream*/)  override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerBidiReactor< ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* Chat(
+      ::grpc::CallbackServerContext* /*context*/)
+      { return nullptr; }
+  };
+  typedef WithCallbackMethod_SayHello<WithCallbackMethod_SayHelloStream<WithCallbackMethod_Chat<Service > > > CallbackService;
   typedef CallbackService ExperimentalCallbackService;
   template <class BaseClass>
   class WithGenericMethod_SayHello : public BaseClass {
@@ -167,6 +308,40 @@ class GrpcService final {
     }
   };
   template <class BaseClass>
+  class WithGenericMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithGenericMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodGeneric(1);
+    }
+    ~WithGenericMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+  };
+  template <class BaseClass>
+  class WithGenericMethod_Chat : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithGenericMethod_Chat() {
+      ::grpc::Service::MarkMethodGeneric(2);
+    }
+    ~WithGenericMethod_Chat() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status Chat(::grpc::ServerContext* /*context*/, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* /*stream*/)  override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+  };
+  template <class BaseClass>
   class WithRawMethod_SayHello : public BaseClass {
    private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
@@ -187,6 +362,46 @@ class GrpcService final {
     }
   };
   template <class BaseClass>
+  class WithRawMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithRawMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodRaw(1);
+    }
+    ~WithRawMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestSayHelloStream(::grpc::ServerContext* context, ::grpc::ByteBuffer* request, ::grpc::ServerAsyncWriter< ::grpc::ByteBuffer>* writer, ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void *tag) {
+      ::grpc::Service::RequestAsyncServerStreaming(1, context, request, writer, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
+  class WithRawMethod_Chat : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithRawMethod_Chat() {
+      ::grpc::Service::MarkMethodRaw(2);
+    }
+    ~WithRawMethod_Chat() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status Chat(::grpc::ServerContext* /*context*/, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* /*stream*/)  override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestChat(::grpc::ServerContext* context, ::grpc::ServerAsyncReaderWriter< ::grpc::ByteBuffer, ::grpc::ByteBuffer>* stream, ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void *tag) {
+      ::grpc::Service::RequestAsyncBidiStreaming(2, context, stream, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
   class WithRawCallbackMethod_SayHello : public BaseClass {
    private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
@@ -209,6 +424,51 @@ class GrpcService final {
       ::grpc::CallbackServerContext* /*context*/, const ::grpc::ByteBuffer* /*request*/, ::grpc::ByteBuffer* /*response*/)  { return nullptr; }
   };
   template <class BaseClass>
+  class WithRawCallbackMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithRawCallbackMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodRawCallback(1,
+          new ::grpc::internal::CallbackServerStreamingHandler< ::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+            [this](
+                   ::grpc::CallbackServerContext* context, const::grpc::ByteBuffer* request) { return this->SayHelloStream(context, request); }));
+    }
+    ~WithRawCallbackMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerWriteReactor< ::grpc::ByteBuffer>* SayHelloStream(
+      ::grpc::CallbackServerContext* /*context*/, const ::grpc::ByteBuffer* /*request*/)  { return nullptr; }
+  };
+  template <class BaseClass>
+  class WithRawCallbackMethod_Chat : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithRawCallbackMethod_Chat() {
+      ::grpc::Service::MarkMethodRawCallback(2,
+          new ::grpc::internal::CallbackBidiHandler< ::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+            [this](
+                   ::grpc::CallbackServerContext* context) { return this->Chat(context); }));
+    }
+    ~WithRawCallbackMethod_Chat() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status Chat(::grpc::ServerContext* /*context*/, ::grpc::ServerReaderWriter< ::GrpcLibrary::HelloReply, ::GrpcLibrary::HelloRequest>* /*stream*/)  override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerBidiReactor< ::grpc::ByteBuffer, ::grpc::ByteBuffer>* Chat(
+      ::grpc::CallbackServerContext* /*context*/)
+      { return nullptr; }
+  };
+  template <class BaseClass>
   class WithStreamedUnaryMethod_SayHello : public BaseClass {
    private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
@@ -236,8 +496,35 @@ class GrpcService final {
     virtual ::grpc::Status StreamedSayHello(::grpc::ServerContext* context, ::grpc::ServerUnaryStreamer< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>* server_unary_streamer) = 0;
   };
   typedef WithStreamedUnaryMethod_SayHello<Service > StreamedUnaryService;
-  typedef Service SplitStreamedService;
-  typedef WithStreamedUnaryMethod_SayHello<Service > StreamedService;
+  template <class BaseClass>
+  class WithSplitStreamingMethod_SayHelloStream : public BaseClass {
+   private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {}
+   public:
+    WithSplitStreamingMethod_SayHelloStream() {
+      ::grpc::Service::MarkMethodStreamed(1,
+        new ::grpc::internal::SplitServerStreamingHandler<
+          ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>(
+            [this](::grpc::ServerContext* context,
+                   ::grpc::ServerSplitStreamer<
+                     ::GrpcLibrary::HelloRequest, ::GrpcLibrary::HelloReply>* streamer) {
+                       return this->StreamedSayHelloStream(context,
+                         streamer);
+                  }));
+    }
+    ~WithSplitStreamingMethod_SayHelloStream() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable regular version of this method
+    ::grpc::Status SayHelloStream(::grpc::ServerContext* /*context*/, const ::GrpcLibrary::HelloRequest* /*request*/, ::grpc::ServerWriter< ::GrpcLibrary::HelloReply>* /*writer*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    // replace default version of method with split streamed
+    virtual ::grpc::Status StreamedSayHelloStream(::grpc::ServerContext* context, ::grpc::ServerSplitStreamer< ::GrpcLibrary::HelloRequest,::GrpcLibrary::HelloReply>* server_split_streamer) = 0;
+  };
+  typedef WithSplitStreamingMethod_SayHelloStream<Service > SplitStreamedService;
+  typedef WithStreamedUnaryMethod_SayHello<WithSplitStreamingMethod_SayHelloStream<Service > > StreamedService;
 };
 
 }  // namespace GrpcLibrary
@@ -112,15 +112,19 @@ const char descriptor_table_protodef_tests_2fgrpc_2fgrpc_5ftest_2eproto[] ABSL_A
     protodesc_cold) = {
     "\n\032tests/grpc/grpc_test.proto\022\013GrpcLibrar"
     "y\"\034\n\014HelloRequest\022\014\n\004name\030\001 \001(\t\"\035\n\nHello"
-    "Reply\022\017\n\007message\030\001 \001(\t2O\n\013GrpcService\022@\n"
-    "\010SayHello\022\031.GrpcLibrary.HelloRequest\032\027.G"
-    "rpcLibrary.HelloReply\"\000b\006proto3"
+    "Reply\022\017\n\007message\030\001 \001(\t2\333\001\n\013GrpcService\022@"
+    "\n\010SayHello\022\031.GrpcLibrary.HelloRequest\032\027."
+    "GrpcLibrary.HelloReply\"\000\022H\n\016SayHelloStre"
+    "am\022\031.GrpcLibrary.HelloRequest\032\027.GrpcLibr"
+    "ary.HelloReply\"\0000\001\022@\n\004Chat\022\031.GrpcLibrary"
+    ".HelloRequest\032\027.GrpcLibrary.HelloReply\"\000"
+    "(\0010\001b\006proto3"
 };
 static ::absl::once_flag descriptor_table_tests_2fgrpc_2fgrpc_5ftest_2eproto_once;
 PROTOBUF_CONSTINIT const ::_pbi::DescriptorTable descriptor_table_tests_2fgrpc_2fgrpc_5ftest_2eproto = {
     false,
     false,
-    191,
+    332,
     descriptor_table_protodef_tests_2fgrpc_2fgrpc_5ftest_2eproto,
     "tests/grpc/grpc_test.proto",
     &descriptor_table_tests_2fgrpc_2fgrpc_5ftest_2eproto_once,
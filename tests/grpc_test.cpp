@@ -5,6 +5,8 @@
 #include <grpcpp/grpcpp.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <vector>
 #include "grpc/grpc_test.grpc.pb.h"
 
 using namespace GrpcLibrary;
@@ -47,4 +49,332 @@ TEST(grpc, say_hello_unary_call)
     server.stop();
 }
 
+static grpc::Status say_hello(const std::string &addr,
+                              const std::string &name,
+                              HelloReply        &reply)
+{
+    hj::grpc_channel channel;
+    channel.connect(addr);
+    auto         stub = GrpcService::NewStub(channel.get());
+    HelloRequest req;
+    req.set_name(name);
+    grpc::ClientContext ctx;
+    return stub->SayHello(&ctx, req, &reply);
+}
+
+TEST(grpc, async_server_unary)
+{
+    hj::grpc_async_server_options opts;
+    opts.cq_num       = 2;
+    opts.calls_per_cq = 2; // fewer call objects than clients: recycled
+    GrpcService::AsyncService svc; // outlives the server
+    hj::grpc_async_server     server{opts};
+    bool added = server.unary<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestSayHello,
+        [](grpc::ServerContext &, const HelloRequest &req, HelloReply &rep) {
+            if(req.name() == "throw")
+                throw std::runtime_error("boom");
+            rep.set_message("Hello, " + req.name());
+            return grpc::Status::OK;
+        });
+    ASSERT_TRUE(added);
+    ASSERT_TRUE(server.start("127.0.0.1:0", &svc));
+    ASSERT_GT(server.port(), 0);
+    EXPECT_FALSE(server.start("127.0.0.1:0", &svc));
+    std::string addr = "127.0.0.1:" + std::to_string(server.port());
+
+    std::atomic<int>         ok{0};
+    std::vector<std::thread> clients;
+    for(int t = 0; t < 8; ++t)
+        clients.emplace_back([&, t]() {
+            for(int i = 0; i < 50; ++i)
+            {
+                std::string name = std::to_string(t) + "-" + std::to_string(i);
+                HelloReply  reply;
+                if(say_hello(addr, name, reply).ok()
+                   && reply.message() == "Hello, " + name)
+                    ok++;
+            }
+        });
+    for(auto &c : clients)
+        c.join();
+    EXPECT_EQ(ok.load(), 400);
+
+    HelloReply reply;
+    auto       status = say_hello(addr, "throw", reply);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::INTERNAL);
+    EXPECT_EQ(status.error_message(), "boom");
+
+    server.stop();
+    EXPECT_FALSE(server.is_running());
+    EXPECT_FALSE(server.start("127.0.0.1:0", &svc));
+}
+
+class CallbackHelloImpl : public GrpcService::CallbackService
+{
+  public:
+    grpc::ServerUnaryReactor *SayHello(grpc::CallbackServerContext *ctx,
+                                       const HelloRequest          *req,
+                                       HelloReply *rep) override
+    {
+        rep->set_message("Hello, " + req->name());
+        auto *reactor = ctx->DefaultReactor();
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+};
+
+TEST(grpc, async_server_callback_mode)
+{
+    hj::grpc_async_server_options opts;
+    opts.callback = true;
+    CallbackHelloImpl         svc;
+    GrpcService::AsyncService unused;
+    hj::grpc_async_server     server{opts};
+    // queue-based methods do not mix with the callback API
+    bool added = server.unary<HelloRequest, HelloReply>(
+        &unused,
+        &GrpcService::AsyncService::RequestSayHello,
+        [](grpc::ServerContext &, const HelloRequest &, HelloReply &) {
+            return grpc::Status::OK;
+        });
+    EXPECT_FALSE(added);
+    ASSERT_TRUE(server.start("127.0.0.1:0", &svc));
+
+    HelloReply reply;
+    EXPECT_TRUE(
+        say_hello("127.0.0.1:" + std::to_string(server.port()), "cb", reply)
+            .ok());
+    EXPECT_EQ(reply.message(), "Hello, cb");
+}
+
+// bidi echo and a server stream of three replies per request
+static void add_stream_methods(hj::grpc_async_server     &server,
+                               GrpcService::AsyncService &svc)
+{
+    ASSERT_TRUE((server.server_stream<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestSayHelloStream,
+        [](grpc::ServerContext &,
+           const HelloRequest            *req,
+           hj::grpc_writer<HelloReply> &writer) {
+            for(int i = 0; i < 3; ++i)
+            {
+                HelloReply rep;
+                rep.set_message(req->name() + "-" + std::to_string(i));
+                writer.write(std::move(rep));
+            }
+            writer.finish(grpc::Status::OK);
+        })));
+    ASSERT_TRUE((server.bidi_stream<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestChat,
+        [](grpc::ServerContext &,
+           const HelloRequest            *req,
+           hj::grpc_writer<HelloReply> &writer) {
+            if(req == nullptr)
+            {
+                writer.finish(grpc::Status::OK);
+                return;
+            }
+            HelloReply rep;
+            rep.set_message("echo " + req->name());
+            writer.write(std::move(rep));
+        })));
+}
+
+TEST(grpc, async_server_stream_echo)
+{
+    hj::grpc_async_server_options opts;
+    opts.cq_num       = 1;
+    opts.calls_per_cq = 1; // every stream recycles the same call objects
+    GrpcService::AsyncService svc;
+    hj::grpc_async_server     server{opts};
+    add_stream_methods(server, svc);
+    ASSERT_TRUE(server.start("127.0.0.1:0", &svc));
+
+    hj::grpc_channel channel;
+    ASSERT_TRUE(
+        channel.connect("127.0.0.1:" + std::to_string(server.port())));
+    auto stub = GrpcService::NewStub(channel.get());
+    for(int round = 0; round < 3; ++round)
+    {
+        grpc::ClientContext ctx;
+        HelloRequest        req;
+        req.set_name("s" + std::to_string(round));
+        auto       reader = stub->SayHelloStream(&ctx, req);
+        HelloReply rep;
+        int        n = 0;
+        while(reader->Read(&rep))
+            EXPECT_EQ(rep.message(), req.name() + "-" + std::to_string(n++));
+        EXPECT_EQ(n, 3);
+        EXPECT_TRUE(reader->Finish().ok());
+
+        grpc::ClientContext chat_ctx;
+        auto                chat = stub->Chat(&chat_ctx);
+        for(int i = 0; i < 3; ++i)
+        {
+            req.set_name(std::to_string(i));
+            ASSERT_TRUE(chat->Write(req));
+            ASSERT_TRUE(chat->Read(&rep));
+            EXPECT_EQ(rep.message(), "echo " + std::to_string(i));
+        }
+        chat->WritesDone();
+        EXPECT_FALSE(chat->Read(&rep));
+        EXPECT_TRUE(chat->Finish().ok());
+    }
+    server.stop();
+}
+
+TEST(grpc, async_server_stream_cancel)
+{
+    hj::grpc_async_server_options opts;
+    opts.cq_num       = 1;
+    opts.calls_per_cq = 1;
+    GrpcService::AsyncService svc;
+    hj::grpc_async_server     server{opts};
+
+    // the handler hands its writer to a thread that writes until refused;
+    // after the client cancels, the call object serves the next stream
+    std::thread       feeder;
+    std::atomic<bool> refused{false};
+    ASSERT_TRUE((server.server_stream<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestSayHelloStream,
+        [&](grpc::ServerContext &,
+            const HelloRequest            *req,
+            hj::grpc_writer<HelloReply> &writer) {
+            if(req->name() != "feed")
+            {
+                HelloReply rep;
+                rep.set_message("fresh");
+                writer.write(std::move(rep));
+                writer.finish(grpc::Status::OK);
+                return;
+            }
+            feeder = std::thread([w = writer, &refused]() mutable {
+                HelloReply rep;
+                rep.set_message("stale");
+                while(w.write(rep))
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                refused = true;
+
+                // still refused once the object serves another call
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                EXPECT_FALSE(w.write(rep));
+                w.finish(grpc::Status::CANCELLED);
+            });
+        })));
+    ASSERT_TRUE(server.start("127.0.0.1:0", &svc));
+
+    hj::grpc_channel channel;
+    ASSERT_TRUE(
+        channel.connect("127.0.0.1:" + std::to_string(server.port())));
+    auto stub = GrpcService::NewStub(channel.get());
+    {
+        grpc::ClientContext ctx;
+        HelloRequest        req;
+        req.set_name("feed");
+        auto       reader = stub->SayHelloStream(&ctx, req);
+        HelloReply rep;
+        ASSERT_TRUE(reader->Read(&rep));
+        EXPECT_EQ(rep.message(), "stale");
+        ctx.TryCancel();
+        while(reader->Read(&rep))
+        {
+        }
+        EXPECT_EQ(reader->Finish().error_code(), grpc::StatusCode::CANCELLED);
+    }
+
+    for(int i = 0; i < 200 && !refused; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(refused);
+    for(int round = 0; round < 3; ++round)
+    {
+        grpc::ClientContext ctx;
+        HelloRequest        req;
+        req.set_name("next");
+        auto                    reader = stub->SayHelloStream(&ctx, req);
+        HelloReply              rep;
+        std::vector<std::string> got;
+        while(reader->Read(&rep))
+            got.push_back(rep.message());
+        EXPECT_TRUE(reader->Finish().ok());
+        EXPECT_EQ(got, std::vector<std::string>{"fresh"});
+    }
+
+    feeder.join();
+    server.stop();
+}
+
+TEST(grpc, async_server_stream_stop)
+{
+    hj::grpc_async_server_options opts;
+    opts.cq_num         = 2;
+    opts.calls_per_cq   = 2;
+    opts.shutdown_grace = std::chrono::milliseconds(100);
+    GrpcService::AsyncService svc;
+    hj::grpc_async_server     server{opts};
+
+    // streams that are never finished by their handlers
+    std::mutex                               mu;
+    std::vector<hj::grpc_writer<HelloReply>> held;
+    ASSERT_TRUE((server.bidi_stream<HelloRequest, HelloReply>(
+        &svc,
+        &GrpcService::AsyncService::RequestChat,
+        [&](grpc::ServerContext &,
+            const HelloRequest            *req,
+            hj::grpc_writer<HelloReply> &writer) {
+            if(req == nullptr)
+                return;
+            HelloReply rep;
+            rep.set_message("open");
+            writer.write(rep);
+            std::lock_guard<std::mutex> lock(mu);
+            held.push_back(writer);
+        })));
+    ASSERT_TRUE(server.start("127.0.0.1:0", &svc));
+
+    hj::grpc_channel channel;
+    ASSERT_TRUE(
+        channel.connect("127.0.0.1:" + std::to_string(server.port())));
+    auto stub = GrpcService::NewStub(channel.get());
+
+    const int                                 n = 3;
+    std::vector<std::unique_ptr<grpc::ClientContext>> ctxs;
+    std::vector<std::unique_ptr<
+        grpc::ClientReaderWriter<HelloRequest, HelloReply>>>
+        chats;
+    for(int i = 0; i < n; ++i)
+    {
+        ctxs.push_back(std::make_unique<grpc::ClientContext>());
+        chats.push_back(stub->Chat(ctxs.back().get()));
+        HelloRequest req;
+        req.set_name("hi");
+        ASSERT_TRUE(chats.back()->Write(req));
+        HelloReply rep;
+        ASSERT_TRUE(chats.back()->Read(&rep));
+        EXPECT_EQ(rep.message(), "open");
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    server.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin,
+              std::chrono::seconds(5));
+
+    // the call objects are gone, writers kept by handlers do nothing
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        ASSERT_EQ(held.size(), static_cast<std::size_t>(n));
+        for(auto &w : held)
+        {
+            EXPECT_FALSE(w.write(HelloReply()));
+            w.finish(grpc::Status::OK);
+        }
+    }
+    for(auto &chat : chats)
+        EXPECT_FALSE(chat->Finish().ok());
+}
+
 #endif // GRPC_ENABLE
\ No newline at end of file
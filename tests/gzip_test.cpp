@@ -6,6 +6,8 @@
 #include <vector>
 #include <random>
 #include <chrono>
+#include <cstdlib>
+#include <algorithm>
 
 class gzip : public ::testing::Test
 {
@@ -373,4 +375,270 @@ TEST_F(gzip, boundary_conditions)
                                                   compressed.size());
     EXPECT_EQ(decompress_result, hj::gzip::err::ok);
     EXPECT_EQ(decompressed.size(), 1);
-}
\ No newline at end of file
+}
+TEST_F(gzip, file_compression)
+{
+    {
+        std::ofstream out("test_input.txt", std::ios::binary);
+        for(int i = 0; i < 1000; ++i)
+            out << test_string << i << "\n";
+    }
+
+    EXPECT_EQ(hj::gzip::compress_file("test_output.gz", "test_input.txt"),
+              hj::gzip::err::ok);
+    EXPECT_EQ(
+        hj::gzip::decompress_file("test_decompressed.txt", "test_output.gz"),
+        hj::gzip::err::ok);
+
+    std::ifstream a("test_input.txt", std::ios::binary);
+    std::ifstream b("test_decompressed.txt", std::ios::binary);
+    std::string   src((std::istreambuf_iterator<char>(a)),
+                    std::istreambuf_iterator<char>());
+    std::string   dst((std::istreambuf_iterator<char>(b)),
+                    std::istreambuf_iterator<char>());
+    EXPECT_EQ(src, dst);
+
+    EXPECT_EQ(hj::gzip::compress_file("test_output.gz", "not_exist.txt"),
+              hj::gzip::err::read_buffer_error);
+}
+
+static std::vector<unsigned char> make_log(size_t sz)
+{
+    std::mt19937               gen(7);
+    std::vector<unsigned char> out;
+    out.reserve(sz + 64);
+    while(out.size() < sz)
+    {
+        std::string line = "2025-01-01 12:00:00 INFO request id="
+                           + std::to_string(gen() % 100000)
+                           + " status=200 latency_us="
+                           + std::to_string(gen() % 5000) + "\n";
+        out.insert(out.end(), line.begin(), line.end());
+    }
+    out.resize(sz);
+    return out;
+}
+
+TEST_F(gzip, parallel_compression)
+{
+    auto                       src = make_log(1000003);
+    std::vector<unsigned char> seq, par, back;
+    ASSERT_EQ(hj::gzip::compress(seq, src.data(), src.size()),
+              hj::gzip::err::ok);
+
+    hj::gzip::parallel_options opts;
+    opts.threads = 3;
+    for(size_t block : {size_t(1000), size_t(65536), size_t(1) << 20})
+    {
+        opts.block_size = block;
+        ASSERT_EQ(hj::gzip::compress_parallel(par,
+                                              src.data(),
+                                              src.size(),
+                                              hj::gzip::compression_lvl::
+                                                  default_compression,
+                                              hj::gzip::mem_lvl::default_level,
+                                              opts),
+                  hj::gzip::err::ok);
+
+        // one member, no extra field
+        ASSERT_TRUE(hj::gzip::is_gzip_format(par.data(), par.size()));
+        EXPECT_EQ(par[3], 0);
+        ASSERT_EQ(hj::gzip::decompress(back, par.data(), par.size()),
+                  hj::gzip::err::ok);
+        EXPECT_EQ(back, src);
+
+        // the previous block primes the next one
+        if(block >= 65536)
+        {
+            EXPECT_LT(par.size(), seq.size() * 102 / 100);
+        }
+    }
+
+    // streams give the same bytes
+    std::istringstream in(std::string(src.begin(), src.end()));
+    std::ostringstream out;
+    ASSERT_EQ(hj::gzip::compress_parallel(
+                  out,
+                  in,
+                  hj::gzip::compression_lvl::default_compression,
+                  hj::gzip::mem_lvl::default_level,
+                  opts),
+              hj::gzip::err::ok);
+    EXPECT_EQ(out.str(), std::string(par.begin(), par.end()));
+
+    // empty stream is one empty member
+    std::istringstream empty_in;
+    std::ostringstream empty_out;
+    ASSERT_EQ(hj::gzip::compress_parallel(empty_out, empty_in),
+              hj::gzip::err::ok);
+    std::string e = empty_out.str();
+    ASSERT_EQ(hj::gzip::decompress(back, e.data(), e.size()),
+              hj::gzip::err::ok);
+    EXPECT_TRUE(back.empty());
+
+    opts.block_size = 0;
+    EXPECT_EQ(hj::gzip::compress_parallel(par,
+                                          src.data(),
+                                          src.size(),
+                                          hj::gzip::compression_lvl::best_speed,
+                                          hj::gzip::mem_lvl::default_level,
+                                          opts),
+              hj::gzip::err::input_invalid);
+}
+
+TEST_F(gzip, parallel_indexed)
+{
+    auto                       src = make_log(700001);
+    std::vector<unsigned char> packed, back;
+    hj::thread_pool            pool(2);
+    hj::gzip::parallel_options opts;
+    opts.block_size = 65536;
+    opts.indexed    = true;
+    opts.pool       = &pool;
+    ASSERT_EQ(hj::gzip::compress_parallel(packed,
+                                          src.data(),
+                                          src.size(),
+                                          hj::gzip::compression_lvl::best_speed,
+                                          hj::gzip::mem_lvl::default_level,
+                                          opts),
+              hj::gzip::err::ok);
+    EXPECT_EQ(packed[3], 0x04);
+    EXPECT_EQ(packed[12], 'H');
+    EXPECT_EQ(packed[13], 'J');
+
+    ASSERT_EQ(hj::gzip::decompress_parallel(back,
+                                            packed.data(),
+                                            packed.size(),
+                                            0,
+                                            opts),
+              hj::gzip::err::ok);
+    EXPECT_EQ(back, src);
+
+    // members are plain gzip for the sequential path too
+    ASSERT_EQ(hj::gzip::decompress(back, packed.data(), packed.size()),
+              hj::gzip::err::ok);
+    EXPECT_EQ(back, src);
+
+    std::istringstream in(std::string(packed.begin(), packed.end()));
+    std::ostringstream out;
+    ASSERT_EQ(hj::gzip::decompress(out, in), hj::gzip::err::ok);
+    EXPECT_EQ(out.str(), std::string(src.begin(), src.end()));
+
+    EXPECT_EQ(hj::gzip::decompress_parallel(back,
+                                            packed.data(),
+                                            packed.size(),
+                                            src.size() - 1,
+                                            opts),
+              hj::gzip::err::max_output_sz_exceeded);
+
+    // a flipped bit in a later member fails its crc or inflate
+    auto bad = packed;
+    bad[bad.size() / 2] ^= 0x10;
+    EXPECT_NE(hj::gzip::decompress_parallel(back, bad.data(), bad.size()),
+              hj::gzip::err::ok);
+    EXPECT_TRUE(back.empty());
+
+    bad = packed;
+    bad.resize(bad.size() - 3);
+    EXPECT_EQ(hj::gzip::decompress_parallel(back, bad.data(), bad.size()),
+              hj::gzip::err::data_error);
+
+    // a member size past the end of the input is not allocated up front
+    bad     = packed;
+    bad[16] = bad[17] = bad[18] = 0xff;
+    bad[19]                     = 0x7f;
+    EXPECT_EQ(hj::gzip::decompress_parallel(back, bad.data(), bad.size()),
+              hj::gzip::err::data_error);
+
+    // the first block's trailer already exceeds a small limit
+    EXPECT_EQ(hj::gzip::decompress_parallel(back,
+                                            packed.data(),
+                                            packed.size(),
+                                            1000,
+                                            opts),
+              hj::gzip::err::max_output_sz_exceeded);
+}
+
+TEST_F(gzip, parallel_decompress_fallback)
+{
+    auto                       src = make_log(300000);
+    std::vector<unsigned char> seq, par, back;
+    ASSERT_EQ(hj::gzip::compress(seq, src.data(), src.size()),
+              hj::gzip::err::ok);
+    ASSERT_EQ(hj::gzip::decompress_parallel(back, seq.data(), seq.size()),
+              hj::gzip::err::ok);
+    EXPECT_EQ(back, src);
+
+    ASSERT_EQ(hj::gzip::compress_parallel(par, src.data(), src.size()),
+              hj::gzip::err::ok);
+    ASSERT_EQ(hj::gzip::decompress_parallel(back, par.data(), par.size()),
+              hj::gzip::err::ok);
+    EXPECT_EQ(back, src);
+
+    // indexed members followed by a plain member and trailing zeros
+    hj::gzip::parallel_options opts;
+    opts.block_size = 50000;
+    opts.indexed    = true;
+    ASSERT_EQ(hj::gzip::compress_parallel(
+                  par,
+                  src.data(),
+                  src.size(),
+                  hj::gzip::compression_lvl::default_compression,
+                  hj::gzip::mem_lvl::default_level,
+                  opts),
+              hj::gzip::err::ok);
+    par.insert(par.end(), seq.begin(), seq.end());
+    par.insert(par.end(), 4, 0);
+    ASSERT_EQ(hj::gzip::decompress_parallel(back, par.data(), par.size()),
+              hj::gzip::err::ok);
+    ASSERT_EQ(back.size(), 2 * src.size());
+    EXPECT_TRUE(std::equal(src.begin(), src.end(), back.begin()));
+    EXPECT_TRUE(std::equal(src.begin(), src.end(), back.begin() + src.size()));
+
+    std::vector<unsigned char> junk = {0x12, 0x34, 0x56, 0x78};
+    EXPECT_NE(hj::gzip::decompress_parallel(back, junk.data(), junk.size()),
+              hj::gzip::err::ok);
+}
+
+TEST_F(gzip, parallel_file_gunzip)
+{
+    auto src = make_log(500000);
+    {
+        std::ofstream out("test_input.txt", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(src.data()), src.size());
+    }
+
+    for(bool indexed : {false, true})
+    {
+        hj::gzip::parallel_options opts;
+        opts.block_size = 100000;
+        opts.indexed    = indexed;
+        ASSERT_EQ(hj::gzip::compress_file_parallel(
+                      "test_output.gz",
+                      "test_input.txt",
+                      hj::gzip::compression_lvl::default_compression,
+                      hj::gzip::mem_lvl::default_level,
+                      opts),
+                  hj::gzip::err::ok);
+        ASSERT_EQ(hj::gzip::decompress_file_parallel("test_decompressed.txt",
+                                                     "test_output.gz"),
+                  hj::gzip::err::ok);
+
+        std::ifstream a("test_decompressed.txt", std::ios::binary);
+        std::string   dst((std::istreambuf_iterator<char>(a)),
+                        std::istreambuf_iterator<char>());
+        EXPECT_EQ(dst, std::string(src.begin(), src.end()));
+
+#if !defined(_WIN32)
+        // the output must stay readable by the stock tool
+        if(std::system("gzip --version > /dev/null 2>&1") != 0)
+            continue;
+        const char *cmd = "gzip -dc test_output.gz > test_decompressed.txt";
+        ASSERT_EQ(std::system(cmd), 0);
+        std::ifstream b("test_decompressed.txt", std::ios::binary);
+        std::string   gz((std::istreambuf_iterator<char>(b)),
+                       std::istreambuf_iterator<char>());
+        EXPECT_EQ(gz, std::string(src.begin(), src.end()));
+#endif
+    }
+}
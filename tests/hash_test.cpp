@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <hj/algo/hash.hpp>
+#include <cstring>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST(hash, hash64_vectors)
+{
+    // wyhash final4 reference vectors, seed = index
+    const char *msgs[] = {
+        "",
+        "a",
+        "abc",
+        "message digest",
+        "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "1234567890123456789012345678901234567890123456789012345678901234"
+        "5678901234567890"};
+    const uint64_t want[] = {0x0409638ee2bde459ULL,
+                             0xa8412d091b5fe0a9ULL,
+                             0x32dd92e4b2915153ULL,
+                             0x8619124089a3a16bULL,
+                             0x7a43afb61d7f5f40ULL,
+                             0xff42329b90e50d58ULL,
+                             0xc39cab13b115aad3ULL};
+    for(int i = 0; i < 7; ++i)
+        EXPECT_EQ(hj::hash64(msgs[i], strlen(msgs[i]), i), want[i]) << i;
+
+    EXPECT_EQ(hj::hash64(std::string("abc"), 2), want[2]);
+    EXPECT_NE(hj::hash64("abc", 3, 0), hj::hash64("abc", 3, 1));
+
+    auto h = hj::hash128("abc", 3);
+    EXPECT_EQ(h.lo, hj::hash64("abc", 3));
+    EXPECT_NE(h.lo, h.hi);
+    EXPECT_NE(h, hj::hash128("abd", 3));
+}
+
+TEST(hash, streaming)
+{
+    std::vector<uint8_t> buf(1000);
+    for(size_t i = 0; i < buf.size(); ++i)
+        buf[i] = static_cast<uint8_t>(i * 97 + 13);
+
+    // every length through the short / 17..48 / striped paths, split at
+    // random points, must match the one shot hash
+    std::mt19937 rng(7);
+    for(size_t len = 0; len <= 300; ++len)
+    {
+        uint64_t want = hj::hash64(buf.data(), len, 42);
+        for(int round = 0; round < 4; ++round)
+        {
+            hj::hasher64 h(42);
+            size_t       pos = 0;
+            while(pos < len)
+            {
+                size_t n = std::min<size_t>(rng() % 70, len - pos);
+                h.update(buf.data() + pos, n);
+                pos += n;
+            }
+            ASSERT_EQ(h.finish(), want) << "len " << len;
+        }
+    }
+
+    hj::hasher64 h;
+    h.update(std::string("hello "));
+    h.update(std::string("world"));
+    EXPECT_EQ(h.finish(), hj::hash64(std::string("hello world")));
+    h.reset();
+    EXPECT_EQ(h.finish(), hj::hash64("", 0));
+}
+
+// SMHasher style avalanche: flipping any input bit must flip every output
+// bit with probability ~0.5
+template <typename F>
+static double worst_avalanche_bias(F f, size_t in_bytes, int samples)
+{
+    std::mt19937_64       rng(12345);
+    std::vector<uint8_t>  in(in_bytes);
+    std::vector<uint32_t> flips(in_bytes * 8 * 64, 0);
+    for(int s = 0; s < samples; ++s)
+    {
+        for(auto &b : in)
+            b = static_cast<uint8_t>(rng());
+        uint64_t base = f(in.data(), in.size());
+        for(size_t bit = 0; bit < in_bytes * 8; ++bit)
+        {
+            in[bit / 8] ^= uint8_t(1u << (bit % 8));
+            uint64_t d = base ^ f(in.data(), in.size());
+            in[bit / 8] ^= uint8_t(1u << (bit % 8));
+            for(int o = 0; o < 64; ++o)
+                flips[bit * 64 + o] += (d >> o) & 1;
+        }
+    }
+
+    double worst = 0;
+    for(auto n : flips)
+        worst = std::max(worst, std::abs(double(n) / samples - 0.5));
+    return worst;
+}
+
+TEST(hash, avalanche)
+{
+    const int samples = 3000;
+    auto      h64     = [](const uint8_t *p, size_t n) {
+        return hj::hash64(p, n);
+    };
+    for(size_t len : {4, 8, 16, 24, 64})
+        EXPECT_LT(worst_avalanche_bias(h64, len, samples), 0.05)
+            << "len " << len;
+
+    auto mix = [](const uint8_t *p, size_t) {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        return hj::hash_mix(x);
+    };
+    EXPECT_LT(worst_avalanche_bias(mix, 8, samples), 0.05);
+}
+
+TEST(hash, functor)
+{
+    hj::hash<int>         hi;
+    hj::hash<std::string> hs;
+    hj::hash<double>      hd;
+
+    EXPECT_EQ(hs("abc"), hj::hash64("abc", 3));
+    EXPECT_EQ(hs(std::string("abc")), hs(std::string_view("abc")));
+    EXPECT_EQ(hd(0.0), hd(-0.0));
+    EXPECT_NE(hd(1.0), hd(2.0));
+
+    // keys with a common stride still spread over buckets
+    std::set<size_t> buckets;
+    for(int i = 0; i < 1024; ++i)
+        buckets.insert(hi(i * 64) % 64);
+    EXPECT_EQ(buckets.size(), 64);
+
+    int x = 0, y = 0;
+    EXPECT_NE(hj::hash<int *>{}(&x), hj::hash<int *>{}(&y));
+    EXPECT_NE(hj::hash_combine(hi(1), hi(2)), hj::hash_combine(hi(2), hi(1)));
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <hj/testing/hdr_histogram.hpp>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+TEST(hdr_histogram, empty)
+{
+    hj::hdr_histogram h;
+    EXPECT_TRUE(h.empty());
+    EXPECT_EQ(h.count(), 0);
+    EXPECT_EQ(h.min(), 0);
+    EXPECT_EQ(h.max(), 0);
+    EXPECT_EQ(h.percentile(99.0), 0);
+    EXPECT_DOUBLE_EQ(h.mean(), 0.0);
+
+    EXPECT_THROW(hj::hdr_histogram(0, 100, 3), std::invalid_argument);
+    EXPECT_THROW(hj::hdr_histogram(1, 100, 6), std::invalid_argument);
+    EXPECT_THROW(hj::hdr_histogram(10, 15, 3), std::invalid_argument);
+}
+
+TEST(hdr_histogram, record_and_percentile)
+{
+    hj::hdr_histogram h{1, 3600LL * 1000 * 1000, 3};
+    for(int64_t v = 1; v <= 10000; ++v)
+        ASSERT_TRUE(h.record(v));
+
+    EXPECT_EQ(h.count(), 10000);
+    EXPECT_EQ(h.min(), 1);
+    EXPECT_EQ(h.max(), 10000);
+    EXPECT_NEAR(h.mean(), 5000.5, 0.001);
+
+    // 3 significant digits: within 0.1% of the exact value
+    EXPECT_NEAR(h.percentile(50.0), 5000, 5);
+    EXPECT_NEAR(h.percentile(99.0), 9900, 10);
+    EXPECT_NEAR(h.percentile(99.9), 9990, 10);
+    EXPECT_EQ(h.percentile(100.0), 10000);
+    EXPECT_EQ(h.percentile(0.0), 1);
+
+    // small values are exact
+    hj::hdr_histogram small;
+    small.record(3);
+    small.record(7, 3);
+    EXPECT_EQ(small.count(), 4);
+    EXPECT_EQ(small.percentile(25.0), 3);
+    EXPECT_EQ(small.percentile(50.0), 7);
+
+    EXPECT_FALSE(h.record(-1));
+    EXPECT_FALSE(h.record(3600LL * 1000 * 1000 + 1));
+    EXPECT_EQ(h.count(), 10000);
+}
+
+TEST(hdr_histogram, tail)
+{
+    hj::hdr_histogram h;
+    std::mt19937_64   rng{42};
+    for(int i = 0; i < 100000; ++i)
+        h.record(20000 + static_cast<int64_t>(rng() % 1000));
+    for(int i = 0; i < 100; ++i)
+        h.record(5000000);
+
+    EXPECT_LT(h.percentile(99.0), 21100);
+    EXPECT_EQ(h.percentile(99.95), 5000000);
+    EXPECT_EQ(h.max(), 5000000);
+}
+
+TEST(hdr_histogram, merge_and_reset)
+{
+    hj::hdr_histogram a, b;
+    for(int64_t v = 1; v <= 1000; ++v)
+        a.record(v);
+    for(int64_t v = 1001; v <= 2000; ++v)
+        b.record(v);
+
+    a.merge(b);
+    EXPECT_EQ(a.count(), 2000);
+    EXPECT_EQ(a.min(), 1);
+    EXPECT_EQ(a.max(), 2000);
+    EXPECT_NEAR(a.percentile(50.0), 1000, 1);
+
+    // different layout falls back to re-recording
+    hj::hdr_histogram c{1, 1000LL * 1000 * 1000, 2};
+    c.merge(a);
+    EXPECT_EQ(c.count(), 2000);
+    EXPECT_NEAR(c.percentile(50.0), 1000, 10);
+
+    a.reset();
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(a.max(), 0);
+    EXPECT_EQ(a.percentile(50.0), 0);
+}
+
+TEST(hdr_histogram, record_corrected)
+{
+    hj::hdr_histogram h;
+    for(int i = 0; i < 99; ++i)
+        h.record_corrected(100, 100);
+    EXPECT_EQ(h.count(), 99);
+
+    // a 1000 stall with 100 expected interval hides 9 more samples
+    h.record_corrected(1000, 100);
+    EXPECT_EQ(h.count(), 109);
+    EXPECT_EQ(h.max(), 1000);
+    EXPECT_GT(h.percentile(95.0), 100);
+}
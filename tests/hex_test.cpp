@@ -120,4 +120,91 @@ TEST(hex, is_valid)
         std::remove("tmp_odd_hex.txt");
         std::remove("tmp_empty_hex.txt");
     }
-}
\ No newline at end of file
+}
+
+TEST(hex, encode_to)
+{
+    unsigned char src[200];
+    for(int i = 0; i < 200; ++i)
+        src[i] = static_cast<unsigned char>(i * 37 + 11);
+
+    // lengths around the 16/32 byte kernel blocks and their tails
+    char buf[400];
+    for(std::size_t len = 0; len <= 200; ++len)
+    {
+        std::string want;
+        for(std::size_t i = 0; i < len; ++i)
+        {
+            want += "0123456789abcdef"[src[i] >> 4];
+            want += "0123456789abcdef"[src[i] & 0x0f];
+        }
+
+        std::size_t n = sizeof(buf);
+        ASSERT_TRUE(hj::hex::encode_to(buf, n, src, len, false));
+        ASSERT_EQ(std::string(buf, n), want) << "len " << len;
+    }
+
+    std::size_t n = 3;
+    EXPECT_FALSE(hj::hex::encode_to(buf, n, src, 2));
+    EXPECT_EQ(n, 4);
+    n = 4;
+    EXPECT_TRUE(hj::hex::encode_to(buf, n, src, 2, true));
+    EXPECT_EQ(std::string(buf, n), "0B30");
+
+    EXPECT_EQ(hj::hex::encode(std::string("\x01\xab", 2), false), "01ab");
+    EXPECT_EQ(hj::hex::encode(std::vector<unsigned char>{0xde, 0xad}),
+              "DEAD");
+}
+
+TEST(hex, decode_to)
+{
+    unsigned char src[150];
+    for(int i = 0; i < 150; ++i)
+        src[i] = static_cast<unsigned char>(i * 53 + 7);
+
+    char          hex[300];
+    unsigned char out[150];
+    for(std::size_t len = 0; len <= 150; ++len)
+    {
+        std::size_t n = sizeof(hex);
+        hj::hex::encode_to(hex, n, src, len, len % 2 == 0);
+
+        std::size_t m = sizeof(out);
+        ASSERT_TRUE(hj::hex::decode_to(out, m, hex, n)) << "len " << len;
+        ASSERT_EQ(m, len);
+        ASSERT_EQ(memcmp(out, src, len), 0) << "len " << len;
+    }
+
+    // a bad char is reported where it is, inside a kernel block or not
+    std::size_t n = sizeof(hex);
+    hj::hex::encode_to(hex, n, src, 150);
+    for(std::size_t pos : {0, 1, 31, 33, 64, 127, 250, 299})
+    {
+        std::string bad(hex, n);
+        bad[pos]        = 'g';
+        std::size_t m   = sizeof(out);
+        std::size_t err = 0;
+        ASSERT_FALSE(hj::hex::decode_to(out, m, bad.data(), bad.size(), &err));
+        EXPECT_EQ(err, pos);
+    }
+
+    std::size_t m   = sizeof(out);
+    std::size_t err = 0;
+    EXPECT_FALSE(hj::hex::decode_to(out, m, "abc", 3, &err));
+    EXPECT_EQ(err, 3);
+    EXPECT_FALSE(hj::hex::decode_to(out, m, "ab ", 3, &err));
+    EXPECT_EQ(err, 2);
+
+    m = 1;
+    EXPECT_FALSE(hj::hex::decode_to(out, m, "aBCd", 4));
+    EXPECT_EQ(m, 2);
+    m = 2;
+    EXPECT_TRUE(hj::hex::decode_to(out, m, "aBCd", 4));
+    EXPECT_EQ(out[0], 0xab);
+    EXPECT_EQ(out[1], 0xcd);
+
+    // decode() still skips junk and pads odd input
+    EXPECT_EQ(hj::hex::decode(std::string("ab:cd")), "\xab\xcd");
+    EXPECT_EQ(hj::hex::decode<std::vector<unsigned char>>(std::string("abc")),
+              (std::vector<unsigned char>{0x0a, 0xbc}));
+}
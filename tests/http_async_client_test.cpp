@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include <hj/net/http/http_async_client.hpp>
+#include <hj/net/http/http_async_server.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using hj::http_async_client;
+using hj::http_async_server;
+
+// local server on an ephemeral port, plus an io thread for the client
+struct client_fixture
+{
+    explicit client_fixture(http_async_server &srv)
+        : srv{srv}
+        , guard{boost::asio::make_work_guard(io)}
+    {
+        port = srv.bind_to_any_port("127.0.0.1");
+        th   = std::thread([this]() { this->srv.listen_after_bind(); });
+        srv.wait_until_ready();
+        io_th = std::thread([this]() { io.run(); });
+    }
+    ~client_fixture()
+    {
+        guard.reset();
+        io_th.join();
+        srv.stop();
+        th.join();
+    }
+
+    std::string url(const std::string &target) const
+    {
+        return "http://127.0.0.1:" + std::to_string(port) + target;
+    }
+
+    http_async_server      &srv;
+    boost::asio::io_context io;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+                guard;
+    int         port;
+    std::thread th;
+    std::thread io_th;
+};
+
+TEST(http_async_client, get_post_future)
+{
+    http_async_server srv{1};
+    srv.Get("/hello", [](const auto &req, auto &res) {
+        res.set_content("hello " + req.get_param_value("who"), "text/plain");
+    });
+    srv.Post("/echo", [](const auto &req, auto &res) {
+        res.set_content(req.body, req.get_header_value("Content-Type"));
+    });
+    client_fixture    fx{srv};
+    http_async_client cli{fx.io};
+
+    auto res = cli.get(fx.url("/hello?who=bob")).get();
+    EXPECT_EQ(res.result_int(), 200);
+    EXPECT_EQ(res.body(), "hello bob");
+
+    res = cli.post(fx.url("/echo"), "payload", "text/plain").get();
+    EXPECT_EQ(res.body(), "payload");
+    EXPECT_EQ(res[boost::beast::http::field::content_type], "text/plain");
+
+    EXPECT_EQ(cli.get(fx.url("/missing")).get().result_int(), 404);
+    EXPECT_THROW(cli.get("https://127.0.0.1/").get(),
+                 boost::system::system_error);
+}
+
+TEST(http_async_client, keep_alive_reuse)
+{
+    http_async_server srv{1};
+    srv.set_keep_alive_max_count(0);
+    srv.Get("/", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    client_fixture    fx{srv};
+    http_async_client cli{fx.io};
+
+    for(int i = 0; i < 50; ++i)
+        EXPECT_EQ(cli.get(fx.url("/")).get().body(), "ok");
+    EXPECT_EQ(cli.connections_opened(), 1);
+}
+
+TEST(http_async_client, server_closes_connection)
+{
+    http_async_server srv{1};
+    srv.set_keep_alive_max_count(3);
+    srv.Get("/", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    client_fixture    fx{srv};
+    http_async_client cli{fx.io};
+
+    for(int i = 0; i < 9; ++i)
+        EXPECT_EQ(cli.get(fx.url("/")).get().body(), "ok");
+    EXPECT_EQ(cli.connections_opened(), 3);
+}
+
+TEST(http_async_client, concurrency_limit)
+{
+    http_async_server srv{2, 4};
+    srv.set_keep_alive_max_count(0);
+    srv.Get("/slow", [](const auto &, auto &res) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        res.set_content("ok", "text/plain");
+    });
+    client_fixture                fx{srv};
+    hj::http_async_client_options opts;
+    opts.max_conns_per_host = 3;
+    http_async_client cli{fx.io, opts};
+
+    std::vector<std::future<http_async_client::response_t>> futs;
+    for(int i = 0; i < 60; ++i)
+        futs.push_back(cli.get(fx.url("/slow")));
+    for(auto &f : futs)
+        EXPECT_EQ(f.get().body(), "ok");
+    EXPECT_LE(cli.connections_opened(), 3);
+}
+
+TEST(http_async_client, pipelining)
+{
+    http_async_server srv{1};
+    srv.set_keep_alive_max_count(0);
+    srv.Get("/n/:i", [](const auto &req, auto &res) {
+        res.set_content(req.path_params.at("i"), "text/plain");
+    });
+    client_fixture                fx{srv};
+    hj::http_async_client_options opts;
+    opts.max_conns_per_host = 1;
+    opts.pipeline_depth     = 8;
+    http_async_client cli{fx.io, opts};
+
+    // first response proves the server keeps alive, then pipeline
+    EXPECT_EQ(cli.get(fx.url("/n/x")).get().body(), "x");
+
+    std::atomic<int>   done{0};
+    std::vector<int>   order;
+    std::promise<void> all;
+    for(int i = 0; i < 100; ++i)
+        cli.async_get(fx.url("/n/" + std::to_string(i)),
+                      [&, i](const auto &ec, auto res) {
+                          EXPECT_FALSE(ec);
+                          EXPECT_EQ(res.body(), std::to_string(i));
+                          order.push_back(i); // handlers run on the strand
+                          if(++done == 100)
+                              all.set_value();
+                      });
+    all.get_future().wait();
+    EXPECT_EQ(cli.connections_opened(), 1);
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST(http_async_client, gzip_decode)
+{
+    std::string plain(10000, 'a');
+    for(std::size_t i = 0; i < plain.size(); i += 7)
+        plain[i] = static_cast<char>('a' + i % 26);
+
+    http_async_server srv{1};
+    srv.Get("/gz", [&plain](const auto &req, auto &res) {
+        EXPECT_EQ(req.get_header_value("Accept-Encoding"), "gzip");
+        std::vector<unsigned char> out;
+        hj::gzip::compress(out, plain.data(), plain.size());
+        res.set_content(reinterpret_cast<const char *>(out.data()),
+                        out.size(),
+                        "text/plain");
+        res.set_header("Content-Encoding", "gzip");
+    });
+    client_fixture fx{srv};
+
+    http_async_client cli{fx.io};
+    auto              res = cli.get(fx.url("/gz")).get();
+    EXPECT_EQ(res.body(), plain);
+    EXPECT_EQ(res.find(boost::beast::http::field::content_encoding),
+              res.end());
+
+    hj::http_async_client_options opts;
+    opts.decompress = false;
+    http_async_client raw{fx.io, opts};
+    http_async_client::request_t req;
+    req.method(boost::beast::http::verb::get);
+    req.set(boost::beast::http::field::accept_encoding, "gzip");
+    res = raw.request(fx.url("/gz"), std::move(req)).get();
+    EXPECT_TRUE(hj::gzip::is_gzip_format(res.body().data(), res.body().size()));
+}
+
+TEST(http_async_client, errors)
+{
+    boost::asio::io_context io;
+    auto                    guard = boost::asio::make_work_guard(io);
+    std::thread             th([&io]() { io.run(); });
+    {
+        hj::http_async_client_options opts;
+        opts.connect_timeout = std::chrono::milliseconds(500);
+        http_async_client cli{io, opts};
+        // nothing listens on port 1
+        EXPECT_THROW(cli.get("http://127.0.0.1:1/").get(),
+                     boost::system::system_error);
+        EXPECT_THROW(cli.get("http://:80/").get(),
+                     boost::system::system_error);
+    }
+    guard.reset();
+    th.join();
+}
+
+TEST(http_async_client, request_timeout)
+{
+    http_async_server srv{1, 2};
+    srv.Get("/hang", [](const auto &, auto &res) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        res.set_content("late", "text/plain");
+    });
+    client_fixture                fx{srv};
+    hj::http_async_client_options opts;
+    opts.request_timeout = std::chrono::milliseconds(50);
+    http_async_client cli{fx.io, opts};
+
+    try
+    {
+        cli.get(fx.url("/hang")).get();
+        FAIL();
+    }
+    catch(const boost::system::system_error &e)
+    {
+        EXPECT_EQ(e.code(), boost::asio::error::timed_out);
+    }
+}
+
+TEST(http_async_client, pipelined_request_timeout)
+{
+    http_async_server srv{1, 2};
+    srv.set_keep_alive_max_count(0);
+    srv.Get("/ok", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    srv.Get("/hang", [](const auto &, auto &res) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        res.set_content("late", "text/plain");
+    });
+    client_fixture                fx{srv};
+    hj::http_async_client_options opts;
+    opts.max_conns_per_host = 1;
+    opts.pipeline_depth     = 4;
+    opts.request_timeout    = std::chrono::milliseconds(100);
+    http_async_client cli{fx.io, opts};
+    EXPECT_EQ(cli.get(fx.url("/ok")).get().body(), "ok");
+
+    // the second write must not disarm the deadline of the first read
+    auto start = std::chrono::steady_clock::now();
+    auto a     = cli.get(fx.url("/hang"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    auto b = cli.get(fx.url("/hang"));
+    for(auto *f : {&a, &b})
+    {
+        try
+        {
+            f->get();
+            FAIL();
+        }
+        catch(const boost::system::system_error &e)
+        {
+            EXPECT_EQ(e.code(), boost::asio::error::timed_out);
+        }
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(900));
+}
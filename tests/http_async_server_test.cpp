@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include <hj/net/http/http_async_server.hpp>
+#include <boost/asio.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using hj::http_async_server;
+
+// minimal blocking client: writes raw bytes, reads until n responses arrived
+static std::string http_roundtrip(int                port,
+                                  const std::string &raw,
+                                  std::size_t        nresp = 1)
+{
+    boost::asio::io_context      io;
+    boost::asio::ip::tcp::socket sock{io};
+    sock.connect({boost::asio::ip::make_address("127.0.0.1"),
+                  static_cast<unsigned short>(port)});
+    boost::asio::write(sock, boost::asio::buffer(raw));
+
+    boost::beast::flat_buffer buf;
+    std::string               out;
+    for(std::size_t i = 0; i < nresp; ++i)
+    {
+        boost::beast::http::response<boost::beast::http::string_body> res;
+        boost::system::error_code                                      ec;
+        boost::beast::http::read(sock, buf, res, ec);
+        if(ec)
+            break;
+        out += std::to_string(res.result_int()) + ":" + res.body() + "\n";
+    }
+    return out;
+}
+
+struct running_server
+{
+    explicit running_server(http_async_server &srv)
+        : srv{srv}
+    {
+        port = srv.bind_to_any_port("127.0.0.1");
+        th   = std::thread([this]() { this->srv.listen_after_bind(); });
+        srv.wait_until_ready();
+    }
+    ~running_server()
+    {
+        srv.stop();
+        th.join();
+    }
+
+    http_async_server &srv;
+    int                port;
+    std::thread        th;
+};
+
+TEST(http_async_server, radix_router)
+{
+    hj::http_radix_router<int> r;
+    EXPECT_TRUE(r.add("GET", "/", 1));
+    EXPECT_TRUE(r.add("GET", "/users", 2));
+    EXPECT_TRUE(r.add("GET", "/users/:id", 3));
+    EXPECT_TRUE(r.add("GET", "/users/:id/posts", 4));
+    EXPECT_TRUE(r.add("GET", "/users/me", 5));
+    EXPECT_TRUE(r.add("GET", "/user", 6));
+    EXPECT_TRUE(r.add("GET", "/static/*path", 7));
+    EXPECT_TRUE(r.add("POST", "/users/:id", 8));
+    EXPECT_FALSE(r.add("GET", "/users/:uid/x", 9)); // conflicting capture
+    EXPECT_FALSE(r.add("GET", "nope", 9));
+    EXPECT_EQ(r.size(), 8);
+
+    hj::http_radix_router<int>::params_t params;
+    auto find = [&](const char *method, const char *path) {
+        params.clear();
+        const int *v = r.find(method, path, params);
+        return v ? *v : 0;
+    };
+    EXPECT_EQ(find("GET", "/"), 1);
+    EXPECT_EQ(find("GET", "/users"), 2);
+    EXPECT_EQ(find("GET", "/user"), 6);
+    EXPECT_EQ(find("GET", "/users/me"), 5);
+    EXPECT_EQ(find("GET", "/users/42"), 3);
+    EXPECT_EQ(params["id"], "42");
+    EXPECT_EQ(find("GET", "/users/meh"), 3);
+    EXPECT_EQ(params["id"], "meh");
+    EXPECT_EQ(find("GET", "/users/7/posts"), 4);
+    EXPECT_EQ(params["id"], "7");
+    EXPECT_EQ(find("POST", "/users/7"), 8);
+    EXPECT_EQ(find("GET", "/static/css/a.css"), 7);
+    EXPECT_EQ(params["path"], "css/a.css");
+    EXPECT_EQ(find("GET", "/users/"), 0);
+    EXPECT_EQ(find("GET", "/usersx"), 0);
+    EXPECT_EQ(find("DELETE", "/users"), 0);
+}
+
+TEST(http_async_server, get_post_and_params)
+{
+    http_async_server srv{2};
+    srv.Get("/hello/:name", [](const auto &req, auto &res) {
+        res.set_content("hi " + req.path_params.at("name") + " "
+                            + req.get_param_value("q"),
+                        "text/plain");
+    });
+    srv.Post("/echo", [](const auto &req, auto &res) {
+        res.set_content(req.body, req.get_header_value("Content-Type"));
+    });
+    srv.Get("/throw", [](const auto &, auto &) {
+        throw std::runtime_error("boom");
+    });
+    running_server run{srv};
+    ASSERT_GT(run.port, 0);
+
+    EXPECT_EQ(http_roundtrip(run.port,
+                             "GET /hello/bob?q=a%20b HTTP/1.1\r\n"
+                             "Host: x\r\nConnection: close\r\n\r\n"),
+              "200:hi bob a b\n");
+    EXPECT_EQ(http_roundtrip(run.port,
+                             "POST /echo HTTP/1.1\r\nHost: x\r\n"
+                             "Content-Type: text/plain\r\n"
+                             "Content-Length: 5\r\nConnection: close\r\n\r\n"
+                             "hello"),
+              "200:hello\n");
+    EXPECT_EQ(http_roundtrip(run.port,
+                             "GET /missing HTTP/1.1\r\nHost: x\r\n"
+                             "Connection: close\r\n\r\n"),
+              "404:\n");
+    EXPECT_EQ(http_roundtrip(run.port,
+                             "GET /throw HTTP/1.1\r\nHost: x\r\n"
+                             "Connection: close\r\n\r\n"),
+              "500:\n");
+}
+
+TEST(http_async_server, keep_alive_pipelining)
+{
+    for(std::size_t handler_threads : {0, 4})
+    {
+        http_async_server srv{2, handler_threads};
+        srv.set_keep_alive_max_count(0);
+        srv.Get("/n/:i", [](const auto &req, auto &res) {
+            res.set_content(req.path_params.at("i"), "text/plain");
+        });
+        srv.set_error_handler([](const auto &, auto &res) {
+            res.set_content("custom", "text/plain");
+        });
+        running_server run{srv};
+
+        // pipeline a burst of requests in one write, all on one connection
+        std::string raw, expect;
+        for(int i = 0; i < 200; ++i)
+        {
+            raw += "GET /n/" + std::to_string(i)
+                   + " HTTP/1.1\r\nHost: x\r\n\r\n";
+            expect += "200:" + std::to_string(i) + "\n";
+        }
+        raw += "GET /none HTTP/1.1\r\nHost: x\r\n\r\n";
+        expect += "404:custom\n";
+        EXPECT_EQ(http_roundtrip(run.port, raw, 201), expect);
+    }
+}
+
+TEST(http_async_server, keep_alive_max_count)
+{
+    http_async_server srv{1};
+    srv.set_keep_alive_max_count(2);
+    srv.Get("/", [](const auto &, auto &res) {
+        res.set_content("x", "text/plain");
+    });
+    running_server run{srv};
+
+    std::string raw;
+    for(int i = 0; i < 3; ++i)
+        raw += "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+    // the second response closes the connection
+    EXPECT_EQ(http_roundtrip(run.port, raw, 3), "200:x\n200:x\n");
+}
+
+TEST(http_async_server, streaming_response)
+{
+    for(std::size_t handler_threads : {0, 2})
+    {
+        http_async_server srv{1, handler_threads};
+        srv.Get("/chunked", [](const auto &, auto &res) {
+            res.set_chunked_content_provider(
+                "text/plain",
+                [](std::size_t offset, http_async_server::data_sink &sink) {
+                    if(offset >= 30)
+                    {
+                        sink.done();
+                        return true;
+                    }
+                    sink.write("0123456789", 10);
+                    return true;
+                });
+        });
+        srv.Get("/sized", [](const auto &, auto &res) {
+            res.set_content_provider(
+                8,
+                "text/plain",
+                [](std::size_t offset,
+                   std::size_t len,
+                   http_async_server::data_sink &sink) {
+                    EXPECT_EQ(offset + len, 8);
+                    sink.write("abcd", 4);
+                    return true;
+                });
+        });
+        running_server run{srv};
+
+        EXPECT_EQ(http_roundtrip(run.port,
+                                 "GET /chunked HTTP/1.1\r\nHost: x\r\n\r\n"
+                                 "GET /sized HTTP/1.1\r\nHost: x\r\n\r\n",
+                                 2),
+                  "200:012345678901234567890123456789\n200:abcdabcd\n");
+    }
+}
+
+TEST(http_async_server, streaming_request)
+{
+    for(std::size_t handler_threads : {0, 2})
+    {
+        http_async_server srv{1, handler_threads};
+        srv.Post("/upload",
+                 [](const auto &,
+                    auto                                        &res,
+                    const http_async_server::content_reader_t &reader) {
+                     std::size_t total = 0, chunks = 0;
+                     reader([&](const char *, std::size_t len) {
+                         total += len;
+                         chunks++;
+                         return true;
+                     });
+                     res.set_content(std::to_string(total), "text/plain");
+                 });
+        running_server run{srv};
+
+        std::string body(200000, 'z');
+        EXPECT_EQ(http_roundtrip(run.port,
+                                 "POST /upload HTTP/1.1\r\nHost: x\r\n"
+                                 "Content-Length: 200000\r\n\r\n"
+                                     + body
+                                     + "POST /upload HTTP/1.1\r\nHost: x\r\n"
+                                       "Transfer-Encoding: chunked\r\n\r\n"
+                                       "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+                                 2),
+                  "200:200000\n200:5\n");
+    }
+}
+
+TEST(http_async_server, payload_limit)
+{
+    http_async_server srv{1};
+    srv.set_payload_max_length(16);
+    srv.Post("/", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    running_server run{srv};
+
+    EXPECT_EQ(http_roundtrip(run.port,
+                             "POST / HTTP/1.1\r\nHost: x\r\n"
+                             "Content-Length: 64\r\n\r\n"
+                                 + std::string(64, 'a')),
+              "413:\n");
+}
+
+TEST(http_async_server, many_connections)
+{
+    http_async_server srv{4, 4};
+    srv.Get("/", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    running_server run{srv};
+
+    std::vector<std::thread> clients;
+    std::atomic<int>         ok{0};
+    for(int t = 0; t < 8; ++t)
+        clients.emplace_back([&]() {
+            for(int i = 0; i < 20; ++i)
+                if(http_roundtrip(run.port,
+                                  "GET / HTTP/1.1\r\nHost: x\r\n\r\n"
+                                  "GET / HTTP/1.1\r\nHost: x\r\n\r\n",
+                                  2)
+                   == "200:ok\n200:ok\n")
+                    ok++;
+        });
+    for(auto &c : clients)
+        c.join();
+    EXPECT_EQ(ok.load(), 160);
+}
+
+TEST(http_async_server, restart)
+{
+    http_async_server srv{2};
+    srv.Get("/", [](const auto &, auto &res) {
+        res.set_content("ok", "text/plain");
+    });
+    for(int i = 0; i < 2; ++i)
+    {
+        running_server run{srv};
+        EXPECT_EQ(http_roundtrip(run.port,
+                                 "GET / HTTP/1.0\r\n\r\n"),
+                  "200:ok\n");
+    }
+    EXPECT_FALSE(srv.is_running());
+}
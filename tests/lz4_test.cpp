@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include <hj/compress/lz4.hpp>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <thread>
+
+class lz4 : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        test_string = "Hello, World! This is a test string for hj::lz4 "
+                      "compression and decompression.";
+        test_data =
+            std::vector<unsigned char>(test_string.begin(), test_string.end());
+
+        for(int i = 0; i < 5000; ++i)
+        {
+            std::string line = "{\"id\":" + std::to_string(i)
+                               + ",\"side\":\"buy\",\"px\":"
+                               + std::to_string(100 + i % 7) + "}\n";
+            text_data.insert(text_data.end(), line.begin(), line.end());
+        }
+
+        std::mt19937                    gen(42);
+        std::uniform_int_distribution<> dis(0, 255);
+        random_data.resize(50000);
+        for(size_t i = 0; i < random_data.size(); ++i)
+            random_data[i] = static_cast<unsigned char>(dis(gen));
+    }
+
+    void TearDown() override
+    {
+        std::remove("lz4_test_input.txt");
+        std::remove("lz4_test_output.lz4");
+        std::remove("lz4_test_decompressed.txt");
+    }
+
+    static std::vector<unsigned char>
+    roundtrip(const std::vector<unsigned char> &src,
+              const hj::lz4::compression_lvl    lvl =
+                  hj::lz4::compression_lvl::default_compression)
+    {
+        std::vector<unsigned char> compressed, decompressed;
+        EXPECT_EQ(
+            hj::lz4::compress(compressed, src.data(), src.size(), lvl),
+            hj::lz4::err::ok);
+        EXPECT_EQ(hj::lz4::decompress(decompressed,
+                                      compressed.data(),
+                                      compressed.size()),
+                  hj::lz4::err::ok);
+        return decompressed;
+    }
+
+    std::string                test_string;
+    std::vector<unsigned char> test_data;
+    std::vector<unsigned char> text_data;
+    std::vector<unsigned char> random_data;
+};
+
+TEST_F(lz4, basic_compression_decompression)
+{
+    std::vector<unsigned char> compressed;
+    EXPECT_EQ(
+        hj::lz4::compress(compressed, test_data.data(), test_data.size()),
+        hj::lz4::err::ok);
+    EXPECT_TRUE(hj::lz4::is_lz4_format(compressed.data(), compressed.size()));
+    EXPECT_LE(compressed.size(),
+              hj::lz4::compress_reserve_sz(test_data.size()));
+    EXPECT_EQ(roundtrip(test_data), test_data);
+    EXPECT_EQ(roundtrip(random_data), random_data);
+
+    unsigned char single_byte = 0x42;
+    EXPECT_EQ(roundtrip({single_byte}).size(), 1);
+}
+
+TEST_F(lz4, empty_data_handling)
+{
+    std::vector<unsigned char> out;
+    unsigned char              dummy = 0;
+    EXPECT_EQ(hj::lz4::compress(out, nullptr, 0),
+              hj::lz4::err::input_invalid);
+    EXPECT_EQ(hj::lz4::compress(out, &dummy, 0), hj::lz4::err::input_invalid);
+    EXPECT_EQ(hj::lz4::decompress(out, nullptr, 0),
+              hj::lz4::err::input_invalid);
+}
+
+TEST_F(lz4, compression_levels)
+{
+    std::vector<unsigned char> fast, best;
+    ASSERT_EQ(hj::lz4::compress(fast,
+                                text_data.data(),
+                                text_data.size(),
+                                hj::lz4::compression_lvl::best_speed),
+              hj::lz4::err::ok);
+    ASSERT_EQ(hj::lz4::compress(best,
+                                text_data.data(),
+                                text_data.size(),
+                                hj::lz4::compression_lvl::best_compression),
+              hj::lz4::err::ok);
+    EXPECT_LT(best.size(), fast.size());
+    EXPECT_LT(best.size(), text_data.size() / 4);
+    EXPECT_EQ(roundtrip(text_data, hj::lz4::compression_lvl::best_speed),
+              text_data);
+    EXPECT_EQ(roundtrip(text_data, hj::lz4::compression_lvl::best_compression),
+              text_data);
+}
+
+TEST_F(lz4, corrupt_and_truncated)
+{
+    std::vector<unsigned char> compressed, out;
+    ASSERT_EQ(
+        hj::lz4::compress(compressed, text_data.data(), text_data.size()),
+        hj::lz4::err::ok);
+
+    EXPECT_EQ(
+        hj::lz4::decompress(out, compressed.data(), compressed.size() / 2),
+        hj::lz4::err::data_error);
+    EXPECT_TRUE(out.empty());
+
+    // the content checksum catches a flipped payload byte
+    compressed[compressed.size() / 2] ^= 0x55;
+    EXPECT_NE(hj::lz4::decompress(out, compressed.data(), compressed.size()),
+              hj::lz4::err::ok);
+
+    EXPECT_EQ(hj::lz4::decompress(out, test_data.data(), test_data.size()),
+              hj::lz4::err::data_error);
+}
+
+TEST_F(lz4, forged_content_size)
+{
+    // a valid frame whose header declares 1 TiB but holds 5 bytes
+    LZ4F_preferences_t prefs;
+    std::memset(&prefs, 0, sizeof(prefs));
+    prefs.frameInfo.contentSize = 1ULL << 40;
+
+    LZ4F_cctx *cctx = nullptr;
+    ASSERT_FALSE(LZ4F_isError(LZ4F_createCompressionContext(&cctx,
+                                                            LZ4F_VERSION)));
+    std::vector<unsigned char> frame(LZ4F_compressBound(5, &prefs)
+                                     + LZ4F_HEADER_SIZE_MAX + 4);
+    size_t n = LZ4F_compressBegin(cctx, frame.data(), frame.size(), &prefs);
+    ASSERT_FALSE(LZ4F_isError(n));
+    size_t m = LZ4F_compressUpdate(
+        cctx, frame.data() + n, frame.size() - n, "hello", 5, nullptr);
+    ASSERT_FALSE(LZ4F_isError(m));
+    n += m;
+    m = LZ4F_flush(cctx, frame.data() + n, frame.size() - n, nullptr);
+    ASSERT_FALSE(LZ4F_isError(m));
+    n += m;
+    LZ4F_freeCompressionContext(cctx);
+    frame.resize(n);
+    frame.insert(frame.end(), 4, 0); // end mark
+
+    std::vector<unsigned char> out;
+    hj::lz4::err               e = hj::lz4::err::ok;
+    EXPECT_NO_THROW(e = hj::lz4::decompress(out, frame.data(), frame.size()));
+    EXPECT_NE(e, hj::lz4::err::ok);
+    EXPECT_TRUE(out.empty());
+
+    // a generous cap bounds the growth, it is not the first allocation
+    std::vector<unsigned char> capped;
+    EXPECT_NE(
+        hj::lz4::decompress(capped, frame.data(), frame.size(), 1ULL << 41),
+        hj::lz4::err::ok);
+    EXPECT_LT(capped.capacity(), size_t(1) << 20);
+}
+
+TEST_F(lz4, max_output_size_limit)
+{
+    std::vector<unsigned char> compressed, out;
+    ASSERT_EQ(
+        hj::lz4::compress(compressed, text_data.data(), text_data.size()),
+        hj::lz4::err::ok);
+
+    EXPECT_EQ(
+        hj::lz4::decompress(out, compressed.data(), compressed.size(), 1000),
+        hj::lz4::err::max_output_sz_exceeded);
+    EXPECT_EQ(hj::lz4::decompress(out,
+                                  compressed.data(),
+                                  compressed.size(),
+                                  text_data.size()),
+              hj::lz4::err::ok);
+    EXPECT_EQ(out, text_data);
+}
+
+TEST_F(lz4, concatenated_frames)
+{
+    std::vector<unsigned char> a, b, out;
+    ASSERT_EQ(hj::lz4::compress(a, test_data.data(), test_data.size()),
+              hj::lz4::err::ok);
+    ASSERT_EQ(hj::lz4::compress(b, text_data.data(), text_data.size()),
+              hj::lz4::err::ok);
+    a.insert(a.end(), b.begin(), b.end());
+
+    EXPECT_EQ(hj::lz4::decompress(out, a.data(), a.size()), hj::lz4::err::ok);
+    std::vector<unsigned char> expect = test_data;
+    expect.insert(expect.end(), text_data.begin(), text_data.end());
+    EXPECT_EQ(out, expect);
+}
+
+TEST_F(lz4, stream_compression)
+{
+    std::string       src(text_data.begin(), text_data.end());
+    std::stringstream in(src, std::ios::binary | std::ios::in);
+    std::stringstream compressed(std::ios::binary | std::ios::in
+                                 | std::ios::out);
+
+    // small chunks to cross many block boundaries
+    ASSERT_EQ(
+        hj::lz4::compress(compressed,
+                          in,
+                          hj::lz4::compression_lvl::default_compression,
+                          1000),
+        hj::lz4::err::ok);
+
+    // a stream frame decompresses one-shot too
+    std::string                payload = compressed.str();
+    std::vector<unsigned char> out;
+    EXPECT_EQ(hj::lz4::decompress(out, payload.data(), payload.size()),
+              hj::lz4::err::ok);
+    EXPECT_EQ(out, text_data);
+
+    std::stringstream  back(std::ios::binary | std::ios::in | std::ios::out);
+    std::istringstream zin(payload, std::ios::binary);
+    EXPECT_EQ(hj::lz4::decompress(back, zin, 0, 333), hj::lz4::err::ok);
+    EXPECT_EQ(back.str(), src);
+
+    std::ostringstream limited(std::ios::binary);
+    std::istringstream zin2(payload, std::ios::binary);
+    EXPECT_EQ(hj::lz4::decompress(limited, zin2, 1000),
+              hj::lz4::err::max_output_sz_exceeded);
+
+    std::ostringstream truncated(std::ios::binary);
+    std::istringstream zin3(payload.substr(0, payload.size() / 2),
+                            std::ios::binary);
+    EXPECT_EQ(hj::lz4::decompress(truncated, zin3), hj::lz4::err::data_error);
+}
+
+TEST_F(lz4, file_compression)
+{
+    {
+        std::ofstream out("lz4_test_input.txt", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(text_data.data()),
+                  text_data.size());
+    }
+
+    EXPECT_EQ(hj::lz4::compress_file("lz4_test_output.lz4",
+                                     "lz4_test_input.txt"),
+              hj::lz4::err::ok);
+    EXPECT_EQ(hj::lz4::decompress_file("lz4_test_decompressed.txt",
+                                       "lz4_test_output.lz4"),
+              hj::lz4::err::ok);
+
+    std::ifstream in("lz4_test_decompressed.txt", std::ios::binary);
+    std::string   dst((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+    EXPECT_EQ(dst, std::string(text_data.begin(), text_data.end()));
+
+    EXPECT_EQ(hj::lz4::compress_file("lz4_test_output.lz4", "not_exist.txt"),
+              hj::lz4::err::read_buffer_error);
+}
+
+TEST_F(lz4, small_messages_multithread)
+{
+    // every thread reuses its own context
+    std::vector<std::thread> threads;
+    std::vector<int>         failures(4, 0);
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t, &failures]() {
+            std::vector<unsigned char> compressed, out;
+            for(int i = 0; i < 2000; ++i)
+            {
+                std::string msg = "{\"order\":" + std::to_string(t * 10000 + i)
+                                  + ",\"qty\":" + std::to_string(i % 100) + "}";
+                if(hj::lz4::compress(compressed, msg.data(), msg.size())
+                       != hj::lz4::err::ok
+                   || hj::lz4::decompress(
+                          out, compressed.data(), compressed.size())
+                          != hj::lz4::err::ok
+                   || std::string(out.begin(), out.end()) != msg)
+                    ++failures[t];
+            }
+        });
+    }
+    for(auto &th : threads)
+        th.join();
+
+    for(int f : failures)
+        EXPECT_EQ(f, 0);
+}
+
+TEST_F(lz4, compression_ratio)
+{
+    EXPECT_DOUBLE_EQ(hj::lz4::compression_ratio(0, 10), 0.0);
+    EXPECT_DOUBLE_EQ(hj::lz4::compression_ratio(100, 25), 0.75);
+}
@@ -3,6 +3,8 @@
 
 #include <fstream>
 #include <cstdio>
+#include <string>
+#include <vector>
 
 bool create_md5_test_file(const char *filename, const std::string &content)
 {
@@ -67,4 +69,63 @@ TEST(md5, to_hex)
 TEST(md5, encode_len_reserve)
 {
     ASSERT_EQ(hj::md5::encode_len_reserve(), MD5_DIGEST_LENGTH);
-}
\ No newline at end of file
+}
+TEST(md5, hasher)
+{
+    auto            ok = hj::md5::error_code::ok;
+    hj::md5::hasher h;
+    std::string     digest;
+    for(int round = 0; round < 2; ++round)
+    {
+        ASSERT_EQ(h.update(std::string("hehehunanchina")), ok);
+        ASSERT_EQ(h.update(std::string("@live.com")), ok);
+        ASSERT_EQ(h.finish(digest), ok);
+        ASSERT_STREQ(hj::md5::to_hex(digest).c_str(),
+                     "2da6acfccab34c8ac05295d0f4262b84");
+    }
+
+    std::array<uint8_t, MD5_DIGEST_LENGTH> arr;
+    ASSERT_EQ(h.finish(arr), ok);
+    ASSERT_STREQ(
+        hj::md5::to_hex(std::string(arr.begin(), arr.end())).c_str(),
+        "d41d8cd98f00b204e9800998ecf8427e");
+}
+
+TEST(md5, hash_many)
+{
+    auto                     ok = hj::md5::error_code::ok;
+    std::vector<std::string> src(300);
+    for(std::size_t i = 0; i < src.size(); ++i)
+        src[i] = std::string(i, char('a' + i % 26));
+
+    hj::thread_pool          pool(3);
+    std::vector<std::string> dst;
+    ASSERT_EQ(hj::md5::hash_many(dst, src, &pool), ok);
+    ASSERT_EQ(dst.size(), src.size());
+    for(std::size_t i = 0; i < src.size(); ++i)
+    {
+        std::string one;
+        hj::md5::encode(one, src[i]);
+        ASSERT_EQ(dst[i], one);
+    }
+}
+
+TEST(md5, hash_files)
+{
+    auto        ok   = hj::md5::error_code::ok;
+    const char *path = "md5_hash_files_input.txt";
+    if(!create_md5_test_file(path, "hehehunanchina@live.com"))
+        GTEST_SKIP() << "Failed to create test input file.";
+
+    std::string digest;
+    ASSERT_EQ(hj::md5::hash_file(digest, path), ok);
+    ASSERT_STREQ(hj::md5::to_hex(digest).c_str(),
+                 "2da6acfccab34c8ac05295d0f4262b84");
+
+    std::vector<std::string> dst;
+    ASSERT_EQ(hj::md5::hash_files(dst, {path, path}), ok);
+    ASSERT_EQ(dst.size(), 2);
+    ASSERT_EQ(dst[1], digest);
+
+    std::remove(path);
+}
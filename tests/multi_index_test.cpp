@@ -63,3 +63,26 @@ TEST(multi_index, erase_and_modify)
     id_view.modify(it, [](person &p) { p.age = 99; });
     EXPECT_EQ(it->age, 99);
 }
+
+using person_hashed_index =
+    hj::multi_index<person,
+                    HJ_HASHED_UNIQUE_INDEX(int, &person::id, id_tag)
+                        HJ_HASHED_NON_UNIQUE_INDEX(
+                            std::string, &person::name, name_tag)>;
+
+TEST(multi_index, hashed_index)
+{
+    person_hashed_index idx;
+    for(int i = 0; i < 1000; ++i)
+        idx.insert({i, i % 2 ? "odd" : "even", i});
+    EXPECT_FALSE(idx.insert({7, "dup", 0}).second);
+
+    auto &id_view = idx.get<id_tag>();
+    auto  it      = id_view.find(123);
+    ASSERT_NE(it, id_view.end());
+    EXPECT_EQ(it->name, "odd");
+
+    auto &name_view = idx.get<name_tag>();
+    EXPECT_EQ(name_view.count(std::string("even")), 500);
+    EXPECT_EQ(name_view.count(std::string("none")), 0);
+}
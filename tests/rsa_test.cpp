@@ -3,6 +3,9 @@
 #include <hj/crypto/base64.hpp>
 #include <cstring>
 #include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(rsa, encrypt)
 {
@@ -341,4 +344,157 @@ MFswDQYJKoZIhvcNAQEBBQADSgAwRwJAevxSYQggOUn0bfka93jW0E2wkakW9gxE
     ASSERT_FALSE(hj::rsa::is_cipher_valid(invalid_cipher,
                                           hj::rsa::padding::no_padding,
                                           prikey));
-}
\ No newline at end of file
+}
+TEST(rsa, key_matches_pem_api)
+{
+    auto        ok = hj::rsa::error_code::ok;
+    std::string prikey;
+    std::string pubkey;
+    ASSERT_EQ(hj::rsa::keygen(pubkey, prikey, 2048), ok);
+
+    auto pub = hj::rsa::key::load_public(pubkey);
+    auto pri = hj::rsa::key::load_private(prikey);
+    ASSERT_TRUE(pub.is_valid());
+    ASSERT_TRUE(pri.is_valid());
+    ASSERT_FALSE(pub.is_private());
+    ASSERT_TRUE(pri.is_private());
+    ASSERT_EQ(pub.size(), 256);
+    ASSERT_FALSE(hj::rsa::key::load_public("not a pem").is_valid());
+
+    std::string plain = "hello world";
+    auto        src   = reinterpret_cast<const unsigned char *>(plain.data());
+
+    // pkcs1 signatures are deterministic, both apis must agree
+    unsigned char sig1[512];
+    std::size_t   sig1_len = sizeof(sig1);
+    ASSERT_EQ(hj::rsa::signature(
+                  sig1,
+                  sig1_len,
+                  src,
+                  plain.size(),
+                  reinterpret_cast<const unsigned char *>(prikey.data()),
+                  prikey.size()),
+              ok);
+    unsigned char sig2[512];
+    std::size_t   sig2_len = sizeof(sig2);
+    ASSERT_EQ(hj::rsa::signature(sig2, sig2_len, src, plain.size(), pri), ok);
+    ASSERT_EQ(sig1_len, sig2_len);
+    ASSERT_EQ(memcmp(sig1, sig2, sig1_len), 0);
+
+    unsigned char out[512];
+    std::size_t   out_len = sizeof(out);
+    ASSERT_EQ(hj::rsa::verify_signature(out, out_len, sig1, sig1_len, pub),
+              ok);
+    ASSERT_EQ(std::string(reinterpret_cast<char *>(out), out_len), plain);
+    ASSERT_EQ(hj::rsa::verify(src, plain.size(), sig1, sig1_len, pub), ok);
+
+    sig1[10] ^= 1;
+    ASSERT_EQ(hj::rsa::verify(src, plain.size(), sig1, sig1_len, pub),
+              hj::rsa::error_code::verification_failed);
+    ASSERT_EQ(hj::rsa::signature(sig2, sig2_len, src, plain.size(), pub),
+              hj::rsa::error_code::key_loading_failed);
+
+    // cipher of the parsed key decrypts with the pem api and back
+    unsigned char cipher[512];
+    std::size_t   cipher_len = sizeof(cipher);
+    ASSERT_EQ(hj::rsa::encrypt(cipher,
+                               cipher_len,
+                               src,
+                               plain.size(),
+                               pub,
+                               hj::rsa::padding::pkcs1_oaep),
+              ok);
+    out_len = sizeof(out);
+    ASSERT_EQ(
+        hj::rsa::decrypt(out,
+                         out_len,
+                         cipher,
+                         cipher_len,
+                         reinterpret_cast<const unsigned char *>(prikey.data()),
+                         prikey.size(),
+                         hj::rsa::padding::pkcs1_oaep),
+        ok);
+    ASSERT_EQ(std::string(reinterpret_cast<char *>(out), out_len), plain);
+
+    std::string cipher2;
+    ASSERT_EQ(hj::rsa::encrypt(cipher2, plain, pubkey), ok);
+    out_len = sizeof(out);
+    ASSERT_EQ(hj::rsa::decrypt(
+                  out,
+                  out_len,
+                  reinterpret_cast<const unsigned char *>(cipher2.data()),
+                  cipher2.size(),
+                  pri),
+              ok);
+    ASSERT_EQ(std::string(reinterpret_cast<char *>(out), out_len), plain);
+}
+
+TEST(rsa, sign_verify_batch)
+{
+    auto        ok = hj::rsa::error_code::ok;
+    std::string prikey;
+    std::string pubkey;
+    ASSERT_EQ(hj::rsa::keygen(pubkey, prikey, 1024), ok);
+    auto pub = hj::rsa::key::load_public(pubkey);
+    auto pri = hj::rsa::key::load_private(prikey);
+
+    const std::size_t               n = 64;
+    std::vector<std::string>        msgs(n);
+    std::vector<unsigned char>      sigs(n * pri.size());
+    std::vector<hj::rsa::sign_item> sign_items(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        msgs[i]    = "license-" + std::to_string(i);
+        auto &it   = sign_items[i];
+        it.dst     = sigs.data() + i * pri.size();
+        it.dst_len = pri.size();
+        it.src     = reinterpret_cast<const unsigned char *>(msgs[i].data());
+        it.src_len = msgs[i].size();
+    }
+
+    hj::thread_pool pool(4);
+    ASSERT_EQ(hj::rsa::sign_batch(sign_items.data(),
+                                  n,
+                                  pri,
+                                  hj::rsa::padding::pkcs1,
+                                  &pool),
+              ok);
+
+    std::vector<hj::rsa::verify_item> verify_items(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(sign_items[i].ec, ok);
+        verify_items[i].msg     = sign_items[i].src;
+        verify_items[i].msg_len = sign_items[i].src_len;
+        verify_items[i].sig     = sign_items[i].dst;
+        verify_items[i].sig_len = sign_items[i].dst_len;
+    }
+    ASSERT_EQ(hj::rsa::verify_batch(verify_items.data(),
+                                    n,
+                                    pub,
+                                    hj::rsa::padding::pkcs1,
+                                    &pool),
+              ok);
+
+    // a bad item fails on its own, the rest still verifies
+    verify_items[7].msg_len--;
+    ASSERT_EQ(hj::rsa::verify_batch(verify_items.data(), n, pub),
+              hj::rsa::error_code::verification_failed);
+    for(std::size_t i = 0; i < n; ++i)
+        ASSERT_EQ(verify_items[i].ec,
+                  i == 7 ? hj::rsa::error_code::verification_failed : ok);
+
+    // batches without a pool of their own share one across callers
+    verify_items[7].msg_len++;
+    std::vector<hj::rsa::verify_item> again = verify_items;
+    std::thread                       t([&again, &pub, n]() {
+        EXPECT_EQ(hj::rsa::verify_batch(again.data(), n, pub),
+                  hj::rsa::error_code::ok);
+    });
+    ASSERT_EQ(hj::rsa::verify_batch(verify_items.data(), n, pub), ok);
+    t.join();
+
+    ASSERT_EQ(hj::rsa::verify_batch(verify_items.data(), 0, pub), ok);
+    ASSERT_EQ(hj::rsa::verify_batch(nullptr, n, pub),
+              hj::rsa::error_code::invalid_input);
+}
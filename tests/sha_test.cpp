@@ -5,6 +5,9 @@
 
 #include <fstream>
 #include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
 
 TEST(sha256, encode)
 {
@@ -79,4 +82,123 @@ TEST(sha256, encode_file)
 
     std::remove(input_file);
     std::remove(output_file);
-}
\ No newline at end of file
+}
+TEST(sha, hasher)
+{
+    auto ok = hj::sha::error_code::ok;
+    for(auto algo : {hj::sha::algorithm::sha1,
+                     hj::sha::algorithm::sha224,
+                     hj::sha::algorithm::sha256,
+                     hj::sha::algorithm::sha384,
+                     hj::sha::algorithm::sha512})
+    {
+        std::string expect;
+        ASSERT_EQ(hj::sha::encode(expect, std::string("hello world"), algo),
+                  ok);
+
+        hj::sha::hasher h(algo);
+        ASSERT_TRUE(h.is_valid());
+        std::string digest;
+        for(int round = 0; round < 3; ++round)
+        {
+            ASSERT_EQ(h.update(std::string("hello")), ok);
+            ASSERT_EQ(h.update(std::string(" world")), ok);
+            ASSERT_EQ(h.finish(digest), ok);
+            ASSERT_EQ(digest, expect);
+        }
+
+        // reset drops what was fed so far
+        h.update(std::string("garbage"));
+        h.reset();
+        h.update(std::string("hello world"));
+        ASSERT_EQ(h.finish(digest), ok);
+        ASSERT_EQ(digest, expect);
+    }
+
+    hj::sha::hasher h;
+    unsigned char   small[16];
+    std::size_t     small_len = sizeof(small);
+    ASSERT_EQ(h.finish(small, small_len),
+              hj::sha::error_code::buffer_too_small);
+
+    hj::hash_array<32> arr;
+    ASSERT_EQ(h.finish(arr), ok);
+    std::string empty;
+    hj::sha::sha256(empty, std::string());
+    ASSERT_EQ(memcmp(arr.data(), empty.data(), 32), 0);
+}
+
+TEST(sha, hash_many)
+{
+    auto                     ok = hj::sha::error_code::ok;
+    std::vector<std::string> src;
+    for(int i = 0; i < 1000; ++i)
+        src.push_back("blob-" + std::to_string(i) + std::string(i % 97, 'x'));
+
+    std::vector<std::string> seq;
+    ASSERT_EQ(hj::sha::hash_many(seq, src), ok);
+    ASSERT_EQ(seq.size(), src.size());
+
+    hj::thread_pool          pool(4);
+    std::vector<std::string> par;
+    ASSERT_EQ(
+        hj::sha::hash_many(par, src, hj::sha::algorithm::sha256, &pool),
+        ok);
+    ASSERT_EQ(par, seq);
+
+    for(std::size_t i = 0; i < src.size(); i += 111)
+    {
+        std::string one;
+        hj::sha::sha256(one, src[i]);
+        ASSERT_EQ(seq[i], one);
+    }
+
+    unsigned char        dst[10];
+    const unsigned char *ptr = nullptr;
+    std::size_t          len = 0;
+    ASSERT_EQ(hj::sha::hash_many(dst, sizeof(dst), &ptr, &len, 1),
+              hj::sha::error_code::buffer_too_small);
+}
+
+TEST(sha, hash_files)
+{
+    auto                     ok = hj::sha::error_code::ok;
+    std::vector<std::string> paths;
+    std::vector<std::string> expect;
+    for(int i = 0; i < 4; ++i)
+    {
+        // cross the read buffer size on the last one
+        std::string content(i == 3 ? (3 << 20) + 7 : i * 1000, char('a' + i));
+        std::string path = "sha_hash_files_" + std::to_string(i) + ".bin";
+        std::ofstream(path, std::ios::binary) << content;
+        paths.push_back(path);
+
+        std::string digest;
+        hj::sha::encode(digest, content, hj::sha::algorithm::sha512);
+        expect.push_back(digest);
+    }
+
+    std::string one;
+    ASSERT_EQ(hj::sha::hash_file(one, paths[3], hj::sha::algorithm::sha512),
+              ok);
+    ASSERT_EQ(one, expect[3]);
+
+    hj::thread_pool          pool(2);
+    std::vector<std::string> got;
+    ASSERT_EQ(hj::sha::hash_files(got,
+                                  paths,
+                                  hj::sha::algorithm::sha512,
+                                  &pool),
+              ok);
+    ASSERT_EQ(got, expect);
+
+    paths.push_back("sha_hash_files_not_exist.bin");
+    ASSERT_EQ(hj::sha::hash_files(got, paths, hj::sha::algorithm::sha512),
+              hj::sha::error_code::invalid_input);
+    ASSERT_EQ(got.size(), paths.size());
+    ASSERT_TRUE(got.back().empty());
+    ASSERT_EQ(got[0], expect[0]);
+
+    for(int i = 0; i < 4; ++i)
+        std::remove(paths[i].c_str());
+}
@@ -40,3 +40,20 @@ TEST(simd, dot_f32_non_multiple_of_4)
     float result   = simd_dot_f32(a, b, 6);
     EXPECT_NEAR(result, expected, 1e-5f);
 }
+
+TEST(simd, has_features)
+{
+    // avx2 cpus all have sse4.2 and pclmul; neon and x86 features never mix
+    if(simd_has_avx2())
+    {
+        EXPECT_TRUE(simd_has_sse41() && simd_has_sse42() && simd_has_pclmul());
+    }
+    if(simd_has_sse42())
+    {
+        EXPECT_TRUE(simd_has_sse41());
+    }
+    if(simd_has_neon())
+    {
+        EXPECT_FALSE(simd_has_sse41() || simd_has_avx2() || simd_has_pclmul());
+    }
+}
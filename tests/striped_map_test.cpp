@@ -245,4 +245,34 @@ TEST(striped_map, multithreaded_read_write)
 
     ASSERT_EQ(m.size(), thread_count * ops_per_thread);
     ASSERT_EQ(write_sum.load(), read_sum.load());
-}
\ No newline at end of file
+}
+TEST(striped_map, default_hash)
+{
+    hj::striped_map<std::string, int> m{16};
+    for(int i = 0; i < 1000; ++i)
+        m.emplace("key" + std::to_string(i), i);
+
+    int value = 0;
+    for(int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(m.find("key" + std::to_string(i), value));
+        ASSERT_EQ(value, i);
+    }
+    EXPECT_FALSE(m.find("key1000", value));
+}
+
+TEST(striped_map, custom_hash)
+{
+    struct mod_hash
+    {
+        std::size_t operator()(const int &key) const { return key % 7; }
+    };
+    using my_alloc = std::allocator<std::pair<const int, int>>;
+    hj::striped_map<int, int, my_alloc, mod_hash> m{4};
+    for(int i = 0; i < 100; ++i)
+        m.emplace(i, i * 2);
+
+    int value = 0;
+    ASSERT_TRUE(m.find(99, value));
+    ASSERT_EQ(value, 198);
+}
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include <hj/net/tcp/tcp_codec.hpp>
+#include <hj/net/tcp/tcp_listener.hpp>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// encode every payload, split the byte stream at random points and decode it
+// back the way tcp_conn does: decode while complete frames are buffered
+template <typename Codec, typename MakeFrame>
+static void codec_roundtrip(const Codec                    &codec,
+                            const std::vector<std::string> &payloads,
+                            MakeFrame                     &&make_frame,
+                            std::mt19937                   &rng)
+{
+    std::string stream;
+    for(const auto &payload : payloads)
+    {
+        std::vector<unsigned char> buf(payload.size() + 64);
+        hj::tcp_frame              in = make_frame(payload);
+        std::size_t sz = codec.encode(buf.data(), buf.size(), &in);
+        ASSERT_GT(sz, 0);
+        stream.append(reinterpret_cast<const char *>(buf.data()), sz);
+    }
+
+    std::string              rbuf;
+    std::vector<std::string> out;
+    std::size_t              off = 0;
+    while(off < stream.size())
+    {
+        std::size_t chunk = std::uniform_int_distribution<std::size_t>(
+            1, std::min<std::size_t>(stream.size() - off, 97))(rng);
+        rbuf.append(stream, off, chunk);
+        off += chunk;
+
+        hj::tcp_frame frame;
+        std::size_t   used = 0;
+        while((used = codec.decode(
+                   &frame,
+                   reinterpret_cast<const unsigned char *>(rbuf.data()),
+                   rbuf.size()))
+              > 0)
+        {
+            ASSERT_TRUE(frame.valid());
+            out.emplace_back(frame.view());
+            rbuf.erase(0, used);
+        }
+    }
+    EXPECT_TRUE(rbuf.empty());
+    EXPECT_EQ(out, payloads);
+}
+
+static std::vector<std::string> random_payloads(std::mt19937 &rng,
+                                                std::size_t   n,
+                                                std::size_t   max_len,
+                                                bool          printable)
+{
+    std::vector<std::string> payloads(n);
+    for(auto &payload : payloads)
+    {
+        payload.resize(
+            std::uniform_int_distribution<std::size_t>(0, max_len)(rng));
+        for(auto &c : payload)
+            c = printable ? static_cast<char>('a' + rng() % 26)
+                          : static_cast<char>(rng());
+    }
+    return payloads;
+}
+
+TEST(tcp_codec, length_prefix_roundtrip)
+{
+    std::mt19937 rng{1};
+    auto         plain = [](const std::string &s) { return hj::tcp_frame(s); };
+    for(auto field : {hj::length_field::u8,
+                      hj::length_field::u16,
+                      hj::length_field::u32,
+                      hj::length_field::varint})
+    {
+        for(auto order : {hj::byte_order::big, hj::byte_order::little})
+        {
+            hj::length_prefix_codec codec{field, order};
+            std::size_t max_len = field == hj::length_field::u8 ? 255 : 1000;
+            for(int round = 0; round < 20; ++round)
+                codec_roundtrip(codec,
+                                random_payloads(rng, 50, max_len, false),
+                                plain,
+                                rng);
+        }
+    }
+}
+
+TEST(tcp_codec, length_prefix_wire_format)
+{
+    unsigned char buf[16] = {};
+    hj::tcp_frame in{"abc", 3};
+
+    hj::length_prefix_codec be{hj::length_field::u16, hj::byte_order::big};
+    ASSERT_EQ(be.encode(buf, sizeof(buf), &in), 5);
+    EXPECT_EQ(buf[0], 0x00);
+    EXPECT_EQ(buf[1], 0x03);
+
+    hj::length_prefix_codec le{hj::length_field::u32, hj::byte_order::little};
+    ASSERT_EQ(le.encode(buf, sizeof(buf), &in), 7);
+    EXPECT_EQ(buf[0], 0x03);
+    EXPECT_EQ(buf[3], 0x00);
+
+    std::string                big(300, 'x');
+    hj::tcp_frame              big_in{big};
+    std::vector<unsigned char> out(512);
+    hj::length_prefix_codec    var{hj::length_field::varint};
+    ASSERT_EQ(var.encode(out.data(), out.size(), &big_in), 302);
+    EXPECT_EQ(out[0], 0xAC);
+    EXPECT_EQ(out[1], 0x02);
+
+    // too small output buffer
+    EXPECT_EQ(be.encode(buf, 4, &in), 0);
+    // length field too narrow
+    hj::length_prefix_codec u8{hj::length_field::u8};
+    EXPECT_EQ(u8.encode(out.data(), out.size(), &big_in), 0);
+}
+
+TEST(tcp_codec, length_prefix_corrupt)
+{
+    hj::length_prefix_codec codec{hj::length_field::u32,
+                                  hj::byte_order::big,
+                                  1024};
+    hj::tcp_frame           frame;
+    unsigned char           huge[] = {0xFF, 0xFF, 0xFF, 0xFF, 1, 2};
+    EXPECT_EQ(codec.decode(&frame, huge, sizeof(huge)), sizeof(huge));
+    EXPECT_FALSE(frame.valid());
+
+    hj::length_prefix_codec var{hj::length_field::varint};
+    unsigned char           endless[12];
+    memset(endless, 0xFF, sizeof(endless));
+    EXPECT_EQ(var.decode(&frame, endless, 5), 0); // may still complete
+    EXPECT_EQ(var.decode(&frame, endless, sizeof(endless)), sizeof(endless));
+    EXPECT_FALSE(frame.valid());
+}
+
+TEST(tcp_codec, delimiter_roundtrip)
+{
+    std::mt19937 rng{2};
+    auto         plain = [](const std::string &s) { return hj::tcp_frame(s); };
+    for(const char *delim : {"\n", "\r\n", "||END||"})
+    {
+        hj::delimiter_codec codec{delim};
+        for(int round = 0; round < 20; ++round)
+            codec_roundtrip(codec,
+                            random_payloads(rng, 50, 500, true),
+                            plain,
+                            rng);
+    }
+
+    hj::delimiter_codec codec{"\n", 8};
+    hj::tcp_frame       frame;
+    std::string         line = "0123456789abcdef";
+    EXPECT_EQ(codec.decode(&frame,
+                           reinterpret_cast<const unsigned char *>(line.data()),
+                           line.size()),
+              line.size());
+    EXPECT_FALSE(frame.valid());
+}
+
+TEST(tcp_codec, header_body_roundtrip)
+{
+    std::mt19937 rng{3};
+    // 8 byte header: u16 msg type, u16 flags, u32 body length at offset 4
+    hj::header_body_codec codec{8, 4};
+    ASSERT_TRUE(codec.valid());
+
+    unsigned char head[8] = {0x12, 0x34, 0x00, 0x01, 0, 0, 0, 0};
+    auto          with_head = [&head](const std::string &s) {
+        return hj::tcp_frame(head, sizeof(head), s.data(), s.size());
+    };
+    for(int round = 0; round < 20; ++round)
+        codec_roundtrip(codec,
+                        random_payloads(rng, 50, 600, false),
+                        with_head,
+                        rng);
+
+    std::vector<unsigned char> buf(64);
+    std::string                body = "payload";
+    hj::tcp_frame              in   = with_head(body);
+    std::size_t                sz   = codec.encode(buf.data(), buf.size(), &in);
+    ASSERT_EQ(sz, 8 + body.size());
+    EXPECT_EQ(buf[7], body.size());
+
+    hj::tcp_frame out;
+    EXPECT_EQ(codec.decode(&out, buf.data(), sz), sz);
+    EXPECT_EQ(out.head_size(), 8);
+    EXPECT_EQ(out.head()[0], 0x12);
+    EXPECT_EQ(out.view(), body);
+
+    // the length field counts the header too
+    hj::header_body_codec incl{4,
+                               0,
+                               hj::length_field::u16,
+                               hj::byte_order::little,
+                               true};
+    unsigned char         h4[4] = {};
+    hj::tcp_frame         in4{h4, 4, body.data(), body.size()};
+    sz = incl.encode(buf.data(), buf.size(), &in4);
+    EXPECT_EQ(buf[0], 4 + body.size());
+    EXPECT_EQ(incl.decode(&out, buf.data(), sz), sz);
+    EXPECT_EQ(out.view(), body);
+
+    EXPECT_FALSE(hj::header_body_codec(4, 2, hj::length_field::u32).valid());
+    EXPECT_FALSE(hj::header_body_codec(4, 0, hj::length_field::varint).valid());
+}
+
+TEST(tcp_codec, retain)
+{
+    hj::length_prefix_codec    codec;
+    std::vector<unsigned char> buf(32);
+    hj::tcp_frame              in{"hello", 5};
+    std::size_t                sz = codec.encode(buf.data(), buf.size(), &in);
+
+    hj::tcp_frame frame;
+    ASSERT_EQ(codec.decode(&frame, buf.data(), sz), sz);
+    EXPECT_FALSE(frame.retained());
+    EXPECT_EQ(frame.data(), buf.data() + 4); // a view, no copy
+
+    hj::tcp_frame kept = frame;
+    kept.retain();
+    EXPECT_TRUE(kept.retained());
+    std::fill(buf.begin(), buf.end(), 0);
+    EXPECT_EQ(kept.view(), "hello");
+
+    hj::tcp_frame shared = kept;
+    EXPECT_EQ(shared.data(), kept.data());
+    shared.retain();
+    EXPECT_EQ(shared.data(), kept.data());
+}
+
+TEST(tcp_codec, handlers)
+{
+    hj::length_prefix_codec        codec{hj::length_field::varint};
+    hj::tcp_conn::encode_handler_t enc = codec.encoder();
+    hj::tcp_conn::decode_handler_t dec = codec.decoder();
+
+    unsigned char buf[32];
+    hj::tcp_frame in{"xyz", 3};
+    std::size_t   sz = enc(buf, sizeof(buf), &in);
+    EXPECT_EQ(sz, 4);
+
+    hj::tcp_frame out;
+    EXPECT_EQ(dec(&out, buf, sz), sz);
+    EXPECT_EQ(out.view(), "xyz");
+
+    hj::tcp_conn::io_t io;
+    hj::tcp_conn       conn{io};
+    codec.bind(conn);
+    hj::delimiter_codec().bind(conn);
+    hj::header_body_codec(4, 0).bind(conn);
+}
+
+TEST(tcp_codec, oversized_prefix)
+{
+    // a length prefix past the receive buffer, followed by enough bytes to
+    // fill it, must end in an invalid frame rather than an exception
+    std::thread t1([]() {
+        hj::tcp_conn::io_t         io;
+        hj::tcp_listener           li{io};
+        std::vector<unsigned char> wire(4 + 64 * 1024, 'x');
+        hj::detail::put_uint(wire.data(), 100000, 4, hj::byte_order::big);
+
+        auto base = li.accept(10017);
+        base->send(wire.data(), wire.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        li.close();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    hj::tcp_conn::io_t io;
+    hj::tcp_conn       conn{io};
+    hj::tcp_frame      frame;
+    int                nrecv = 0;
+    hj::length_prefix_codec{}.bind(conn);
+    conn.set_recv_handler(
+        [&nrecv](hj::tcp_conn::conn_ptr_t conn, hj::tcp_conn::msg_ptr_t arg) {
+            nrecv++;
+            EXPECT_FALSE(static_cast<hj::tcp_frame *>(arg)->valid());
+            conn->disconnect();
+        });
+    ASSERT_TRUE(conn.async_connect("127.0.0.1",
+                                   10017,
+                                   [&frame](hj::tcp_conn::conn_ptr_t   conn,
+                                            const hj::tcp_conn::err_t &err) {
+                                       ASSERT_FALSE(err.failed());
+                                       conn->async_recv(&frame);
+                                   }));
+
+    EXPECT_NO_THROW(io.run());
+    t1.join();
+    EXPECT_EQ(nrecv, 1);
+}
@@ -0,0 +1,450 @@
+#include <gtest/gtest.h>
+#include <hj/net/udp/udp_arq.hpp>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// in-memory link between two arq cores: drops every n-th datagram and
+// delays delivery by a fixed number of simulated ms
+struct arq_link
+{
+    struct packet
+    {
+        std::uint32_t at;
+        std::string   data;
+    };
+
+    std::uint32_t      delay     = 0;
+    std::uint32_t      drop_nth  = 0;
+    std::uint32_t      count     = 0;
+    std::uint32_t      dropped   = 0;
+    std::deque<packet> in_flight;
+
+    void push(std::uint32_t now, const char *data, std::size_t len)
+    {
+        if(drop_nth > 0 && (++count % drop_nth) == 0)
+        {
+            dropped++;
+            return;
+        }
+        in_flight.push_back(packet{now + delay, std::string(data, len)});
+    }
+
+    void deliver(std::uint32_t now, hj::udp::arq &to)
+    {
+        to.set_current(now);
+        while(!in_flight.empty()
+              && static_cast<std::int32_t>(now - in_flight.front().at) >= 0)
+        {
+            to.input(in_flight.front().data.data(),
+                     in_flight.front().data.size());
+            in_flight.pop_front();
+        }
+    }
+};
+
+static std::string make_msg(std::size_t i)
+{
+    // mix small messages with ones spanning several fragments
+    std::size_t len = (i % 5 == 0) ? 4000 + i : 16 + i % 100;
+    std::string msg(len, '\0');
+    for(std::size_t j = 0; j < len; ++j)
+        msg[j] = static_cast<char>('a' + (i + j) % 26);
+    return msg;
+}
+
+static void run_arq_pair(arq_link &ab, arq_link &ba, std::size_t n)
+{
+    hj::udp::arq_options opts;
+    opts.mtu = 512;
+
+    std::uint32_t now = 0;
+    hj::udp::arq  a{1, opts};
+    hj::udp::arq  b{1, opts};
+    a.set_output([&](const char *data, std::size_t len) {
+        ab.push(now, data, len);
+    });
+    b.set_output([&](const char *data, std::size_t len) {
+        ba.push(now, data, len);
+    });
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::string msg = make_msg(i);
+        ASSERT_TRUE(a.send(msg.data(), msg.size()));
+    }
+
+    std::size_t recvd = 0;
+    std::string out;
+    for(; now < 60000 && recvd < n; now += 5)
+    {
+        a.update(now);
+        b.update(now);
+        ab.deliver(now, b);
+        ba.deliver(now, a);
+        while(b.recv(out))
+        {
+            ASSERT_EQ(out, make_msg(recvd));
+            recvd++;
+        }
+    }
+    EXPECT_EQ(recvd, n);
+    EXPECT_FALSE(a.is_dead());
+
+    // drain the last acks
+    for(std::uint32_t end = now + 2000; now < end && a.wait_snd() > 0; now += 5)
+    {
+        a.update(now);
+        b.update(now);
+        ab.deliver(now, b);
+        ba.deliver(now, a);
+    }
+    EXPECT_EQ(a.wait_snd(), 0);
+    EXPECT_TRUE(a.is_acked(a.next_sn() - 1));
+}
+
+TEST(udp_arq, timer_wheel)
+{
+    hj::udp::timer_wheel       wheel{8, 10};
+    std::vector<std::uint32_t> fired;
+    wheel.reset(0);
+    wheel.schedule(25, 1);
+    wheel.schedule(105, 2); // wraps the 8-slot wheel
+    wheel.schedule(5, 3);
+
+    auto collect = [&](const hj::udp::timer_wheel::entry &e) {
+        fired.push_back(e.id);
+    };
+    wheel.advance(10, collect);
+    EXPECT_EQ(fired, std::vector<std::uint32_t>({3}));
+    wheel.advance(29, collect);
+    EXPECT_EQ(fired, std::vector<std::uint32_t>({3, 1}));
+    wheel.advance(99, collect);
+    EXPECT_EQ(fired.size(), 2);
+    wheel.advance(1000, collect);
+    EXPECT_EQ(fired, std::vector<std::uint32_t>({3, 1, 2}));
+}
+
+TEST(udp_arq, fragment_and_reassemble)
+{
+    hj::udp::arq_options opts;
+    opts.mtu = 128;
+    hj::udp::arq a{7, opts};
+    hj::udp::arq b{7, opts};
+    a.set_output([&](const char *data, std::size_t len) { b.input(data, len); });
+    b.set_output([&](const char *data, std::size_t len) { a.input(data, len); });
+
+    std::string big(a.mss() * 3 + 10, 'x');
+    EXPECT_TRUE(a.send(big.data(), big.size()));
+    EXPECT_TRUE(a.send("", 0));
+    EXPECT_FALSE(a.send(big.data(), a.max_msg_size() + 1));
+    for(std::uint32_t now = 0; now < 1000; now += 10)
+    {
+        a.update(now);
+        b.update(now);
+    }
+
+    std::string out;
+    EXPECT_EQ(b.peek_size(), static_cast<long>(big.size()));
+    EXPECT_TRUE(b.recv(out));
+    EXPECT_EQ(out, big);
+    EXPECT_TRUE(b.recv(out));
+    EXPECT_TRUE(out.empty());
+    EXPECT_FALSE(b.recv(out));
+    EXPECT_EQ(a.wait_snd(), 0);
+}
+
+TEST(udp_arq, degenerate_options)
+{
+    // an mtu without room for the header, zero windows and tick
+    hj::udp::arq_options opts;
+    opts.mtu         = 10;
+    opts.snd_wnd     = 0;
+    opts.rcv_wnd     = 0;
+    opts.interval    = 0;
+    opts.wheel_slots = 0;
+    hj::udp::arq a{7, opts};
+    hj::udp::arq b{7, opts};
+    EXPECT_EQ(a.mss(), 1u);
+    EXPECT_EQ(hj::udp::arq::checked(opts).mtu, hj::udp::arq::overhead + 1);
+
+    std::size_t max_dgram = 0;
+    a.set_output([&](const char *data, std::size_t len) {
+        max_dgram = std::max(max_dgram, len);
+        b.input(data, len);
+    });
+    b.set_output([&](const char *data, std::size_t len) { a.input(data, len); });
+
+    // one byte segments and a one segment window
+    EXPECT_EQ(a.max_msg_size(), 1u);
+    EXPECT_FALSE(a.send("ab", 2));
+    EXPECT_TRUE(a.send("a", 1));
+    std::string out;
+    for(std::uint32_t now = 0; now < 3000 && !b.recv(out); now += 10)
+    {
+        a.update(now);
+        b.update(now);
+    }
+    EXPECT_EQ(out, "a");
+    EXPECT_LE(max_dgram, hj::udp::arq::overhead + 1);
+}
+
+TEST(udp_arq, reject_foreign_conv)
+{
+    hj::udp::arq a{1};
+    hj::udp::arq b{2};
+    std::string  wire;
+    a.set_output([&](const char *data, std::size_t len) {
+        wire.assign(data, len);
+    });
+    a.send("hi", 2);
+    a.update(0);
+    ASSERT_FALSE(wire.empty());
+    EXPECT_FALSE(b.input(wire.data(), wire.size()));
+    EXPECT_FALSE(b.input(wire.data(), 3));
+}
+
+TEST(udp_arq, first_datagram_lost)
+{
+    // send() + flush() before the first update(), as arq_conn does; the
+    // lost datagram must still be resent by its rto timer
+    hj::udp::arq a{3};
+    hj::udp::arq b{3};
+    std::size_t  outputs = 0;
+    a.set_output([&](const char *data, std::size_t len) {
+        if(outputs++ > 0)
+            b.input(data, len);
+    });
+    b.set_output([&](const char *data, std::size_t len) { a.input(data, len); });
+
+    a.set_current(1000);
+    ASSERT_TRUE(a.send("hello", 5));
+    a.flush();
+    EXPECT_EQ(outputs, 1);
+
+    std::string out;
+    for(std::uint32_t now = 1000; now < 5000 && !b.recv(out); now += 10)
+    {
+        a.update(now);
+        b.update(now);
+    }
+    EXPECT_EQ(out, "hello");
+    EXPECT_GT(outputs, 1);
+}
+
+TEST(udp_arq, lossless_link)
+{
+    arq_link ab, ba;
+    ab.delay = ba.delay = 10;
+    run_arq_pair(ab, ba, 200);
+}
+
+TEST(udp_arq, lossy_link)
+{
+    arq_link ab, ba;
+    ab.delay    = ba.delay = 20;
+    ab.drop_nth = 4;
+    ba.drop_nth = 7;
+    run_arq_pair(ab, ba, 200);
+    EXPECT_GT(ab.dropped, 0);
+    EXPECT_GT(ba.dropped, 0);
+}
+
+// localhost UDP relay that drops and delays datagrams in both directions
+class udp_drop_shim
+{
+  public:
+    udp_drop_shim(boost::asio::io_context &io,
+                  std::uint16_t            port,
+                  std::uint16_t            server_port,
+                  double                   loss,
+                  std::chrono::milliseconds delay)
+        : _io{io}
+        , _sock{io.get_executor()}
+        , _server{hj::udp::socket::endpoint("127.0.0.1", server_port)}
+        , _loss{loss}
+        , _delay{delay}
+        , _rng{42}
+    {
+        std::error_code ec;
+        _sock.bind(hj::udp::socket::endpoint("127.0.0.1", port), ec);
+        _recv();
+    }
+
+    std::size_t dropped = 0;
+
+    void close() { _sock.close(); }
+
+  private:
+    void _recv()
+    {
+        _sock.async_recv(
+            _buf,
+            sizeof(_buf),
+            _from,
+            [this](const std::error_code &ec, std::size_t sz) {
+                if(ec)
+                    return;
+
+                if(_from != _server)
+                    _client = _from;
+                if(std::uniform_real_distribution<double>(0, 1)(_rng) < _loss)
+                {
+                    dropped++;
+                } else
+                {
+                    auto to    = _from == _server ? _client : _server;
+                    auto data  = std::make_shared<std::string>(_buf, sz);
+                    auto timer = std::make_shared<boost::asio::steady_timer>(
+                        _io, _delay);
+                    timer->async_wait(
+                        [this, to, data, timer](
+                            const boost::system::error_code &err) {
+                            std::error_code ec;
+                            if(!err)
+                                _sock.send(data->data(), data->size(), to, ec);
+                        });
+                }
+                _recv();
+            });
+    }
+
+  private:
+    boost::asio::io_context    &_io;
+    hj::udp::socket             _sock;
+    hj::udp::socket::endpoint_t _server;
+    hj::udp::socket::endpoint_t _client;
+    hj::udp::socket::endpoint_t _from;
+    double                      _loss;
+    std::chrono::milliseconds   _delay;
+    std::mt19937                _rng;
+    char                        _buf[65536];
+};
+
+TEST(udp_arq, conn_over_lossy_localhost)
+{
+    boost::asio::io_context io;
+    hj::udp::arq_options    opts;
+    opts.interval = 5;
+    udp_drop_shim shim{io, 3011, 3010, 0.1, std::chrono::milliseconds(5)};
+
+    hj::udp::arq_conn server{io, 99, opts};
+    hj::udp::arq_conn client{io, 99, opts};
+
+    const std::size_t        n = 100;
+    std::vector<std::string> sent(n);
+    std::vector<std::string> recvd(n);
+    std::size_t              nsent = 0, nrecvd = 0;
+
+    auto encode = [](unsigned char *buf, const std::size_t len, void *msg) {
+        std::string *str = static_cast<std::string *>(msg);
+        if(str->size() > len)
+            return std::size_t(0);
+        memcpy(buf, str->data(), str->size());
+        return str->size();
+    };
+    auto decode = [](void *msg, const unsigned char *buf, const std::size_t len) {
+        static_cast<std::string *>(msg)->assign(
+            reinterpret_cast<const char *>(buf), len);
+        return len;
+    };
+    client.set_encode_handler(encode);
+    server.set_decode_handler(decode);
+    client.set_send_handler([&](hj::udp::arq_conn *, void *) { nsent++; });
+    server.set_recv_handler([&](hj::udp::arq_conn *, void *msg) {
+        EXPECT_EQ(msg, &recvd[nrecvd]);
+        nrecvd++;
+    });
+
+    std::error_code ec;
+    ASSERT_TRUE(server.bind(3010, ec));
+    ASSERT_TRUE(client.connect("127.0.0.1", 3011, ec));
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        sent[i] = make_msg(i);
+        EXPECT_TRUE(server.async_recv(&recvd[i]));
+        EXPECT_TRUE(client.async_send(&sent[i]));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while((nrecvd < n || nsent < n)
+          && std::chrono::steady_clock::now() < deadline)
+        io.run_for(std::chrono::milliseconds(50));
+
+    EXPECT_EQ(nrecvd, n);
+    EXPECT_EQ(nsent, n);
+    EXPECT_EQ(recvd, sent);
+    EXPECT_GT(shim.dropped, 0);
+
+    bool disconnected = false;
+    server.set_disconn_handler(
+        [&](hj::udp::arq_conn *) { disconnected = true; });
+    EXPECT_TRUE(server.disconnect());
+    EXPECT_TRUE(disconnected);
+    EXPECT_FALSE(server.is_connected());
+    EXPECT_FALSE(server.async_send(&sent[0]));
+    shim.close();
+}
+
+TEST(udp_arq, conn_ignores_stray_datagram)
+{
+    boost::asio::io_context io;
+    hj::udp::arq_options    opts;
+    opts.interval = 5;
+
+    hj::udp::arq_conn            server{io, 77, opts};
+    hj::udp::arq_conn            client{io, 77, opts};
+    std::string                  sent = "payload", recvd;
+    std::size_t                  nrecvd = 0;
+    std::vector<std::error_code> errors;
+
+    server.set_decode_handler(
+        [](void *msg, const unsigned char *buf, const std::size_t len) {
+            static_cast<std::string *>(msg)->assign(
+                reinterpret_cast<const char *>(buf), len);
+            return len;
+        });
+    server.set_recv_handler([&](hj::udp::arq_conn *, void *) { nrecvd++; });
+    client.set_encode_handler(
+        [](unsigned char *buf, const std::size_t len, void *msg) {
+            std::string *str = static_cast<std::string *>(msg);
+            if(str->empty() || str->size() > len)
+                return std::size_t(0);
+            memcpy(buf, str->data(), str->size());
+            return str->size();
+        });
+    client.set_error_handler(
+        [&](hj::udp::arq_conn *, void *, const std::error_code &ec) {
+            errors.push_back(ec);
+        });
+
+    std::error_code ec;
+    ASSERT_TRUE(server.bind(3012, ec));
+
+    // garbage from another socket must not become the server's peer
+    hj::udp::socket stray{io.get_executor()};
+    stray.bind(hj::udp::socket::endpoint("127.0.0.1", 3014), ec);
+    stray.send("junk", 4, hj::udp::socket::endpoint("127.0.0.1", 3012), ec);
+    io.run_for(std::chrono::milliseconds(50));
+
+    ASSERT_TRUE(client.bind(3013, ec));
+    ASSERT_TRUE(client.connect("127.0.0.1", 3012, ec));
+    EXPECT_TRUE(server.async_recv(&recvd));
+    EXPECT_TRUE(client.async_send(&sent));
+
+    std::string empty;
+    EXPECT_TRUE(client.async_send(&empty));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while(nrecvd < 1 && std::chrono::steady_clock::now() < deadline)
+        io.run_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(nrecvd, 1);
+    EXPECT_EQ(recvd, sent);
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors[0], hj::udp::make_err(hj::udp::error_code::encode_failed));
+    stray.close();
+}
@@ -133,4 +133,152 @@ TEST(udp_socket, executor_and_socket_reuse)
     EXPECT_TRUE(s.is_open());
     s.close();
     EXPECT_FALSE(s.is_open());
-}
\ No newline at end of file
+}
+#if defined(__linux__)
+TEST(udp_socket, send_recv_batch)
+{
+    boost::asio::io_context     io;
+    std::error_code             ec;
+    hj::udp::socket             p1(io.get_executor());
+    hj::udp::socket             p2(io.get_executor());
+    hj::udp::socket::endpoint_t ep =
+        hj::udp::socket::endpoint("127.0.0.1", 3005);
+
+    p1.bind(3005, ec);
+    EXPECT_FALSE(ec);
+    p2.bind(3006, ec);
+    EXPECT_FALSE(ec);
+    p1.set_timestamp(true, ec);
+    EXPECT_FALSE(ec);
+
+    std::vector<std::string> msgs = {"hello", "world", "batch", "io"};
+    hj::udp::mmsg_batch      tx(8);
+    for(auto &msg : msgs)
+        EXPECT_TRUE(tx.push(msg.data(), msg.size(), ep));
+    EXPECT_EQ(tx.size(), msgs.size());
+
+    size_t sent = p2.send_batch(tx, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(sent, msgs.size());
+
+    hj::udp::mmsg_batch rx(8, 64);
+    size_t              recvd = 0;
+    while(recvd < msgs.size())
+    {
+        size_t n = p1.recv_batch(rx, ec);
+        ASSERT_FALSE(ec);
+        for(size_t i = 0; i < n; ++i)
+        {
+            EXPECT_EQ(std::string(rx.data(i), rx.length(i)), msgs[recvd + i]);
+            EXPECT_EQ(rx.endpoint(i).port(), 3006);
+            EXPECT_GT(rx.timestamp(i).count(), 0);
+        }
+        recvd += n;
+    }
+    EXPECT_EQ(recvd, msgs.size());
+
+    // full batch rejects more messages
+    hj::udp::mmsg_batch small(1);
+    EXPECT_TRUE(small.push("a", 1, ep));
+    EXPECT_FALSE(small.push("b", 1, ep));
+    small.clear();
+    EXPECT_TRUE(small.empty());
+    EXPECT_EQ(p2.send_batch(small, ec), 0);
+    EXPECT_EQ(ec, hj::udp::make_err(hj::udp::error_code::invalid_argument));
+}
+
+TEST(udp_socket, async_recv_batch)
+{
+    boost::asio::io_context     io;
+    std::error_code             ec;
+    hj::udp::socket             p1(io.get_executor());
+    hj::udp::socket             p2(io.get_executor());
+    hj::udp::socket::endpoint_t ep =
+        hj::udp::socket::endpoint("127.0.0.1", 3007);
+    hj::udp::mmsg_batch rx(4);
+    size_t              recvd = 0;
+
+    p1.bind(3007, ec);
+    EXPECT_FALSE(ec);
+    p1.async_recv_batch(rx, [&](const std::error_code &ec, std::size_t n) {
+        EXPECT_FALSE(ec);
+        recvd = n;
+    });
+
+    EXPECT_EQ(p2.send("abc", 3, ep, ec), 3);
+    io.run();
+    ASSERT_GE(recvd, 1);
+    EXPECT_EQ(std::string(rx.data(0), rx.length(0)), "abc");
+}
+
+TEST(udp_socket, gso_gro)
+{
+    boost::asio::io_context     io;
+    std::error_code             ec;
+    hj::udp::socket             p1(io.get_executor());
+    hj::udp::socket             p2(io.get_executor());
+    hj::udp::socket::endpoint_t ep =
+        hj::udp::socket::endpoint("127.0.0.1", 3008);
+
+    p1.bind(3008, ec);
+    EXPECT_FALSE(ec);
+    p2.set_gso(100, ec);
+    if(ec)
+        GTEST_SKIP() << "UDP_SEGMENT not supported: " << ec.message();
+
+    // one send, three datagrams on the wire
+    std::string payload(300, 'x');
+    EXPECT_EQ(p2.send(payload.data(), payload.size(), ep, ec), 300);
+    EXPECT_FALSE(ec);
+
+    hj::udp::mmsg_batch rx(8, 1500);
+    size_t              total = 0;
+    while(total < 3)
+    {
+        size_t n = p1.recv_batch(rx, ec);
+        ASSERT_FALSE(ec);
+        for(size_t i = 0; i < n; ++i)
+            EXPECT_EQ(rx.length(i), 100);
+        total += n;
+    }
+    EXPECT_EQ(total, 3);
+
+    p1.set_gro(true, ec);
+    EXPECT_FALSE(ec);
+
+    // with GRO the three segments arrive as one 300 byte message
+    EXPECT_EQ(p2.send(payload.data(), payload.size(), ep, ec), 300);
+    EXPECT_FALSE(ec);
+    hj::udp::mmsg_batch big(8, 65535);
+    size_t              bytes = 0;
+    while(bytes < 300)
+    {
+        size_t n = p1.recv_batch(big, ec);
+        ASSERT_FALSE(ec);
+        for(size_t i = 0; i < n; ++i)
+        {
+            EXPECT_EQ(big.length(i), 300);
+            EXPECT_EQ(big.segment_size(i), 100);
+            EXPECT_FALSE(big.truncated(i));
+            bytes += big.length(i);
+        }
+    }
+    EXPECT_EQ(bytes, 300);
+
+    // a slot smaller than the coalesced message cuts it
+    EXPECT_EQ(p2.send(payload.data(), payload.size(), ep, ec), 300);
+    EXPECT_FALSE(ec);
+    hj::udp::mmsg_batch small(8, 128);
+    size_t              n = 0;
+    while(n == 0)
+    {
+        n = p1.recv_batch(small, ec);
+        ASSERT_FALSE(ec);
+    }
+    EXPECT_EQ(small.length(0), 128);
+    EXPECT_TRUE(small.truncated(0));
+
+    p2.set_gso(0, ec);
+    EXPECT_FALSE(ec);
+}
+#endif
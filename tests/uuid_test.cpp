@@ -2,7 +2,8 @@
 #include <hj/algo/uuid.hpp>
 
 #include <algorithm>
-#include <cctype>
+#include <cctype>
+#include <cstring>
 #include <mutex>
 #include <regex>
 #include <string>
@@ -156,4 +157,150 @@ TEST(uuid, custom_generator_extension)
     EXPECT_EQ(hj::uuid::gen_u64<DummyGenParam>(true), 0x1122334455667788ULL);
     EXPECT_EQ(hj::uuid::gen_u64<DummyGenParam>(false), 0x8877665544332211ULL);
     EXPECT_EQ(hj::uuid::gen<DummyGenParam>(), "custom-dummy-uuid-string");
-}
\ No newline at end of file
+}
+TEST(uuid, format_to)
+{
+    hj::uuid128 id{0x0123456789abcdefULL, 0xfedcba9876543210ULL};
+    char        buf[40];
+    std::memset(buf, '#', sizeof(buf));
+    char *end = hj::uuid::format_to(buf, id);
+    ASSERT_EQ(end, buf + 36);
+    EXPECT_EQ(std::string(buf, 36), "01234567-89ab-cdef-fedc-ba9876543210");
+    EXPECT_EQ(buf[36], '#');
+    EXPECT_EQ(hj::uuid::to_string(hj::uuid128{0, ~0ULL}),
+              "00000000-0000-0000-ffff-ffffffffffff");
+}
+
+TEST(uuid, v7_layout)
+{
+    uint64_t    before = hj::detail::uuid_v7::clock_t::now_ms();
+    hj::uuid128 id     = hj::uuid::gen_v7();
+    uint64_t    after  = hj::detail::uuid_v7::clock_t::now_ms();
+
+    EXPECT_EQ((id.hi >> 12) & 0xF, 7U);
+    EXPECT_EQ(id.lo >> 62, 2U);
+    EXPECT_GE(id.hi >> 16, before);
+    EXPECT_LE(id.hi >> 16, after + 1);
+
+    std::regex v7_regex("^[0-9a-f]{8}-[0-9a-f]{4}-7[0-9a-f]{3}-[89ab][0-9a-f]"
+                        "{3}-[0-9a-f]{12}$");
+    EXPECT_TRUE(std::regex_match(hj::uuid::to_string(id), v7_regex));
+    EXPECT_TRUE(std::regex_match(hj::uuid::gen<hj::detail::uuid_v7>(),
+                                 v7_regex));
+}
+
+TEST(uuid, v7_monotonic)
+{
+    hj::uuid128 prev = hj::uuid::gen_v7();
+    for(int i = 0; i < 100000; ++i)
+    {
+        hj::uuid128 id = hj::uuid::gen_v7();
+        ASSERT_TRUE(prev < id);
+        prev = id;
+    }
+
+    std::vector<hj::uuid128> batch(5000);
+    hj::uuid::gen_v7_n(batch.data(), batch.size());
+    EXPECT_TRUE(prev < batch.front());
+    EXPECT_TRUE(std::is_sorted(batch.begin(), batch.end()));
+    EXPECT_TRUE(std::adjacent_find(batch.begin(), batch.end())
+                == batch.end());
+}
+
+TEST(uuid, gen_u64_n)
+{
+    std::vector<uint64_t> ids(10000);
+    hj::uuid::gen_u64_n(ids.data(), ids.size(), false);
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+    EXPECT_TRUE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+
+    // falls back to gen_u64 for generators without generate_n
+    uint64_t dummy[3];
+    hj::uuid::gen_u64_n<DummyGenU64>(dummy, 3, false);
+    EXPECT_EQ(dummy[2], 0x123456789ABCDEF0ULL);
+}
+
+TEST(uuid, multithreaded_blocks)
+{
+    constexpr int thread_count   = 8;
+    constexpr int ids_per_thread = 20000;
+
+    std::vector<std::thread>              threads;
+    std::vector<std::vector<uint64_t>>    u64_results(thread_count);
+    std::vector<std::vector<hj::uuid128>> v7_results(thread_count);
+    for(int t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([t, &u64_results, &v7_results]() {
+            auto &u64 = u64_results[t];
+            auto &v7  = v7_results[t];
+            for(int i = 0; i < ids_per_thread; ++i)
+            {
+                u64.push_back(hj::uuid::gen_u64(false));
+                v7.push_back(hj::uuid::gen_v7());
+            }
+            u64.resize(u64.size() + 100);
+            hj::uuid::gen_u64_n(u64.data() + ids_per_thread, 100, false);
+            v7.resize(v7.size() + 100);
+            hj::uuid::gen_v7_n(v7.data() + ids_per_thread, 100);
+        });
+    }
+    for(auto &th : threads)
+        th.join();
+
+    std::unordered_set<uint64_t> u64_set;
+    std::vector<hj::uuid128>     v7_all;
+    for(int t = 0; t < thread_count; ++t)
+    {
+        // increasing per thread
+        EXPECT_TRUE(std::is_sorted(u64_results[t].begin(),
+                                   u64_results[t].end()));
+        EXPECT_TRUE(std::is_sorted(v7_results[t].begin(),
+                                   v7_results[t].end()));
+        u64_set.insert(u64_results[t].begin(), u64_results[t].end());
+        v7_all.insert(v7_all.end(),
+                      v7_results[t].begin(),
+                      v7_results[t].end());
+    }
+    EXPECT_EQ(u64_set.size(), size_t(thread_count) * (ids_per_thread + 100));
+
+    std::sort(v7_all.begin(), v7_all.end());
+    EXPECT_TRUE(std::adjacent_find(v7_all.begin(), v7_all.end())
+                == v7_all.end());
+}
+
+TEST(uuid, clock_regression)
+{
+    hj::detail::seq_clock<12, 0> clock;
+    uint64_t                     a = clock.reserve(1, 10000);
+    EXPECT_EQ(a, 10000ULL << 12);
+
+    // a small step back keeps counting on the last millisecond
+    uint64_t b = clock.reserve(1, 9000);
+    EXPECT_EQ(b, a + 1);
+
+    // sequence overflow carries into the next millisecond
+    uint64_t c = clock.reserve(4096, 10000);
+    EXPECT_EQ(c, a + 2);
+    EXPECT_EQ(clock.reserve(1, 10000) >> 12, 10001ULL);
+
+    EXPECT_THROW(clock.reserve(1, 4000), std::runtime_error);
+}
+
+TEST(uuid, clock_reserve_bound)
+{
+    using clock_t = hj::detail::seq_clock<12, 0>;
+    clock_t clock;
+    EXPECT_THROW(clock.reserve(0, 10000), std::invalid_argument);
+    EXPECT_THROW(clock.reserve(clock_t::max_reserve + 1, 10000),
+                 std::invalid_argument);
+
+    // a bulk run larger than the allowed lead is split and waits for the
+    // wall clock instead of pushing the last ids far ahead of it
+    using engine_t = hj::detail::snowflake_engine;
+    engine_t              eng;
+    std::vector<uint64_t> ids(5 << 20);
+    eng.generate_n(ids.data(), ids.size());
+    uint64_t last = ids.back() >> engine_t::timestamp_shift;
+    EXPECT_LE(last, engine_t::clock_t::now_ms() + clock_t::max_ahead_ms);
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+}
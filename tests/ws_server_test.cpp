@@ -2,6 +2,8 @@
 #include <hj/net/http/ws_client.hpp>
 #include <hj/net/http/ws_server.hpp>
 #include <thread>
+#include <vector>
+#include <atomic>
 #include <chrono>
 #include <iostream> // Include iostream for std::cout
 
@@ -136,6 +138,317 @@ TEST(ws_server, async_accept_recv_send_close)
     ASSERT_TRUE(is_async_ws_server_running);
 }
 
+// accept n clients synchronously, each subscribed and drained by a reader
+static std::vector<hj::ws_server::ws_stream_ptr_t>
+accept_subscribers(std::shared_ptr<hj::ws_server> serv,
+                   uint16_t                       port,
+                   std::size_t                    n)
+{
+    std::vector<hj::ws_server::ws_stream_ptr_t> conns;
+    hj::ws_server::err_t                        err;
+    auto ep = hj::ws_server::make_endpoint("127.0.0.1", port);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        auto ws = serv->accept(ep, err);
+        if(err || !ws)
+            break;
+        EXPECT_TRUE(serv->subscribe(ws));
+        serv->async_recv(ws, [](const auto &, auto, std::string) {});
+        conns.push_back(ws);
+    }
+    return conns;
+}
+
+static std::shared_ptr<hj::ws_client> connect_retry(hj::ws_client::io_t &io,
+                                                    uint16_t             port)
+{
+    for(int i = 0; i < 100; ++i)
+    {
+        auto client = std::make_shared<hj::ws_client>(io);
+        if(client->connect("127.0.0.1", std::to_string(port), "/"))
+            return client;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return nullptr;
+}
+
+TEST(ws_server, broadcast)
+{
+    const uint16_t    port = 21003;
+    const std::size_t n = 8, msgs = 100;
+
+    std::atomic<std::size_t> ok{0};
+    std::vector<std::thread> clients;
+    for(std::size_t i = 0; i < n; ++i)
+        clients.emplace_back([&]() {
+            hj::ws_client::io_t io;
+            auto                client = connect_retry(io, port);
+            ASSERT_TRUE(client);
+            std::string msg;
+            for(std::size_t j = 0; j < msgs; ++j)
+            {
+                ASSERT_TRUE(client->recv(msg));
+                EXPECT_EQ(msg, "msg " + std::to_string(j));
+            }
+            ok++;
+            client->close();
+        });
+
+    hj::ws_server::io_t io;
+    auto                guard = boost::asio::make_work_guard(io);
+    auto                serv  = std::make_shared<hj::ws_server>(io);
+    auto                conns = accept_subscribers(serv, port, n);
+    ASSERT_EQ(conns.size(), n);
+    std::thread io_th([&io]() { io.run(); });
+
+    for(std::size_t j = 0; j < msgs; ++j)
+        EXPECT_EQ(serv->broadcast("msg " + std::to_string(j)), n);
+    for(auto &c : clients)
+        c.join();
+    EXPECT_EQ(ok.load(), n);
+    EXPECT_EQ(serv->fanout().dropped(), 0);
+
+    // a unicast shares the subscriber queue
+    EXPECT_FALSE(serv->fanout().send(nullptr, nullptr));
+    EXPECT_TRUE(serv->unsubscribe(conns[0]));
+    EXPECT_EQ(serv->fanout().size(), n - 1);
+    serv->close();
+    EXPECT_EQ(serv->broadcast("late"), 0);
+
+    guard.reset();
+    io.stop();
+    io_th.join();
+}
+
+TEST(ws_server, broadcast_high_water)
+{
+    using policy = hj::ws_server::fanout_t::overflow_policy;
+    const uint16_t port = 21004;
+    for(auto pol : {policy::drop, policy::disconnect})
+    {
+        std::atomic<std::size_t> received{0};
+        std::thread              client_th([&]() {
+            hj::ws_client::io_t io;
+            auto                client = connect_retry(io, port);
+            ASSERT_TRUE(client);
+            std::string msg;
+            while(client->recv(msg))
+                if(++received == 1 && pol == policy::drop)
+                    break;
+            client->close();
+        });
+
+        // io is not running yet, nothing leaves the queue while broadcasting
+        hj::ws_server::io_t io;
+        auto                serv  = std::make_shared<hj::ws_server>(io);
+        auto                conns = accept_subscribers(serv, port, 1);
+        ASSERT_EQ(conns.size(), 1);
+        serv->fanout().set_high_water(1024, pol);
+
+        std::string payload(1000, 'x');
+        EXPECT_EQ(serv->broadcast(payload), 1);
+        for(int i = 0; i < 99; ++i)
+            EXPECT_EQ(serv->broadcast(payload), 0);
+        if(pol == policy::drop)
+        {
+            EXPECT_EQ(serv->fanout().dropped(), 99);
+            EXPECT_EQ(serv->fanout().size(), 1);
+        } else
+        {
+            EXPECT_EQ(serv->fanout().disconnected(), 1);
+            EXPECT_EQ(serv->fanout().size(), 0);
+        }
+
+        std::thread io_th([&io]() { io.run(); });
+        client_th.join();
+        EXPECT_LE(received.load(), 1);
+        if(pol == policy::drop)
+        {
+            EXPECT_EQ(received.load(), 1);
+        }
+        conns.clear();
+        serv->close();
+        io.stop();
+        io_th.join();
+    }
+}
+
+TEST(ws_server, permessage_deflate)
+{
+    using stream_t = hj::ws_server::ws_stream_t;
+    using field    = boost::beast::http::field;
+    const uint16_t port = 21005;
+
+    std::string json;
+    for(int i = 0; json.size() < 900; ++i)
+        json += "{\"sym\":\"ABC" + std::to_string(i % 50)
+                + "\",\"px\":100.25,\"qty\":" + std::to_string(i) + "},";
+
+    struct deflate_case
+    {
+        bool client;
+        bool takeover;
+    };
+    for(auto c : {deflate_case{true, true},
+                  deflate_case{true, false},
+                  deflate_case{false, true}})
+    {
+        std::string ext;
+        std::thread client_th([&]() {
+            boost::asio::io_context io;
+            stream_t                ws{io};
+            for(int i = 0; i < 100; ++i)
+            {
+                boost::system::error_code ec;
+                ws.next_layer().connect(
+                    {boost::asio::ip::make_address("127.0.0.1"), port},
+                    ec);
+                if(!ec)
+                    break;
+                ws.next_layer().close();
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            hj::ws_deflate_options opts;
+            opts.enable = c.client;
+            ws.set_option(hj::make_permessage_deflate(opts));
+
+            boost::beast::websocket::response_type res;
+            ws.handshake(res, "127.0.0.1", "/");
+            ext = std::string(res[field::sec_websocket_extensions]);
+            for(int i = 0; i < 3; ++i)
+            {
+                ws.write(boost::asio::buffer(json));
+                boost::beast::flat_buffer buf;
+                ws.read(buf);
+                EXPECT_EQ(boost::beast::buffers_to_string(buf.data()), json);
+            }
+            ws.close(boost::beast::websocket::close_code::normal);
+        });
+
+        hj::ws_server::io_t    io;
+        hj::ws_server::err_t   err;
+        auto                   serv = std::make_shared<hj::ws_server>(io);
+        hj::ws_deflate_options opts;
+        opts.server_context_takeover = c.takeover;
+        opts.server_max_window_bits  = 12;
+        opts.mem_level               = 4;
+        serv->set_deflate(opts);
+
+        auto ws = serv->accept(hj::ws_server::make_endpoint("127.0.0.1", port),
+                               err);
+        ASSERT_FALSE(err);
+        for(int i = 0; i < 3; ++i)
+        {
+            std::string msg = serv->recv(ws, err);
+            ASSERT_FALSE(err);
+            serv->send(ws, err, msg);
+            ASSERT_FALSE(err);
+        }
+        serv->recv(ws, err); // peer close
+        client_th.join();
+        serv->close();
+
+        EXPECT_EQ(ext.find("permessage-deflate") != std::string::npos,
+                  c.client);
+        EXPECT_EQ(ext.find("server_no_context_takeover") != std::string::npos,
+                  c.client && !c.takeover);
+    }
+}
+
+TEST(ws_server, async_read_loop)
+{
+    const uint16_t port = 21006;
+    const int      n    = 1000;
+
+    std::vector<std::string> client_got;
+    std::thread              client_th([&]() {
+        hj::ws_client::io_t io;
+        auto                client = connect_retry(io, port);
+        ASSERT_TRUE(client);
+        for(int i = 0; i < n; ++i)
+            ASSERT_TRUE(client->send("m" + std::to_string(i)));
+
+        client->async_read_loop([&](const auto &err, const auto &msgs) {
+            for(auto &m : msgs)
+                client_got.push_back(m.str());
+            return !err && client_got.size() < 3;
+        });
+        io.run();
+        client->close();
+    });
+
+    hj::ws_server::io_t  io;
+    hj::ws_server::err_t err;
+    auto                 serv = std::make_shared<hj::ws_server>(io);
+
+    auto ws = serv->accept(hj::ws_server::make_endpoint("127.0.0.1", port),
+                           err);
+    ASSERT_FALSE(err);
+
+    int                         next    = 0;
+    std::size_t                 batches = 0;
+    std::vector<hj::ws_message> kept;
+    serv->async_read_loop(
+        ws,
+        [&](const auto &err, auto, const auto &msgs) {
+            EXPECT_FALSE(err);
+            batches++;
+            for(auto &m : msgs)
+            {
+                EXPECT_EQ(m.view(), "m" + std::to_string(next));
+                EXPECT_FALSE(m.binary());
+                if(next++ % 100 == 0)
+                    kept.push_back(m); // outlives the handler
+            }
+            return next < n;
+        },
+        16);
+    io.run();
+    EXPECT_EQ(next, n);
+    EXPECT_LE(batches, static_cast<std::size_t>(n));
+    ASSERT_EQ(kept.size(), 10);
+    for(std::size_t i = 0; i < kept.size(); ++i)
+        EXPECT_EQ(kept[i].view(), "m" + std::to_string(i * 100));
+
+    for(const char *msg : {"a", "b", "c"})
+        serv->send(ws, err, msg);
+    serv->recv(ws, err); // peer close
+    client_th.join();
+    EXPECT_EQ(client_got, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(ws_server, recv_large_message)
+{
+    const uint16_t    port = 21007;
+    const std::string big(64 * 1024, 'x');
+
+    std::thread client_th([&]() {
+        hj::ws_client::io_t io;
+        auto                client = connect_retry(io, port);
+        ASSERT_TRUE(client);
+        ASSERT_TRUE(client->send(big));
+        std::string echo;
+        ASSERT_TRUE(client->recv(echo));
+        EXPECT_EQ(echo, big);
+        client->close();
+    });
+
+    hj::ws_server::io_t  io;
+    hj::ws_server::err_t err;
+    auto                 serv = std::make_shared<hj::ws_server>(io);
+    auto ws = serv->accept(hj::ws_server::make_endpoint("127.0.0.1", port),
+                           err);
+    ASSERT_FALSE(err);
+
+    std::string msg = serv->recv(ws, err);
+    ASSERT_FALSE(err);
+    EXPECT_EQ(msg.size(), big.size());
+    serv->send(ws, err, msg);
+    serv->recv(ws, err); // peer close
+    client_th.join();
+    serv->close();
+}
+
 TEST(ws_server_ssl, connect_recv_send_close)
 {
     auto client_crt = "./client.crt";
@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include <hj/net/zmq.hpp>
+#include <hj/net/zmq_reactor.hpp>
+#include <hj/sync/object_pool.hpp>
 #include <zmq.h>
 #include <thread>
 #include <chrono>
 #include <vector>
+#include <memory>
 
 TEST(zmq, context_and_message_basic)
 {
@@ -254,4 +257,247 @@ TEST(zmq, poller_basic)
     std::string recv_data;
     ASSERT_GT(cons.pull(recv_data), 0);
     ASSERT_EQ(recv_data, "poller_test");
-}
\ No newline at end of file
+}
+TEST(zmq, zero_copy_adopt)
+{
+    auto              ctx = hj::zmq::context::create();
+    hj::zmq::producer prod(ctx);
+    hj::zmq::consumer cons(ctx);
+    std::string       addr = "inproc://test-zero-copy";
+    ASSERT_EQ(prod.bind(addr), 0);
+    ASSERT_EQ(cons.connect(addr), 0);
+
+    // inproc hands the very same bytes to the receiver
+    std::vector<uint8_t> vec(4096, 'v');
+    const void          *vec_data = vec.data();
+    auto                 msg      = hj::zmq::message::adopt(std::move(vec));
+    ASSERT_TRUE(prod.send(msg));
+    hj::zmq::message in;
+    ASSERT_TRUE(cons.recv(in));
+    EXPECT_EQ(in.data(), vec_data);
+    EXPECT_EQ(in.size(), 4096u);
+
+    msg = hj::zmq::message::adopt(std::string("tiny"));
+    ASSERT_TRUE(prod.send(msg));
+    ASSERT_TRUE(cons.recv(in));
+    EXPECT_EQ(in.to_string_view(), "tiny");
+
+    // refcounted buffer: released once both sides dropped it
+    auto shared = std::make_shared<std::string>(1000, 's');
+    std::weak_ptr<std::string> weak = shared;
+    msg = hj::zmq::message::adopt(shared);
+    shared.reset();
+    ASSERT_TRUE(prod.send(msg));
+    EXPECT_FALSE(weak.expired());
+    ASSERT_TRUE(cons.recv(in));
+    EXPECT_EQ(in.size(), 1000u);
+    in = hj::zmq::message();
+    EXPECT_TRUE(weak.expired());
+
+    // pooled object goes back to the pool from the free callback
+    hj::object_pool<std::string> pool;
+    std::string *obj = pool.create("pooled");
+    ASSERT_EQ(pool.acquire(), obj);
+    msg = hj::zmq::message::adopt(pool, obj, obj->data(), obj->size());
+    EXPECT_EQ(pool.size(), 0u);
+    ASSERT_TRUE(prod.send(msg));
+    ASSERT_TRUE(cons.recv(in));
+    EXPECT_EQ(in.to_string_view(), "pooled");
+    in = hj::zmq::message();
+    EXPECT_EQ(pool.acquire(), obj);
+}
+
+TEST(zmq, chain_buffer_blocks)
+{
+    auto            ctx = hj::zmq::context::create();
+    hj::zmq::w_chan w_ch(ctx);
+    hj::zmq::r_chan r_ch = w_ch.make_r_chan();
+
+    std::string        data = "0123456789abcdefghijklmnopqrstuvwxyz";
+    hj::chain_buffer   buf(16);
+    buf.append(data.data(), data.size());
+    buf.consume(4);
+    ASSERT_TRUE(w_ch.send_blocks(buf));
+    EXPECT_TRUE(buf.empty());
+
+    hj::zmq::multipart parts;
+    ASSERT_TRUE(r_ch.recv_multipart(parts));
+    ASSERT_EQ(parts.size(), 3u);
+    std::string joined;
+    for(size_t i = 0; i < parts.size(); ++i)
+        joined += parts.view(i);
+    EXPECT_EQ(joined, data.substr(4));
+
+    // the buffer keeps working after its blocks were taken
+    buf.append("xy", 2);
+    ASSERT_TRUE(w_ch.send_blocks(buf));
+    ASSERT_TRUE(r_ch.recv_multipart(parts));
+    ASSERT_EQ(parts.size(), 1u);
+    EXPECT_EQ(parts.view(0), "xy");
+
+    // nothing sent, the blocks go back to the buffer
+    hj::zmq::producer prod(ctx);
+    buf.append(data.data(), data.size());
+    EXPECT_FALSE(prod.send_blocks(buf, ZMQ_DONTWAIT));
+    EXPECT_EQ(errno, EAGAIN);
+    ASSERT_EQ(buf.size(), data.size());
+    std::string back(data.size(), '\0');
+    EXPECT_EQ(buf.read(&back[0], back.size()), data.size());
+    EXPECT_EQ(back, data);
+}
+
+TEST(zmq, multipart_reuse_and_batch)
+{
+    auto              ctx = hj::zmq::context::create();
+    hj::zmq::producer prod(ctx);
+    hj::zmq::consumer cons(ctx);
+    std::string       addr = "inproc://test-multipart-batch";
+    ASSERT_EQ(prod.bind(addr), 0);
+    ASSERT_EQ(cons.connect(addr), 0);
+
+    hj::zmq::multipart out;
+    for(int i = 0; i < 10; ++i)
+    {
+        out.add("topic");
+        out.add(hj::zmq::message::adopt(std::to_string(i)));
+        ASSERT_TRUE(prod.send_multipart(out));
+        EXPECT_TRUE(out.empty());
+    }
+
+    std::vector<hj::zmq::multipart> batch;
+    size_t                          got = 0;
+    while(got < 10)
+    {
+        size_t n = cons.recv_batch(batch, 4);
+        ASSERT_GT(n, 0u);
+        ASSERT_LE(n, 4u);
+        for(size_t i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(batch[i].size(), 2u);
+            EXPECT_EQ(batch[i].view(0), "topic");
+            EXPECT_EQ(batch[i].view(1), std::to_string(got++));
+        }
+    }
+    EXPECT_EQ(cons.recv_batch(batch, 4, ZMQ_DONTWAIT), 0u);
+}
+
+TEST(zmq, reactor_readable)
+{
+    auto                    ctx = hj::zmq::context::create();
+    boost::asio::io_context io;
+    hj::zmq::reactor        r(io);
+
+    const int                                      n_socks = 4;
+    const int                                      n_msgs  = 200;
+    std::vector<std::unique_ptr<hj::zmq::producer>> prods;
+    std::vector<std::unique_ptr<hj::zmq::consumer>> conss;
+    for(int i = 0; i < n_socks; ++i)
+    {
+        std::string addr = "inproc://test-reactor-" + std::to_string(i);
+        prods.push_back(std::make_unique<hj::zmq::producer>(ctx));
+        conss.push_back(std::make_unique<hj::zmq::consumer>(ctx));
+        ASSERT_EQ(prods.back()->bind(addr), 0);
+        ASSERT_EQ(conss.back()->connect(addr), 0);
+    }
+
+    // queued before the reactor watches the socket: no fd edge left
+    for(auto &p : prods)
+        p->push("early");
+
+    int              got = 0;
+    hj::zmq::message in;
+    for(auto &c : conss)
+        ASSERT_TRUE(r.add(*c, [&](hj::zmq::socket_base &sock) {
+            // one message per call, the reactor has to come back
+            if(sock.recv(in, ZMQ_DONTWAIT) && ++got == n_socks * (n_msgs + 1))
+                io.stop();
+        }));
+    EXPECT_FALSE(r.add(*conss[0], [](hj::zmq::socket_base &) {}));
+    EXPECT_EQ(r.size(), static_cast<size_t>(n_socks));
+
+    std::thread th([&]() {
+        for(int i = 0; i < n_msgs; ++i)
+            for(auto &p : prods)
+                boost::asio::post(r.executor(), [&p]() { p->push("late"); });
+    });
+    io.run_for(std::chrono::seconds(5));
+    th.join();
+    EXPECT_EQ(got, n_socks * (n_msgs + 1));
+
+    for(auto &c : conss)
+        EXPECT_TRUE(r.remove(*c));
+    EXPECT_EQ(r.size(), 0u);
+}
+
+TEST(zmq, reactor_req_rep)
+{
+    auto                    ctx = hj::zmq::context::create();
+    boost::asio::io_context io;
+    hj::zmq::reactor        r(io);
+    hj::zmq::socket         rep(ctx, ZMQ_REP);
+    hj::zmq::socket         req(ctx, ZMQ_REQ);
+    ASSERT_EQ(zmq_bind(rep.get(), "inproc://test-reactor-rep"), 0);
+    ASSERT_EQ(zmq_connect(req.get(), "inproc://test-reactor-rep"), 0);
+
+    // every handler sends right after receiving, the classic way to lose
+    // the ZMQ_FD edge of the next reply
+    const int        rounds = 1000;
+    int              done   = 0;
+    hj::zmq::message msg;
+    r.add(rep, [&](hj::zmq::socket_base &sock) {
+        while(sock.recv(msg, ZMQ_DONTWAIT))
+            sock.send(msg);
+    });
+    r.add(req, [&](hj::zmq::socket_base &sock) {
+        while(sock.recv(msg, ZMQ_DONTWAIT))
+        {
+            if(++done == rounds)
+            {
+                r.remove(sock);
+                io.stop();
+                return;
+            }
+            sock.send_multipart({std::string_view("ping")});
+        }
+    });
+
+    boost::asio::post(r.executor(), [&]() {
+        req.send_multipart({std::string_view("ping")});
+        r.notify(req);
+    });
+    io.run_for(std::chrono::seconds(5));
+    EXPECT_EQ(done, rounds);
+    EXPECT_EQ(r.size(), 1u);
+}
+
+TEST(zmq, reactor_writable)
+{
+    auto                    ctx = hj::zmq::context::create();
+    boost::asio::io_context io;
+    hj::zmq::reactor        r(io);
+    hj::zmq::producer       prod(ctx);
+    hj::zmq::consumer       cons(ctx);
+    prod.set_opt(ZMQ_SNDHWM, 8);
+    cons.set_opt(ZMQ_RCVHWM, 8);
+    ASSERT_EQ(prod.bind("inproc://test-reactor-write"), 0);
+    ASSERT_EQ(cons.connect("inproc://test-reactor-write"), 0);
+
+    // the producer fills the pipe until the HWM, the consumer frees it up
+    const int        total = 500;
+    int              sent = 0, got = 0;
+    hj::zmq::message in;
+    r.add(prod, nullptr, [&](hj::zmq::socket_base &) {
+        while(sent < total && prod.push("x", ZMQ_DONTWAIT) >= 0)
+            ++sent;
+        if(sent == total)
+            r.modify(prod, 0);
+    });
+    r.add(cons, [&](hj::zmq::socket_base &sock) {
+        while(sock.recv(in, ZMQ_DONTWAIT))
+            if(++got == total)
+                io.stop();
+    });
+    io.run_for(std::chrono::seconds(5));
+    EXPECT_EQ(sent, total);
+    EXPECT_EQ(got, total);
+}
@@ -0,0 +1,448 @@
+#include <gtest/gtest.h>
+#include <hj/compress/zstd.hpp>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <thread>
+
+class zstd : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        test_string = "Hello, World! This is a test string for hj::zstd "
+                      "compression and decompression.";
+        test_data =
+            std::vector<unsigned char>(test_string.begin(), test_string.end());
+
+        for(int i = 0; i < 5000; ++i)
+        {
+            std::string line = "{\"id\":" + std::to_string(i)
+                               + ",\"side\":\"buy\",\"px\":"
+                               + std::to_string(100 + i % 7) + "}\n";
+            text_data.insert(text_data.end(), line.begin(), line.end());
+        }
+
+        std::mt19937                    gen(42);
+        std::uniform_int_distribution<> dis(0, 255);
+        random_data.resize(50000);
+        for(size_t i = 0; i < random_data.size(); ++i)
+            random_data[i] = static_cast<unsigned char>(dis(gen));
+    }
+
+    void TearDown() override
+    {
+        std::remove("zstd_test_input.txt");
+        std::remove("zstd_test_output.zst");
+        std::remove("zstd_test_decompressed.txt");
+    }
+
+    static std::vector<unsigned char>
+    roundtrip(const std::vector<unsigned char> &src,
+              const hj::zstd::compression_lvl    lvl =
+                  hj::zstd::compression_lvl::default_compression)
+    {
+        std::vector<unsigned char> compressed, decompressed;
+        EXPECT_EQ(
+            hj::zstd::compress(compressed, src.data(), src.size(), lvl),
+            hj::zstd::err::ok);
+        EXPECT_EQ(hj::zstd::decompress(decompressed,
+                                       compressed.data(),
+                                       compressed.size()),
+                  hj::zstd::err::ok);
+        return decompressed;
+    }
+
+    std::string                test_string;
+    std::vector<unsigned char> test_data;
+    std::vector<unsigned char> text_data;
+    std::vector<unsigned char> random_data;
+};
+
+TEST_F(zstd, basic_compression_decompression)
+{
+    std::vector<unsigned char> compressed;
+    EXPECT_EQ(
+        hj::zstd::compress(compressed, test_data.data(), test_data.size()),
+        hj::zstd::err::ok);
+    EXPECT_TRUE(hj::zstd::is_zstd_format(compressed.data(), compressed.size()));
+    EXPECT_LE(compressed.size(),
+              hj::zstd::compress_reserve_sz(test_data.size()));
+    EXPECT_EQ(roundtrip(test_data), test_data);
+    EXPECT_EQ(roundtrip(random_data), random_data);
+
+    unsigned char single_byte = 0x42;
+    EXPECT_EQ(roundtrip({single_byte}).size(), 1);
+}
+
+TEST_F(zstd, empty_data_handling)
+{
+    std::vector<unsigned char> out;
+    unsigned char              dummy = 0;
+    EXPECT_EQ(hj::zstd::compress(out, nullptr, 0),
+              hj::zstd::err::input_invalid);
+    EXPECT_EQ(hj::zstd::compress(out, &dummy, 0), hj::zstd::err::input_invalid);
+    EXPECT_EQ(hj::zstd::decompress(out, nullptr, 0),
+              hj::zstd::err::input_invalid);
+}
+
+TEST_F(zstd, compression_levels)
+{
+    std::vector<unsigned char> fast, best;
+    ASSERT_EQ(hj::zstd::compress(fast,
+                                 text_data.data(),
+                                 text_data.size(),
+                                 hj::zstd::compression_lvl::best_speed),
+              hj::zstd::err::ok);
+    ASSERT_EQ(hj::zstd::compress(best,
+                                 text_data.data(),
+                                 text_data.size(),
+                                 hj::zstd::compression_lvl::best_compression),
+              hj::zstd::err::ok);
+    EXPECT_LT(best.size(), fast.size());
+    EXPECT_LT(best.size(), text_data.size() / 4);
+    EXPECT_EQ(roundtrip(text_data, hj::zstd::compression_lvl::best_speed),
+              text_data);
+    EXPECT_EQ(roundtrip(text_data, hj::zstd::compression_lvl::best_compression),
+              text_data);
+}
+
+TEST_F(zstd, corrupt_and_truncated)
+{
+    std::vector<unsigned char> compressed, out;
+    ASSERT_EQ(
+        hj::zstd::compress(compressed, text_data.data(), text_data.size()),
+        hj::zstd::err::ok);
+
+    EXPECT_EQ(
+        hj::zstd::decompress(out, compressed.data(), compressed.size() / 2),
+        hj::zstd::err::data_error);
+    EXPECT_TRUE(out.empty());
+
+    // the content checksum catches a flipped payload byte
+    compressed[compressed.size() / 2] ^= 0x55;
+    EXPECT_NE(hj::zstd::decompress(out, compressed.data(), compressed.size()),
+              hj::zstd::err::ok);
+
+    EXPECT_EQ(hj::zstd::decompress(out, test_data.data(), test_data.size()),
+              hj::zstd::err::data_error);
+}
+
+TEST_F(zstd, forged_content_size)
+{
+    // one raw block of 5 bytes in a frame declaring 1 TiB of content
+    std::vector<unsigned char> frame = {0x28, 0xb5, 0x2f, 0xfd, 0xc0, 0x00};
+    for(int i = 0; i < 8; ++i)
+        frame.push_back(i == 5 ? 0x01 : 0x00);
+    frame.insert(frame.end(), {0x29, 0x00, 0x00, 'h', 'e', 'l', 'l', 'o'});
+
+    std::vector<unsigned char> out;
+    hj::zstd::err              e = hj::zstd::err::ok;
+    EXPECT_NO_THROW(e = hj::zstd::decompress(out, frame.data(), frame.size()));
+    EXPECT_NE(e, hj::zstd::err::ok);
+    EXPECT_TRUE(out.empty());
+
+    // a generous cap bounds the growth, it is not the first allocation
+    std::vector<unsigned char> capped;
+    EXPECT_NE(
+        hj::zstd::decompress(capped, frame.data(), frame.size(), 1ULL << 41),
+        hj::zstd::err::ok);
+    EXPECT_LT(capped.capacity(), size_t(1) << 20);
+}
+
+TEST_F(zstd, max_output_size_limit)
+{
+    std::vector<unsigned char> compressed, out;
+    ASSERT_EQ(
+        hj::zstd::compress(compressed, text_data.data(), text_data.size()),
+        hj::zstd::err::ok);
+
+    EXPECT_EQ(
+        hj::zstd::decompress(out, compressed.data(), compressed.size(), 1000),
+        hj::zstd::err::max_output_sz_exceeded);
+    EXPECT_EQ(hj::zstd::decompress(out,
+                                   compressed.data(),
+                                   compressed.size(),
+                                   text_data.size()),
+              hj::zstd::err::ok);
+    EXPECT_EQ(out, text_data);
+}
+
+TEST_F(zstd, concatenated_frames)
+{
+    std::vector<unsigned char> a, b, out;
+    ASSERT_EQ(hj::zstd::compress(a, test_data.data(), test_data.size()),
+              hj::zstd::err::ok);
+    ASSERT_EQ(hj::zstd::compress(b, text_data.data(), text_data.size()),
+              hj::zstd::err::ok);
+    a.insert(a.end(), b.begin(), b.end());
+
+    EXPECT_EQ(hj::zstd::decompress(out, a.data(), a.size()), hj::zstd::err::ok);
+    std::vector<unsigned char> expect = test_data;
+    expect.insert(expect.end(), text_data.begin(), text_data.end());
+    EXPECT_EQ(out, expect);
+}
+
+TEST_F(zstd, stream_compression)
+{
+    std::string       src(text_data.begin(), text_data.end());
+    std::stringstream in(src, std::ios::binary | std::ios::in);
+    std::stringstream compressed(std::ios::binary | std::ios::in
+                                 | std::ios::out);
+
+    // small chunks to cross many block boundaries
+    ASSERT_EQ(
+        hj::zstd::compress(compressed,
+                           in,
+                           hj::zstd::compression_lvl::default_compression,
+                           1000),
+        hj::zstd::err::ok);
+
+    // a stream frame decompresses one-shot too
+    std::string                payload = compressed.str();
+    std::vector<unsigned char> out;
+    EXPECT_EQ(hj::zstd::decompress(out, payload.data(), payload.size()),
+              hj::zstd::err::ok);
+    EXPECT_EQ(out, text_data);
+
+    std::stringstream  back(std::ios::binary | std::ios::in | std::ios::out);
+    std::istringstream zin(payload, std::ios::binary);
+    EXPECT_EQ(hj::zstd::decompress(back, zin, 0, 333), hj::zstd::err::ok);
+    EXPECT_EQ(back.str(), src);
+
+    std::ostringstream limited(std::ios::binary);
+    std::istringstream zin2(payload, std::ios::binary);
+    EXPECT_EQ(hj::zstd::decompress(limited, zin2, 1000),
+              hj::zstd::err::max_output_sz_exceeded);
+
+    std::ostringstream truncated(std::ios::binary);
+    std::istringstream zin3(payload.substr(0, payload.size() / 2),
+                            std::ios::binary);
+    EXPECT_EQ(hj::zstd::decompress(truncated, zin3), hj::zstd::err::data_error);
+}
+
+TEST_F(zstd, file_compression)
+{
+    {
+        std::ofstream out("zstd_test_input.txt", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(text_data.data()),
+                  text_data.size());
+    }
+
+    EXPECT_EQ(hj::zstd::compress_file("zstd_test_output.zst",
+                                      "zstd_test_input.txt"),
+              hj::zstd::err::ok);
+    EXPECT_EQ(hj::zstd::decompress_file("zstd_test_decompressed.txt",
+                                        "zstd_test_output.zst"),
+              hj::zstd::err::ok);
+
+    std::ifstream in("zstd_test_decompressed.txt", std::ios::binary);
+    std::string   dst((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+    EXPECT_EQ(dst, std::string(text_data.begin(), text_data.end()));
+
+    EXPECT_EQ(hj::zstd::compress_file("zstd_test_output.zst", "not_exist.txt"),
+              hj::zstd::err::read_buffer_error);
+}
+
+TEST_F(zstd, small_messages_multithread)
+{
+    // every thread reuses its own context
+    std::vector<std::thread> threads;
+    std::vector<int>         failures(4, 0);
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t, &failures]() {
+            std::vector<unsigned char> compressed, out;
+            for(int i = 0; i < 2000; ++i)
+            {
+                std::string msg = "{\"order\":" + std::to_string(t * 10000 + i)
+                                  + ",\"qty\":" + std::to_string(i % 100) + "}";
+                if(hj::zstd::compress(compressed, msg.data(), msg.size())
+                       != hj::zstd::err::ok
+                   || hj::zstd::decompress(
+                          out, compressed.data(), compressed.size())
+                          != hj::zstd::err::ok
+                   || std::string(out.begin(), out.end()) != msg)
+                    ++failures[t];
+            }
+        });
+    }
+    for(auto &th : threads)
+        th.join();
+
+    for(int f : failures)
+        EXPECT_EQ(f, 0);
+}
+
+TEST_F(zstd, compression_ratio)
+{
+    EXPECT_DOUBLE_EQ(hj::zstd::compression_ratio(0, 10), 0.0);
+    EXPECT_DOUBLE_EQ(hj::zstd::compression_ratio(100, 25), 0.75);
+}
+
+static std::vector<std::string> make_records(int n, unsigned seed)
+{
+    const char              *syms[] = {"AAPL", "MSFT", "NVDA", "TSLA"};
+    const char              *sides[] = {"buy", "sell"};
+    std::mt19937             gen(seed);
+    std::vector<std::string> out;
+    for(int i = 0; i < n; ++i)
+    {
+        out.push_back("{\"id\":" + std::to_string(gen() % 10000000)
+                      + ",\"symbol\":\"" + syms[gen() % 4] + "\",\"side\":\""
+                      + sides[gen() % 2]
+                      + "\",\"qty\":" + std::to_string(gen() % 1000)
+                      + ",\"px\":" + std::to_string(100 + gen() % 900)
+                      + ".25,\"tif\":\"day\",\"account\":\"ACC-"
+                      + std::to_string(gen() % 1000)
+                      + "\",\"venue\":\"XNAS\",\"status\":\"new\"}");
+    }
+    return out;
+}
+
+TEST_F(zstd, dictionary)
+{
+    hj::zstd::dictionary dict;
+    EXPECT_TRUE(dict.empty());
+    EXPECT_EQ(hj::zstd::dictionary::train(dict, {}),
+              hj::zstd::err::input_invalid);
+
+    auto samples = make_records(2000, 1);
+    ASSERT_EQ(hj::zstd::dictionary::train(dict, samples, 8 * 1024, 40001),
+              hj::zstd::err::ok);
+    EXPECT_FALSE(dict.empty());
+    EXPECT_EQ(dict.id(), 40001u);
+    EXPECT_LE(dict.size(), 8 * 1024u);
+
+    size_t                     plain_sz = 0, dict_sz = 0, raw_sz = 0;
+    std::vector<unsigned char> compressed, out;
+    for(const auto &msg : make_records(200, 2))
+    {
+        raw_sz += msg.size();
+        ASSERT_EQ(hj::zstd::compress(compressed, msg.data(), msg.size()),
+                  hj::zstd::err::ok);
+        plain_sz += compressed.size();
+
+        ASSERT_EQ(hj::zstd::compress(compressed, msg.data(), msg.size(), dict),
+                  hj::zstd::err::ok);
+        dict_sz += compressed.size();
+        EXPECT_EQ(hj::zstd::frame_dict_id(compressed.data(), compressed.size()),
+                  40001u);
+
+        ASSERT_EQ(hj::zstd::decompress(out,
+                                       compressed.data(),
+                                       compressed.size(),
+                                       dict),
+                  hj::zstd::err::ok);
+        EXPECT_EQ(std::string(out.begin(), out.end()), msg);
+    }
+    EXPECT_LT(dict_sz * 2, plain_sz);
+    EXPECT_LT(dict_sz * 3, raw_sz);
+
+    // the frame names its dictionary
+    EXPECT_EQ(hj::zstd::decompress(out, compressed.data(), compressed.size()),
+              hj::zstd::err::dictionary_wrong);
+    hj::zstd::dictionary other;
+    ASSERT_EQ(hj::zstd::dictionary::train(other, samples, 8 * 1024, 40002),
+              hj::zstd::err::ok);
+    EXPECT_EQ(hj::zstd::decompress(out,
+                                   compressed.data(),
+                                   compressed.size(),
+                                   other),
+              hj::zstd::err::dictionary_wrong);
+    EXPECT_TRUE(out.empty());
+
+    // plain frames still go through, the thread's context forgets dict
+    ASSERT_EQ(
+        hj::zstd::compress(compressed, test_data.data(), test_data.size()),
+        hj::zstd::err::ok);
+    EXPECT_EQ(hj::zstd::frame_dict_id(compressed.data(), compressed.size()),
+              0u);
+    ASSERT_EQ(hj::zstd::decompress(out, compressed.data(), compressed.size()),
+              hj::zstd::err::ok);
+    EXPECT_EQ(out, test_data);
+}
+
+TEST_F(zstd, dictionary_save_load)
+{
+    hj::zstd::dictionary dict, loaded, raw;
+    ASSERT_EQ(hj::zstd::dictionary::train(dict, make_records(2000, 3)),
+              hj::zstd::err::ok);
+    EXPECT_NE(dict.id(), 0u);
+    ASSERT_EQ(dict.save_file("zstd_test_output.zst"), hj::zstd::err::ok);
+    ASSERT_EQ(loaded.load_file("zstd_test_output.zst",
+                               hj::zstd::compression_lvl::best_compression),
+              hj::zstd::err::ok);
+    EXPECT_EQ(loaded.id(), dict.id());
+    EXPECT_EQ(loaded.level(), hj::zstd::compression_lvl::best_compression);
+    EXPECT_EQ(std::vector<unsigned char>(loaded.data(),
+                                         loaded.data() + loaded.size()),
+              std::vector<unsigned char>(dict.data(),
+                                         dict.data() + dict.size()));
+
+    std::string                msg = make_records(1, 4)[0];
+    std::vector<unsigned char> compressed, out;
+    ASSERT_EQ(hj::zstd::compress(compressed, msg.data(), msg.size(), dict),
+              hj::zstd::err::ok);
+    ASSERT_EQ(
+        hj::zstd::decompress(out, compressed.data(), compressed.size(), loaded),
+        hj::zstd::err::ok);
+    EXPECT_EQ(std::string(out.begin(), out.end()), msg);
+
+    // raw content, no id in the frames
+    ASSERT_EQ(raw.load(text_data.data(), 4096), hj::zstd::err::ok);
+    EXPECT_EQ(raw.id(), 0u);
+    ASSERT_EQ(hj::zstd::compress(compressed, msg.data(), msg.size(), raw),
+              hj::zstd::err::ok);
+    EXPECT_EQ(hj::zstd::frame_dict_id(compressed.data(), compressed.size()),
+              0u);
+    ASSERT_EQ(
+        hj::zstd::decompress(out, compressed.data(), compressed.size(), raw),
+        hj::zstd::err::ok);
+    EXPECT_EQ(std::string(out.begin(), out.end()), msg);
+
+    hj::zstd::dictionary empty;
+    EXPECT_EQ(empty.save_file("zstd_test_output.zst"),
+              hj::zstd::err::input_invalid);
+    EXPECT_EQ(hj::zstd::compress(compressed, msg.data(), msg.size(), empty),
+              hj::zstd::err::input_invalid);
+    EXPECT_EQ(empty.load_file("not_exist.dict"),
+              hj::zstd::err::read_buffer_error);
+}
+
+TEST_F(zstd, dictionary_shared_across_threads)
+{
+    hj::zstd::dictionary dict;
+    ASSERT_EQ(hj::zstd::dictionary::train(dict, make_records(2000, 5)),
+              hj::zstd::err::ok);
+
+    std::vector<std::thread> threads;
+    std::vector<int>         failures(4, 0);
+    for(int t = 0; t < 4; ++t)
+    {
+        // copies share the digested dictionaries
+        threads.emplace_back([t, dict, &failures]() {
+            std::vector<unsigned char> compressed, out;
+            for(const auto &msg : make_records(500, 10 + t))
+            {
+                if(hj::zstd::compress(compressed, msg.data(), msg.size(), dict)
+                       != hj::zstd::err::ok
+                   || hj::zstd::decompress(out,
+                                           compressed.data(),
+                                           compressed.size(),
+                                           dict)
+                          != hj::zstd::err::ok
+                   || std::string(out.begin(), out.end()) != msg)
+                    ++failures[t];
+            }
+        });
+    }
+    for(auto &th : threads)
+        th.join();
+
+    for(int f : failures)
+        EXPECT_EQ(f, 0);
+}